@@ -0,0 +1,133 @@
+#ifndef BOIDTABLE_H_
+#define BOIDTABLE_H_
+
+#include "ConstexprMath.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BoidTable.h
+/// @brief compile time boid table, 4 triangles as 12 positions followed by the 12 face normals so the struct can be
+/// uploaded as one buffer with the normals at an offset of 12*3 floats. Use as
+/// static constexpr auto boid = makeBoid();
+//----------------------------------------------------------------------------------------------------------------------
+struct BoidMesh
+{
+  std::array<cmath::Float3, 12> positions;
+  std::array<cmath::Float3, 12> normals;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the same result as ngl::calcNormal
+//----------------------------------------------------------------------------------------------------------------------
+constexpr cmath::Float3 calcNormal(const cmath::Float3 &_p1, const cmath::Float3 &_p2, const cmath::Float3 &_p3)
+{
+  double ax = static_cast<double>(_p2.x) - _p1.x;
+  double ay = static_cast<double>(_p2.y) - _p1.y;
+  double az = static_cast<double>(_p2.z) - _p1.z;
+  double bx = static_cast<double>(_p3.x) - _p1.x;
+  double by = static_cast<double>(_p3.y) - _p1.y;
+  double bz = static_cast<double>(_p3.z) - _p1.z;
+  double nx = ay * bz - az * by;
+  double ny = az * bx - ax * bz;
+  double nz = ax * by - ay * bx;
+  double length = cmath::sqrt(nx * nx + ny * ny + nz * nz);
+  if (length == 0.0)
+  {
+    return {0.0f, 0.0f, 0.0f};
+  }
+  return {static_cast<float>(-nx / length), static_cast<float>(-ny / length), static_cast<float>(-nz / length)};
+}
+
+constexpr BoidMesh makeBoid()
+{
+  BoidMesh boid{
+      {{{0.0f, 1.0f, 1.0f},
+        {0.0f, 0.0f, -1.0f},
+        {-0.5f, 0.0f, 1.0f},
+        {0.0f, 1.0f, 1.0f},
+        {0.0f, 0.0f, -1.0f},
+        {0.5f, 0.0f, 1.0f},
+        {0.0f, 1.0f, 1.0f},
+        {0.0f, 0.0f, 1.5f},
+        {-0.5f, 0.0f, 1.0f},
+        {0.0f, 1.0f, 1.0f},
+        {0.0f, 0.0f, 1.5f},
+        {0.5f, 0.0f, 1.0f}}},
+      {}};
+  // the winding of each face is not consistent so the vertex order for the normal is per face
+  constexpr size_t order[4][3] = {{2, 1, 0}, {3, 4, 5}, {6, 7, 8}, {11, 10, 9}};
+  for (size_t f = 0; f < 4; ++f)
+  {
+    auto n = calcNormal(boid.positions[order[f][0]], boid.positions[order[f][1]], boid.positions[order[f][2]]);
+    for (size_t i = 0; i < 3; ++i)
+    {
+      boid.normals[f * 3 + i] = n;
+    }
+  }
+  return boid;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a triangle soup with its equal positions shared, Vertices unique positions in first use order and an index
+/// per corner of the soup
+//----------------------------------------------------------------------------------------------------------------------
+template <size_t Vertices, size_t Indices>
+struct IndexedMesh
+{
+  std::array<cmath::Float3, Vertices> positions;
+  std::array<uint16_t, Indices> indices;
+};
+
+constexpr bool samePosition(const cmath::Float3 &_a, const cmath::Float3 &_b)
+{
+  return _a.x == _b.x && _a.y == _b.y && _a.z == _b.z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the number of different positions in _soup, the Vertices to give weldPositions
+//----------------------------------------------------------------------------------------------------------------------
+template <size_t N>
+constexpr size_t countUnique(const std::array<cmath::Float3, N> &_soup)
+{
+  size_t unique = 0;
+  for (size_t i = 0; i < N; ++i)
+  {
+    bool first = true;
+    for (size_t j = 0; j < i && first; ++j)
+    {
+      first = !samePosition(_soup[j], _soup[i]);
+    }
+    unique += first;
+  }
+  return unique;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief weld equal positions at compile time, a search per corner is nothing for a table this size. Use as
+/// static constexpr auto mesh = weldPositions<countUnique(soup)>(soup);
+//----------------------------------------------------------------------------------------------------------------------
+template <size_t Vertices, size_t N>
+constexpr IndexedMesh<Vertices, N> weldPositions(const std::array<cmath::Float3, N> &_soup)
+{
+  static_assert(Vertices <= 65536, "the indices are 16 bit");
+  IndexedMesh<Vertices, N> mesh{};
+  size_t next = 0;
+  for (size_t i = 0; i < N; ++i)
+  {
+    size_t index = 0;
+    while (index < next && !samePosition(mesh.positions[index], _soup[i]))
+    {
+      ++index;
+    }
+    if (index == next)
+    {
+      mesh.positions[next++] = _soup[i];
+    }
+    mesh.indices[i] = static_cast<uint16_t>(index);
+  }
+  return mesh;
+}
+
+#endif
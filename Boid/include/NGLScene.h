@@ -4,6 +4,7 @@
 #include <ngl/Mat4.h>
 #include <ngl/Vec3.h>
 #include "WindowParams.h"
+#include "UniformHandle.h"
 #include <QOpenGLWindow>
 #include <memory>
 
@@ -71,6 +72,10 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     std::unique_ptr<ngl::AbstractVAO> m_vao;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the MVP uniform of the shader, found once after linking
+    //----------------------------------------------------------------------------------------------------------------------
+    UniformHandle m_MVPUniform;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief Qt Event called when a key is pressed
     /// @param [in] _event the Qt event to query for size etc
     //----------------------------------------------------------------------------------------------------------------------
@@ -4,8 +4,9 @@
 #include <ngl/Transformation.h>
 #include <ngl/NGLInit.h>
 #include <ngl/VAOFactory.h>
-#include <ngl/SimpleVAO.h>
+#include <ngl/SimpleIndexVAO.h>
 #include <ngl/ShaderLib.h>
+#include "BoidTable.h"
 #include <iostream>
 
 NGLScene::NGLScene()
@@ -53,38 +54,34 @@ void NGLScene::initializeGL()
   // grab an instance of shader manager
   ngl::ShaderLib::use("nglColourShader");
   ngl::ShaderLib::setUniform("Colour", 1.0f, 1.0f, 1.0f, 1.0f);
+  // looked up once here so paintGL sets MVP without a name lookup
+  m_MVPUniform = UniformHandle(ngl::ShaderLib::getProgramID("nglColourShader"), "MVP");
   buildVAO();
   glViewport(0, 0, width(), height());
 }
 
 void NGLScene::buildVAO()
 {
-  std::array<ngl::Vec3, 12> verts =
-      {{ngl::Vec3(0.0f, 1.0f, 1.0f),
-        ngl::Vec3(0.0f, 0.0f, -1.0f),
-        ngl::Vec3(-0.5f, 0.0f, 1.0f),
-        ngl::Vec3(0.0f, 1.0f, 1.0f),
-        ngl::Vec3(0.0f, 0.0f, -1.0f),
-        ngl::Vec3(0.5f, 0.0f, 1.0f),
-        ngl::Vec3(0.0f, 1.0f, 1.0f),
-        ngl::Vec3(0.0f, 0.0f, 1.5f),
-        ngl::Vec3(-0.5f, 0.0f, 1.0f),
-        ngl::Vec3(0.0f, 1.0f, 1.0f),
-        ngl::Vec3(0.0f, 0.0f, 1.5f),
-        ngl::Vec3(0.5f, 0.0f, 1.0f)}};
-  std::cout << "sizeof(verts) " << sizeof(verts) << " sizeof(ngl::Vec3) " << sizeof(ngl::Vec3) << "\n";
+  // built by the compiler, this demo only needs the positions
+  static constexpr auto boid = makeBoid();
+  // the table is a triangle soup, the compiler welds the corners the faces have in common
+  static constexpr auto welded = weldPositions<countUnique(boid.positions)>(boid.positions);
+  static_assert(welded.positions.size() == 5, "the boid has 5 distinct corners");
   // create a vao as a series of GL_TRIANGLES
-  m_vao = ngl::VAOFactory::createVAO(ngl::simpleVAO, GL_TRIANGLES);
+  m_vao = ngl::VAOFactory::createVAO(ngl::simpleIndexVAO, GL_TRIANGLES);
   m_vao->bind();
 
-  // in this case we are going to set our data as the vertices above
-  m_vao->setData(ngl::SimpleVAO::VertexData(verts.size() * sizeof(ngl::Vec3), verts[0].m_x));
+  // in this case we are going to set our data as the welded vertices and indices
+  m_vao->setData(ngl::SimpleIndexVAO::VertexData(
+      sizeof(welded.positions),
+      welded.positions[0].x,
+      static_cast<unsigned int>(welded.indices.size()), &welded.indices[0],
+      GL_UNSIGNED_SHORT));
   // now we set the attribute pointer to be 0 (as this matches vertIn in our shader)
 
   m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, 0, 0);
 
-  // divide by 2 as we have both verts and normals
-  m_vao->setNumIndices(verts.size());
+  m_vao->setNumIndices(welded.indices.size());
 
   // now unbind
   m_vao->unbind();
@@ -111,10 +108,9 @@ void NGLScene::paintGL()
   ngl::Mat4 MVP;
   MVP = m_project * m_view * m_mouseGlobalTX;
 
-  ngl::ShaderLib::setUniform("MVP", MVP);
+  m_MVPUniform.set(MVP);
 
   m_vao->bind();
-  ngl::ShaderLib::setUniform("MVP", MVP);
   m_vao->draw();
   m_vao->unbind();
 }
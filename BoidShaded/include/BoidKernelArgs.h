@@ -0,0 +1,60 @@
+#ifndef BOIDKERNELARGS_H_
+#define BOIDKERNELARGS_H_
+
+#include <cstddef>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BoidKernelArgs.h
+/// @brief the raw pointer form of the BoidKernels arguments used by each instruction set. The SIMD versions are
+/// built with their own compiler flags so they only see this header, anything inline from elsewhere (ngl, the
+/// standard library) could otherwise be emitted with AVX2 instructions and picked by the linker for the rest of the
+/// program. All the arrays hold _count values rounded up to a whole register.
+//----------------------------------------------------------------------------------------------------------------------
+struct SteerArgs
+{
+  const float *px,*py,*pz;
+  const float *vx,*vy,*vz;
+  const float *neighbours;
+  const float *headingX,*headingY,*headingZ;
+  const float *centreX,*centreY,*centreZ;
+  const float *separationX,*separationY,*separationZ;
+  float *fx,*fy,*fz;
+  size_t count;
+  float separationWeight;
+  float alignmentWeight;
+  float cohesionWeight;
+  float boundsWeight;
+  float maxSpeed;
+  float maxForce;
+  float boundsX,boundsY,boundsZ;
+};
+
+struct IntegrateArgs
+{
+  const float *px,*py,*pz;
+  const float *vx,*vy,*vz;
+  const float *fx,*fy,*fz;
+  float *nextPx,*nextPy,*nextPz;
+  float *nextVx,*nextVy,*nextVz;
+  size_t count;
+  float dt;
+  float minSpeed;
+  float maxSpeed;
+};
+
+namespace boidKernels
+{
+  void steerScalar(const SteerArgs &_args);
+  void integrateScalar(const IntegrateArgs &_args);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief false if the file wasn't built with the instruction set, the CPU check is done by the caller
+  //----------------------------------------------------------------------------------------------------------------------
+  bool builtAVX2();
+  void steerAVX2(const SteerArgs &_args);
+  void integrateAVX2(const IntegrateArgs &_args);
+  bool builtNEON();
+  void steerNEON(const SteerArgs &_args);
+  void integrateNEON(const IntegrateArgs &_args);
+}
+
+#endif
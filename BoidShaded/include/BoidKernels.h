@@ -0,0 +1,54 @@
+#ifndef BOIDKERNELS_H_
+#define BOIDKERNELS_H_
+
+#include "BoidStore.h"
+#include "FlockParams.h"
+#include <cstddef>
+#include <string>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the per boid parts of the flock update working on whole SoA ranges so they can run a SIMD register of
+/// boids at a time. Every instruction set provides the same functions and the scalar set is the reference, the
+/// others must agree with it to within rounding (they use FMA and a different order of operations).
+/// A range is [_offset,_offset+_count) in the boid arrays and [0,_count) in the per block sums and force arrays,
+/// _offset must be a multiple of SoABuffer::c_simdWidth.
+//----------------------------------------------------------------------------------------------------------------------
+struct BoidKernels
+{
+  const char *name;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the steering sum, the weighted separation, alignment, cohesion and bounds steering for each boid from
+  /// its NeighbourSum values, limited to maxForce and written to the 3 channels of o_force
+  //----------------------------------------------------------------------------------------------------------------------
+  void (*steer)(const BoidStore &_boids, size_t _offset, size_t _count, const SoABuffer &_sums,
+                const FlockParams &_params, SoABuffer &o_force);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add _force*_dt to the velocity, clamp the speed to [minSpeed,maxSpeed] then move the boid, the result
+  /// is written to the same range of o_next
+  //----------------------------------------------------------------------------------------------------------------------
+  void (*integrate)(const BoidStore &_boids, size_t _offset, size_t _count, const SoABuffer &_force, float _dt,
+                    const FlockParams &_params, BoidStore &o_next);
+};
+
+namespace boidKernels
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief plain C++, always available
+  //----------------------------------------------------------------------------------------------------------------------
+  const BoidKernels &scalar();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief nullptr if they weren't built for this target or the CPU doesn't support them
+  //----------------------------------------------------------------------------------------------------------------------
+  const BoidKernels *avx2();
+  const BoidKernels *neon();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the fastest set this CPU can run
+  //----------------------------------------------------------------------------------------------------------------------
+  const BoidKernels &best();
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief look a set up by name (scalar, avx2 or neon), nullptr if it isn't available
+  //----------------------------------------------------------------------------------------------------------------------
+  const BoidKernels *find(const std::string &_name);
+}
+
+#endif
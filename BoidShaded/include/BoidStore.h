@@ -0,0 +1,73 @@
+#ifndef BOIDSTORE_H_
+#define BOIDSTORE_H_
+
+#include "FlockParams.h"
+#include <cstddef>
+#include <memory>
+#include <new>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class SoABuffer
+/// @brief a fixed number of float channels of the same length, each channel is its own array aligned to a cache line
+/// and padded to a whole number of SIMD registers so the kernels can use full width loads on any range that starts
+/// on a multiple of c_simdWidth. The padding is zero filled.
+//----------------------------------------------------------------------------------------------------------------------
+class SoABuffer
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the widest register used by the kernels in floats (AVX2)
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr size_t c_simdWidth=8;
+    static constexpr size_t c_alignment=64;
+    explicit SoABuffer(size_t _channels, size_t _size=0);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief resize every channel, the contents are not kept
+    //----------------------------------------------------------------------------------------------------------------------
+    void resize(size_t _size);
+    size_t size() const {return m_size;}
+    size_t channels() const {return m_channels;}
+    float *operator[](size_t _channel) {return m_data.get()+_channel*m_stride;}
+    const float *operator[](size_t _channel) const {return m_data.get()+_channel*m_stride;}
+    void swap(SoABuffer &_other) noexcept;
+
+  private :
+    struct AlignedDelete
+    {
+      void operator()(float *_p) const {::operator delete[](_p,std::align_val_t(c_alignment));}
+    };
+    size_t m_channels;
+    size_t m_size=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the distance between channels in floats, the padded size rounded up to a cache line
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_stride=0;
+    std::unique_ptr<float[],AlignedDelete> m_data;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class BoidStore
+/// @brief the flock state as separate position and velocity x,y,z arrays
+//----------------------------------------------------------------------------------------------------------------------
+class BoidStore : public SoABuffer
+{
+  public :
+    enum Channel : size_t {PX,PY,PZ,VX,VY,VZ,NumChannels};
+    explicit BoidStore(size_t _size=0) : SoABuffer(NumChannels,_size){}
+    Boid get(size_t _i) const;
+    void set(size_t _i, const Boid &_boid);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the per boid neighbour sums the steering kernel works from, laid out the same way
+//----------------------------------------------------------------------------------------------------------------------
+enum NeighbourSum : size_t
+{
+  Neighbours,
+  HeadingX,HeadingY,HeadingZ,
+  CentreX,CentreY,CentreZ,
+  SeparationX,SeparationY,SeparationZ,
+  NumNeighbourSums
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef BOIDTABLE_H_
+#define BOIDTABLE_H_
+
+#include "ConstexprMath.h"
+#include <array>
+#include <cstddef>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BoidTable.h
+/// @brief compile time boid table, 4 triangles as 12 positions followed by the 12 face normals so the struct can be
+/// uploaded as one buffer with the normals at an offset of 12*3 floats. Use as
+/// static constexpr auto boid = makeBoid();
+//----------------------------------------------------------------------------------------------------------------------
+struct BoidMesh
+{
+  std::array<cmath::Float3, 12> positions;
+  std::array<cmath::Float3, 12> normals;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the same result as ngl::calcNormal
+//----------------------------------------------------------------------------------------------------------------------
+constexpr cmath::Float3 calcNormal(const cmath::Float3 &_p1, const cmath::Float3 &_p2, const cmath::Float3 &_p3)
+{
+  double ax = static_cast<double>(_p2.x) - _p1.x;
+  double ay = static_cast<double>(_p2.y) - _p1.y;
+  double az = static_cast<double>(_p2.z) - _p1.z;
+  double bx = static_cast<double>(_p3.x) - _p1.x;
+  double by = static_cast<double>(_p3.y) - _p1.y;
+  double bz = static_cast<double>(_p3.z) - _p1.z;
+  double nx = ay * bz - az * by;
+  double ny = az * bx - ax * bz;
+  double nz = ax * by - ay * bx;
+  double length = cmath::sqrt(nx * nx + ny * ny + nz * nz);
+  if (length == 0.0)
+  {
+    return {0.0f, 0.0f, 0.0f};
+  }
+  return {static_cast<float>(-nx / length), static_cast<float>(-ny / length), static_cast<float>(-nz / length)};
+}
+
+constexpr BoidMesh makeBoid()
+{
+  BoidMesh boid{
+      {{{0.0f, 1.0f, 1.0f},
+        {0.0f, 0.0f, -1.0f},
+        {-0.5f, 0.0f, 1.0f},
+        {0.0f, 1.0f, 1.0f},
+        {0.0f, 0.0f, -1.0f},
+        {0.5f, 0.0f, 1.0f},
+        {0.0f, 1.0f, 1.0f},
+        {0.0f, 0.0f, 1.5f},
+        {-0.5f, 0.0f, 1.0f},
+        {0.0f, 1.0f, 1.0f},
+        {0.0f, 0.0f, 1.5f},
+        {0.5f, 0.0f, 1.0f}}},
+      {}};
+  // the winding of each face is not consistent so the vertex order for the normal is per face
+  constexpr size_t order[4][3] = {{2, 1, 0}, {3, 4, 5}, {6, 7, 8}, {11, 10, 9}};
+  for (size_t f = 0; f < 4; ++f)
+  {
+    auto n = calcNormal(boid.positions[order[f][0]], boid.positions[order[f][1]], boid.positions[order[f][2]]);
+    for (size_t i = 0; i < 3; ++i)
+    {
+      boid.normals[f * 3 + i] = n;
+    }
+  }
+  return boid;
+}
+
+#endif
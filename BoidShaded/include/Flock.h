@@ -0,0 +1,69 @@
+#ifndef FLOCK_H_
+#define FLOCK_H_
+
+#include "BoidKernels.h"
+#include "BoidStore.h"
+#include "FlockParams.h"
+#include "SpatialGrid.h"
+#include <ngl/Vec3.h>
+#include <cstddef>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class Flock
+/// @brief Reynolds flocking (separation, alignment and cohesion) for N boids. The state is double buffered so every
+/// boid reads the previous step and the update runs in parallel. This has no GL in it so it can be run headless.
+/// With the grid search the boids are re-ordered by cell each step so the neighbours of a boid are close in memory,
+/// this means the order of the boids changes from step to step. The state is held as separate x,y,z arrays and the
+/// per boid steering and integration run through BoidKernels so a register of boids is done at a time.
+//----------------------------------------------------------------------------------------------------------------------
+class Flock
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create the flock with random positions and velocities inside the bounds
+    /// @param _seed the random seed so runs can be repeated
+    //----------------------------------------------------------------------------------------------------------------------
+    Flock(size_t _numBoids, const FlockParams &_params={}, unsigned int _seed=1);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief advance the flock by _dt seconds
+    //----------------------------------------------------------------------------------------------------------------------
+    void update(float _dt);
+    size_t size() const {return m_boids.size();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the current state as separate position and velocity arrays
+    //----------------------------------------------------------------------------------------------------------------------
+    const BoidStore &store() const {return m_boids;}
+    Boid boid(size_t _i) const {return m_boids.get(_i);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief pack the boids into the interleaved instance layout, o_instances must have room for size() boids
+    //----------------------------------------------------------------------------------------------------------------------
+    void writeInstances(Boid *o_instances) const;
+    const FlockParams &params() const {return m_params;}
+    void setParams(const FlockParams &_params);
+    NeighbourSearch neighbourSearch() const {return m_search;}
+    void setNeighbourSearch(NeighbourSearch _search) {m_search=_search;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the kernels used for the per boid steering and integration, the default is boidKernels::best()
+    //----------------------------------------------------------------------------------------------------------------------
+    const BoidKernels &kernels() const {return *m_kernels;}
+    void setKernels(const BoidKernels &_kernels) {m_kernels=&_kernels;}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the boids are updated in blocks of this many so the sums and forces for a block stay in cache
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr size_t c_blockSize=256;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sum the neighbours of boid _i in the current state into entry _k of o_sums
+    //----------------------------------------------------------------------------------------------------------------------
+    void accumulate(size_t _i, SoABuffer &o_sums, size_t _k) const;
+    void configureGrid();
+    FlockParams m_params;
+    NeighbourSearch m_search=NeighbourSearch::Grid;
+    const BoidKernels *m_kernels;
+    SpatialGrid m_grid;
+    BoidStore m_boids;
+    BoidStore m_next;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef FLOCKPARAMS_H_
+#define FLOCKPARAMS_H_
+
+#include <ngl/Vec3.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the state of a single boid, this is the per instance layout streamed to the GPU. The flock itself is
+/// stored as separate x,y,z arrays (see BoidStore) and packed into this layout for upload.
+//----------------------------------------------------------------------------------------------------------------------
+struct Boid
+{
+  ngl::Vec3 position;
+  ngl::Vec3 velocity;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the tuning values for the flock
+//----------------------------------------------------------------------------------------------------------------------
+struct FlockParams
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief boids closer than this are used for alignment and cohesion
+  //----------------------------------------------------------------------------------------------------------------------
+  float neighbourRadius=1.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief boids closer than this push each other apart
+  //----------------------------------------------------------------------------------------------------------------------
+  float separationRadius=0.4f;
+  float separationWeight=1.5f;
+  float alignmentWeight=1.0f;
+  float cohesionWeight=1.0f;
+  float minSpeed=0.5f;
+  float maxSpeed=2.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the largest steering acceleration applied in one update
+  //----------------------------------------------------------------------------------------------------------------------
+  float maxForce=4.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the half size of the box the flock is kept in, boids outside it are steered back
+  //----------------------------------------------------------------------------------------------------------------------
+  ngl::Vec3 bounds={10.0f,10.0f,10.0f};
+  float boundsWeight=2.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the neighbour grid cell size, 0 uses the neighbour radius
+  //----------------------------------------------------------------------------------------------------------------------
+  float cellSize=0.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the half size of the box covered by the grid, boids do go a little outside bounds
+  //----------------------------------------------------------------------------------------------------------------------
+  ngl::Vec3 gridBounds={12.0f,12.0f,12.0f};
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief how each boid finds its neighbours, BruteForce tests every pair and is kept as the reference
+//----------------------------------------------------------------------------------------------------------------------
+enum class NeighbourSearch {Grid,BruteForce};
+
+#endif
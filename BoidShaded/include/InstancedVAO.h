@@ -0,0 +1,68 @@
+#ifndef INSTANCEDVAO_H_
+#define INSTANCEDVAO_H_
+
+#include <ngl/AbstractVAO.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class InstancedVAO
+/// @brief a VAO with two buffers, one with the mesh set with setData and one with per instance data which is
+/// expected to change every frame. draw uses glDrawArraysInstanced so the whole set is a single draw call.
+//----------------------------------------------------------------------------------------------------------------------
+class InstancedVAO : public ngl::AbstractVAO
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief creator method for the factory
+    /// @param _mode the mode to draw with.
+    /// @returns a new AbstractVAO * object
+    //----------------------------------------------------------------------------------------------------------------------
+    static std::unique_ptr<ngl::AbstractVAO> create(GLenum _mode=GL_TRIANGLES) { return std::unique_ptr<AbstractVAO>(new InstancedVAO(_mode)); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw numIndices vertices for each instance
+    //----------------------------------------------------------------------------------------------------------------------
+    void draw() const override;
+    virtual ~InstancedVAO()=default;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief remove the VAO and both buffers
+    //----------------------------------------------------------------------------------------------------------------------
+    void removeVAO() override;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the per vertex (mesh) data
+    //----------------------------------------------------------------------------------------------------------------------
+    void setData(const VertexData &_data) override;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief map the instance buffer for writing, the old contents are orphaned so this doesn't wait for the GPU to
+    /// finish with the previous frame. The buffer is only re-allocated when it has to grow.
+    /// @param _size the size in bytes of the instance data
+    /// @param _numInstances the number of instances drawn
+    /// @returns the pointer to write the data to, only valid until unmapInstances, or nullptr if the buffer couldn't
+    /// be mapped (or _size is 0) in which case there is nothing to unmap and no instances are drawn
+    //----------------------------------------------------------------------------------------------------------------------
+    void *mapInstances(size_t _size, size_t _numInstances);
+    void unmapInstances();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief like setVertexAttributePointer but for the instance buffer, the attribute advances once per instance
+    //----------------------------------------------------------------------------------------------------------------------
+    void setInstanceAttributePointer(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, unsigned int _dataOffset);
+    size_t numInstances() const {return m_numInstances;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief return the id of the buffer, 0 is the mesh 1 is the instance data
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint getBufferID(unsigned int _buffer) const override {return _buffer==0 ? m_meshBuffer : m_instanceBuffer;}
+    // not needed for the demo, use mapInstances for the instance data
+    ngl::Real *mapBuffer(unsigned int, GLenum) override {return nullptr;}
+
+  protected :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor calles parent ctor to allocate vao;
+    //----------------------------------------------------------------------------------------------------------------------
+    InstancedVAO(GLenum _mode) : ngl::AbstractVAO(_mode) {}
+
+  private :
+    GLuint m_meshBuffer=0;
+    GLuint m_instanceBuffer=0;
+    size_t m_instanceCapacity=0;
+    size_t m_numInstances=0;
+};
+
+#endif
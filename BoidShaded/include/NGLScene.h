@@ -4,6 +4,12 @@
 #include <ngl/Vec3.h>
 #include <ngl/Mat4.h>
 #include "WindowParams.h"
+#include "TransformCache.h"
+#include "UniformBuffer.h"
+#include "PhongBlocks.h"
+#include "Flock.h"
+#include "InstancedVAO.h"
+#include <QElapsedTimer>
 #include <QOpenGLWindow>
 #include <memory>
 
@@ -25,9 +31,10 @@ class NGLScene : public QOpenGLWindow
   public:
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief ctor for our NGL drawing class
-    /// @param [in] parent the parent window to the class
+    /// @param _numBoids the size of the flock
+    /// @param _params the flock settings
     //----------------------------------------------------------------------------------------------------------------------
-    NGLScene();
+    explicit NGLScene(size_t _numBoids=2000, const FlockParams &_params={});
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief dtor must close down ngl and release OpenGL resources
     //----------------------------------------------------------------------------------------------------------------------
@@ -51,10 +58,9 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     WinParams m_win;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Our Camera
+    /// @brief Our Camera and the model transform, with the matrices made from them cached
     //----------------------------------------------------------------------------------------------------------------------
-    ngl::Mat4 m_view;
-    ngl::Mat4 m_project;
+    TransformCache m_transforms;
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief the model position for mouse movement
     //----------------------------------------------------------------------------------------------------------------------
@@ -66,7 +72,19 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief a simple light use to illuminate the screen
     //----------------------------------------------------------------------------------------------------------------------
-    std::unique_ptr<ngl::AbstractVAO> m_vao;
+    std::unique_ptr<InstancedVAO> m_vao;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the Phong light and a library of materials, m_material is the one drawn with
+    //----------------------------------------------------------------------------------------------------------------------
+    std::unique_ptr<UniformBuffer> m_light;
+    std::unique_ptr<UniformBuffer> m_materials;
+    size_t m_material=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the simulation, drawn as one instance of the boid mesh per boid
+    //----------------------------------------------------------------------------------------------------------------------
+    std::unique_ptr<Flock> m_flock;
+    QElapsedTimer m_timer;
+    bool m_animate=true;
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief Qt Event called when a key is pressed
     /// @param [in] _event the Qt event to query for size etc
@@ -100,8 +118,10 @@ private:
     /// @brief build our VAO
     //----------------------------------------------------------------------------------------------------------------------
     void buildVAO();
-
-
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief step the flock
+    //----------------------------------------------------------------------------------------------------------------------
+    void timerEvent(QTimerEvent *) override;
 };
 
 
@@ -0,0 +1,138 @@
+#ifndef SPATIALGRID_H_
+#define SPATIALGRID_H_
+
+#include "JobSystem.h"
+#include <ngl/Vec3.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class SpatialGrid
+/// @brief a uniform grid over a box built with a counting sort (cell histogram, prefix sum, scatter) every step.
+/// Cells are numbered x fastest so a row of cells is one contiguous span of the sorted order, neighbour queries are
+/// a handful of spans rather than a walk over all of the points. Points outside the box are clamped into the border
+/// cells so queries are still correct, just slower if a lot of points leave.
+//----------------------------------------------------------------------------------------------------------------------
+class SpatialGrid
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @param _cellSize the size of each cell, the neighbour radius is usually the best choice
+    /// @param _min the minimum corner of the domain
+    /// @param _max the maximum corner of the domain
+    //----------------------------------------------------------------------------------------------------------------------
+    SpatialGrid(float _cellSize, const ngl::Vec3 &_min, const ngl::Vec3 &_max);
+    void configure(float _cellSize, const ngl::Vec3 &_min, const ngl::Vec3 &_max);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sort _count points into the cells
+    /// @param _position called as _position(i) to get point i, this is called once per point
+    //----------------------------------------------------------------------------------------------------------------------
+    template<typename PositionFunc>
+    void build(size_t _count, PositionFunc &&_position);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief call _func(begin,end) for each span of the sorted order that may hold points within _radius of _p.
+    /// Positions in sorted order k are point order()[k].
+    //----------------------------------------------------------------------------------------------------------------------
+    template<typename Func>
+    void forEachCandidate(const ngl::Vec3 &_p, float _radius, Func &&_func) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sorted position k holds point order()[k], within a cell the points stay in index order
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<uint32_t> &order() const {return m_order;}
+    size_t numCells() const {return m_cellStart.size()-1;}
+    float cellSize() const {return m_cellSize;}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the cell along _axis, clamped to the grid before converting to int as converting a float outside the
+    /// int range (or NaN) is undefined. A NaN or -inf position goes in the first cell and +inf in the last.
+    //----------------------------------------------------------------------------------------------------------------------
+    int cellCoord(float _v, int _axis) const
+    {
+      float c=(_v-m_min[_axis])*m_invCellSize;
+      // NaN fails this test too
+      if(!(c>0.0f))
+      {
+        return 0;
+      }
+      int last=m_dims[_axis]-1;
+      return c<static_cast<float>(last) ? static_cast<int>(c) : last;
+    }
+    uint32_t cellIndex(const ngl::Vec3 &_p) const
+    {
+      return static_cast<uint32_t>(cellCoord(_p.m_x,0)+m_dims[0]*(cellCoord(_p.m_y,1)+m_dims[1]*cellCoord(_p.m_z,2)));
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the prefix sum, scatter and per cell ordering once the cells are known
+    //----------------------------------------------------------------------------------------------------------------------
+    void sortCells();
+    float m_cellSize=1.0f;
+    float m_invCellSize=1.0f;
+    float m_min[3]={0.0f,0.0f,0.0f};
+    int m_dims[3]={1,1,1};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief points per cell, then the write cursor for each cell during the scatter
+    //----------------------------------------------------------------------------------------------------------------------
+    std::unique_ptr<std::atomic<uint32_t>[]> m_counts;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief numCells+1 offsets into m_order
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<uint32_t> m_cellStart;
+    std::vector<uint32_t> m_cellOf;
+    std::vector<uint32_t> m_order;
+    static constexpr size_t c_minPerChunk=4096;
+};
+
+template<typename PositionFunc>
+void SpatialGrid::build(size_t _count, PositionFunc &&_position)
+{
+  m_cellOf.resize(_count);
+  m_order.resize(_count);
+  size_t cells=numCells();
+  parallelFor(cells,parallelChunks(cells,c_minPerChunk*4),[this](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t c=_begin; c<_end; ++c)
+    {
+      m_counts[c].store(0,std::memory_order_relaxed);
+    }
+  });
+  // histogram
+  parallelFor(_count,parallelChunks(_count,c_minPerChunk),[&](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      uint32_t cell=cellIndex(_position(i));
+      m_cellOf[i]=cell;
+      m_counts[cell].fetch_add(1,std::memory_order_relaxed);
+    }
+  });
+  sortCells();
+}
+
+template<typename Func>
+void SpatialGrid::forEachCandidate(const ngl::Vec3 &_p, float _radius, Func &&_func) const
+{
+  int x0=cellCoord(_p.m_x-_radius,0);
+  int x1=cellCoord(_p.m_x+_radius,0);
+  int y0=cellCoord(_p.m_y-_radius,1);
+  int y1=cellCoord(_p.m_y+_radius,1);
+  int z0=cellCoord(_p.m_z-_radius,2);
+  int z1=cellCoord(_p.m_z+_radius,2);
+  for(int z=z0; z<=z1; ++z)
+  {
+    for(int y=y0; y<=y1; ++y)
+    {
+      size_t row=static_cast<size_t>(m_dims[0])*(y+static_cast<size_t>(m_dims[1])*z);
+      uint32_t begin=m_cellStart[row+x0];
+      uint32_t end=m_cellStart[row+x1+1];
+      if(begin !=end)
+      {
+        _func(begin,end);
+      }
+    }
+  }
+}
+
+#endif
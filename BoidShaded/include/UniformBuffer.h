@@ -0,0 +1,56 @@
+#ifndef UNIFORMBUFFER_H_
+#define UNIFORMBUFFER_H_
+
+#include <ngl/Types.h>
+#include <cstddef>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class UniformBuffer
+/// @brief a uniform buffer object holding one or more copies of a uniform block, each at an offset the GL allows
+/// binding at. Every program that uses the block is attached to the same binding point once after linking, then
+/// switching to another copy (another material say) is a single glBindBufferRange whichever program is in use.
+/// The block's C++ struct must match the std140 layout of the GLSL block.
+//----------------------------------------------------------------------------------------------------------------------
+class UniformBuffer
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief allocate room for _count blocks of _blockSize bytes, needs a current GL context
+    //----------------------------------------------------------------------------------------------------------------------
+    UniformBuffer(GLuint _binding, size_t _blockSize, size_t _count=1);
+    UniformBuffer(const UniformBuffer &)=delete;
+    UniformBuffer &operator=(const UniformBuffer &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief delete the buffer, like removeVAO this must be called while the context is current
+    //----------------------------------------------------------------------------------------------------------------------
+    void remove();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief replace block _index with one glBufferSubData
+    //----------------------------------------------------------------------------------------------------------------------
+    template<typename Block>
+    void set(const Block &_block, size_t _index=0) {update(&_block,sizeof(Block),_index);}
+    void update(const void *_data, size_t _size, size_t _index=0);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make block _index the one every attached program sees
+    //----------------------------------------------------------------------------------------------------------------------
+    void bind(size_t _index=0);
+    size_t bound() const {return m_bound;}
+    size_t count() const {return m_count;}
+    GLuint binding() const {return m_binding;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief point the uniform block _blockName of _program at _binding
+    /// @returns false if the program has no active block of that name
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool attach(GLuint _program, const char *_blockName, GLuint _binding);
+
+  private :
+    GLuint m_id=0;
+    GLuint m_binding=0;
+    size_t m_blockSize=0;
+    // the block size rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    size_t m_stride=0;
+    size_t m_count=0;
+    size_t m_bound=0;
+};
+
+#endif
@@ -9,6 +9,10 @@ out vec3 fragmentNormal;
 layout(location =0)in vec3 inVert;
 /// @brief the normal passed in
 layout(location =1)in vec3 inNormal;
+/// @brief the position of this boid, one per instance
+layout(location =2)in vec3 inPosition;
+/// @brief the velocity of this boid, one per instance
+layout(location =3)in vec3 inVelocity;
 
 struct Materials
 {
@@ -26,10 +30,16 @@ struct Lights
 	vec4 diffuse;
 	vec4 specular;
 };
-// our material
-uniform Materials material;
+// our material, the blocks must match PhongFragment.glsl and PhongBlocks.h
+layout(std140) uniform MaterialBlock
+{
+	Materials material;
+};
 // array of lights
-uniform Lights light;
+layout(std140) uniform LightBlock
+{
+	Lights light;
+};
 // direction of the lights used for shading
 out vec3 lightDir;
 // out the blinn half vector
@@ -41,23 +51,30 @@ uniform mat4 MV;
 uniform mat4 MVP;
 uniform mat3 normalMatrix;
 uniform mat4 M;
-
+/// @brief the size of each boid
+uniform float boidScale;
 
 void main()
 {
+// the boid mesh points down -z, build a rotation that turns it to face along the velocity
+float speed=length(inVelocity);
+vec3 forward= speed > 0.0 ? inVelocity/speed : vec3(0.0,0.0,-1.0);
+vec3 zAxis=-forward;
+vec3 up= abs(zAxis.y) < 0.99 ? vec3(0.0,1.0,0.0) : vec3(1.0,0.0,0.0);
+vec3 xAxis=normalize(cross(up,zAxis));
+vec3 yAxis=cross(zAxis,xAxis);
+mat3 orient=mat3(xAxis,yAxis,zAxis);
+vec3 vert=orient*(inVert*boidScale)+inPosition;
 // calculate the fragments surface normal
-fragmentNormal =  (normalMatrix*inNormal);
-
-
+fragmentNormal =  (normalMatrix*(orient*inNormal));
 // calculate the vertex position
-gl_Position = MVP*vec4(inVert,1.0);
-
-vec4 worldPosition = M * vec4(inVert, 1.0);
+gl_Position = MVP*vec4(vert,1.0);
+vec4 worldPosition = M * vec4(vert, 1.0);
 eyeDirection = normalize(viewerPos - worldPosition.xyz);
 // Get vertex position in eye coordinates
 // Transform the vertex to eye co-ordinates for frag shader
 /// @brief the vertex in eye co-ordinates  homogeneous
-vec4 eyeCord=MV*vec4(inVert,1);
+vec4 eyeCord=MV*vec4(vert,1);
 
 vPosition = eyeCord.xyz / eyeCord.w;;
 
@@ -67,5 +84,4 @@ lightDir=vec3(light.position.xyz-eyeCord.xyz);
 dist = length(lightDir);
 lightDir/= dist;
 halfVector = normalize(eyeDirection + lightDir);
-
 }
@@ -0,0 +1,255 @@
+#include "BoidKernels.h"
+#include "BoidKernelArgs.h"
+#include <cmath>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief scale (x,y,z) down to _max if it is longer
+  //----------------------------------------------------------------------------------------------------------------------
+  void limit(float &io_x, float &io_y, float &io_z, float _max)
+  {
+    float length2=io_x*io_x+io_y*io_y+io_z*io_z;
+    if(length2>_max*_max)
+    {
+      float scale=_max/std::sqrt(length2);
+      io_x*=scale;
+      io_y*=scale;
+      io_z*=scale;
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Reynolds steering, the change in velocity needed to head along d at full speed, added to f with _weight
+  //----------------------------------------------------------------------------------------------------------------------
+  void steerTowards(float _dx, float _dy, float _dz, float _vx, float _vy, float _vz, const SteerArgs &_args,
+                    float _weight, float &io_fx, float &io_fy, float &io_fz)
+  {
+    float length2=_dx*_dx+_dy*_dy+_dz*_dz;
+    if(length2==0.0f)
+    {
+      return;
+    }
+    float scale=_args.maxSpeed/std::sqrt(length2);
+    float x=_dx*scale-_vx;
+    float y=_dy*scale-_vy;
+    float z=_dz*scale-_vz;
+    limit(x,y,z,_args.maxForce);
+    io_fx+=x*_weight;
+    io_fy+=y*_weight;
+    io_fz+=z*_weight;
+  }
+
+  SteerArgs steerArgs(const BoidStore &_boids, size_t _offset, size_t _count, const SoABuffer &_sums,
+                      const FlockParams &_params, SoABuffer &o_force)
+  {
+    SteerArgs a;
+    a.px=_boids[BoidStore::PX]+_offset;
+    a.py=_boids[BoidStore::PY]+_offset;
+    a.pz=_boids[BoidStore::PZ]+_offset;
+    a.vx=_boids[BoidStore::VX]+_offset;
+    a.vy=_boids[BoidStore::VY]+_offset;
+    a.vz=_boids[BoidStore::VZ]+_offset;
+    a.neighbours=_sums[Neighbours];
+    a.headingX=_sums[HeadingX];
+    a.headingY=_sums[HeadingY];
+    a.headingZ=_sums[HeadingZ];
+    a.centreX=_sums[CentreX];
+    a.centreY=_sums[CentreY];
+    a.centreZ=_sums[CentreZ];
+    a.separationX=_sums[SeparationX];
+    a.separationY=_sums[SeparationY];
+    a.separationZ=_sums[SeparationZ];
+    a.fx=o_force[0];
+    a.fy=o_force[1];
+    a.fz=o_force[2];
+    a.count=_count;
+    a.separationWeight=_params.separationWeight;
+    a.alignmentWeight=_params.alignmentWeight;
+    a.cohesionWeight=_params.cohesionWeight;
+    a.boundsWeight=_params.boundsWeight;
+    a.maxSpeed=_params.maxSpeed;
+    a.maxForce=_params.maxForce;
+    a.boundsX=_params.bounds.m_x;
+    a.boundsY=_params.bounds.m_y;
+    a.boundsZ=_params.bounds.m_z;
+    return a;
+  }
+
+  IntegrateArgs integrateArgs(const BoidStore &_boids, size_t _offset, size_t _count, const SoABuffer &_force,
+                              float _dt, const FlockParams &_params, BoidStore &o_next)
+  {
+    IntegrateArgs a;
+    a.px=_boids[BoidStore::PX]+_offset;
+    a.py=_boids[BoidStore::PY]+_offset;
+    a.pz=_boids[BoidStore::PZ]+_offset;
+    a.vx=_boids[BoidStore::VX]+_offset;
+    a.vy=_boids[BoidStore::VY]+_offset;
+    a.vz=_boids[BoidStore::VZ]+_offset;
+    a.fx=_force[0];
+    a.fy=_force[1];
+    a.fz=_force[2];
+    a.nextPx=o_next[BoidStore::PX]+_offset;
+    a.nextPy=o_next[BoidStore::PY]+_offset;
+    a.nextPz=o_next[BoidStore::PZ]+_offset;
+    a.nextVx=o_next[BoidStore::VX]+_offset;
+    a.nextVy=o_next[BoidStore::VY]+_offset;
+    a.nextVz=o_next[BoidStore::VZ]+_offset;
+    a.count=_count;
+    a.dt=_dt;
+    a.minSpeed=_params.minSpeed;
+    a.maxSpeed=_params.maxSpeed;
+    return a;
+  }
+
+  template<void (*Steer)(const SteerArgs &)>
+  void steer(const BoidStore &_boids, size_t _offset, size_t _count, const SoABuffer &_sums,
+             const FlockParams &_params, SoABuffer &o_force)
+  {
+    Steer(steerArgs(_boids,_offset,_count,_sums,_params,o_force));
+  }
+
+  template<void (*Integrate)(const IntegrateArgs &)>
+  void integrate(const BoidStore &_boids, size_t _offset, size_t _count, const SoABuffer &_force, float _dt,
+                 const FlockParams &_params, BoidStore &o_next)
+  {
+    Integrate(integrateArgs(_boids,_offset,_count,_force,_dt,_params,o_next));
+  }
+
+  bool cpuHasAVX2()
+  {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info,1);
+    bool fma=(info[2] & (1<<12))!=0;
+    bool osxsave=(info[2] & (1<<27))!=0;
+    // the OS has to save the ymm registers as well
+    bool ymm=osxsave && (_xgetbv(0) & 6)==6;
+    __cpuidex(info,7,0);
+    return fma && ymm && (info[1] & (1<<5))!=0;
+#else
+    return false;
+#endif
+  }
+}
+
+namespace boidKernels
+{
+  void steerScalar(const SteerArgs &_args)
+  {
+    for(size_t i=0; i<_args.count; ++i)
+    {
+      float px=_args.px[i];
+      float py=_args.py[i];
+      float pz=_args.pz[i];
+      float vx=_args.vx[i];
+      float vy=_args.vy[i];
+      float vz=_args.vz[i];
+      float fx=0.0f;
+      float fy=0.0f;
+      float fz=0.0f;
+      float count=_args.neighbours[i];
+      if(count>0.0f)
+      {
+        steerTowards(_args.separationX[i],_args.separationY[i],_args.separationZ[i],vx,vy,vz,_args,_args.separationWeight,fx,fy,fz);
+        steerTowards(_args.headingX[i],_args.headingY[i],_args.headingZ[i],vx,vy,vz,_args,_args.alignmentWeight,fx,fy,fz);
+        steerTowards(_args.centreX[i]/count-px,_args.centreY[i]/count-py,_args.centreZ[i]/count-pz,vx,vy,vz,_args,
+                     _args.cohesionWeight,fx,fy,fz);
+      }
+      // head back towards the centre once outside the box
+      if(std::abs(px)>_args.boundsX || std::abs(py)>_args.boundsY || std::abs(pz)>_args.boundsZ)
+      {
+        steerTowards(-px,-py,-pz,vx,vy,vz,_args,_args.boundsWeight,fx,fy,fz);
+      }
+      limit(fx,fy,fz,_args.maxForce);
+      _args.fx[i]=fx;
+      _args.fy[i]=fy;
+      _args.fz[i]=fz;
+    }
+  }
+
+  void integrateScalar(const IntegrateArgs &_args)
+  {
+    for(size_t i=0; i<_args.count; ++i)
+    {
+      float vx=_args.vx[i]+_args.fx[i]*_args.dt;
+      float vy=_args.vy[i]+_args.fy[i]*_args.dt;
+      float vz=_args.vz[i]+_args.fz[i]*_args.dt;
+      float speed=std::sqrt(vx*vx+vy*vy+vz*vz);
+      float scale=1.0f;
+      if(speed>_args.maxSpeed)
+      {
+        scale=_args.maxSpeed/speed;
+      }
+      else if(speed<_args.minSpeed && speed>0.0f)
+      {
+        scale=_args.minSpeed/speed;
+      }
+      vx*=scale;
+      vy*=scale;
+      vz*=scale;
+      _args.nextVx[i]=vx;
+      _args.nextVy[i]=vy;
+      _args.nextVz[i]=vz;
+      _args.nextPx[i]=_args.px[i]+vx*_args.dt;
+      _args.nextPy[i]=_args.py[i]+vy*_args.dt;
+      _args.nextPz[i]=_args.pz[i]+vz*_args.dt;
+    }
+  }
+
+  const BoidKernels &scalar()
+  {
+    static const BoidKernels kernels={"scalar",steer<steerScalar>,integrate<integrateScalar>};
+    return kernels;
+  }
+
+  const BoidKernels *avx2()
+  {
+    static const BoidKernels kernels={"avx2",steer<steerAVX2>,integrate<integrateAVX2>};
+    static const bool available=builtAVX2() && cpuHasAVX2();
+    return available ? &kernels : nullptr;
+  }
+
+  const BoidKernels *neon()
+  {
+    // NEON is part of the base AArch64 instruction set so there is nothing to check at run time
+    static const BoidKernels kernels={"neon",steer<steerNEON>,integrate<integrateNEON>};
+    return builtNEON() ? &kernels : nullptr;
+  }
+
+  const BoidKernels &best()
+  {
+    if(auto k=avx2())
+    {
+      return *k;
+    }
+    if(auto k=neon())
+    {
+      return *k;
+    }
+    return scalar();
+  }
+
+  const BoidKernels *find(const std::string &_name)
+  {
+    if(_name=="scalar")
+    {
+      return &scalar();
+    }
+    if(_name=="avx2")
+    {
+      return avx2();
+    }
+    if(_name=="neon")
+    {
+      return neon();
+    }
+    return nullptr;
+  }
+}
@@ -0,0 +1,149 @@
+#include "BoidKernelArgs.h"
+// this file is built with AVX2 and FMA enabled (see CMakeLists.txt) and is only called once the CPU has been checked
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+
+namespace
+{
+  constexpr size_t c_width=8;
+
+  inline __m256 length2(__m256 _x, __m256 _y, __m256 _z)
+  {
+    return _mm256_fmadd_ps(_x,_x,_mm256_fmadd_ps(_y,_y,_mm256_mul_ps(_z,_z)));
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief scale each lane of (x,y,z) down to _max if it is longer
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void limit(__m256 &io_x, __m256 &io_y, __m256 &io_z, __m256 _max)
+  {
+    __m256 l2=length2(io_x,io_y,io_z);
+    __m256 over=_mm256_cmp_ps(l2,_mm256_mul_ps(_max,_max),_CMP_GT_OQ);
+    __m256 scale=_mm256_blendv_ps(_mm256_set1_ps(1.0f),_mm256_div_ps(_max,_mm256_sqrt_ps(l2)),over);
+    io_x=_mm256_mul_ps(io_x,scale);
+    io_y=_mm256_mul_ps(io_y,scale);
+    io_z=_mm256_mul_ps(io_z,scale);
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Reynolds steering for the lanes in _active with a non zero direction, added to f with _weight
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void steerTowards(__m256 _dx, __m256 _dy, __m256 _dz, __m256 _vx, __m256 _vy, __m256 _vz, __m256 _maxSpeed,
+                           __m256 _maxForce, __m256 _weight, __m256 _active, __m256 &io_fx, __m256 &io_fy, __m256 &io_fz)
+  {
+    __m256 l2=length2(_dx,_dy,_dz);
+    __m256 mask=_mm256_and_ps(_active,_mm256_cmp_ps(l2,_mm256_setzero_ps(),_CMP_NEQ_OQ));
+    // masked lanes may hold inf or nan here, they are dropped by the and below
+    __m256 scale=_mm256_div_ps(_maxSpeed,_mm256_sqrt_ps(l2));
+    __m256 x=_mm256_fmsub_ps(_dx,scale,_vx);
+    __m256 y=_mm256_fmsub_ps(_dy,scale,_vy);
+    __m256 z=_mm256_fmsub_ps(_dz,scale,_vz);
+    limit(x,y,z,_maxForce);
+    io_fx=_mm256_add_ps(io_fx,_mm256_and_ps(_mm256_mul_ps(x,_weight),mask));
+    io_fy=_mm256_add_ps(io_fy,_mm256_and_ps(_mm256_mul_ps(y,_weight),mask));
+    io_fz=_mm256_add_ps(io_fz,_mm256_and_ps(_mm256_mul_ps(z,_weight),mask));
+  }
+}
+
+namespace boidKernels
+{
+  bool builtAVX2()
+  {
+    return true;
+  }
+
+  void steerAVX2(const SteerArgs &_args)
+  {
+    const __m256 maxSpeed=_mm256_set1_ps(_args.maxSpeed);
+    const __m256 maxForce=_mm256_set1_ps(_args.maxForce);
+    const __m256 separationWeight=_mm256_set1_ps(_args.separationWeight);
+    const __m256 alignmentWeight=_mm256_set1_ps(_args.alignmentWeight);
+    const __m256 cohesionWeight=_mm256_set1_ps(_args.cohesionWeight);
+    const __m256 boundsWeight=_mm256_set1_ps(_args.boundsWeight);
+    const __m256 boundsX=_mm256_set1_ps(_args.boundsX);
+    const __m256 boundsY=_mm256_set1_ps(_args.boundsY);
+    const __m256 boundsZ=_mm256_set1_ps(_args.boundsZ);
+    const __m256 signBit=_mm256_set1_ps(-0.0f);
+    const __m256 zero=_mm256_setzero_ps();
+    for(size_t i=0; i<_args.count; i+=c_width)
+    {
+      __m256 px=_mm256_load_ps(_args.px+i);
+      __m256 py=_mm256_load_ps(_args.py+i);
+      __m256 pz=_mm256_load_ps(_args.pz+i);
+      __m256 vx=_mm256_load_ps(_args.vx+i);
+      __m256 vy=_mm256_load_ps(_args.vy+i);
+      __m256 vz=_mm256_load_ps(_args.vz+i);
+      __m256 count=_mm256_load_ps(_args.neighbours+i);
+      __m256 hasNeighbours=_mm256_cmp_ps(count,zero,_CMP_GT_OQ);
+      __m256 fx=zero;
+      __m256 fy=zero;
+      __m256 fz=zero;
+      steerTowards(_mm256_load_ps(_args.separationX+i),_mm256_load_ps(_args.separationY+i),_mm256_load_ps(_args.separationZ+i),
+                   vx,vy,vz,maxSpeed,maxForce,separationWeight,hasNeighbours,fx,fy,fz);
+      steerTowards(_mm256_load_ps(_args.headingX+i),_mm256_load_ps(_args.headingY+i),_mm256_load_ps(_args.headingZ+i),
+                   vx,vy,vz,maxSpeed,maxForce,alignmentWeight,hasNeighbours,fx,fy,fz);
+      steerTowards(_mm256_sub_ps(_mm256_div_ps(_mm256_load_ps(_args.centreX+i),count),px),
+                   _mm256_sub_ps(_mm256_div_ps(_mm256_load_ps(_args.centreY+i),count),py),
+                   _mm256_sub_ps(_mm256_div_ps(_mm256_load_ps(_args.centreZ+i),count),pz),
+                   vx,vy,vz,maxSpeed,maxForce,cohesionWeight,hasNeighbours,fx,fy,fz);
+      __m256 outside=_mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(_mm256_andnot_ps(signBit,px),boundsX,_CMP_GT_OQ),
+                                               _mm256_cmp_ps(_mm256_andnot_ps(signBit,py),boundsY,_CMP_GT_OQ)),
+                                  _mm256_cmp_ps(_mm256_andnot_ps(signBit,pz),boundsZ,_CMP_GT_OQ));
+      steerTowards(_mm256_xor_ps(px,signBit),_mm256_xor_ps(py,signBit),_mm256_xor_ps(pz,signBit),
+                   vx,vy,vz,maxSpeed,maxForce,boundsWeight,outside,fx,fy,fz);
+      limit(fx,fy,fz,maxForce);
+      _mm256_store_ps(_args.fx+i,fx);
+      _mm256_store_ps(_args.fy+i,fy);
+      _mm256_store_ps(_args.fz+i,fz);
+    }
+  }
+
+  void integrateAVX2(const IntegrateArgs &_args)
+  {
+    const __m256 dt=_mm256_set1_ps(_args.dt);
+    const __m256 minSpeed=_mm256_set1_ps(_args.minSpeed);
+    const __m256 maxSpeed=_mm256_set1_ps(_args.maxSpeed);
+    const __m256 one=_mm256_set1_ps(1.0f);
+    const __m256 zero=_mm256_setzero_ps();
+    for(size_t i=0; i<_args.count; i+=c_width)
+    {
+      __m256 vx=_mm256_fmadd_ps(_mm256_load_ps(_args.fx+i),dt,_mm256_load_ps(_args.vx+i));
+      __m256 vy=_mm256_fmadd_ps(_mm256_load_ps(_args.fy+i),dt,_mm256_load_ps(_args.vy+i));
+      __m256 vz=_mm256_fmadd_ps(_mm256_load_ps(_args.fz+i),dt,_mm256_load_ps(_args.vz+i));
+      __m256 speed=_mm256_sqrt_ps(length2(vx,vy,vz));
+      __m256 tooFast=_mm256_cmp_ps(speed,maxSpeed,_CMP_GT_OQ);
+      __m256 tooSlow=_mm256_and_ps(_mm256_cmp_ps(speed,minSpeed,_CMP_LT_OQ),_mm256_cmp_ps(speed,zero,_CMP_GT_OQ));
+      __m256 scale=_mm256_blendv_ps(one,_mm256_div_ps(maxSpeed,speed),tooFast);
+      scale=_mm256_blendv_ps(scale,_mm256_div_ps(minSpeed,speed),tooSlow);
+      vx=_mm256_mul_ps(vx,scale);
+      vy=_mm256_mul_ps(vy,scale);
+      vz=_mm256_mul_ps(vz,scale);
+      _mm256_store_ps(_args.nextVx+i,vx);
+      _mm256_store_ps(_args.nextVy+i,vy);
+      _mm256_store_ps(_args.nextVz+i,vz);
+      _mm256_store_ps(_args.nextPx+i,_mm256_fmadd_ps(vx,dt,_mm256_load_ps(_args.px+i)));
+      _mm256_store_ps(_args.nextPy+i,_mm256_fmadd_ps(vy,dt,_mm256_load_ps(_args.py+i)));
+      _mm256_store_ps(_args.nextPz+i,_mm256_fmadd_ps(vz,dt,_mm256_load_ps(_args.pz+i)));
+    }
+  }
+}
+
+#else
+
+namespace boidKernels
+{
+  bool builtAVX2()
+  {
+    return false;
+  }
+
+  void steerAVX2(const SteerArgs &)
+  {
+  }
+
+  void integrateAVX2(const IntegrateArgs &)
+  {
+  }
+}
+
+#endif
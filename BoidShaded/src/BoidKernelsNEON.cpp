@@ -0,0 +1,152 @@
+#include "BoidKernelArgs.h"
+// vdivq_f32 and vsqrtq_f32 are AArch64 only so 32 bit ARM uses the scalar kernels
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+
+namespace
+{
+  constexpr size_t c_width=4;
+
+  inline float32x4_t length2(float32x4_t _x, float32x4_t _y, float32x4_t _z)
+  {
+    return vfmaq_f32(vfmaq_f32(vmulq_f32(_z,_z),_y,_y),_x,_x);
+  }
+
+  inline float32x4_t maskAnd(float32x4_t _v, uint32x4_t _mask)
+  {
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(_v),_mask));
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief scale each lane of (x,y,z) down to _max if it is longer
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void limit(float32x4_t &io_x, float32x4_t &io_y, float32x4_t &io_z, float32x4_t _max)
+  {
+    float32x4_t l2=length2(io_x,io_y,io_z);
+    uint32x4_t over=vcgtq_f32(l2,vmulq_f32(_max,_max));
+    float32x4_t scale=vbslq_f32(over,vdivq_f32(_max,vsqrtq_f32(l2)),vdupq_n_f32(1.0f));
+    io_x=vmulq_f32(io_x,scale);
+    io_y=vmulq_f32(io_y,scale);
+    io_z=vmulq_f32(io_z,scale);
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Reynolds steering for the lanes in _active with a non zero direction, added to f with _weight
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void steerTowards(float32x4_t _dx, float32x4_t _dy, float32x4_t _dz, float32x4_t _vx, float32x4_t _vy,
+                           float32x4_t _vz, float32x4_t _maxSpeed, float32x4_t _maxForce, float32x4_t _weight,
+                           uint32x4_t _active, float32x4_t &io_fx, float32x4_t &io_fy, float32x4_t &io_fz)
+  {
+    float32x4_t l2=length2(_dx,_dy,_dz);
+    uint32x4_t mask=vandq_u32(_active,vmvnq_u32(vceqq_f32(l2,vdupq_n_f32(0.0f))));
+    // masked lanes may hold inf or nan here, they are dropped by the and below
+    float32x4_t scale=vdivq_f32(_maxSpeed,vsqrtq_f32(l2));
+    float32x4_t x=vsubq_f32(vmulq_f32(_dx,scale),_vx);
+    float32x4_t y=vsubq_f32(vmulq_f32(_dy,scale),_vy);
+    float32x4_t z=vsubq_f32(vmulq_f32(_dz,scale),_vz);
+    limit(x,y,z,_maxForce);
+    io_fx=vaddq_f32(io_fx,maskAnd(vmulq_f32(x,_weight),mask));
+    io_fy=vaddq_f32(io_fy,maskAnd(vmulq_f32(y,_weight),mask));
+    io_fz=vaddq_f32(io_fz,maskAnd(vmulq_f32(z,_weight),mask));
+  }
+}
+
+namespace boidKernels
+{
+  bool builtNEON()
+  {
+    return true;
+  }
+
+  void steerNEON(const SteerArgs &_args)
+  {
+    const float32x4_t maxSpeed=vdupq_n_f32(_args.maxSpeed);
+    const float32x4_t maxForce=vdupq_n_f32(_args.maxForce);
+    const float32x4_t separationWeight=vdupq_n_f32(_args.separationWeight);
+    const float32x4_t alignmentWeight=vdupq_n_f32(_args.alignmentWeight);
+    const float32x4_t cohesionWeight=vdupq_n_f32(_args.cohesionWeight);
+    const float32x4_t boundsWeight=vdupq_n_f32(_args.boundsWeight);
+    const float32x4_t boundsX=vdupq_n_f32(_args.boundsX);
+    const float32x4_t boundsY=vdupq_n_f32(_args.boundsY);
+    const float32x4_t boundsZ=vdupq_n_f32(_args.boundsZ);
+    const float32x4_t zero=vdupq_n_f32(0.0f);
+    for(size_t i=0; i<_args.count; i+=c_width)
+    {
+      float32x4_t px=vld1q_f32(_args.px+i);
+      float32x4_t py=vld1q_f32(_args.py+i);
+      float32x4_t pz=vld1q_f32(_args.pz+i);
+      float32x4_t vx=vld1q_f32(_args.vx+i);
+      float32x4_t vy=vld1q_f32(_args.vy+i);
+      float32x4_t vz=vld1q_f32(_args.vz+i);
+      float32x4_t count=vld1q_f32(_args.neighbours+i);
+      uint32x4_t hasNeighbours=vcgtq_f32(count,zero);
+      float32x4_t fx=zero;
+      float32x4_t fy=zero;
+      float32x4_t fz=zero;
+      steerTowards(vld1q_f32(_args.separationX+i),vld1q_f32(_args.separationY+i),vld1q_f32(_args.separationZ+i),
+                   vx,vy,vz,maxSpeed,maxForce,separationWeight,hasNeighbours,fx,fy,fz);
+      steerTowards(vld1q_f32(_args.headingX+i),vld1q_f32(_args.headingY+i),vld1q_f32(_args.headingZ+i),
+                   vx,vy,vz,maxSpeed,maxForce,alignmentWeight,hasNeighbours,fx,fy,fz);
+      steerTowards(vsubq_f32(vdivq_f32(vld1q_f32(_args.centreX+i),count),px),
+                   vsubq_f32(vdivq_f32(vld1q_f32(_args.centreY+i),count),py),
+                   vsubq_f32(vdivq_f32(vld1q_f32(_args.centreZ+i),count),pz),
+                   vx,vy,vz,maxSpeed,maxForce,cohesionWeight,hasNeighbours,fx,fy,fz);
+      uint32x4_t outside=vorrq_u32(vorrq_u32(vcgtq_f32(vabsq_f32(px),boundsX),vcgtq_f32(vabsq_f32(py),boundsY)),
+                                   vcgtq_f32(vabsq_f32(pz),boundsZ));
+      steerTowards(vnegq_f32(px),vnegq_f32(py),vnegq_f32(pz),vx,vy,vz,maxSpeed,maxForce,boundsWeight,outside,fx,fy,fz);
+      limit(fx,fy,fz,maxForce);
+      vst1q_f32(_args.fx+i,fx);
+      vst1q_f32(_args.fy+i,fy);
+      vst1q_f32(_args.fz+i,fz);
+    }
+  }
+
+  void integrateNEON(const IntegrateArgs &_args)
+  {
+    const float32x4_t dt=vdupq_n_f32(_args.dt);
+    const float32x4_t minSpeed=vdupq_n_f32(_args.minSpeed);
+    const float32x4_t maxSpeed=vdupq_n_f32(_args.maxSpeed);
+    const float32x4_t one=vdupq_n_f32(1.0f);
+    const float32x4_t zero=vdupq_n_f32(0.0f);
+    for(size_t i=0; i<_args.count; i+=c_width)
+    {
+      float32x4_t vx=vfmaq_f32(vld1q_f32(_args.vx+i),vld1q_f32(_args.fx+i),dt);
+      float32x4_t vy=vfmaq_f32(vld1q_f32(_args.vy+i),vld1q_f32(_args.fy+i),dt);
+      float32x4_t vz=vfmaq_f32(vld1q_f32(_args.vz+i),vld1q_f32(_args.fz+i),dt);
+      float32x4_t speed=vsqrtq_f32(length2(vx,vy,vz));
+      uint32x4_t tooFast=vcgtq_f32(speed,maxSpeed);
+      uint32x4_t tooSlow=vandq_u32(vcltq_f32(speed,minSpeed),vcgtq_f32(speed,zero));
+      float32x4_t scale=vbslq_f32(tooFast,vdivq_f32(maxSpeed,speed),one);
+      scale=vbslq_f32(tooSlow,vdivq_f32(minSpeed,speed),scale);
+      vx=vmulq_f32(vx,scale);
+      vy=vmulq_f32(vy,scale);
+      vz=vmulq_f32(vz,scale);
+      vst1q_f32(_args.nextVx+i,vx);
+      vst1q_f32(_args.nextVy+i,vy);
+      vst1q_f32(_args.nextVz+i,vz);
+      vst1q_f32(_args.nextPx+i,vfmaq_f32(vld1q_f32(_args.px+i),vx,dt));
+      vst1q_f32(_args.nextPy+i,vfmaq_f32(vld1q_f32(_args.py+i),vy,dt));
+      vst1q_f32(_args.nextPz+i,vfmaq_f32(vld1q_f32(_args.pz+i),vz,dt));
+    }
+  }
+}
+
+#else
+
+namespace boidKernels
+{
+  bool builtNEON()
+  {
+    return false;
+  }
+
+  void steerNEON(const SteerArgs &)
+  {
+  }
+
+  void integrateNEON(const IntegrateArgs &)
+  {
+  }
+}
+
+#endif
@@ -0,0 +1,53 @@
+#include "BoidStore.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+SoABuffer::SoABuffer(size_t _channels, size_t _size) : m_channels(_channels)
+{
+  resize(_size);
+}
+
+void SoABuffer::resize(size_t _size)
+{
+  constexpr size_t lineFloats=c_alignment/sizeof(float);
+  size_t stride=(_size+lineFloats-1)/lineFloats*lineFloats;
+  if(stride !=m_stride || !m_data)
+  {
+    size_t total=std::max<size_t>(stride*m_channels,lineFloats);
+    m_data.reset(static_cast<float *>(::operator new[](total*sizeof(float),std::align_val_t(c_alignment))));
+    m_stride=stride;
+  }
+  m_size=_size;
+  // only the padding needs to be cleared, the rest is written before it is read
+  for(size_t c=0; c<m_channels; ++c)
+  {
+    std::memset((*this)[c]+m_size,0,(m_stride-m_size)*sizeof(float));
+  }
+}
+
+void SoABuffer::swap(SoABuffer &_other) noexcept
+{
+  std::swap(m_channels,_other.m_channels);
+  std::swap(m_size,_other.m_size);
+  std::swap(m_stride,_other.m_stride);
+  m_data.swap(_other.m_data);
+}
+
+Boid BoidStore::get(size_t _i) const
+{
+  Boid b;
+  b.position.set((*this)[PX][_i],(*this)[PY][_i],(*this)[PZ][_i]);
+  b.velocity.set((*this)[VX][_i],(*this)[VY][_i],(*this)[VZ][_i]);
+  return b;
+}
+
+void BoidStore::set(size_t _i, const Boid &_boid)
+{
+  (*this)[PX][_i]=_boid.position.m_x;
+  (*this)[PY][_i]=_boid.position.m_y;
+  (*this)[PZ][_i]=_boid.position.m_z;
+  (*this)[VX][_i]=_boid.velocity.m_x;
+  (*this)[VY][_i]=_boid.velocity.m_y;
+  (*this)[VZ][_i]=_boid.velocity.m_z;
+}
@@ -0,0 +1,172 @@
+#include "Flock.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+static_assert(sizeof(Boid)==6*sizeof(float),"Boid must be tightly packed to be used as instance data");
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief scale _v down to _max if it is longer
+  //----------------------------------------------------------------------------------------------------------------------
+  ngl::Vec3 limit(const ngl::Vec3 &_v, float _max)
+  {
+    float length2=_v.lengthSquared();
+    if(length2>_max*_max)
+    {
+      return _v*(_max/std::sqrt(length2));
+    }
+    return _v;
+  }
+}
+
+Flock::Flock(size_t _numBoids, const FlockParams &_params, unsigned int _seed) :
+  m_params(_params), m_kernels(&boidKernels::best()), m_grid(1.0f,_params.gridBounds*-1.0f,_params.gridBounds),
+  m_boids(_numBoids), m_next(_numBoids)
+{
+  configureGrid();
+  std::mt19937 rng(_seed);
+  std::uniform_real_distribution<float> unit(-1.0f,1.0f);
+  for(size_t i=0; i<_numBoids; ++i)
+  {
+    Boid b;
+    b.position.set(unit(rng)*m_params.bounds.m_x,unit(rng)*m_params.bounds.m_y,unit(rng)*m_params.bounds.m_z);
+    b.velocity.set(unit(rng),unit(rng),unit(rng));
+    b.velocity=limit(b.velocity*m_params.maxSpeed,m_params.maxSpeed);
+    m_boids.set(i,b);
+  }
+}
+
+void Flock::setParams(const FlockParams &_params)
+{
+  m_params=_params;
+  configureGrid();
+}
+
+void Flock::configureGrid()
+{
+  float cellSize=m_params.cellSize>0.0f ? m_params.cellSize : m_params.neighbourRadius;
+  m_grid.configure(cellSize,m_params.gridBounds*-1.0f,m_params.gridBounds);
+}
+
+void Flock::writeInstances(Boid *o_instances) const
+{
+  parallelFor(size(),parallelChunks(size(),4096),[this,o_instances](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      o_instances[i]=m_boids.get(i);
+    }
+  });
+}
+
+void Flock::accumulate(size_t _i, SoABuffer &o_sums, size_t _k) const
+{
+  const float *px=m_boids[BoidStore::PX];
+  const float *py=m_boids[BoidStore::PY];
+  const float *pz=m_boids[BoidStore::PZ];
+  const float *vx=m_boids[BoidStore::VX];
+  const float *vy=m_boids[BoidStore::VY];
+  const float *vz=m_boids[BoidStore::VZ];
+  const float neighbour2=m_params.neighbourRadius*m_params.neighbourRadius;
+  const float separation2=m_params.separationRadius*m_params.separationRadius;
+  const float x=px[_i];
+  const float y=py[_i];
+  const float z=pz[_i];
+  float sums[NumNeighbourSums]={};
+  size_t count=0;
+  auto visit=[&](size_t _begin, size_t _end)
+  {
+    for(size_t j=_begin; j<_end; ++j)
+    {
+      float dx=px[j]-x;
+      float dy=py[j]-y;
+      float dz=pz[j]-z;
+      float dist2=dx*dx+dy*dy+dz*dz;
+      if(j==_i || dist2>=neighbour2)
+      {
+        continue;
+      }
+      ++count;
+      sums[HeadingX]+=vx[j];
+      sums[HeadingY]+=vy[j];
+      sums[HeadingZ]+=vz[j];
+      sums[CentreX]+=px[j];
+      sums[CentreY]+=py[j];
+      sums[CentreZ]+=pz[j];
+      if(dist2<separation2 && dist2>0.0f)
+      {
+        // closer boids push harder
+        sums[SeparationX]-=dx/dist2;
+        sums[SeparationY]-=dy/dist2;
+        sums[SeparationZ]-=dz/dist2;
+      }
+    }
+  };
+  if(m_search==NeighbourSearch::Grid)
+  {
+    // the boids are in cell order so each span is a run of neighbouring boids
+    m_grid.forEachCandidate(ngl::Vec3(x,y,z),m_params.neighbourRadius,visit);
+  }
+  else
+  {
+    visit(0,size());
+  }
+  sums[Neighbours]=static_cast<float>(count);
+  for(size_t c=0; c<NumNeighbourSums; ++c)
+  {
+    o_sums[c][_k]=sums[c];
+  }
+}
+
+void Flock::update(float _dt)
+{
+  const size_t numBoids=size();
+  if(m_search==NeighbourSearch::Grid)
+  {
+    m_grid.build(numBoids,[this](size_t _i)
+    {
+      return ngl::Vec3(m_boids[BoidStore::PX][_i],m_boids[BoidStore::PY][_i],m_boids[BoidStore::PZ][_i]);
+    });
+    // gather into cell order, m_next is free until the integration below
+    const auto &order=m_grid.order();
+    parallelFor(numBoids,parallelChunks(numBoids,4096),[&](size_t,size_t _begin,size_t _end)
+    {
+      for(size_t c=0; c<BoidStore::NumChannels; ++c)
+      {
+        const float *src=m_boids[c];
+        float *dst=m_next[c];
+        for(size_t k=_begin; k<_end; ++k)
+        {
+          dst[k]=src[order[k]];
+        }
+      }
+    });
+    m_boids.swap(m_next);
+  }
+
+  const size_t numBlocks=(numBoids+c_blockSize-1)/c_blockSize;
+  parallelFor(numBlocks,parallelChunks(numBlocks,1),[this,_dt,numBoids](size_t,size_t _begin,size_t _end)
+  {
+    SoABuffer sums(NumNeighbourSums,c_blockSize);
+    SoABuffer force(3,c_blockSize);
+    for(size_t block=_begin; block<_end; ++block)
+    {
+      size_t offset=block*c_blockSize;
+      size_t count=std::min(c_blockSize,numBoids-offset);
+      for(size_t k=0; k<count; ++k)
+      {
+        accumulate(offset+k,sums,k);
+      }
+      // the kernels work in whole registers so clear what the last block doesn't fill
+      for(size_t c=0; c<NumNeighbourSums; ++c)
+      {
+        std::fill(sums[c]+count,sums[c]+c_blockSize,0.0f);
+      }
+      m_kernels->steer(m_boids,offset,count,sums,m_params,force);
+      m_kernels->integrate(m_boids,offset,count,force,_dt,m_params,m_next);
+    }
+  });
+  m_boids.swap(m_next);
+}
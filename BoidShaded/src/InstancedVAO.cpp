@@ -0,0 +1,96 @@
+#include "InstancedVAO.h"
+#include <iostream>
+
+void InstancedVAO::draw() const
+{
+  if(m_allocated == false)
+  {
+    std::cerr<<"Warning trying to draw an unallocated VOA\n";
+  }
+  if(m_bound == false)
+  {
+    std::cerr<<"Warning trying to draw an unbound VOA\n";
+  }
+  glDrawArraysInstanced(m_mode,0,static_cast<GLsizei>(m_indicesCount),static_cast<GLsizei>(m_numInstances));
+}
+
+void InstancedVAO::removeVAO()
+{
+  if(m_bound == true)
+  {
+    unbind();
+  }
+  if(m_allocated == true)
+  {
+    glDeleteBuffers(1,&m_meshBuffer);
+  }
+  if(m_instanceBuffer !=0)
+  {
+    glDeleteBuffers(1,&m_instanceBuffer);
+  }
+  glDeleteVertexArrays(1,&m_id);
+  m_allocated=false;
+  m_instanceBuffer=0;
+  m_instanceCapacity=0;
+}
+
+void InstancedVAO::setData(const VertexData &_data)
+{
+  if(m_bound == false)
+  {
+    std::cerr<<"trying to set VOA data when unbound\n";
+  }
+  if(m_allocated == false)
+  {
+    glGenBuffers(1,&m_meshBuffer);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER,m_meshBuffer);
+  glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(_data.m_size),&_data.m_data,_data.m_mode);
+  m_allocated=true;
+}
+
+void *InstancedVAO::mapInstances(size_t _size, size_t _numInstances)
+{
+  if(m_instanceBuffer==0)
+  {
+    glGenBuffers(1,&m_instanceBuffer);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER,m_instanceBuffer);
+  if(_size>m_instanceCapacity)
+  {
+    glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(_size),nullptr,GL_STREAM_DRAW);
+    m_instanceCapacity=_size;
+  }
+  // invalidating lets the driver hand us fresh storage rather than stall on the last frame
+  void *mapped= _size==0 ? nullptr :
+    glMapBufferRange(GL_ARRAY_BUFFER,0,static_cast<GLsizeiptr>(_size),GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if(mapped==nullptr)
+  {
+    // the old contents may be gone so draw nothing until the next successful map
+    if(_size!=0)
+    {
+      std::cerr<<"couldn't map the instance buffer\n";
+    }
+    m_numInstances=0;
+    return nullptr;
+  }
+  m_numInstances=_numInstances;
+  return mapped;
+}
+
+void InstancedVAO::unmapInstances()
+{
+  glBindBuffer(GL_ARRAY_BUFFER,m_instanceBuffer);
+  glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+void InstancedVAO::setInstanceAttributePointer(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, unsigned int _dataOffset)
+{
+  if(m_instanceBuffer==0)
+  {
+    glGenBuffers(1,&m_instanceBuffer);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER,m_instanceBuffer);
+  setVertexAttributePointer(_id,_size,_type,_stride,_dataOffset);
+  glVertexAttribDivisor(_id,1);
+}
@@ -7,11 +7,25 @@
 #include <ngl/VAOFactory.h>
 #include <ngl/SimpleVAO.h>
 #include <ngl/ShaderLib.h>
-#include <ngl/NGLStream.h>
+#include "BoidTable.h"
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <iostream>
 
-NGLScene::NGLScene()
+namespace
+{
+  // the boid mesh is 2.5 units long, this makes it about the separation radius
+  constexpr float c_boidScale = 0.2f;
+  // gold, silver, copper and chrome, M steps through them
+  constexpr std::array<PhongMaterial, 4> c_materials = {{
+      {{0.274725f, 0.1995f, 0.0745f, 0.0f}, {0.75164f, 0.60648f, 0.22648f, 0.0f}, {0.628281f, 0.555802f, 0.3666065f, 0.0f}, 51.2f, {}},
+      {{0.19225f, 0.19225f, 0.19225f, 0.0f}, {0.50754f, 0.50754f, 0.50754f, 0.0f}, {0.508273f, 0.508273f, 0.508273f, 0.0f}, 51.2f, {}},
+      {{0.19125f, 0.0735f, 0.0225f, 0.0f}, {0.7038f, 0.27048f, 0.0828f, 0.0f}, {0.256777f, 0.137622f, 0.086014f, 0.0f}, 12.8f, {}},
+      {{0.25f, 0.25f, 0.25f, 0.0f}, {0.4f, 0.4f, 0.4f, 0.0f}, {0.774597f, 0.774597f, 0.774597f, 0.0f}, 76.8f, {}}}};
+} // end anon namespace
+
+NGLScene::NGLScene(size_t _numBoids, const FlockParams &_params) : m_flock(std::make_unique<Flock>(_numBoids, _params))
 {
   setTitle("Qt5 Simple NGL Demo");
 }
@@ -19,11 +33,14 @@ NGLScene::NGLScene()
 NGLScene::~NGLScene()
 {
   std::cout << "Shutting down NGL, removing VAO's and Shaders\n";
+  m_vao->removeVAO();
+  m_light->remove();
+  m_materials->remove();
 }
 
 void NGLScene::resizeGL(int _w, int _h)
 {
-  m_project = ngl::perspective(45.0f, static_cast<float>(_w) / _h, 0.05f, 350.0f);
+  m_transforms.setProject(ngl::perspective(45.0f, static_cast<float>(_w) / _h, 0.05f, 350.0f));
   m_win.width = static_cast<int>(_w * devicePixelRatio());
   m_win.height = static_cast<int>(_h * devicePixelRatio());
 }
@@ -43,14 +60,14 @@ void NGLScene::initializeGL()
   // Now we will create a basic Camera from the graphics library
   // This is a static camera so it only needs to be set once
   // First create Values for the camera position
-  ngl::Vec3 from(0, 1, -4);
+  ngl::Vec3 from(0, 12, -32);
   ngl::Vec3 to(0, 0, 0);
   ngl::Vec3 up(0, 1, 0);
 
-  m_view = ngl::lookAt(from, to, up);
+  m_transforms.setView(ngl::lookAt(from, to, up));
   // set the shape using FOV 45 Aspect Ratio based on Width and Height
   // The final two are near and far clipping planes of 0.5 and 10
-  m_project = ngl::perspective(45.0f, 1024.0f / 720.0f, 0.01f, 150.0f);
+  m_transforms.setProject(ngl::perspective(45.0f, 1024.0f / 720.0f, 0.01f, 150.0f));
 
   // we are creating a shader called Phong to save typos
   // in the code create some constexpr
@@ -76,67 +93,45 @@ void NGLScene::initializeGL()
   ngl::ShaderLib::linkProgramObject(shaderProgram);
   // and make it active ready to load values
   ngl::ShaderLib::use(shaderProgram);
-  ngl::Vec4 lightPos(-2.0f, 5.0f, 2.0f, 0.0f);
-  ngl::ShaderLib::setUniform("light.position", lightPos);
-  ngl::ShaderLib::setUniform("light.ambient", 0.0f, 0.0f, 0.0f, 1.0f);
-  ngl::ShaderLib::setUniform("light.diffuse", 1.0f, 1.0f, 1.0f, 1.0f);
-  ngl::ShaderLib::setUniform("light.specular", 0.8f, 0.8f, 0.8f, 1.0f);
-  // gold like phong material
-  ngl::ShaderLib::setUniform("material.ambient", 0.274725f, 0.1995f, 0.0745f, 0.0f);
-  ngl::ShaderLib::setUniform("material.diffuse", 0.75164f, 0.60648f, 0.22648f, 0.0f);
-  ngl::ShaderLib::setUniform("material.specular", 0.628281f, 0.555802f, 0.3666065f, 0.0f);
-  ngl::ShaderLib::setUniform("material.shininess", 51.2f);
+  // the light and material are std140 uniform blocks (see PhongBlocks.h) each filled with one call, any program
+  // attached to the same binding points shares them
+  GLuint program = ngl::ShaderLib::getProgramID(shaderProgram);
+  UniformBuffer::attach(program, c_lightBlock, c_lightBinding);
+  UniformBuffer::attach(program, c_materialBlock, c_materialBinding);
+  m_transforms.attach(program);
+  m_light = std::make_unique<UniformBuffer>(c_lightBinding, sizeof(PhongLight));
+  m_light->set(PhongLight{{-2.0f, 5.0f, 2.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, {0.8f, 0.8f, 0.8f, 1.0f}});
+  // every material is uploaded now, switching between them is one glBindBufferRange
+  m_materials = std::make_unique<UniformBuffer>(c_materialBinding, sizeof(PhongMaterial), c_materials.size());
+  for (size_t i = 0; i < c_materials.size(); ++i)
+  {
+    m_materials->set(c_materials[i], i);
+  }
+  m_materials->bind(m_material);
   ngl::ShaderLib::setUniform("viewerPos", from);
+  // the instanced vertex shader scales the mesh by this before placing it at each boid
+  ngl::ShaderLib::setUniform("boidScale", c_boidScale);
 
+  // the mesh and the per boid data are two buffers of one VAO drawn with a single instanced call
+  ngl::VAOFactory::registerVAOCreator("instancedVAO", InstancedVAO::create);
   buildVAO();
   glViewport(0, 0, width(), height());
+  // step the flock at about 60Hz, timerEvent uses the real time between steps
+  startTimer(16);
+  m_timer.start();
 }
 
 void NGLScene::buildVAO()
 {
-  std::vector<ngl::Vec3> verts =
-      {
-          ngl::Vec3(0, 1, 1),
-          ngl::Vec3(0, 0, -1),
-          ngl::Vec3(-0.5, 0, 1),
-          ngl::Vec3(0, 1, 1),
-          ngl::Vec3(0, 0, -1),
-          ngl::Vec3(0.5, 0, 1),
-          ngl::Vec3(0, 1, 1),
-          ngl::Vec3(0, 0, 1.5),
-          ngl::Vec3(-0.5, 0, 1),
-          ngl::Vec3(0, 1, 1),
-          ngl::Vec3(0, 0, 1.5),
-          ngl::Vec3(0.5, 0, 1)
-
-      };
-  std::cout << "Initial " << verts.size() << '\n';
-  ngl::Vec3 n = ngl::calcNormal(verts[2], verts[1], verts[0]);
-  verts.push_back(n);
-  verts.push_back(n);
-  verts.push_back(n);
-  n = ngl::calcNormal(verts[3], verts[4], verts[5]);
-  verts.push_back(n);
-  verts.push_back(n);
-  verts.push_back(n);
-
-  n = ngl::calcNormal(verts[6], verts[7], verts[8]);
-  verts.push_back(n);
-  verts.push_back(n);
-  verts.push_back(n);
-
-  n = ngl::calcNormal(verts[11], verts[10], verts[9]);
-  verts.push_back(n);
-  verts.push_back(n);
-  verts.push_back(n);
-
-  std::cout << "sizeof(verts) " << sizeof(verts) << " sizeof(ngl::Vec3) " << sizeof(ngl::Vec3) << "\n";
+  // built by the compiler including the face normals, see BoidTable.h
+  static constexpr auto boid = makeBoid();
+  static_assert(offsetof(BoidMesh, normals) == 12 * 3 * sizeof(float), "normals must follow the 12 positions");
   // create a vao as a series of GL_TRIANGLES
-  m_vao = ngl::VAOFactory::createVAO(ngl::simpleVAO, GL_TRIANGLES);
+  m_vao = ngl::vaoFactoryCast<InstancedVAO>(ngl::VAOFactory::createVAO("instancedVAO", GL_TRIANGLES));
   m_vao->bind();
 
   // in this case we are going to set our data as the vertices above
-  m_vao->setData(ngl::SimpleVAO::VertexData(verts.size() * sizeof(ngl::Vec3), verts[0].m_x));
+  m_vao->setData(ngl::SimpleVAO::VertexData(sizeof(boid), boid.positions[0].x));
   // now we set the attribute pointer to be 0 (as this matches vertIn in our shader)
 
   m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, 0, 0);
@@ -144,13 +139,15 @@ void NGLScene::buildVAO()
   // now we set the attribute pointer to be 1 (as this matches normal in our shader)
   // as we cast to ngl::Real for offset use 12 * 3 (as in x,y,z is 3 floats)
   m_vao->setVertexAttributePointer(1, 3, GL_FLOAT, 0, 12 * 3);
-  // divide by 2 as we have both verts and normals
-  m_vao->setNumIndices(verts.size() / 2);
+  m_vao->setNumIndices(boid.positions.size());
+
+  // the position and velocity of each boid (inPosition and inVelocity) come from the instance buffer and advance
+  // once per instance, as ngl::Real offsets into a Boid
+  m_vao->setInstanceAttributePointer(2, 3, GL_FLOAT, sizeof(Boid), 0);
+  m_vao->setInstanceAttributePointer(3, 3, GL_FLOAT, sizeof(Boid), offsetof(Boid, velocity) / sizeof(float));
 
   // now unbind
   m_vao->unbind();
-  for (auto f : verts)
-    std::cout << f << '\n';
 }
 
 void NGLScene::paintGL()
@@ -171,25 +168,39 @@ void NGLScene::paintGL()
 
   ngl::ShaderLib::use("Phong");
 
-  ngl::Mat4 MV;
-  ngl::Mat4 MVP;
-  ngl::Mat3 normalMatrix;
-  ngl::Mat4 M;
-  M = m_mouseGlobalTX;
-  MV = m_view * M;
-  MVP = m_project * MV;
-  normalMatrix = MV;
-  normalMatrix.inverse().transpose();
-  ngl::ShaderLib::setUniform("MV", MV);
-  ngl::ShaderLib::setUniform("MVP", MVP);
-  ngl::ShaderLib::setUniform("normalMatrix", normalMatrix);
-  ngl::ShaderLib::setUniform("M", M);
+  // MV, MVP and the normal matrix are only rebuilt and sent when the camera or the mouse transform has changed
+  m_transforms.setModel(m_mouseGlobalTX);
+  m_transforms.loadUniforms();
+  if (m_materials->bound() != m_material)
+  {
+    m_materials->bind(m_material);
+  }
 
   m_vao->bind();
-  m_vao->draw();
+  // stream this frame's boids then draw the whole flock in one call, the flock is packed straight into the mapped
+  // buffer so there is no staging copy
+  size_t numBoids = m_flock->size();
+  void *instances = m_vao->mapInstances(numBoids * sizeof(Boid), numBoids);
+  if (instances != nullptr)
+  {
+    m_flock->writeInstances(static_cast<Boid *>(instances));
+    m_vao->unmapInstances();
+    m_vao->draw();
+  }
   m_vao->unbind();
 }
 
+void NGLScene::timerEvent(QTimerEvent *)
+{
+  // use the real elapsed time but don't let a stall make the flock jump
+  float dt = std::min(static_cast<float>(m_timer.restart()) / 1000.0f, 0.05f);
+  if (m_animate)
+  {
+    m_flock->update(dt);
+  }
+  update();
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 void NGLScene::mouseMoveEvent(QMouseEvent *_event)
 {
@@ -308,6 +319,13 @@ void NGLScene::keyPressEvent(QKeyEvent *_event)
   case Qt::Key_N:
     showNormal();
     break;
+  case Qt::Key_Space:
+    m_animate ^= true;
+    break;
+  // next material, bound in paintGL where the context is current
+  case Qt::Key_M:
+    m_material = (m_material + 1) % c_materials.size();
+    break;
   default:
     break;
   }
@@ -0,0 +1,103 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+
+SpatialGrid::SpatialGrid(float _cellSize, const ngl::Vec3 &_min, const ngl::Vec3 &_max)
+{
+  configure(_cellSize,_min,_max);
+}
+
+void SpatialGrid::configure(float _cellSize, const ngl::Vec3 &_min, const ngl::Vec3 &_max)
+{
+  // keep the cell table to a sensible size if we are given a tiny cell or a huge domain
+  constexpr double maxCells=1<<24;
+  ngl::Vec3 size=_max-_min;
+  double volume=std::max(1e-6,static_cast<double>(size.m_x)*size.m_y*size.m_z);
+  m_cellSize=std::max(_cellSize,static_cast<float>(std::cbrt(volume/maxCells)));
+  if(m_cellSize !=_cellSize)
+  {
+    std::cerr<<"SpatialGrid cell size "<<_cellSize<<" is too small for the domain using "<<m_cellSize<<'\n';
+  }
+  m_invCellSize=1.0f/m_cellSize;
+  m_min[0]=_min.m_x;
+  m_min[1]=_min.m_y;
+  m_min[2]=_min.m_z;
+  const float extent[3]={size.m_x,size.m_y,size.m_z};
+  size_t cells=1;
+  for(int i=0; i<3; ++i)
+  {
+    m_dims[i]=std::max(1,static_cast<int>(std::ceil(extent[i]*m_invCellSize)));
+    cells*=static_cast<size_t>(m_dims[i]);
+  }
+  m_counts.reset(new std::atomic<uint32_t>[cells]);
+  m_cellStart.assign(cells+1,0);
+}
+
+void SpatialGrid::sortCells()
+{
+  size_t cells=numCells();
+  // exclusive prefix sum, each chunk totals its cells then adds the total of the chunks before it
+  size_t chunks=parallelChunks(cells,c_minPerChunk*4);
+  std::vector<uint32_t> chunkBase(chunks+1,0);
+  parallelFor(cells,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+  {
+    uint32_t sum=0;
+    for(size_t c=_begin; c<_end; ++c)
+    {
+      sum+=m_counts[c].load(std::memory_order_relaxed);
+    }
+    chunkBase[_chunk+1]=sum;
+  });
+  std::partial_sum(chunkBase.begin(),chunkBase.end(),chunkBase.begin());
+  parallelFor(cells,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+  {
+    uint32_t offset=chunkBase[_chunk];
+    for(size_t c=_begin; c<_end; ++c)
+    {
+      uint32_t count=m_counts[c].load(std::memory_order_relaxed);
+      m_cellStart[c]=offset;
+      // the count becomes the write cursor for the scatter
+      m_counts[c].store(offset,std::memory_order_relaxed);
+      offset+=count;
+    }
+  });
+  m_cellStart[cells]=chunkBase[chunks];
+
+  // scatter
+  size_t count=m_order.size();
+  parallelFor(count,parallelChunks(count,c_minPerChunk),[this](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      m_order[m_counts[m_cellOf[i]].fetch_add(1,std::memory_order_relaxed)]=static_cast<uint32_t>(i);
+    }
+  });
+
+  // the scatter order within a cell depends on the threads, put each cell back in index order so the
+  // simulation gives the same answer every run. Cells usually only hold a few points so insertion sort is best.
+  parallelFor(cells,chunks,[this](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t c=_begin; c<_end; ++c)
+    {
+      uint32_t *first=m_order.data()+m_cellStart[c];
+      uint32_t *last=m_order.data()+m_cellStart[c+1];
+      if(last-first>32)
+      {
+        std::sort(first,last);
+        continue;
+      }
+      for(uint32_t *i=first+1; i<last; ++i)
+      {
+        uint32_t value=*i;
+        uint32_t *j=i;
+        for(; j>first && *(j-1)>value; --j)
+        {
+          *j=*(j-1);
+        }
+        *j=value;
+      }
+    }
+  });
+}
@@ -0,0 +1,52 @@
+#include "UniformBuffer.h"
+#include <iostream>
+
+UniformBuffer::UniformBuffer(GLuint _binding, size_t _blockSize, size_t _count) :
+  m_binding(_binding),m_blockSize(_blockSize),m_count(_count)
+{
+  GLint alignment=256;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,&alignment);
+  size_t align=static_cast<size_t>(alignment>0 ? alignment : 256);
+  m_stride=(_blockSize+align-1)/align*align;
+  glGenBuffers(1,&m_id);
+  glBindBuffer(GL_UNIFORM_BUFFER,m_id);
+  glBufferData(GL_UNIFORM_BUFFER,static_cast<GLsizeiptr>(m_stride*_count),nullptr,GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER,0);
+  bind(0);
+}
+
+void UniformBuffer::remove()
+{
+  glDeleteBuffers(1,&m_id);
+  m_id=0;
+}
+
+void UniformBuffer::update(const void *_data, size_t _size, size_t _index)
+{
+  if(_index>=m_count || _size>m_blockSize)
+  {
+    std::cerr<<"UniformBuffer block "<<_index<<" of "<<_size<<" bytes doesn't fit\n";
+    return;
+  }
+  glBindBuffer(GL_UNIFORM_BUFFER,m_id);
+  glBufferSubData(GL_UNIFORM_BUFFER,static_cast<GLintptr>(_index*m_stride),static_cast<GLsizeiptr>(_size),_data);
+  glBindBuffer(GL_UNIFORM_BUFFER,0);
+}
+
+void UniformBuffer::bind(size_t _index)
+{
+  glBindBufferRange(GL_UNIFORM_BUFFER,m_binding,m_id,static_cast<GLintptr>(_index*m_stride),static_cast<GLsizeiptr>(m_blockSize));
+  m_bound=_index;
+}
+
+bool UniformBuffer::attach(GLuint _program, const char *_blockName, GLuint _binding)
+{
+  GLuint index=glGetUniformBlockIndex(_program,_blockName);
+  if(index==GL_INVALID_INDEX)
+  {
+    std::cerr<<"no uniform block "<<_blockName<<" in program "<<_program<<'\n';
+    return false;
+  }
+  glUniformBlockBinding(_program,index,_binding);
+  return true;
+}
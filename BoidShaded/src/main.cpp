@@ -2,13 +2,205 @@
 basic OpenGL demo modified from http://qt-project.org/doc/qt-5.0/qtgui/openglwindow.html
 ****************************************************************************/
 #include <QtGui/QGuiApplication>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <random>
+#include <string>
+#include <vector>
 #include "NGLScene.h"
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief run _kernels and the scalar kernels on the same random boids and neighbour sums and check they agree
+/// @returns the largest difference relative to the size of the scalar value
+//----------------------------------------------------------------------------------------------------------------------
+float verifyKernels(const BoidKernels &_kernels, const FlockParams &_params, size_t _count)
+{
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  std::uniform_int_distribution<int> neighbours(-2, 12);
+  BoidStore boids(_count);
+  SoABuffer sums(NumNeighbourSums, _count);
+  for (size_t i = 0; i < _count; ++i)
+  {
+    // some boids are outside the bounds and some are too fast so every branch is used
+    boids[BoidStore::PX][i] = unit(rng) * _params.bounds.m_x * 1.5f;
+    boids[BoidStore::PY][i] = unit(rng) * _params.bounds.m_y * 1.5f;
+    boids[BoidStore::PZ][i] = unit(rng) * _params.bounds.m_z * 1.5f;
+    for (size_t c = BoidStore::VX; c <= BoidStore::VZ; ++c)
+    {
+      boids[c][i] = unit(rng) * _params.maxSpeed * 1.5f;
+    }
+    float count = static_cast<float>(std::max(0, neighbours(rng)));
+    sums[Neighbours][i] = count;
+    for (size_t c = HeadingX; c <= HeadingZ; ++c)
+    {
+      sums[c][i] = unit(rng) * _params.maxSpeed * count;
+    }
+    for (size_t c = 0; c < 3; ++c)
+    {
+      sums[CentreX + c][i] = (boids[BoidStore::PX + c][i] + unit(rng) * _params.neighbourRadius) * count;
+      // leave some separations at zero as most boids have no one that close
+      sums[SeparationX + c][i] = (i % 3 == 0) ? 0.0f : unit(rng) * 10.0f;
+    }
+  }
+  const BoidKernels &reference = boidKernels::scalar();
+  SoABuffer force(3, _count);
+  SoABuffer referenceForce(3, _count);
+  BoidStore next(_count);
+  BoidStore referenceNext(_count);
+  constexpr float dt = 1.0f / 60.0f;
+  _kernels.steer(boids, 0, _count, sums, _params, force);
+  reference.steer(boids, 0, _count, sums, _params, referenceForce);
+  // integrate both from the same force so the steering error isn't counted twice
+  _kernels.integrate(boids, 0, _count, referenceForce, dt, _params, next);
+  reference.integrate(boids, 0, _count, referenceForce, dt, _params, referenceNext);
+  float error = 0.0f;
+  auto compare = [&error](const SoABuffer &_a, const SoABuffer &_b)
+  {
+    for (size_t c = 0; c < _a.channels(); ++c)
+    {
+      for (size_t i = 0; i < _a.size(); ++i)
+      {
+        error = std::max(error, std::abs(_a[c][i] - _b[c][i]) / std::max(1.0f, std::abs(_b[c][i])));
+      }
+    }
+  };
+  compare(force, referenceForce);
+  compare(next, referenceNext);
+  return error;
+}
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief run the flock with no window (or GL) and report the throughput
+//----------------------------------------------------------------------------------------------------------------------
+int runHeadless(size_t _numBoids, const FlockParams &_params, NeighbourSearch _search, const BoidKernels &_kernels, int _frames)
+{
+  Flock flock(_numBoids, _params);
+  flock.setNeighbourSearch(_search);
+  flock.setKernels(_kernels);
+  constexpr float dt = 1.0f / 60.0f;
+  // one untimed step so the first touch of the memory isn't counted
+  flock.update(dt);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < _frames; ++i)
+  {
+    flock.update(dt);
+  }
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  std::cout << (_search == NeighbourSearch::Grid ? "grid " : "brute force ") << _kernels.name << ' ' << _numBoids << " boids "
+            << JobSystem::instance().numThreads() << " threads " << _frames << " frames in " << seconds << " s, "
+            << seconds * 1000.0 / _frames << " ms per frame, "
+            << static_cast<double>(_numBoids) * _frames / seconds << " boids/sec\n";
+  return EXIT_SUCCESS;
+}
 
 int main(int argc, char **argv)
 {
+  // --boids N sets the flock size, --bounds H the half size of the box (by default this grows with the flock so
+  // the density stays the same) and --cell S the grid cell size. --headless [--frames N] [--brute] runs the
+  // simulation without a window, --brute tests every pair for comparison with the grid. --kernels scalar|avx2|neon
+  // picks the steering and integration kernels (the default is the fastest available) and --verify checks them
+  // against the scalar kernels, or every SIMD set this build and CPU can run if --kernels isn't given. --threads N sizes the job system (all cores by default) and --pin pins its workers.
+  bool headless = false;
+  bool verify = false;
+  const BoidKernels *kernels = &boidKernels::best();
+  bool kernelsChosen = false;
+  NeighbourSearch search = NeighbourSearch::Grid;
+  size_t numBoids = 2000;
+  float bounds = 0.0f;
+  FlockParams params;
+  int frames = 100;
+  JobSystem::Options jobOptions;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--headless")
+    {
+      headless = true;
+    }
+    else if (arg == "--boids" && i + 1 < argc)
+    {
+      numBoids = std::stoul(argv[++i]);
+    }
+    else if (arg == "--frames" && i + 1 < argc)
+    {
+      frames = std::stoi(argv[++i]);
+    }
+    else if (arg == "--bounds" && i + 1 < argc)
+    {
+      bounds = std::stof(argv[++i]);
+    }
+    else if (arg == "--cell" && i + 1 < argc)
+    {
+      params.cellSize = std::stof(argv[++i]);
+    }
+    else if (arg == "--brute")
+    {
+      search = NeighbourSearch::BruteForce;
+    }
+    else if (arg == "--kernels" && i + 1 < argc)
+    {
+      kernels = boidKernels::find(argv[++i]);
+      kernelsChosen = true;
+      if (kernels == nullptr)
+      {
+        std::cerr << argv[i] << " kernels are not available on this machine\n";
+        return EXIT_FAILURE;
+      }
+    }
+    else if (arg == "--verify")
+    {
+      verify = true;
+    }
+    else if (arg == "--threads" && i + 1 < argc)
+    {
+      jobOptions.threads = std::stoul(argv[++i]);
+    }
+    else if (arg == "--pin")
+    {
+      jobOptions.pinThreads = true;
+    }
+  }
+  JobSystem::setInstanceOptions(jobOptions);
+  if (bounds <= 0.0f)
+  {
+    // about one boid per 8 units^3
+    bounds = std::max(10.0f, 0.5f * std::cbrt(static_cast<float>(numBoids) * 8.0f));
+  }
+  params.bounds.set(bounds, bounds, bounds);
+  params.gridBounds = params.bounds * 1.2f;
+  if (verify)
+  {
+    // the SIMD versions use FMA and divide in a different order so they are close but not bit exact
+    constexpr float tolerance = 1.0e-4f;
+    std::vector<const BoidKernels *> sets = {kernels};
+    if (!kernelsChosen)
+    {
+      // so one run on an AArch64 machine checks the NEON kernels, which nothing else exercises
+      sets = {boidKernels::avx2(), boidKernels::neon()};
+      sets.erase(std::remove(sets.begin(), sets.end(), nullptr), sets.end());
+      if (sets.empty())
+      {
+        std::cout << "no SIMD kernels were built for this machine, only the scalar ones run\n";
+      }
+    }
+    int status = EXIT_SUCCESS;
+    for (auto set : sets)
+    {
+      float error = verifyKernels(*set, params, 100003);
+      std::cout << set->name << " kernels differ from scalar by " << error << (error <= tolerance ? " ok\n" : " FAILED\n");
+      status = error <= tolerance ? status : EXIT_FAILURE;
+    }
+    return status;
+  }
+  if (headless)
+  {
+    return runHeadless(numBoids, params, search, *kernels, frames);
+  }
+
   QGuiApplication app(argc, argv);
   // create an OpenGL format specifier
   QSurfaceFormat format;
@@ -30,7 +222,7 @@ int main(int argc, char **argv)
   // now set the depth buffer to 24 bits
   format.setDepthBufferSize(24);
   // now we are going to create our scene window
-  NGLScene window;
+  NGLScene window(numBoids, params);
   // and set the OpenGL format
   window.setFormat(format);
   // we can now query the version to see if it worked
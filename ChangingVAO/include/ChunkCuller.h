@@ -0,0 +1,52 @@
+#ifndef CHUNKCULLER_H_
+#define CHUNKCULLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class ChunkCuller
+/// @brief frustum culling for a buffer of points drawn in fixed size chunks. build() finds the bounding box of each
+/// chunk when the data is uploaded, cull() tests the boxes against the frustum four at a time (SSE2 or NEON, scalar
+/// elsewhere) and returns the visible chunks merged into (first,count) ranges for a multi draw. It only pays off if
+/// the points in a chunk are close together, sort them first (see MortonSort) if they aren't.
+/// This has no GL or NGL in it.
+//----------------------------------------------------------------------------------------------------------------------
+class ChunkCuller
+{
+  public :
+    struct Range
+    {
+      size_t first;
+      size_t count;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief find the bounds of each chunk of _chunkSize points, runs on the job system
+    /// @param _positions the first x of the x,y,z floats
+    /// @param _stride bytes from one point to the next, 0 for packed x,y,z
+    //----------------------------------------------------------------------------------------------------------------------
+    void build(const void *_positions, size_t _count, size_t _chunkSize, size_t _stride=0);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the ranges of points in chunks at least partly inside the frustum of a column major model view projection
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<Range> &cull(const float _mvp[16]);
+    size_t numChunks() const {return m_numChunks;}
+    size_t chunkSize() const {return m_chunkSize;}
+    size_t visibleChunks() const {return m_visibleChunks;}
+    size_t visiblePoints() const {return m_visiblePoints;}
+
+  private :
+    // centre and half extent of each chunk's box, padded to a multiple of 4 for the SIMD test
+    std::vector<float> m_centre[3];
+    std::vector<float> m_extent[3];
+    std::vector<uint8_t> m_visible;
+    std::vector<Range> m_ranges;
+    size_t m_count=0;
+    size_t m_chunkSize=0;
+    size_t m_numChunks=0;
+    size_t m_visibleChunks=0;
+    size_t m_visiblePoints=0;
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef FRAMERING_H_
+#define FRAMERING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class FrameRing
+/// @brief a single producer single consumer ring of point frames in POSIX shared memory so a simulation in another
+/// process can hand frames to the renderer without copying them through a socket. The producer writes each frame
+/// straight into a slot of the mapping and the consumer uploads straight from the slot, the only copy is the one
+/// the GL driver makes. The consumer always takes the newest frame and skips any it was too slow for, if the ring
+/// is full the producer drops the frame rather than wait for the renderer.
+/// This has no GL or NGL in it so the producer tool can use it too.
+//----------------------------------------------------------------------------------------------------------------------
+class FrameRing
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief what each point in a frame holds
+    //----------------------------------------------------------------------------------------------------------------------
+    enum class Layout : uint32_t
+    {
+      PositionXYZ=1 ///< 3 floats per point
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the header at the start of each slot, the points follow at the next cache line
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Frame
+    {
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief numbered from 0 by the producer, a gap means frames were dropped or skipped
+      //----------------------------------------------------------------------------------------------------------------------
+      uint64_t sequence;
+      uint32_t count;
+      Layout layout;
+      const float *points() const {return reinterpret_cast<const float *>(reinterpret_cast<const char *>(this)+c_frameHeaderSize);}
+      float *points() {return reinterpret_cast<float *>(reinterpret_cast<char *>(this)+c_frameHeaderSize);}
+    };
+    static constexpr size_t c_frameHeaderSize=64;
+    static size_t floatsPerPoint(Layout _layout);
+
+    FrameRing()=default;
+    ~FrameRing();
+    FrameRing(const FrameRing &)=delete;
+    FrameRing &operator=(const FrameRing &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief producer side, create (or replace) the shared memory
+    /// @param _name the shm name, it must start with / and is best kept under 31 characters for macOS
+    /// @param _slots the number of frames in flight, 3 lets the producer work while the consumer uploads
+    /// @param _maxPoints the largest frame
+    /// @returns false if the shared memory couldn't be created, the reason is printed
+    //----------------------------------------------------------------------------------------------------------------------
+    bool create(const std::string &_name, uint32_t _slots, uint32_t _maxPoints, Layout _layout=Layout::PositionXYZ);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief consumer side, map an existing ring
+    /// @returns false if there is no ring of that name yet or it isn't valid
+    //----------------------------------------------------------------------------------------------------------------------
+    bool open(const std::string &_name);
+    void close();
+    bool isOpen() const {return m_header!=nullptr;}
+    uint32_t maxPoints() const;
+    Layout layout() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief producer, the next free slot to write _maxPoints into or nullptr if the consumer hasn't freed one
+    //----------------------------------------------------------------------------------------------------------------------
+    Frame *beginWrite();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief producer, publish the slot from beginWrite holding _count points
+    //----------------------------------------------------------------------------------------------------------------------
+    void endWrite(uint32_t _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief consumer, the newest frame not seen yet or nullptr, older frames are released unread. The frame stays
+    /// valid until release() is called.
+    //----------------------------------------------------------------------------------------------------------------------
+    const Frame *acquireLatest();
+    void release();
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the start of the mapping, the counters are on their own cache lines so the two sides don't share one
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Header
+    {
+      char magic[8];
+      uint32_t version;
+      uint32_t slots;
+      uint32_t maxPoints;
+      Layout layout;
+      uint64_t slotSize;
+      alignas(64) std::atomic<uint64_t> written;
+      alignas(64) std::atomic<uint64_t> read;
+    };
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,"the ring counters must be lock free to work across processes");
+    static constexpr uint32_t c_version=1;
+    Frame *slot(uint64_t _frame) const;
+    Header *m_header=nullptr;
+    size_t m_mapSize=0;
+    std::string m_name;
+    bool m_owner=false;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frame number written or held by this side
+    //----------------------------------------------------------------------------------------------------------------------
+    uint64_t m_current=0;
+    bool m_holding=false;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef MORTONSORT_H_
+#define MORTONSORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class MortonSort
+/// @brief reorders points along a Morton (Z order) curve so points close in space are close in the buffer. The
+/// rasteriser and any later chunked culling then see spatially coherent runs rather than points scattered over the
+/// whole cloud. Each point gets a 30 bit key (10 bits an axis within the bounding box), the keys are sorted with an
+/// LSD radix sort and the positions and any per point attribute are gathered into the new order, every step runs in
+/// parallel chunks on the job system. The buffers are kept between calls so sorting every frame doesn't allocate.
+/// The index is carried in 32 bits so a sort is limited to 4G points.
+/// This has no GL or NGL in it.
+//----------------------------------------------------------------------------------------------------------------------
+class MortonSort
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief milliseconds spent in each stage of the last sort
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Timings
+    {
+      double keys=0.0;
+      double sort=0.0;
+      double gather=0.0;
+      double total() const {return keys+sort+gather;}
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sort _count x,y,z points in place
+    /// @param io_attribs optional per point data reordered with the points, _attribFloats floats each (4 for a colour)
+    //----------------------------------------------------------------------------------------------------------------------
+    void sort(float *io_positions, size_t _count, float *io_attribs=nullptr, size_t _attribFloats=0);
+    const Timings &timings() const {return m_timings;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the key of each point after the last sort, in sorted order
+    //----------------------------------------------------------------------------------------------------------------------
+    uint32_t key(size_t _index) const {return static_cast<uint32_t>(m_pairs[_index]>>32);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief spread the low 10 bits of _v so there are two zero bits between each
+    //----------------------------------------------------------------------------------------------------------------------
+    static uint32_t expandBits(uint32_t _v);
+    static uint32_t encode(uint32_t _x, uint32_t _y, uint32_t _z) {return (expandBits(_x)<<2) | (expandBits(_y)<<1) | expandBits(_z);}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief key in the top 32 bits and the original index in the bottom so the sort carries the index along
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<uint64_t> m_pairs;
+    std::vector<uint64_t> m_scratch;
+    std::vector<float> m_gather;
+    std::vector<uint32_t> m_histograms;
+    std::vector<float> m_bounds;
+    Timings m_timings;
+};
+
+#endif
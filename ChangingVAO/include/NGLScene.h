@@ -5,8 +5,18 @@
 #include <ngl/Vec3.h>
 #include <ngl/AbstractVAO.h>
 #include "WindowParams.h"
+#include "UniformHandle.h"
+#include "FrameRing.h"
+#include "FrameRecording.h"
+#include "PlyFile.h"
+#include "PointOctree.h"
+#include "OctreeLOD.h"
+#include "MortonSort.h"
+#include "ChunkCuller.h"
+#include <QElapsedTimer>
 #include <QOpenGLWindow>
 #include <memory>
+#include <string>
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @file NGLScene.h
@@ -21,14 +31,40 @@
 /// put in this file
 //----------------------------------------------------------------------------------------------------------------------
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief where the points come from and whether they are recorded
+//----------------------------------------------------------------------------------------------------------------------
+struct SceneOptions
+{
+  // the name of a FrameRing to draw frames from (see FrameRing.h)
+  std::string feed;
+  // play this recording (see FrameRecording.h) instead of generating points
+  std::string play;
+  // playback frames per second, 0 plays as fast as the frames can be drawn
+  double playRate = 60.0;
+  // append every new frame to this recording
+  std::string record;
+  // draw this binary PLY point cloud instead of changing points
+  std::string ply;
+  // stream this octree (see ChangingVAOOctreeBuilder) within a fixed GPU budget
+  std::string octree;
+  size_t octreeBudgetMB = 256;
+  // octree nodes are refined until their points are this many pixels apart
+  float octreeError = 2.0f;
+  // sort generated points into Morton order before upload
+  bool morton = false;
+  // only draw the chunks of generated or PLY points that are in the view frustum, best with morton for generated
+  bool cull = false;
+};
+
 class NGLScene : public QOpenGLWindow
 {
   public:
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief ctor for our NGL drawing class
-    /// @param [in] parent the parent window to the class
+    /// @param [in] _options the data source, by default random points are generated
     //----------------------------------------------------------------------------------------------------------------------
-    NGLScene();
+    explicit NGLScene(const SceneOptions &_options = {});
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief dtor must close down ngl and release OpenGL resources
     //----------------------------------------------------------------------------------------------------------------------
@@ -99,7 +135,70 @@ private:
     void timerEvent(QTimerEvent *_event) override;
     // Data to plot each frame
     std::vector <ngl::Vec3> m_data;
+    // frame counter used to seed the generation
+    unsigned int m_frame = 0;
+    MortonSort m_sorter;
+    // the Morton sort cost in ms per million points averaged over the frames since the last report
+    double m_sortMs = 0.0;
+    size_t m_sortPoints = 0;
+    double m_sortMsPerMillion = 0.0;
+    SceneOptions m_options;
+    // frames from an external simulation, see FrameRing.h
+    FrameRing m_feed;
+    uint64_t m_feedSequence = 0;
+    uint64_t m_feedFrames = 0;
+    uint64_t m_feedSkipped = 0;
+    size_t m_numPoints = 0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief upload the newest feed frame straight from the shared memory if there is one
+    //----------------------------------------------------------------------------------------------------------------------
+    void uploadFeedFrame();
+    FrameRecorder m_recorder;
+    // playback state, a frame is only stepped on once the last has been drawn so every frame is shown in order
+    FramePlayer m_player;
+    size_t m_playFrame = 0;
+    bool m_playPending = false;
+    double m_nextPlayTime = 0.0;
+    QElapsedTimer m_playTimer;
+    // sustained upload throughput for each pass through the recording
+    uint64_t m_playBytes = 0;
+    double m_playPassStart = 0.0;
+    double m_playFps = 0.0;
+    double m_playMBs = 0.0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief upload the current recorded frame straight from the mapped file
+    //----------------------------------------------------------------------------------------------------------------------
+    void uploadPlayFrame();
+    // a static point cloud, only mapped until it is uploaded
+    PlyFile m_cloud;
+    // scales and centres the cloud to fill the view
+    ngl::Mat4 m_cloudTX;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief upload m_cloud once, straight from the mapping if its layout allows or converted in parallel if not
+    //----------------------------------------------------------------------------------------------------------------------
+    void uploadCloud();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set m_cloudTX to centre and scale a box to fill the view
+    //----------------------------------------------------------------------------------------------------------------------
+    void fitToView(const float _min[3], const float _max[3]);
+    // an out of core cloud, m_vao is a PointPoolVAO holding the nodes m_lod picks
+    PointOctree m_octree;
+    std::unique_ptr<OctreeLOD> m_lod;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief choose this frame's octree nodes and upload any that aren't on the GPU yet
+    //----------------------------------------------------------------------------------------------------------------------
+    void streamOctree(const ngl::Mat4 &_MV, const ngl::Mat4 &_MVP);
+    // chunk bounds of the uploaded points when culling, m_vao is then a PointPoolVAO drawn as the visible ranges
+    ChunkCuller m_culler;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief replace the draw list with the chunks in the frustum
+    //----------------------------------------------------------------------------------------------------------------------
+    void cullChunks(const ngl::Mat4 &_MVP);
     std::unique_ptr<ngl::AbstractVAO> m_vao;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the MVP uniform of the shader, found once after linking
+    //----------------------------------------------------------------------------------------------------------------------
+    UniformHandle m_MVPUniform;
 
     // text render class
     std::unique_ptr <ngl::Text> m_text;
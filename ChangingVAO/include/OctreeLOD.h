@@ -0,0 +1,96 @@
+#ifndef OCTREELOD_H_
+#define OCTREELOD_H_
+
+#include "PointOctree.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class OctreeLOD
+/// @brief picks the PointOctree nodes to draw each frame and keeps them in a fixed number of GPU slots. Nodes in the
+/// frustum are refined largest screen space error first until the error is under the limit or every slot is spoken
+/// for, so the memory used never grows past the budget however big the cloud is. Nodes already in a slot are drawn
+/// straight away, missing ones are loaded a few a frame into free slots or the least recently used slot of a node
+/// that isn't wanted and the rest are prefetched from disk for the next frames. The GL side is left to the caller,
+/// see PointPoolVAO.
+//----------------------------------------------------------------------------------------------------------------------
+class OctreeLOD
+{
+  public :
+    struct Load
+    {
+      uint32_t node;
+      uint32_t slot;
+    };
+    struct Draw
+    {
+      uint32_t slot;
+      uint32_t count;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @param _octree an open octree, it must outlive this
+    /// @param _slots how many nodes fit in the GPU pool
+    //----------------------------------------------------------------------------------------------------------------------
+    OctreeLOD(const PointOctree &_octree, size_t _slots);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief nodes whose points are further apart than this many pixels on screen are refined
+    //----------------------------------------------------------------------------------------------------------------------
+    void setMaxError(float _pixels) {m_maxError=_pixels;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief limit the uploads each frame so streaming doesn't stall the frame rate
+    //----------------------------------------------------------------------------------------------------------------------
+    void setMaxLoadsPerFrame(size_t _loads) {m_maxLoads=_loads;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief choose this frame's nodes, after this upload loads() then draw draws()
+    /// @param _mvp the column major model view projection for the octree's coordinates
+    /// @param _eye the camera position in the octree's coordinates
+    /// @param _projScale pixels per unit at a distance of 1, viewport height / (2 tan(fov/2))
+    //----------------------------------------------------------------------------------------------------------------------
+    void update(const float _mvp[16], const float _eye[3], float _projScale);
+    const std::vector<Load> &loads() const {return m_loads;}
+    const std::vector<Draw> &draws() const {return m_draws;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if nodes were wanted that couldn't be loaded this frame so another frame should be drawn
+    //----------------------------------------------------------------------------------------------------------------------
+    bool pending() const {return m_pending;}
+    size_t numSlots() const {return m_slotNode.size();}
+    size_t residentNodes() const {return m_resident;}
+    size_t pointsDrawn() const {return m_pointsDrawn;}
+    uint64_t evictions() const {return m_evictions;}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief move a slot to the front of the recently used list
+    //----------------------------------------------------------------------------------------------------------------------
+    void touch(uint32_t _slot);
+    void unlink(uint32_t _slot);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a free slot or the least recently used one not wanted this frame, c_none if every slot is in use
+    //----------------------------------------------------------------------------------------------------------------------
+    uint32_t claimSlot();
+    static constexpr uint32_t c_none=0xffffffff;
+    const PointOctree &m_octree;
+    float m_maxError=2.0f;
+    size_t m_maxLoads=16;
+    // node to slot and back, c_none when not resident
+    std::vector<uint32_t> m_nodeSlot;
+    std::vector<uint32_t> m_slotNode;
+    // the recently used list threaded through the slots, m_head is the most recent
+    std::vector<uint32_t> m_prev;
+    std::vector<uint32_t> m_next;
+    uint32_t m_head=c_none;
+    uint32_t m_tail=c_none;
+    std::vector<uint64_t> m_slotFrame;
+    std::vector<uint32_t> m_free;
+    uint64_t m_frame=0;
+    std::vector<uint32_t> m_selected;
+    std::vector<Load> m_loads;
+    std::vector<Draw> m_draws;
+    bool m_pending=false;
+    size_t m_resident=0;
+    size_t m_pointsDrawn=0;
+    uint64_t m_evictions=0;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef PLYFILE_H_
+#define PLYFILE_H_
+
+#include <QFile>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class PlyFile
+/// @brief a binary little endian PLY point cloud loader for very large scans. The file is memory mapped and only the
+/// text header is parsed, the vertex data is used where it lies. If x,y,z are consecutive floats the vertices can be
+/// passed to setData as they are (with the vertex size as the attribute stride) so loading costs nothing more than
+/// the driver's copy, any other layout (doubles, quantised ints, properties in between) is converted to packed
+/// x,y,z floats in parallel chunks. Only the vertex element is read, faces and other elements are ignored.
+/// This has no GL or NGL in it.
+//----------------------------------------------------------------------------------------------------------------------
+class PlyFile
+{
+  public :
+    enum class Type : uint8_t
+    {
+      Int8,UInt8,Int16,UInt16,Int32,UInt32,Float32,Float64
+    };
+    struct Property
+    {
+      std::string name;
+      Type type;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief byte offset in the vertex
+      //----------------------------------------------------------------------------------------------------------------------
+      size_t offset;
+    };
+
+    PlyFile()=default;
+    ~PlyFile();
+    PlyFile(const PlyFile &)=delete;
+    PlyFile &operator=(const PlyFile &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief map a file and validate its header
+    /// @returns false if it isn't a binary little endian PLY with x,y,z vertices or is shorter than the header says,
+    /// the reason is printed
+    //----------------------------------------------------------------------------------------------------------------------
+    bool open(const std::string &_fname);
+    void close();
+    bool isOpen() const {return m_vertices!=nullptr;}
+    size_t numPoints() const {return m_numPoints;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the size of one vertex in bytes
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t stride() const {return m_stride;}
+    const std::vector<Property> &properties() const {return m_properties;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if x,y,z are consecutive floats at a 4 byte offset so vertexData() can be drawn directly with
+    /// a stride of stride() and a float offset of positionOffset()/sizeof(float)
+    //----------------------------------------------------------------------------------------------------------------------
+    bool positionsInPlace() const {return m_inPlace;}
+    size_t positionOffset() const {return m_position[0]->offset;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the first vertex in the mapping
+    //----------------------------------------------------------------------------------------------------------------------
+    const uchar *vertexData() const {return m_vertices;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copy the positions out as packed x,y,z floats whatever their type, this runs on the job system
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<float> convertPositions() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the bounding box of the positions, computed in parallel straight from the mapping
+    //----------------------------------------------------------------------------------------------------------------------
+    void bounds(float o_min[3], float o_max[3]) const;
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief read the vertex properties from the header
+    /// @param [out] o_headerSize the bytes up to and including the end_header line
+    /// @param [out] o_skip the bytes of any elements stored before the vertices
+    //----------------------------------------------------------------------------------------------------------------------
+    bool parseHeader(const char *_begin, const char *_end, size_t &o_headerSize, uint64_t &o_skip);
+    QFile m_file;
+    const uchar *m_map=nullptr;
+    const uchar *m_vertices=nullptr;
+    size_t m_numPoints=0;
+    size_t m_stride=0;
+    std::vector<Property> m_properties;
+    const Property *m_position[3]={nullptr,nullptr,nullptr};
+    bool m_inPlace=false;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef POINTOCTREE_H_
+#define POINTOCTREE_H_
+
+#include <QFile>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class PointOctree
+/// @brief an out of core level of detail octree for point clouds too big for the GPU. Each node keeps a representative
+/// subset of the points in its cube (at most one per cell of a grid over the node) and passes the rest down to its
+/// children, so drawing any top part of the tree shows every point of those nodes and the detail fills in as nodes
+/// further down are added. build() writes the tree to a paged file offline, each node's points start on a page so
+/// they can be streamed in on their own, open() maps the file for the renderer to pick nodes from. See OctreeLOD for
+/// the runtime selection. This has no GL or NGL in it.
+//----------------------------------------------------------------------------------------------------------------------
+class PointOctree
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a node as stored in the file
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Node
+    {
+      float min[3];
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the length of the sides of the node's cube
+      //----------------------------------------------------------------------------------------------------------------------
+      float size;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief byte offset of the points in the file
+      //----------------------------------------------------------------------------------------------------------------------
+      uint64_t offset;
+      uint32_t count;
+      uint32_t level;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief child node indices, 0 for no child as the root is never a child
+      //----------------------------------------------------------------------------------------------------------------------
+      uint32_t children[8];
+    };
+    static constexpr uint32_t c_defaultPointsPerNode=16384;
+
+    PointOctree()=default;
+    ~PointOctree();
+    PointOctree(const PointOctree &)=delete;
+    PointOctree &operator=(const PointOctree &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief build an octree from x,y,z points and write it to _fname
+    /// @param _positions packed x,y,z floats, these are reordered as the tree is built
+    /// @param _pointsPerNode the most points in a node, this is the unit that is streamed to the GPU
+    /// @returns false if the file can't be written, the reason is printed
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool build(std::vector<float> &_positions, const std::string &_fname, uint32_t _pointsPerNode=c_defaultPointsPerNode);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief map an octree file and check the node table
+    /// @returns false if it isn't an octree file or is truncated, the reason is printed
+    //----------------------------------------------------------------------------------------------------------------------
+    bool open(const std::string &_fname);
+    void close();
+    bool isOpen() const {return m_map!=nullptr;}
+    size_t numNodes() const {return m_numNodes;}
+    const Node &node(size_t _index) const {return m_nodes[_index];}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the node's points in the mapping, touching them reads them from disk if they aren't cached
+    //----------------------------------------------------------------------------------------------------------------------
+    const float *points(size_t _index) const;
+    uint32_t pointsPerNode() const {return m_pointsPerNode;}
+    uint64_t totalPoints() const {return m_totalPoints;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the distance between the node's points, the error if it is drawn without its children
+    //----------------------------------------------------------------------------------------------------------------------
+    float spacing(size_t _index) const {return m_nodes[_index].size/static_cast<float>(m_gridResolution);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ask the kernel to start reading a node that will be needed soon
+    //----------------------------------------------------------------------------------------------------------------------
+    void prefetch(size_t _index) const;
+
+  private :
+    QFile m_file;
+    const uchar *m_map=nullptr;
+    const Node *m_nodes=nullptr;
+    size_t m_numNodes=0;
+    uint32_t m_pointsPerNode=0;
+    uint32_t m_gridResolution=0;
+    uint64_t m_totalPoints=0;
+};
+
+#endif
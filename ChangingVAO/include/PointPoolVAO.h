@@ -0,0 +1,66 @@
+#ifndef POINTPOOLVAO_H_
+#define POINTPOOLVAO_H_
+
+#include <ngl/AbstractVAO.h>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class PointPoolVAO
+/// @brief a single x,y,z buffer split into fixed size slots that are filled independently with glBufferSubData, used
+/// to keep a bounded set of octree nodes on the GPU. The buffer is allocated once so streaming never reallocates, draw
+/// issues every slot in the draw list with one glMultiDrawArrays. It can also hold one ordinary setData buffer drawn as
+/// arbitrary ranges, which is how the chunks ChunkCuller finds visible are drawn.
+//----------------------------------------------------------------------------------------------------------------------
+class PointPoolVAO : public ngl::AbstractVAO
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief creator method for the factory
+    /// @param _mode the mode to draw with.
+    /// @returns a new AbstractVAO * object
+    //----------------------------------------------------------------------------------------------------------------------
+    static std::unique_ptr<ngl::AbstractVAO> create(GLenum _mode=GL_POINTS) { return std::unique_ptr<AbstractVAO>(new PointPoolVAO(_mode)); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw each slot or range added since the last clearDraws
+    //----------------------------------------------------------------------------------------------------------------------
+    void draw() const override;
+    virtual ~PointPoolVAO()=default;
+    void removeVAO() override;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief replace the whole buffer, prefer allocate and upload
+    //----------------------------------------------------------------------------------------------------------------------
+    void setData(const VertexData &_data) override;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief allocate the pool with no data and point attribute 0 at it, the VAO must be bound
+    //----------------------------------------------------------------------------------------------------------------------
+    void allocate(size_t _slots, size_t _pointsPerSlot);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copy _count x,y,z points into a slot
+    //----------------------------------------------------------------------------------------------------------------------
+    void upload(size_t _slot, const float *_points, size_t _count);
+    void clearDraws();
+    void addDraw(size_t _slot, size_t _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw _count points from point _first, which needn't be the start of a slot
+    //----------------------------------------------------------------------------------------------------------------------
+    void addRange(size_t _first, size_t _count);
+    size_t numSlots() const {return m_slots;}
+    GLuint getBufferID(unsigned int) const override {return m_buffer;}
+    // not needed, use upload
+    ngl::Real *mapBuffer(unsigned int, GLenum) override {return nullptr;}
+
+  protected :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor calles parent ctor to allocate vao;
+    //----------------------------------------------------------------------------------------------------------------------
+    PointPoolVAO(GLenum _mode) : ngl::AbstractVAO(_mode) {}
+
+  private :
+    GLuint m_buffer=0;
+    size_t m_slots=0;
+    size_t m_pointsPerSlot=0;
+    std::vector<GLint> m_firsts;
+    std::vector<GLsizei> m_counts;
+};
+
+#endif
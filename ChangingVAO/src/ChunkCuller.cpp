@@ -0,0 +1,197 @@
+#include "ChunkCuller.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#include <emmintrin.h>
+#define CHUNKCULLER_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CHUNKCULLER_NEON 1
+#endif
+
+namespace
+{
+  constexpr size_t c_simdWidth=4;
+  // chunks are small so give each job plenty of them
+  constexpr size_t c_minChunksPerJob=256;
+
+  struct Planes
+  {
+    // a,b,c,d of the 6 planes and |a|,|b|,|c| for the box extent
+    float p[6][4];
+    float abs[6][3];
+  };
+
+  Planes extractPlanes(const float _mvp[16])
+  {
+    // Gribb and Hartmann, the planes are the sum and difference of the last row with each of the others
+    Planes planes;
+    for(size_t i=0; i<6; ++i)
+    {
+      size_t row=i/2;
+      float sign=(i&1) ? -1.0f : 1.0f;
+      float length=0.0f;
+      for(size_t c=0; c<4; ++c)
+      {
+        planes.p[i][c]=_mvp[c*4+3]+sign*_mvp[c*4+row];
+        length+=c<3 ? planes.p[i][c]*planes.p[i][c] : 0.0f;
+      }
+      length=length>0.0f ? std::sqrt(length) : 1.0f;
+      for(size_t c=0; c<4; ++c)
+      {
+        planes.p[i][c]/=length;
+      }
+      for(size_t c=0; c<3; ++c)
+      {
+        planes.abs[i][c]=std::abs(planes.p[i][c]);
+      }
+    }
+    return planes;
+  }
+} // end anon namespace
+
+void ChunkCuller::build(const void *_positions, size_t _count, size_t _chunkSize, size_t _stride)
+{
+  m_count=_count;
+  m_chunkSize=std::max<size_t>(_chunkSize,1);
+  m_numChunks=(_count+m_chunkSize-1)/m_chunkSize;
+  size_t padded=(m_numChunks+c_simdWidth-1)/c_simdWidth*c_simdWidth;
+  for(size_t a=0; a<3; ++a)
+  {
+    m_centre[a].assign(padded,0.0f);
+    m_extent[a].assign(padded,0.0f);
+  }
+  m_visible.assign(padded,0);
+  size_t stride=_stride!=0 ? _stride : 3*sizeof(float);
+  auto bytes=static_cast<const unsigned char *>(_positions);
+  parallelFor(m_numChunks,parallelChunks(m_numChunks,c_minChunksPerJob),[&](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t chunk=_begin; chunk<_end; ++chunk)
+    {
+      float min[3];
+      float max[3];
+      for(size_t a=0; a<3; ++a)
+      {
+        min[a]=std::numeric_limits<float>::max();
+        max[a]=std::numeric_limits<float>::lowest();
+      }
+      size_t last=std::min(_count,(chunk+1)*m_chunkSize);
+      for(size_t i=chunk*m_chunkSize; i<last; ++i)
+      {
+        float p[3];
+        std::memcpy(p,bytes+i*stride,sizeof(p));
+        for(size_t a=0; a<3; ++a)
+        {
+          min[a]=std::min(min[a],p[a]);
+          max[a]=std::max(max[a],p[a]);
+        }
+      }
+      for(size_t a=0; a<3; ++a)
+      {
+        m_centre[a][chunk]=0.5f*(min[a]+max[a]);
+        m_extent[a][chunk]=0.5f*(max[a]-min[a]);
+      }
+    }
+  });
+}
+
+const std::vector<ChunkCuller::Range> &ChunkCuller::cull(const float _mvp[16])
+{
+  Planes planes=extractPlanes(_mvp);
+  // a box is outside if it is wholly behind any plane, that is its centre is further behind than its extent
+  // projected onto the plane normal reaches
+#if defined(CHUNKCULLER_SSE2)
+  for(size_t c=0; c<m_numChunks; c+=c_simdWidth)
+  {
+    __m128 cx=_mm_loadu_ps(&m_centre[0][c]);
+    __m128 cy=_mm_loadu_ps(&m_centre[1][c]);
+    __m128 cz=_mm_loadu_ps(&m_centre[2][c]);
+    __m128 ex=_mm_loadu_ps(&m_extent[0][c]);
+    __m128 ey=_mm_loadu_ps(&m_extent[1][c]);
+    __m128 ez=_mm_loadu_ps(&m_extent[2][c]);
+    __m128 inside=_mm_castsi128_ps(_mm_set1_epi32(-1));
+    for(size_t i=0; i<6; ++i)
+    {
+      const float *p=planes.p[i];
+      const float *a=planes.abs[i];
+      __m128 d=_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[0]),cx),_mm_mul_ps(_mm_set1_ps(p[1]),cy)),
+                          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[2]),cz),_mm_set1_ps(p[3])));
+      __m128 r=_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]),ex),_mm_mul_ps(_mm_set1_ps(a[1]),ey)),
+                          _mm_mul_ps(_mm_set1_ps(a[2]),ez));
+      inside=_mm_and_ps(inside,_mm_cmpge_ps(_mm_add_ps(d,r),_mm_setzero_ps()));
+    }
+    int mask=_mm_movemask_ps(inside);
+    for(size_t k=0; k<c_simdWidth; ++k)
+    {
+      m_visible[c+k]=static_cast<uint8_t>((mask>>k)&1);
+    }
+  }
+#elif defined(CHUNKCULLER_NEON)
+  for(size_t c=0; c<m_numChunks; c+=c_simdWidth)
+  {
+    float32x4_t cx=vld1q_f32(&m_centre[0][c]);
+    float32x4_t cy=vld1q_f32(&m_centre[1][c]);
+    float32x4_t cz=vld1q_f32(&m_centre[2][c]);
+    float32x4_t ex=vld1q_f32(&m_extent[0][c]);
+    float32x4_t ey=vld1q_f32(&m_extent[1][c]);
+    float32x4_t ez=vld1q_f32(&m_extent[2][c]);
+    uint32x4_t inside=vdupq_n_u32(0xffffffff);
+    for(size_t i=0; i<6; ++i)
+    {
+      const float *p=planes.p[i];
+      const float *a=planes.abs[i];
+      float32x4_t d=vaddq_f32(vaddq_f32(vmulq_n_f32(cx,p[0]),vmulq_n_f32(cy,p[1])),
+                              vaddq_f32(vmulq_n_f32(cz,p[2]),vdupq_n_f32(p[3])));
+      float32x4_t r=vaddq_f32(vaddq_f32(vmulq_n_f32(ex,a[0]),vmulq_n_f32(ey,a[1])),vmulq_n_f32(ez,a[2]));
+      inside=vandq_u32(inside,vcgeq_f32(vaddq_f32(d,r),vdupq_n_f32(0.0f)));
+    }
+    uint32_t lanes[c_simdWidth];
+    vst1q_u32(lanes,inside);
+    for(size_t k=0; k<c_simdWidth; ++k)
+    {
+      m_visible[c+k]=static_cast<uint8_t>(lanes[k]&1);
+    }
+  }
+#else
+  for(size_t c=0; c<m_numChunks; ++c)
+  {
+    bool inside=true;
+    for(size_t i=0; i<6 && inside; ++i)
+    {
+      const float *p=planes.p[i];
+      const float *a=planes.abs[i];
+      float d=p[0]*m_centre[0][c]+p[1]*m_centre[1][c]+p[2]*m_centre[2][c]+p[3];
+      float r=a[0]*m_extent[0][c]+a[1]*m_extent[1][c]+a[2]*m_extent[2][c];
+      inside=d+r>=0.0f;
+    }
+    m_visible[c]=inside ? 1 : 0;
+  }
+#endif
+  // merge runs of visible chunks so a zoomed out view is still one draw
+  m_ranges.clear();
+  m_visibleChunks=0;
+  m_visiblePoints=0;
+  for(size_t c=0; c<m_numChunks; ++c)
+  {
+    if(m_visible[c]==0)
+    {
+      continue;
+    }
+    size_t first=c*m_chunkSize;
+    size_t count=std::min(m_count,first+m_chunkSize)-first;
+    if(!m_ranges.empty() && m_ranges.back().first+m_ranges.back().count==first)
+    {
+      m_ranges.back().count+=count;
+    }
+    else
+    {
+      m_ranges.push_back({first,count});
+    }
+    ++m_visibleChunks;
+    m_visiblePoints+=count;
+  }
+  return m_ranges;
+}
@@ -0,0 +1,126 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file FrameProducer.cpp
+/// @brief a stand in for an external simulation, writes an animated point cloud into a FrameRing at a fixed rate.
+/// Run this then ChangingVAO --shm with the same name.
+/// ChangingVAOProducer [--shm /ChangingVAO] [--points N] [--rate Hz] [--slots N] [--seconds S]
+//----------------------------------------------------------------------------------------------------------------------
+#include "FrameRing.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace
+{
+  std::atomic<bool> g_quit={false};
+
+  void onSignal(int)
+  {
+    g_quit=true;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a Fibonacci sphere that spins and ripples over time, written straight into the frame
+  //----------------------------------------------------------------------------------------------------------------------
+  void simulate(float *o_points, uint32_t _count, float _time)
+  {
+    constexpr float goldenAngle=2.39996323f;
+    for(uint32_t i=0; i<_count; ++i)
+    {
+      float y=1.0f-2.0f*(static_cast<float>(i)+0.5f)/static_cast<float>(_count);
+      float r=std::sqrt(std::max(0.0f,1.0f-y*y));
+      float phi=static_cast<float>(i)*goldenAngle+_time;
+      float radius=5.0f*(1.0f+0.1f*std::sin(6.0f*y+3.0f*_time));
+      o_points[i*3]=radius*r*std::cos(phi);
+      o_points[i*3+1]=radius*y;
+      o_points[i*3+2]=radius*r*std::sin(phi);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  std::string name="/ChangingVAO";
+  uint32_t points=123456;
+  uint32_t slots=3;
+  double rate=60.0;
+  double seconds=0.0;
+  for(int i=1; i<argc; ++i)
+  {
+    std::string arg=argv[i];
+    if(arg=="--shm" && i+1<argc)
+    {
+      name=argv[++i];
+    }
+    else if(arg=="--points" && i+1<argc)
+    {
+      points=static_cast<uint32_t>(std::stoul(argv[++i]));
+    }
+    else if(arg=="--rate" && i+1<argc)
+    {
+      rate=std::stod(argv[++i]);
+    }
+    else if(arg=="--slots" && i+1<argc)
+    {
+      slots=static_cast<uint32_t>(std::stoul(argv[++i]));
+    }
+    else if(arg=="--seconds" && i+1<argc)
+    {
+      seconds=std::stod(argv[++i]);
+    }
+  }
+  FrameRing ring;
+  if(!ring.create(name,slots,points))
+  {
+    return EXIT_FAILURE;
+  }
+  // ctrl-c stops cleanly so the shared memory is removed
+  std::signal(SIGINT,onSignal);
+  std::signal(SIGTERM,onSignal);
+  std::cout<<"writing "<<points<<" points at "<<rate<<" Hz to "<<name<<'\n';
+
+  using clock=std::chrono::steady_clock;
+  const auto period=std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0/rate));
+  const auto start=clock::now();
+  auto next=start;
+  auto report=start+std::chrono::seconds(1);
+  uint64_t written=0;
+  uint64_t dropped=0;
+  double simulateTime=0.0;
+  while(!g_quit)
+  {
+    auto now=clock::now();
+    double time=std::chrono::duration<double>(now-start).count();
+    if(seconds>0.0 && time>=seconds)
+    {
+      break;
+    }
+    if(auto frame=ring.beginWrite())
+    {
+      simulate(frame->points(),points,static_cast<float>(time));
+      ring.endWrite(points);
+      ++written;
+      simulateTime+=std::chrono::duration<double>(clock::now()-now).count();
+    }
+    else
+    {
+      // the renderer still has every slot, a real simulation keeps going rather than wait for it
+      ++dropped;
+    }
+    if(now>=report)
+    {
+      std::cout<<written<<" frames written "<<dropped<<" dropped, "
+               <<(written !=0 ? simulateTime*1000.0/written : 0.0)<<" ms per frame to write\n";
+      report+=std::chrono::seconds(1);
+    }
+    next+=period;
+    std::this_thread::sleep_until(next);
+  }
+  std::cout<<written<<" frames written "<<dropped<<" dropped\n";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,225 @@
+#include "FrameRecording.h"
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define FRAMERECORDING_MADVISE 1
+#endif
+
+namespace
+{
+  constexpr char c_fileMagic[8]={'N','G','L','F','R','E','C','\0'};
+  constexpr char c_chunkMagic[4]={'F','R','A','M'};
+  constexpr uint32_t c_version=1;
+  constexpr uint64_t c_pageSize=4096;
+  constexpr uint32_t c_floatsPerPoint=3;
+
+  struct FileHeader
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t floatsPerPoint;
+  };
+
+  struct ChunkHeader
+  {
+    char magic[4];
+    uint32_t count;
+    uint64_t sequence;
+    uint64_t time;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief where the next chunk starts, also used to check the chunk was written in full
+    //----------------------------------------------------------------------------------------------------------------------
+    uint64_t next;
+  };
+  constexpr uint64_t c_chunkHeaderSize=64;
+  static_assert(sizeof(ChunkHeader)<=c_chunkHeaderSize,"chunk header must fit its slot");
+
+  uint64_t alignUp(uint64_t _value, uint64_t _alignment)
+  {
+    return (_value+_alignment-1)/_alignment*_alignment;
+  }
+
+  int64_t nowNs()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+}
+
+FrameRecorder::~FrameRecorder()
+{
+  close();
+}
+
+bool FrameRecorder::open(const std::string &_fname)
+{
+  close();
+  QDir().mkpath(QFileInfo(QString::fromStdString(_fname)).absolutePath());
+  m_file.setFileName(QString::fromStdString(_fname));
+  if(!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    return false;
+  }
+  std::vector<char> page(c_pageSize,0);
+  FileHeader header;
+  std::memcpy(header.magic,c_fileMagic,sizeof(c_fileMagic));
+  header.version=c_version;
+  header.floatsPerPoint=c_floatsPerPoint;
+  std::memcpy(page.data(),&header,sizeof(FileHeader));
+  if(m_file.write(page.data(),static_cast<qint64>(page.size()))!=static_cast<qint64>(page.size()))
+  {
+    // a short header (say the disk is full) mustn't be left for playback to find
+    close();
+    m_file.remove();
+    return false;
+  }
+  m_offset=c_pageSize;
+  m_frames=0;
+  m_start=nowNs();
+  return true;
+}
+
+void FrameRecorder::close()
+{
+  if(m_file.isOpen())
+  {
+    m_file.close();
+  }
+}
+
+bool FrameRecorder::append(const float *_points, size_t _count)
+{
+  if(!m_file.isOpen())
+  {
+    return false;
+  }
+  uint64_t payload=uint64_t(_count)*c_floatsPerPoint*sizeof(float);
+  char header[c_chunkHeaderSize]={};
+  ChunkHeader chunk;
+  std::memcpy(chunk.magic,c_chunkMagic,sizeof(c_chunkMagic));
+  chunk.count=static_cast<uint32_t>(_count);
+  chunk.sequence=m_frames;
+  chunk.time=static_cast<uint64_t>(nowNs()-m_start);
+  chunk.next=alignUp(m_offset+c_chunkHeaderSize+payload,c_pageSize);
+  std::memcpy(header,&chunk,sizeof(ChunkHeader));
+  static const std::vector<char> padding(c_pageSize,0);
+  qint64 pad=static_cast<qint64>(chunk.next-(m_offset+c_chunkHeaderSize+payload));
+  bool ok=m_file.write(header,c_chunkHeaderSize)==c_chunkHeaderSize &&
+          m_file.write(reinterpret_cast<const char *>(_points),static_cast<qint64>(payload))==static_cast<qint64>(payload) &&
+          m_file.write(padding.data(),pad)==pad;
+  if(!ok)
+  {
+    close();
+    return false;
+  }
+  m_offset=chunk.next;
+  ++m_frames;
+  return true;
+}
+
+bool FramePlayer::open(const std::string &_fname)
+{
+  close();
+  m_file.setFileName(QString::fromStdString(_fname));
+  if(!m_file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+  m_size=static_cast<uint64_t>(m_file.size());
+  m_map=m_size>=c_pageSize ? m_file.map(0,m_file.size()) : nullptr;
+  FileHeader header;
+  if(m_map==nullptr)
+  {
+    close();
+    return false;
+  }
+  std::memcpy(&header,m_map,sizeof(FileHeader));
+  if(std::memcmp(header.magic,c_fileMagic,sizeof(c_fileMagic)) !=0 || header.version !=c_version ||
+     header.floatsPerPoint !=c_floatsPerPoint)
+  {
+    close();
+    return false;
+  }
+  // walk the chunks, the index is small and stops at the first incomplete chunk
+  uint64_t offset=c_pageSize;
+  while(offset+c_chunkHeaderSize<=m_size)
+  {
+    ChunkHeader chunk;
+    std::memcpy(&chunk,m_map+offset,sizeof(ChunkHeader));
+    uint64_t end=offset+c_chunkHeaderSize+uint64_t(chunk.count)*c_floatsPerPoint*sizeof(float);
+    if(std::memcmp(chunk.magic,c_chunkMagic,sizeof(c_chunkMagic)) !=0 || chunk.next<end || end>m_size)
+    {
+      break;
+    }
+    m_chunks.push_back(offset);
+    m_maxCount=std::max(m_maxCount,chunk.count);
+    offset=chunk.next;
+  }
+  if(m_chunks.empty())
+  {
+    close();
+    return false;
+  }
+#if defined(FRAMERECORDING_MADVISE)
+  // playback is in order so let the kernel read ahead aggressively as well
+  madvise(const_cast<uchar *>(m_map),static_cast<size_t>(m_size),MADV_SEQUENTIAL);
+#endif
+  return true;
+}
+
+void FramePlayer::close()
+{
+  if(m_map !=nullptr)
+  {
+    m_file.unmap(const_cast<uchar *>(m_map));
+    m_map=nullptr;
+  }
+  m_file.close();
+  m_chunks.clear();
+  m_maxCount=0;
+  m_size=0;
+}
+
+FramePlayer::Frame FramePlayer::frame(size_t _index) const
+{
+  ChunkHeader chunk;
+  uint64_t offset=m_chunks[_index];
+  std::memcpy(&chunk,m_map+offset,sizeof(ChunkHeader));
+  return {chunk.sequence,chunk.time,chunk.count,reinterpret_cast<const float *>(m_map+offset+c_chunkHeaderSize)};
+}
+
+void FramePlayer::advise(size_t _index, bool _willNeed) const
+{
+#if defined(FRAMERECORDING_MADVISE)
+  // chunks start on a page, the end is rounded up to take in the padding
+  uint64_t begin=m_chunks[_index];
+  uint64_t end=_index+1<m_chunks.size() ? m_chunks[_index+1] : alignUp(m_size,c_pageSize);
+  madvise(const_cast<uchar *>(m_map)+begin,static_cast<size_t>(end-begin),_willNeed ? MADV_WILLNEED : MADV_DONTNEED);
+#else
+  (void)_index;
+  (void)_willNeed;
+#endif
+}
+
+void FramePlayer::prefetch(size_t _current, size_t _ahead)
+{
+  size_t frames=m_chunks.size();
+  if(frames<2)
+  {
+    return;
+  }
+  _ahead=std::min(_ahead,frames-1);
+  for(size_t i=1; i<=_ahead; ++i)
+  {
+    advise((_current+i)%frames,true);
+  }
+  // unless the whole recording fits in the window drop the frame just played, it stays in the page cache so a
+  // loop back to it is cheap but it no longer counts against this process
+  if(_ahead<frames-1)
+  {
+    advise((_current+frames-1)%frames,false);
+  }
+}
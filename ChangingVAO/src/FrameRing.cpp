@@ -0,0 +1,225 @@
+#include "FrameRing.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FRAMERING_POSIX 1
+#endif
+
+namespace
+{
+  constexpr char c_magic[8]={'N','G','L','R','I','N','G','\0'};
+  constexpr uint64_t c_pageSize=4096;
+
+  uint64_t alignUp(uint64_t _value, uint64_t _alignment)
+  {
+    return (_value+_alignment-1)/_alignment*_alignment;
+  }
+}
+
+size_t FrameRing::floatsPerPoint(Layout _layout)
+{
+  switch(_layout)
+  {
+    case Layout::PositionXYZ : return 3;
+  }
+  return 0;
+}
+
+FrameRing::~FrameRing()
+{
+  close();
+}
+
+uint32_t FrameRing::maxPoints() const
+{
+  return m_header !=nullptr ? m_header->maxPoints : 0;
+}
+
+FrameRing::Layout FrameRing::layout() const
+{
+  return m_header !=nullptr ? m_header->layout : Layout::PositionXYZ;
+}
+
+FrameRing::Frame *FrameRing::slot(uint64_t _frame) const
+{
+  // slots start on their own pages after the header
+  auto base=reinterpret_cast<char *>(m_header)+c_pageSize;
+  return reinterpret_cast<Frame *>(base+(_frame % m_header->slots)*m_header->slotSize);
+}
+
+#if defined(FRAMERING_POSIX)
+
+bool FrameRing::create(const std::string &_name, uint32_t _slots, uint32_t _maxPoints, Layout _layout)
+{
+  close();
+  if(_slots<2 || floatsPerPoint(_layout)==0)
+  {
+    std::cerr<<"FrameRing needs at least 2 slots and a known layout\n";
+    return false;
+  }
+  uint64_t slotSize=alignUp(c_frameHeaderSize+uint64_t(_maxPoints)*floatsPerPoint(_layout)*sizeof(float),c_pageSize);
+  uint64_t mapSize=c_pageSize+slotSize*_slots;
+  // a ring left behind by a producer that crashed is replaced, a consumer still mapping it keeps the old pages
+  shm_unlink(_name.c_str());
+  int fd=shm_open(_name.c_str(),O_CREAT | O_EXCL | O_RDWR,0600);
+  if(fd<0)
+  {
+    std::cerr<<"FrameRing unable to create "<<_name<<" "<<std::strerror(errno)<<'\n';
+    return false;
+  }
+  void *map=MAP_FAILED;
+  if(ftruncate(fd,static_cast<off_t>(mapSize))==0)
+  {
+    map=mmap(nullptr,mapSize,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+  }
+  ::close(fd);
+  if(map==MAP_FAILED)
+  {
+    std::cerr<<"FrameRing unable to map "<<_name<<" "<<std::strerror(errno)<<'\n';
+    shm_unlink(_name.c_str());
+    return false;
+  }
+  // the new pages are zero filled so the magic is only valid once it is written below
+  m_header=new(map) Header;
+  m_header->version=c_version;
+  m_header->slots=_slots;
+  m_header->maxPoints=_maxPoints;
+  m_header->layout=_layout;
+  m_header->slotSize=slotSize;
+  m_header->written.store(0,std::memory_order_relaxed);
+  m_header->read.store(0,std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(m_header->magic,c_magic,sizeof(c_magic));
+  m_mapSize=mapSize;
+  m_name=_name;
+  m_owner=true;
+  m_current=0;
+  return true;
+}
+
+bool FrameRing::open(const std::string &_name)
+{
+  close();
+  int fd=shm_open(_name.c_str(),O_RDWR,0);
+  if(fd<0)
+  {
+    return false;
+  }
+  struct stat info;
+  void *map=MAP_FAILED;
+  if(fstat(fd,&info)==0 && static_cast<uint64_t>(info.st_size)>=c_pageSize)
+  {
+    map=mmap(nullptr,static_cast<size_t>(info.st_size),PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+  }
+  ::close(fd);
+  if(map==MAP_FAILED)
+  {
+    return false;
+  }
+  auto header=static_cast<Header *>(map);
+  bool valid=std::memcmp(header->magic,c_magic,sizeof(c_magic))==0;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  valid=valid && header->version==c_version && header->slots>=2 && floatsPerPoint(header->layout) !=0 &&
+        header->slotSize>=c_frameHeaderSize+uint64_t(header->maxPoints)*floatsPerPoint(header->layout)*sizeof(float) &&
+        c_pageSize+header->slotSize*header->slots<=static_cast<uint64_t>(info.st_size);
+  if(!valid)
+  {
+    // most likely the producer is still setting it up
+    munmap(map,static_cast<size_t>(info.st_size));
+    return false;
+  }
+  m_header=header;
+  m_mapSize=static_cast<size_t>(info.st_size);
+  m_name=_name;
+  m_owner=false;
+  m_holding=false;
+  return true;
+}
+
+void FrameRing::close()
+{
+  if(m_header==nullptr)
+  {
+    return;
+  }
+  release();
+  munmap(m_header,m_mapSize);
+  if(m_owner)
+  {
+    shm_unlink(m_name.c_str());
+  }
+  m_header=nullptr;
+  m_mapSize=0;
+  m_owner=false;
+}
+
+#else
+
+bool FrameRing::create(const std::string &, uint32_t, uint32_t, Layout)
+{
+  std::cerr<<"FrameRing needs POSIX shared memory\n";
+  return false;
+}
+
+bool FrameRing::open(const std::string &)
+{
+  return false;
+}
+
+void FrameRing::close()
+{
+}
+
+#endif
+
+FrameRing::Frame *FrameRing::beginWrite()
+{
+  uint64_t written=m_header->written.load(std::memory_order_relaxed);
+  // the consumer frees a slot by moving read past it
+  if(written-m_header->read.load(std::memory_order_acquire)>=m_header->slots)
+  {
+    return nullptr;
+  }
+  m_current=written;
+  return slot(written);
+}
+
+void FrameRing::endWrite(uint32_t _count)
+{
+  Frame *frame=slot(m_current);
+  frame->sequence=m_current;
+  frame->count=_count<m_header->maxPoints ? _count : m_header->maxPoints;
+  frame->layout=m_header->layout;
+  m_header->written.store(m_current+1,std::memory_order_release);
+}
+
+const FrameRing::Frame *FrameRing::acquireLatest()
+{
+  uint64_t written=m_header->written.load(std::memory_order_acquire);
+  uint64_t read=m_header->read.load(std::memory_order_relaxed);
+  if(written==read || (m_holding && written==m_current+1))
+  {
+    return nullptr;
+  }
+  release();
+  // keep read at the held frame so the producer can't reuse its slot, everything before it is free
+  m_current=written-1;
+  m_header->read.store(m_current,std::memory_order_release);
+  m_holding=true;
+  return slot(m_current);
+}
+
+void FrameRing::release()
+{
+  if(m_holding)
+  {
+    m_header->read.store(m_current+1,std::memory_order_release);
+    m_holding=false;
+  }
+}
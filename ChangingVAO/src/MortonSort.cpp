@@ -0,0 +1,179 @@
+#include "MortonSort.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+  // enough points per chunk that scheduling is lost in the work
+  constexpr size_t c_minPointsPerChunk=1<<15;
+  constexpr size_t c_radixBits=8;
+  constexpr size_t c_buckets=1<<c_radixBits;
+  // 30 bit keys need 4 passes of 8 bits, the keys sit above the 32 bit index
+  constexpr size_t c_keyShift=32;
+  constexpr size_t c_passes=4;
+  constexpr uint32_t c_maxCell=1023;
+
+  using clock=std::chrono::steady_clock;
+  double msSince(clock::time_point _start)
+  {
+    return std::chrono::duration<double,std::milli>(clock::now()-_start).count();
+  }
+} // end anon namespace
+
+uint32_t MortonSort::expandBits(uint32_t _v)
+{
+  _v&=0x3ff;
+  _v=(_v | (_v<<16)) & 0x030000ff;
+  _v=(_v | (_v<<8)) & 0x0300f00f;
+  _v=(_v | (_v<<4)) & 0x030c30c3;
+  _v=(_v | (_v<<2)) & 0x09249249;
+  return _v;
+}
+
+void MortonSort::sort(float *io_positions, size_t _count, float *io_attribs, size_t _attribFloats)
+{
+  m_timings=Timings();
+  if(_count<2)
+  {
+    return;
+  }
+  size_t chunks=parallelChunks(_count,c_minPointsPerChunk);
+  m_pairs.resize(_count);
+  m_scratch.resize(_count);
+  m_histograms.resize(chunks*c_buckets);
+  m_bounds.resize(chunks*6);
+
+  // keys, first the bounding box of each chunk then quantise every point into it
+  auto start=clock::now();
+  parallelFor(_count,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+  {
+    float *b=&m_bounds[_chunk*6];
+    for(size_t a=0; a<3; ++a)
+    {
+      b[a]=std::numeric_limits<float>::max();
+      b[a+3]=std::numeric_limits<float>::lowest();
+    }
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      for(size_t a=0; a<3; ++a)
+      {
+        b[a]=std::min(b[a],io_positions[i*3+a]);
+        b[a+3]=std::max(b[a+3],io_positions[i*3+a]);
+      }
+    }
+  });
+  float min[3];
+  float scale[3];
+  for(size_t a=0; a<3; ++a)
+  {
+    float lo=std::numeric_limits<float>::max();
+    float hi=std::numeric_limits<float>::lowest();
+    for(size_t c=0; c<chunks; ++c)
+    {
+      lo=std::min(lo,m_bounds[c*6+a]);
+      hi=std::max(hi,m_bounds[c*6+a+3]);
+    }
+    min[a]=lo;
+    scale[a]=hi>lo ? static_cast<float>(c_maxCell)/(hi-lo) : 0.0f;
+  }
+  parallelFor(_count,chunks,[&](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      uint32_t cell[3];
+      for(size_t a=0; a<3; ++a)
+      {
+        float q=(io_positions[i*3+a]-min[a])*scale[a];
+        cell[a]=std::min(static_cast<uint32_t>(std::max(q,0.0f)),c_maxCell);
+      }
+      m_pairs[i]=(uint64_t(encode(cell[0],cell[1],cell[2]))<<c_keyShift) | i;
+    }
+  });
+  m_timings.keys=msSince(start);
+
+  // LSD radix sort, each chunk counts its digits then scatters to where its share of each bucket starts so the
+  // sort is stable and every pass is two parallel loops
+  start=clock::now();
+  uint64_t *src=m_pairs.data();
+  uint64_t *dst=m_scratch.data();
+  for(size_t pass=0; pass<c_passes; ++pass)
+  {
+    size_t shift=c_keyShift+pass*c_radixBits;
+    parallelFor(_count,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+    {
+      uint32_t *histogram=&m_histograms[_chunk*c_buckets];
+      std::fill(histogram,histogram+c_buckets,0);
+      for(size_t i=_begin; i<_end; ++i)
+      {
+        ++histogram[(src[i]>>shift)&(c_buckets-1)];
+      }
+    });
+    // a digit every key shares doesn't change the order
+    bool allOneBucket=false;
+    for(size_t d=0; d<c_buckets && !allOneBucket; ++d)
+    {
+      size_t total=0;
+      for(size_t c=0; c<chunks; ++c)
+      {
+        total+=m_histograms[c*c_buckets+d];
+      }
+      allOneBucket=total==_count;
+    }
+    if(allOneBucket)
+    {
+      continue;
+    }
+    uint32_t offset=0;
+    for(size_t d=0; d<c_buckets; ++d)
+    {
+      for(size_t c=0; c<chunks; ++c)
+      {
+        uint32_t n=m_histograms[c*c_buckets+d];
+        m_histograms[c*c_buckets+d]=offset;
+        offset+=n;
+      }
+    }
+    parallelFor(_count,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+    {
+      uint32_t *next=&m_histograms[_chunk*c_buckets];
+      for(size_t i=_begin; i<_end; ++i)
+      {
+        dst[next[(src[i]>>shift)&(c_buckets-1)]++]=src[i];
+      }
+    });
+    std::swap(src,dst);
+  }
+  if(src!=m_pairs.data())
+  {
+    m_pairs.swap(m_scratch);
+  }
+  m_timings.sort=msSince(start);
+
+  // gather each array into the sorted order then copy it back
+  start=clock::now();
+  auto gather=[&](float *io_data, size_t _floats)
+  {
+    m_gather.resize(_count*_floats);
+    parallelFor(_count,chunks,[&](size_t,size_t _begin,size_t _end)
+    {
+      for(size_t i=_begin; i<_end; ++i)
+      {
+        auto from=static_cast<uint32_t>(m_pairs[i]);
+        std::memcpy(&m_gather[i*_floats],io_data+from*_floats,_floats*sizeof(float));
+      }
+    });
+    parallelFor(_count,chunks,[&](size_t,size_t _begin,size_t _end)
+    {
+      std::memcpy(io_data+_begin*_floats,&m_gather[_begin*_floats],(_end-_begin)*_floats*sizeof(float));
+    });
+  };
+  gather(io_positions,3);
+  if(io_attribs!=nullptr && _attribFloats!=0)
+  {
+    gather(io_attribs,_attribFloats);
+  }
+  m_timings.gather=msSince(start);
+}
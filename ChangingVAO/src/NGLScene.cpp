@@ -5,16 +5,49 @@
 #include <ngl/Transformation.h>
 #include <ngl/NGLInit.h>
 #include <ngl/SimpleVAO.h>
+#include <ngl/VAOFactory.h>
 #include <ngl/VAOPrimitives.h>
-#include <ngl/Random.h>
 #include <ngl/ShaderLib.h>
+#include "JobSystem.h"
+#include "PointPoolVAO.h"
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <iostream>
+#include <random>
 
-NGLScene::NGLScene()
+namespace
+{
+  // small enough that a chunk's box is tight after a Morton sort, big enough that culling is cheap
+  constexpr size_t c_cullChunkSize = 4096;
+} // end anon namespace
+
+NGLScene::NGLScene(const SceneOptions &_options) : m_options(_options)
 {
   setTitle("Qt5 Simple NGL Demo");
-  m_data.resize(123456);
+  if (!m_options.play.empty() && !m_player.open(m_options.play))
+  {
+    std::cerr << "Unable to play " << m_options.play << " generating points instead\n";
+    m_options.play.clear();
+  }
+  if (!m_options.ply.empty() && !m_cloud.open(m_options.ply))
+  {
+    std::cerr << "Unable to load " << m_options.ply << " generating points instead\n";
+    m_options.ply.clear();
+  }
+  if (!m_options.octree.empty() && !m_octree.open(m_options.octree))
+  {
+    std::cerr << "Unable to load " << m_options.octree << " generating points instead\n";
+    m_options.octree.clear();
+  }
+  if (m_options.feed.empty() && m_options.play.empty() && m_options.ply.empty() && m_options.octree.empty())
+  {
+    m_data.resize(123456);
+  }
+  if (!m_options.record.empty() && !m_recorder.open(m_options.record))
+  {
+    std::cerr << "Unable to record to " << m_options.record << '\n';
+  }
 }
 
 NGLScene::~NGLScene()
@@ -58,13 +91,153 @@ void NGLScene::initializeGL()
   // grab an instance of shader manager
   ngl::ShaderLib::use("nglColourShader");
   ngl::ShaderLib::setUniform("Colour", 1.0f, 1.0f, 1.0f, 1.0f);
+  // looked up once here so paintGL sets MVP without a name lookup
+  m_MVPUniform = UniformHandle(ngl::ShaderLib::getProgramID("nglColourShader"), "MVP");
   glViewport(0, 0, width(), height());
-  startTimer(250);
+  if (!m_options.ply.empty() || !m_options.octree.empty())
+  {
+    // the cloud doesn't change so there is nothing to time
+  }
+  else if (!m_options.play.empty())
+  {
+    // playback is paced in timerEvent so check often, the first frame is drawn straight away
+    m_playTimer.start();
+    m_playPending = true;
+    startTimer(1, Qt::PreciseTimer);
+  }
+  else
+  {
+    // the feed is polled at display rate, generated data is only made 4 times a second
+    startTimer(m_options.feed.empty() ? 250 : 16);
+  }
   glPointSize(10);
   m_text = std::make_unique<ngl::Text>("fonts/Arial.ttf", 18);
   m_text->setScreenSize(width(), height());
+  if (!m_options.octree.empty())
+  {
+    // the pool is allocated once, OctreeLOD keeps the nodes in it within the budget. The LOD picks the visible
+    // nodes itself so the chunk culling, which would clear its draws, is off
+    m_options.cull = false;
+    ngl::VAOFactory::registerVAOCreator("pointPoolVAO", PointPoolVAO::create);
+    m_vao = ngl::VAOFactory::createVAO("pointPoolVAO", GL_POINTS);
+    size_t slotBytes = m_octree.pointsPerNode() * 3 * sizeof(float);
+    size_t slots = std::max<size_t>(1, m_options.octreeBudgetMB * 1024 * 1024 / slotBytes);
+    m_vao->bind();
+    static_cast<PointPoolVAO *>(m_vao.get())->allocate(slots, m_octree.pointsPerNode());
+    m_vao->unbind();
+    m_lod = std::make_unique<OctreeLOD>(m_octree, slots);
+    m_lod->setMaxError(m_options.octreeError);
+    const auto &root = m_octree.node(0);
+    float max[3] = {root.min[0] + root.size, root.min[1] + root.size, root.min[2] + root.size};
+    fitToView(root.min, max);
+    glPointSize(1);
+    std::cout << "Streaming " << m_octree.totalPoints() << " points in " << m_octree.numNodes() << " nodes through " << slots << " slots (" << slots * slotBytes / (1024 * 1024) << " MB)\n";
+    return;
+  }
   // create the VAO but don't populate
-  m_vao = ngl::VAOFactory::createVAO(ngl::simpleVAO, GL_LINES);
+  if (m_options.cull && m_options.feed.empty() && m_options.play.empty())
+  {
+    // a PointPoolVAO can draw any list of ranges of its buffer with one glMultiDrawArrays
+    ngl::VAOFactory::registerVAOCreator("pointPoolVAO", PointPoolVAO::create);
+    m_vao = ngl::VAOFactory::createVAO("pointPoolVAO", m_options.ply.empty() ? GL_LINES : GL_POINTS);
+  }
+  else
+  {
+    m_options.cull = false;
+    m_vao = ngl::VAOFactory::createVAO(ngl::simpleVAO, m_options.ply.empty() ? GL_LINES : GL_POINTS);
+  }
+  if (!m_options.ply.empty())
+  {
+    glPointSize(1);
+    uploadCloud();
+  }
+}
+
+void NGLScene::fitToView(const float _min[3], const float _max[3])
+{
+  float extent = std::max({_max[0] - _min[0], _max[1] - _min[1], _max[2] - _min[2], 1e-6f});
+  // fit the largest side into 10 units about the origin
+  float scale = 10.0f / extent;
+  m_cloudTX = ngl::Mat4();
+  m_cloudTX.m_m[0][0] = scale;
+  m_cloudTX.m_m[1][1] = scale;
+  m_cloudTX.m_m[2][2] = scale;
+  m_cloudTX.m_m[3][0] = -0.5f * (_min[0] + _max[0]) * scale;
+  m_cloudTX.m_m[3][1] = -0.5f * (_min[1] + _max[1]) * scale;
+  m_cloudTX.m_m[3][2] = -0.5f * (_min[2] + _max[2]) * scale;
+}
+
+void NGLScene::streamOctree(const ngl::Mat4 &_MV, const ngl::Mat4 &_MVP)
+{
+  // the camera is at the origin of eye space so its position in the octree is the translation of the inverse
+  ngl::Mat4 inverseMV = _MV;
+  inverseMV = inverseMV.inverse();
+  float eye[3] = {inverseMV.m_m[3][0], inverseMV.m_m[3][1], inverseMV.m_m[3][2]};
+  // 0.41421356 is tan(22.5) for the 45 degree field of view in resizeGL
+  float projScale = static_cast<float>(m_win.height) / (2.0f * 0.41421356f);
+  m_lod->update(&_MVP.m_openGL[0], eye, projScale);
+
+  auto pool = static_cast<PointPoolVAO *>(m_vao.get());
+  for (auto &load : m_lod->loads())
+  {
+    pool->upload(load.slot, m_octree.points(load.node), m_octree.node(load.node).count);
+  }
+  pool->clearDraws();
+  for (auto &draw : m_lod->draws())
+  {
+    pool->addDraw(draw.slot, draw.count);
+  }
+  m_numPoints = m_lod->pointsDrawn();
+}
+
+void NGLScene::cullChunks(const ngl::Mat4 &_MVP)
+{
+  auto pool = static_cast<PointPoolVAO *>(m_vao.get());
+  pool->clearDraws();
+  for (auto &range : m_culler.cull(&_MVP.m_openGL[0]))
+  {
+    pool->addRange(range.first, range.count);
+  }
+}
+
+void NGLScene::uploadCloud()
+{
+  auto start = std::chrono::steady_clock::now();
+  float min[3];
+  float max[3];
+  m_cloud.bounds(min, max);
+  fitToView(min, max);
+
+  m_vao->bind();
+  m_numPoints = m_cloud.numPoints();
+  bool inPlace = m_cloud.positionsInPlace();
+  if (inPlace)
+  {
+    // the whole vertex block goes to GL as it is, anything after x,y,z is stepped over by the stride
+    auto vertices = reinterpret_cast<const float *>(m_cloud.vertexData());
+    m_vao->setData(ngl::SimpleVAO::VertexData(m_numPoints * m_cloud.stride(), vertices[0]));
+    m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, static_cast<GLsizei>(m_cloud.stride()), static_cast<int>(m_cloud.positionOffset() / sizeof(float)));
+    if (m_options.cull)
+    {
+      m_culler.build(m_cloud.vertexData() + m_cloud.positionOffset(), m_numPoints, c_cullChunkSize, m_cloud.stride());
+    }
+  }
+  else
+  {
+    auto positions = m_cloud.convertPositions();
+    m_vao->setData(ngl::SimpleVAO::VertexData(positions.size() * sizeof(float), positions[0]));
+    m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, 0, 0);
+    if (m_options.cull)
+    {
+      m_culler.build(positions.data(), m_numPoints, c_cullChunkSize);
+    }
+  }
+  m_vao->setNumIndices(m_numPoints);
+  m_vao->unbind();
+  // GL has its own copy now so the mapping can go
+  m_cloud.close();
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "Loaded " << m_numPoints << " points from " << m_options.ply << (inPlace ? " in place" : " converted") << " in " << elapsed.count() << " ms\n";
 }
 
 void NGLScene::paintGL()
@@ -85,31 +258,207 @@ void NGLScene::paintGL()
   m_mouseGlobalTX.m_m[3][2] = m_modelPos.m_z;
   ngl::ShaderLib::use("nglColourShader");
 
+  ngl::Mat4 MV;
   ngl::Mat4 MVP;
-  MVP = m_project * m_view * m_mouseGlobalTX;
+  MV = m_view * m_mouseGlobalTX * m_cloudTX;
+  MVP = m_project * MV;
 
-  ngl::ShaderLib::setUniform("MVP", MVP);
+  m_MVPUniform.set(MVP);
   m_vao->bind();
-  m_vao->setData(ngl::SimpleVAO::VertexData(m_data.size() * sizeof(ngl::Vec3), m_data[0].m_x));
-  // We must do this each time as we change the data.
-  m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, 0, 0);
-  m_vao->setNumIndices(m_data.size());
+  if (m_lod)
+  {
+    streamOctree(MV, MVP);
+  }
+  else if (!m_options.ply.empty())
+  {
+    // uploaded once in initializeGL
+  }
+  else if (!m_options.play.empty())
+  {
+    uploadPlayFrame();
+  }
+  else if (m_options.feed.empty())
+  {
+    m_vao->setData(ngl::SimpleVAO::VertexData(m_data.size() * sizeof(ngl::Vec3), m_data[0].m_x));
+    // We must do this each time as we change the data.
+    m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, 0, 0);
+    m_vao->setNumIndices(m_data.size());
+    m_numPoints = m_data.size();
+  }
+  else
+  {
+    uploadFeedFrame();
+  }
+  if (m_options.cull)
+  {
+    cullChunks(MVP);
+  }
   m_vao->draw();
   m_vao->unbind();
 
   m_text->setColour(1.0f, 1.0f, 1.0f);
-  std::string text = fmt::format("Data Size {} ", m_data.size());
+  std::string text;
+  if (m_lod)
+  {
+    text = fmt::format("Points {} Nodes {}/{} Loads {} Evictions {}", m_numPoints, m_lod->draws().size(), m_lod->numSlots(), m_lod->loads().size(), m_lod->evictions());
+    // keep drawing until everything wanted has been streamed in
+    if (m_lod->pending() || !m_lod->loads().empty())
+    {
+      update();
+    }
+  }
+  else if (m_options.cull)
+  {
+    text = fmt::format("Points {}/{} Chunks {}/{} ", m_culler.visiblePoints(), m_numPoints, m_culler.visibleChunks(), m_culler.numChunks());
+  }
+  else if (!m_options.ply.empty())
+  {
+    text = fmt::format("Points {} ", m_numPoints);
+  }
+  else if (!m_options.play.empty())
+  {
+    text = fmt::format("Frame {}/{} Points {} {:.1f} fps {:.1f} MB/s", m_playFrame + 1, m_player.numFrames(), m_numPoints, m_playFps, m_playMBs);
+  }
+  else if (!m_options.feed.empty())
+  {
+    text = fmt::format("Frame {} Points {} Skipped {} ", m_feedSequence, m_numPoints, m_feedSkipped);
+  }
+  else if (m_options.morton)
+  {
+    text = fmt::format("Data Size {} Morton {:.1f} ms/M points", m_numPoints, m_sortMsPerMillion);
+  }
+  else
+  {
+    text = fmt::format("Data Size {} ", m_numPoints);
+  }
   m_text->renderText(10, 700, text);
 }
 
+void NGLScene::uploadPlayFrame()
+{
+  if (!m_playPending)
+  {
+    return;
+  }
+  auto frame = m_player.frame(m_playFrame);
+  // the points are passed straight from the mapped file, the pages were prefetched while earlier frames played
+  m_vao->setData(ngl::SimpleVAO::VertexData(frame.count * 3 * sizeof(float), frame.points[0], GL_STREAM_DRAW));
+  m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, 0, 0);
+  m_vao->setNumIndices(frame.count);
+  m_numPoints = frame.count;
+  m_player.prefetch(m_playFrame, 8);
+  m_playBytes += frame.count * 3 * sizeof(float);
+  m_playPending = false;
+  if (m_playFrame + 1 == m_player.numFrames())
+  {
+    // report each full pass so the upload rate is measured over the whole recording
+    double now = m_playTimer.nsecsElapsed() * 1.0e-9;
+    double seconds = now - m_playPassStart;
+    m_playFps = m_player.numFrames() / seconds;
+    m_playMBs = m_playBytes / seconds / (1024.0 * 1024.0);
+    std::cout << "played " << m_player.numFrames() << " frames in " << seconds << " s, " << m_playFps << " fps, " << m_playMBs << " MB/s\n";
+    m_playPassStart = now;
+    m_playBytes = 0;
+  }
+}
+
+void NGLScene::uploadFeedFrame()
+{
+  const FrameRing::Frame *frame = m_feed.isOpen() ? m_feed.acquireLatest() : nullptr;
+  // with no new frame the VAO still holds the last one
+  if (frame == nullptr)
+  {
+    return;
+  }
+  if (frame->layout == FrameRing::Layout::PositionXYZ)
+  {
+    size_t count = std::min<size_t>(frame->count, m_feed.maxPoints());
+    // glBufferData reads straight from the shared memory slot so the only copy is the driver's
+    m_vao->setData(ngl::SimpleVAO::VertexData(count * 3 * sizeof(float), frame->points()[0], GL_STREAM_DRAW));
+    m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, 0, 0);
+    m_vao->setNumIndices(count);
+    m_numPoints = count;
+  }
+  if (m_feedFrames != 0 && frame->sequence > m_feedSequence + 1)
+  {
+    m_feedSkipped += frame->sequence - m_feedSequence - 1;
+  }
+  m_feedSequence = frame->sequence;
+  ++m_feedFrames;
+  if (m_recorder.isOpen() && frame->layout == FrameRing::Layout::PositionXYZ)
+  {
+    m_recorder.append(frame->points(), m_numPoints);
+  }
+  // the data has been handed to GL so the slot can go back to the producer
+  m_feed.release();
+}
+
 void NGLScene::timerEvent(QTimerEvent *_event)
 {
   NGL_UNUSED(_event);
-  // clear out old data ready to add new
-  // note reference as mutating vector
-  for (auto &p : m_data)
+  if (!m_options.play.empty())
+  {
+    // step on once the last frame has been drawn and the next is due, if drawing is slower than the rate every
+    // frame is still shown just later
+    double now = m_playTimer.nsecsElapsed() * 1.0e-9;
+    if (!m_playPending && (m_options.playRate <= 0.0 || now >= m_nextPlayTime))
+    {
+      m_playFrame = (m_playFrame + 1) % m_player.numFrames();
+      m_nextPlayTime = std::max(m_nextPlayTime + (m_options.playRate > 0.0 ? 1.0 / m_options.playRate : 0.0), now - 1.0);
+      m_playPending = true;
+      update();
+    }
+    return;
+  }
+  if (!m_options.feed.empty())
+  {
+    // keep trying until the producer has created the ring, new frames are picked up in paintGL
+    if (!m_feed.isOpen() && m_feed.open(m_options.feed))
+    {
+      std::cout << "Reading frames from " << m_options.feed << " up to " << m_feed.maxPoints() << " points\n";
+    }
+    update();
+    return;
+  }
+  // fill the data in parallel on the shared job system, ngl::Random has one global generator so each chunk has
+  // its own seeded from the frame and chunk so the points don't depend on which thread ran it
+  constexpr size_t chunkSize = 16384;
+  size_t chunks = (m_data.size() + chunkSize - 1) / chunkSize;
+  ++m_frame;
+  parallelFor(m_data.size(), chunks, [this](size_t _chunk, size_t _begin, size_t _end)
+  {
+    std::seed_seq seed{m_frame, static_cast<unsigned int>(_chunk)};
+    std::mt19937 rng(seed);
+    // the same range as ngl::Random::getRandomVec3
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (size_t i = _begin; i < _end; ++i)
+    {
+      m_data[i].set(unit(rng) * 5.0f, unit(rng) * 5.0f, unit(rng) * 5.0f);
+    }
+  });
+  if (m_options.morton)
+  {
+    // spatially coherent runs of points rasterise faster and can be culled in chunks
+    m_sorter.sort(&m_data[0].m_x, m_data.size());
+    m_sortMs += m_sorter.timings().total();
+    m_sortPoints += m_data.size();
+    if (m_frame % 20 == 0)
+    {
+      m_sortMsPerMillion = m_sortMs / (m_sortPoints * 1.0e-6);
+      const auto &t = m_sorter.timings();
+      std::cout << "Morton sort " << m_sortMsPerMillion << " ms per million points (last frame keys " << t.keys << " sort " << t.sort << " gather " << t.gather << " ms)\n";
+      m_sortMs = 0.0;
+      m_sortPoints = 0;
+    }
+  }
+  if (m_options.cull)
+  {
+    // the bounds are found here with the data rather than every time it is drawn
+    m_culler.build(&m_data[0].m_x, m_data.size(), c_cullChunkSize);
+  }
+  if (m_recorder.isOpen())
   {
-    p = ngl::Random::getRandomVec3() * 5;
+    m_recorder.append(&m_data[0].m_x, m_data.size());
   }
   update();
 }
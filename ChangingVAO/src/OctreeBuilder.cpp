@@ -0,0 +1,66 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file OctreeBuilder.cpp
+/// @brief builds the paged level of detail octree ChangingVAO --octree draws from a binary PLY point cloud. This is
+/// done offline once as it reads and reorders every point.
+/// ChangingVAOOctreeBuilder --ply in.ply --out out.oct [--node-points N] [--threads N]
+//----------------------------------------------------------------------------------------------------------------------
+#include "JobSystem.h"
+#include "PlyFile.h"
+#include "PointOctree.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char **argv)
+{
+  std::string ply;
+  std::string out;
+  uint32_t pointsPerNode=PointOctree::c_defaultPointsPerNode;
+  for(int i=1; i<argc; ++i)
+  {
+    std::string arg=argv[i];
+    if(arg=="--ply" && i+1<argc)
+    {
+      ply=argv[++i];
+    }
+    else if(arg=="--out" && i+1<argc)
+    {
+      out=argv[++i];
+    }
+    else if(arg=="--node-points" && i+1<argc)
+    {
+      pointsPerNode=static_cast<uint32_t>(std::stoul(argv[++i]));
+    }
+    else if(arg=="--threads" && i+1<argc)
+    {
+      JobSystem::Options options;
+      options.threads=std::stoul(argv[++i]);
+      JobSystem::setInstanceOptions(options);
+    }
+  }
+  if(ply.empty() || out.empty())
+  {
+    std::cerr<<"usage "<<argv[0]<<" --ply in.ply --out out.oct [--node-points N] [--threads N]\n";
+    return EXIT_FAILURE;
+  }
+  using clock=std::chrono::steady_clock;
+  auto start=clock::now();
+  std::vector<float> positions;
+  {
+    PlyFile file;
+    if(!file.open(ply))
+    {
+      return EXIT_FAILURE;
+    }
+    positions=file.convertPositions();
+  }
+  auto loaded=clock::now();
+  std::cout<<"Read "<<positions.size()/3<<" points in "<<std::chrono::duration<double>(loaded-start).count()<<" s\n";
+  if(!PointOctree::build(positions,out,pointsPerNode))
+  {
+    return EXIT_FAILURE;
+  }
+  std::cout<<"Built in "<<std::chrono::duration<double>(clock::now()-loaded).count()<<" s\n";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,187 @@
+#include "OctreeLOD.h"
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <utility>
+
+OctreeLOD::OctreeLOD(const PointOctree &_octree, size_t _slots) :
+  m_octree(_octree),
+  m_nodeSlot(_octree.numNodes(),c_none),
+  m_slotNode(_slots,c_none),
+  m_prev(_slots,c_none),
+  m_next(_slots,c_none),
+  m_slotFrame(_slots,0)
+{
+  // handed out from the back so slot 0 goes first
+  for(size_t s=_slots; s>0; --s)
+  {
+    m_free.push_back(static_cast<uint32_t>(s-1));
+  }
+}
+
+void OctreeLOD::unlink(uint32_t _slot)
+{
+  if(m_prev[_slot]!=c_none)
+  {
+    m_next[m_prev[_slot]]=m_next[_slot];
+  }
+  else if(m_head==_slot)
+  {
+    m_head=m_next[_slot];
+  }
+  if(m_next[_slot]!=c_none)
+  {
+    m_prev[m_next[_slot]]=m_prev[_slot];
+  }
+  else if(m_tail==_slot)
+  {
+    m_tail=m_prev[_slot];
+  }
+  m_prev[_slot]=m_next[_slot]=c_none;
+}
+
+void OctreeLOD::touch(uint32_t _slot)
+{
+  unlink(_slot);
+  m_next[_slot]=m_head;
+  if(m_head!=c_none)
+  {
+    m_prev[m_head]=_slot;
+  }
+  m_head=_slot;
+  if(m_tail==c_none)
+  {
+    m_tail=_slot;
+  }
+  m_slotFrame[_slot]=m_frame;
+}
+
+uint32_t OctreeLOD::claimSlot()
+{
+  if(!m_free.empty())
+  {
+    uint32_t slot=m_free.back();
+    m_free.pop_back();
+    ++m_resident;
+    return slot;
+  }
+  // everything wanted this frame has been touched so the tail is only evictable if it is from an earlier frame
+  if(m_tail==c_none || m_slotFrame[m_tail]==m_frame)
+  {
+    return c_none;
+  }
+  uint32_t slot=m_tail;
+  m_nodeSlot[m_slotNode[slot]]=c_none;
+  m_slotNode[slot]=c_none;
+  ++m_evictions;
+  return slot;
+}
+
+void OctreeLOD::update(const float _mvp[16], const float _eye[3], float _projScale)
+{
+  ++m_frame;
+  m_loads.clear();
+  m_draws.clear();
+  m_selected.clear();
+  m_pending=false;
+  m_pointsDrawn=0;
+
+  // the frustum planes from the rows of the column major matrix, a point is inside if every plane gives >= 0
+  float planes[6][4];
+  for(size_t p=0; p<6; ++p)
+  {
+    size_t row=p/2;
+    float sign=(p&1) ? -1.0f : 1.0f;
+    float length=0.0f;
+    for(size_t c=0; c<4; ++c)
+    {
+      planes[p][c]=_mvp[c*4+3]+sign*_mvp[c*4+row];
+      length+=c<3 ? planes[p][c]*planes[p][c] : 0.0f;
+    }
+    length=std::sqrt(length);
+    for(auto &v : planes[p])
+    {
+      v/=length>0.0f ? length : 1.0f;
+    }
+  }
+  // returns the screen space error in pixels or a negative value if the node is outside the frustum
+  auto error=[&](uint32_t _node)
+  {
+    const PointOctree::Node &n=m_octree.node(_node);
+    float half=n.size*0.5f;
+    float centre[3]={n.min[0]+half,n.min[1]+half,n.min[2]+half};
+    float radius=half*1.7320508f;
+    for(auto &p : planes)
+    {
+      if(p[0]*centre[0]+p[1]*centre[1]+p[2]*centre[2]+p[3]<-radius)
+      {
+        return -1.0f;
+      }
+    }
+    float d[3]={centre[0]-_eye[0],centre[1]-_eye[1],centre[2]-_eye[2]};
+    float distance=std::sqrt(d[0]*d[0]+d[1]*d[1]+d[2]*d[2])-radius;
+    if(distance<=0.0f)
+    {
+      return std::numeric_limits<float>::max();
+    }
+    return m_octree.spacing(_node)*_projScale/distance;
+  };
+
+  // refine the biggest error first so if the budget runs out it is the finest detail that is missing
+  std::priority_queue<std::pair<float,uint32_t>> queue;
+  float rootError=error(0);
+  if(rootError>=0.0f)
+  {
+    queue.push({rootError,0});
+  }
+  while(!queue.empty() && m_selected.size()<m_slotNode.size())
+  {
+    auto top=queue.top();
+    queue.pop();
+    m_selected.push_back(top.second);
+    if(top.first>m_maxError)
+    {
+      for(auto c : m_octree.node(top.second).children)
+      {
+        float e=c!=0 ? error(c) : -1.0f;
+        if(e>=0.0f)
+        {
+          queue.push({e,c});
+        }
+      }
+    }
+  }
+
+  // mark everything already resident as used first so loads can't evict it
+  for(auto node : m_selected)
+  {
+    uint32_t slot=m_nodeSlot[node];
+    if(slot!=c_none)
+    {
+      touch(slot);
+      m_draws.push_back({slot,m_octree.node(node).count});
+      m_pointsDrawn+=m_octree.node(node).count;
+    }
+  }
+  for(auto node : m_selected)
+  {
+    if(m_nodeSlot[node]!=c_none)
+    {
+      continue;
+    }
+    uint32_t slot=m_loads.size()<m_maxLoads ? claimSlot() : c_none;
+    if(slot==c_none)
+    {
+      // start reading it now so it is in the page cache when there is room to load it
+      m_octree.prefetch(node);
+      m_pending=true;
+      continue;
+    }
+    m_nodeSlot[node]=slot;
+    m_slotNode[slot]=node;
+    touch(slot);
+    m_loads.push_back({node,slot});
+    m_draws.push_back({slot,m_octree.node(node).count});
+    m_pointsDrawn+=m_octree.node(node).count;
+  }
+}
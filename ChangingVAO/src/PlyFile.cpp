@@ -0,0 +1,356 @@
+#include "PlyFile.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+  // the header is text and small, anything longer than this isn't a PLY we can read
+  constexpr size_t c_maxHeaderSize=1<<20;
+  // enough points per chunk that scheduling is lost in the copy
+  constexpr size_t c_minPointsPerChunk=1<<16;
+
+  bool typeFromName(const std::string &_name, PlyFile::Type &o_type)
+  {
+    static const struct {const char *name; PlyFile::Type type;} names[]=
+    {
+      {"char",PlyFile::Type::Int8},{"int8",PlyFile::Type::Int8},
+      {"uchar",PlyFile::Type::UInt8},{"uint8",PlyFile::Type::UInt8},
+      {"short",PlyFile::Type::Int16},{"int16",PlyFile::Type::Int16},
+      {"ushort",PlyFile::Type::UInt16},{"uint16",PlyFile::Type::UInt16},
+      {"int",PlyFile::Type::Int32},{"int32",PlyFile::Type::Int32},
+      {"uint",PlyFile::Type::UInt32},{"uint32",PlyFile::Type::UInt32},
+      {"float",PlyFile::Type::Float32},{"float32",PlyFile::Type::Float32},
+      {"double",PlyFile::Type::Float64},{"float64",PlyFile::Type::Float64}
+    };
+    for(auto &n : names)
+    {
+      if(_name==n.name)
+      {
+        o_type=n.type;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  size_t typeSize(PlyFile::Type _type)
+  {
+    switch(_type)
+    {
+      case PlyFile::Type::Int8 : case PlyFile::Type::UInt8 : return 1;
+      case PlyFile::Type::Int16 : case PlyFile::Type::UInt16 : return 2;
+      case PlyFile::Type::Int32 : case PlyFile::Type::UInt32 : case PlyFile::Type::Float32 : return 4;
+      case PlyFile::Type::Float64 : return 8;
+    }
+    return 0;
+  }
+
+  bool hostIsLittleEndian()
+  {
+    uint16_t one=1;
+    uchar first;
+    std::memcpy(&first,&one,1);
+    return first==1;
+  }
+
+  // one coordinate of _count vertices into every third float of o_dst, memcpy as PLY vertices are packed and
+  // values are rarely aligned, the compiler turns it into a plain load
+  template<typename T>
+  void convertColumn(const uchar *_src, size_t _stride, size_t _count, float *o_dst)
+  {
+    for(size_t i=0; i<_count; ++i)
+    {
+      T value;
+      std::memcpy(&value,_src+i*_stride,sizeof(T));
+      o_dst[i*3]=static_cast<float>(value);
+    }
+  }
+
+  void convertColumn(PlyFile::Type _type, const uchar *_src, size_t _stride, size_t _count, float *o_dst)
+  {
+    switch(_type)
+    {
+      case PlyFile::Type::Int8 : convertColumn<int8_t>(_src,_stride,_count,o_dst); break;
+      case PlyFile::Type::UInt8 : convertColumn<uint8_t>(_src,_stride,_count,o_dst); break;
+      case PlyFile::Type::Int16 : convertColumn<int16_t>(_src,_stride,_count,o_dst); break;
+      case PlyFile::Type::UInt16 : convertColumn<uint16_t>(_src,_stride,_count,o_dst); break;
+      case PlyFile::Type::Int32 : convertColumn<int32_t>(_src,_stride,_count,o_dst); break;
+      case PlyFile::Type::UInt32 : convertColumn<uint32_t>(_src,_stride,_count,o_dst); break;
+      case PlyFile::Type::Float32 : convertColumn<float>(_src,_stride,_count,o_dst); break;
+      case PlyFile::Type::Float64 : convertColumn<double>(_src,_stride,_count,o_dst); break;
+    }
+  }
+} // end anon namespace
+
+PlyFile::~PlyFile()
+{
+  close();
+}
+
+bool PlyFile::open(const std::string &_fname)
+{
+  close();
+  if(!hostIsLittleEndian())
+  {
+    std::cerr<<"PlyFile only reads binary_little_endian on a little endian host\n";
+    return false;
+  }
+  m_file.setFileName(QString::fromStdString(_fname));
+  if(!m_file.open(QIODevice::ReadOnly))
+  {
+    std::cerr<<"Unable to open "<<_fname<<'\n';
+    return false;
+  }
+  uint64_t size=static_cast<uint64_t>(m_file.size());
+  m_map=size>0 ? m_file.map(0,m_file.size()) : nullptr;
+  if(m_map==nullptr)
+  {
+    std::cerr<<"Unable to map "<<_fname<<'\n';
+    close();
+    return false;
+  }
+  size_t headerSize=0;
+  uint64_t skip=0;
+  auto text=reinterpret_cast<const char *>(m_map);
+  if(!parseHeader(text,text+std::min<uint64_t>(size,c_maxHeaderSize),headerSize,skip))
+  {
+    std::cerr<<" in "<<_fname<<'\n';
+    close();
+    return false;
+  }
+  uint64_t start=headerSize+skip;
+  if(start>size || (size-start)/m_stride<m_numPoints)
+  {
+    std::cerr<<_fname<<" is truncated, the header has "<<m_numPoints<<" vertices of "<<m_stride<<" bytes\n";
+    close();
+    return false;
+  }
+  m_vertices=m_map+start;
+  return true;
+}
+
+bool PlyFile::parseHeader(const char *_begin, const char *_end, size_t &o_headerSize, uint64_t &o_skip)
+{
+  const char endHeader[]="end_header";
+  auto end=std::search(_begin,_end,endHeader,endHeader+sizeof(endHeader)-1);
+  auto newline=std::find(end,_end,'\n');
+  if(end==_end || newline==_end)
+  {
+    std::cerr<<"No PLY header";
+    return false;
+  }
+  o_headerSize=static_cast<size_t>(newline+1-_begin);
+  std::istringstream header(std::string(_begin,end));
+  std::string line;
+  std::getline(header,line);
+  if(line.compare(0,3,"ply")!=0)
+  {
+    std::cerr<<"Not a PLY file";
+    return false;
+  }
+  // elements before the vertices are skipped so their size must be known, one with a list property can't be
+  o_skip=0;
+  bool listBeforeVertices=false;
+  std::string element;
+  uint64_t elementCount=0;
+  size_t elementStride=0;
+  bool elementHasList=false;
+  bool found=false;
+  bool binary=false;
+  auto endElement=[&]()
+  {
+    if(element=="vertex" && !found)
+    {
+      found=true;
+      m_numPoints=static_cast<size_t>(elementCount);
+      m_stride=elementStride;
+    }
+    else if(!found)
+    {
+      o_skip+=elementCount*elementStride;
+      listBeforeVertices|=elementHasList;
+    }
+  };
+  while(std::getline(header,line))
+  {
+    if(!line.empty() && line.back()=='\r')
+    {
+      line.pop_back();
+    }
+    std::istringstream words(line);
+    std::string keyword;
+    words>>keyword;
+    if(keyword=="format")
+    {
+      std::string format;
+      words>>format;
+      if(format!="binary_little_endian")
+      {
+        std::cerr<<"PLY format "<<format<<" isn't supported, only binary_little_endian";
+        return false;
+      }
+      binary=true;
+    }
+    else if(keyword=="element")
+    {
+      endElement();
+      element.clear();
+      elementCount=0;
+      words>>element>>elementCount;
+      elementStride=0;
+      elementHasList=false;
+    }
+    else if(keyword=="property")
+    {
+      std::string typeName;
+      std::string name;
+      words>>typeName;
+      if(typeName=="list")
+      {
+        elementHasList=true;
+        if(element=="vertex")
+        {
+          std::cerr<<"PLY vertices with list properties aren't supported";
+          return false;
+        }
+        continue;
+      }
+      words>>name;
+      Type type;
+      if(!typeFromName(typeName,type))
+      {
+        std::cerr<<"Unknown PLY property type "<<typeName;
+        return false;
+      }
+      if(element=="vertex" && !found)
+      {
+        m_properties.push_back({name,type,elementStride});
+      }
+      elementStride+=typeSize(type);
+    }
+  }
+  endElement();
+  if(!binary)
+  {
+    std::cerr<<"PLY header has no format";
+    return false;
+  }
+  if(!found || m_numPoints==0)
+  {
+    std::cerr<<"PLY file has no vertices";
+    return false;
+  }
+  if(listBeforeVertices)
+  {
+    std::cerr<<"PLY elements with lists before the vertices aren't supported";
+    return false;
+  }
+  const char *axes[3]={"x","y","z"};
+  for(size_t a=0; a<3; ++a)
+  {
+    auto p=std::find_if(m_properties.begin(),m_properties.end(),[&](const Property &_p){return _p.name==axes[a];});
+    if(p==m_properties.end())
+    {
+      std::cerr<<"PLY vertices have no "<<axes[a];
+      return false;
+    }
+    m_position[a]=&*p;
+  }
+  // drawable as is if x,y,z are floats one after the other, GL takes any stride but setVertexAttributePointer
+  // takes the offset in floats
+  m_inPlace=m_position[0]->type==Type::Float32 && m_position[1]->type==Type::Float32 &&
+            m_position[2]->type==Type::Float32 && m_position[1]->offset==m_position[0]->offset+4 &&
+            m_position[2]->offset==m_position[0]->offset+8 && m_position[0]->offset%4==0;
+  return true;
+}
+
+void PlyFile::close()
+{
+  if(m_map!=nullptr)
+  {
+    m_file.unmap(const_cast<uchar *>(m_map));
+    m_map=nullptr;
+  }
+  m_file.close();
+  m_vertices=nullptr;
+  m_numPoints=0;
+  m_stride=0;
+  m_properties.clear();
+  m_position[0]=m_position[1]=m_position[2]=nullptr;
+  m_inPlace=false;
+}
+
+std::vector<float> PlyFile::convertPositions() const
+{
+  std::vector<float> positions(m_numPoints*3);
+  if(!isOpen())
+  {
+    return positions;
+  }
+  // each chunk is a run of vertices so the mapping is read in order and the first touch of each page is spread over
+  // the workers
+  parallelFor(m_numPoints,parallelChunks(m_numPoints,c_minPointsPerChunk),[&](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t a=0; a<3; ++a)
+    {
+      convertColumn(m_position[a]->type,m_vertices+_begin*m_stride+m_position[a]->offset,m_stride,_end-_begin,
+                    &positions[_begin*3+a]);
+    }
+  });
+  return positions;
+}
+
+void PlyFile::bounds(float o_min[3], float o_max[3]) const
+{
+  for(size_t a=0; a<3; ++a)
+  {
+    o_min[a]=std::numeric_limits<float>::max();
+    o_max[a]=std::numeric_limits<float>::lowest();
+  }
+  if(!isOpen())
+  {
+    return;
+  }
+  size_t chunks=parallelChunks(m_numPoints,c_minPointsPerChunk);
+  std::vector<float> chunkBounds(chunks*6);
+  parallelFor(m_numPoints,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+  {
+    // convert a block at a time so this works for any type without a copy of the whole cloud
+    constexpr size_t blockSize=4096;
+    float block[blockSize*3];
+    float *b=&chunkBounds[_chunk*6];
+    for(size_t a=0; a<3; ++a)
+    {
+      b[a]=std::numeric_limits<float>::max();
+      b[a+3]=std::numeric_limits<float>::lowest();
+    }
+    for(size_t start=_begin; start<_end; start+=blockSize)
+    {
+      size_t count=std::min(blockSize,_end-start);
+      for(size_t a=0; a<3; ++a)
+      {
+        convertColumn(m_position[a]->type,m_vertices+start*m_stride+m_position[a]->offset,m_stride,count,&block[a]);
+      }
+      for(size_t i=0; i<count; ++i)
+      {
+        for(size_t a=0; a<3; ++a)
+        {
+          b[a]=std::min(b[a],block[i*3+a]);
+          b[a+3]=std::max(b[a+3],block[i*3+a]);
+        }
+      }
+    }
+  });
+  for(size_t c=0; c<chunks; ++c)
+  {
+    for(size_t a=0; a<3; ++a)
+    {
+      o_min[a]=std::min(o_min[a],chunkBounds[c*6+a]);
+      o_max[a]=std::max(o_max[a],chunkBounds[c*6+a+3]);
+    }
+  }
+}
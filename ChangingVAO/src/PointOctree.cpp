@@ -0,0 +1,364 @@
+#include "PointOctree.h"
+#include "JobSystem.h"
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define POINTOCTREE_MADVISE 1
+#endif
+
+namespace
+{
+  constexpr char c_fileMagic[8]={'N','G','L','O','C','T','\0','\0'};
+  constexpr uint32_t c_version=1;
+  constexpr uint64_t c_pageSize=4096;
+  // past this the cube is smaller than float precision can split so whatever is left is dropped
+  constexpr uint32_t c_maxLevel=21;
+  // subtrees with fewer points than this are built on the thread that reached them
+  constexpr size_t c_minParallelPoints=1<<20;
+
+  struct FileHeader
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t pointsPerNode;
+    uint32_t gridResolution;
+    uint32_t numNodes;
+    uint64_t totalPoints;
+  };
+  static_assert(sizeof(PointOctree::Node)==64,"nodes are stored as 64 byte records");
+
+  uint64_t alignUp(uint64_t _value, uint64_t _alignment)
+  {
+    return (_value+_alignment-1)/_alignment*_alignment;
+  }
+
+  struct BuildNode
+  {
+    float min[3];
+    float size;
+    uint32_t level;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the node's points are [begin,begin+count) of the reordered positions
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t begin;
+    uint32_t count;
+    std::array<std::unique_ptr<BuildNode>,8> children;
+  };
+
+  struct Builder
+  {
+    float *positions;
+    float *scratch;
+    uint32_t pointsPerNode;
+    uint32_t gridResolution;
+    std::atomic<uint64_t> dropped={0};
+
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief keep at most one point per grid cell (up to pointsPerNode) at the front of the node's range and sort the
+    /// rest by octant behind them for the children. scratch is the same range of a second buffer so siblings can be
+    /// built at the same time.
+    //----------------------------------------------------------------------------------------------------------------------
+    void build(BuildNode &_node, size_t _count)
+    {
+      float *points=positions+_node.begin*3;
+      if(_count<=pointsPerNode || _node.level==c_maxLevel)
+      {
+        _node.count=static_cast<uint32_t>(std::min<size_t>(_count,pointsPerNode));
+        dropped+=_count-_node.count;
+        return;
+      }
+      float *copy=scratch+_node.begin*3;
+      std::memcpy(copy,points,_count*3*sizeof(float));
+      // the code of each point is its octant or 8 if it stays in this node
+      std::vector<uint8_t> codes(_count);
+      size_t cells=size_t(gridResolution)*gridResolution*gridResolution;
+      std::vector<uint64_t> occupied((cells+63)/64,0);
+      std::array<size_t,9> counts{};
+      float half=_node.size*0.5f;
+      float toCell=static_cast<float>(gridResolution)/_node.size;
+      for(size_t i=0; i<_count; ++i)
+      {
+        const float *p=copy+i*3;
+        size_t cell=0;
+        uint8_t octant=0;
+        for(size_t a=0; a<3; ++a)
+        {
+          float local=p[a]-_node.min[a];
+          auto c=static_cast<size_t>(std::min(std::max(local*toCell,0.0f),static_cast<float>(gridResolution-1)));
+          cell=cell*gridResolution+c;
+          octant|=static_cast<uint8_t>(local>=half)<<a;
+        }
+        uint64_t bit=uint64_t(1)<<(cell&63);
+        if(counts[8]<pointsPerNode && (occupied[cell/64]&bit)==0)
+        {
+          occupied[cell/64]|=bit;
+          octant=8;
+        }
+        codes[i]=octant;
+        ++counts[octant];
+      }
+      std::array<size_t,9> offsets;
+      offsets[8]=0;
+      size_t offset=counts[8];
+      for(size_t o=0; o<8; ++o)
+      {
+        offsets[o]=offset;
+        offset+=counts[o];
+      }
+      std::array<size_t,9> write=offsets;
+      for(size_t i=0; i<_count; ++i)
+      {
+        std::memcpy(points+write[codes[i]]*3,copy+i*3,3*sizeof(float));
+        ++write[codes[i]];
+      }
+      _node.count=static_cast<uint32_t>(counts[8]);
+      for(size_t o=0; o<8; ++o)
+      {
+        if(counts[o]!=0)
+        {
+          auto child=std::make_unique<BuildNode>();
+          for(size_t a=0; a<3; ++a)
+          {
+            child->min[a]=_node.min[a]+((o>>a)&1 ? half : 0.0f);
+          }
+          child->size=half;
+          child->level=_node.level+1;
+          child->begin=_node.begin+offsets[o];
+          child->count=0;
+          _node.children[o]=std::move(child);
+        }
+      }
+      if(_count>=c_minParallelPoints)
+      {
+        parallelFor(8,8,[&](size_t _o,size_t,size_t)
+        {
+          if(_node.children[_o])
+          {
+            build(*_node.children[_o],counts[_o]);
+          }
+        });
+      }
+      else
+      {
+        for(size_t o=0; o<8; ++o)
+        {
+          if(_node.children[o])
+          {
+            build(*_node.children[o],counts[o]);
+          }
+        }
+      }
+    }
+  };
+} // end anon namespace
+
+PointOctree::~PointOctree()
+{
+  close();
+}
+
+bool PointOctree::build(std::vector<float> &_positions, const std::string &_fname, uint32_t _pointsPerNode)
+{
+  size_t count=_positions.size()/3;
+  if(count==0 || _pointsPerNode==0)
+  {
+    std::cerr<<"No points to build an octree from\n";
+    return false;
+  }
+  // the root is the bounding cube, grown a little so the far faces fall inside
+  float min[3];
+  float max[3];
+  for(size_t a=0; a<3; ++a)
+  {
+    min[a]=std::numeric_limits<float>::max();
+    max[a]=std::numeric_limits<float>::lowest();
+  }
+  for(size_t i=0; i<count; ++i)
+  {
+    for(size_t a=0; a<3; ++a)
+    {
+      min[a]=std::min(min[a],_positions[i*3+a]);
+      max[a]=std::max(max[a],_positions[i*3+a]);
+    }
+  }
+  float size=std::max({max[0]-min[0],max[1]-min[1],max[2]-min[2]})*1.0001f+std::numeric_limits<float>::min();
+
+  // a node has about as many points as the grid has cells on one face, that is how a scanned surface fills it
+  auto grid=static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(_pointsPerNode))));
+  std::vector<float> scratch(_positions.size());
+  Builder builder{_positions.data(),scratch.data(),_pointsPerNode,grid};
+  BuildNode root;
+  std::copy(min,min+3,root.min);
+  root.size=size;
+  root.level=0;
+  root.begin=0;
+  root.count=0;
+  builder.build(root,count);
+  scratch=std::vector<float>();
+  if(builder.dropped!=0)
+  {
+    std::cerr<<"Dropped "<<builder.dropped<<" coincident points\n";
+  }
+
+  // breadth first so the coarse levels are together at the front of the file
+  std::vector<const BuildNode *> order;
+  std::vector<Node> nodes;
+  order.push_back(&root);
+  for(size_t i=0; i<order.size(); ++i)
+  {
+    const BuildNode &b=*order[i];
+    Node n;
+    std::copy(b.min,b.min+3,n.min);
+    n.size=b.size;
+    n.offset=0;
+    n.count=b.count;
+    n.level=b.level;
+    for(size_t o=0; o<8; ++o)
+    {
+      n.children[o]=0;
+      if(b.children[o])
+      {
+        n.children[o]=static_cast<uint32_t>(order.size());
+        order.push_back(b.children[o].get());
+      }
+    }
+    nodes.push_back(n);
+  }
+  uint64_t offset=alignUp(c_pageSize+nodes.size()*sizeof(Node),c_pageSize);
+  uint64_t total=0;
+  for(auto &n : nodes)
+  {
+    n.offset=offset;
+    offset=alignUp(offset+uint64_t(n.count)*3*sizeof(float),c_pageSize);
+    total+=n.count;
+  }
+
+  QDir().mkpath(QFileInfo(QString::fromStdString(_fname)).absolutePath());
+  QFile file(QString::fromStdString(_fname));
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    std::cerr<<"Unable to write "<<_fname<<'\n';
+    return false;
+  }
+  std::vector<char> page(c_pageSize,0);
+  FileHeader header;
+  std::memcpy(header.magic,c_fileMagic,sizeof(c_fileMagic));
+  header.version=c_version;
+  header.pointsPerNode=_pointsPerNode;
+  header.gridResolution=grid;
+  header.numNodes=static_cast<uint32_t>(nodes.size());
+  header.totalPoints=total;
+  std::memcpy(page.data(),&header,sizeof(FileHeader));
+  bool ok=file.write(page.data(),c_pageSize)==static_cast<qint64>(c_pageSize);
+  // everything else is padded with zeros to the next page
+  std::fill(page.begin(),page.end(),0);
+  auto pad=[&](uint64_t _written)
+  {
+    auto bytes=static_cast<qint64>(alignUp(_written,c_pageSize)-_written);
+    return file.write(page.data(),bytes)==bytes;
+  };
+  auto tableSize=static_cast<qint64>(nodes.size()*sizeof(Node));
+  ok=ok && file.write(reinterpret_cast<const char *>(nodes.data()),tableSize)==tableSize && pad(c_pageSize+tableSize);
+  for(size_t i=0; i<nodes.size() && ok; ++i)
+  {
+    auto bytes=static_cast<qint64>(uint64_t(nodes[i].count)*3*sizeof(float));
+    ok=file.write(reinterpret_cast<const char *>(_positions.data()+order[i]->begin*3),bytes)==bytes && pad(nodes[i].offset+bytes);
+  }
+  file.close();
+  if(!ok)
+  {
+    std::cerr<<"Error writing "<<_fname<<'\n';
+    return false;
+  }
+  std::cout<<"Wrote "<<total<<" points in "<<nodes.size()<<" nodes to "<<_fname<<'\n';
+  return true;
+}
+
+bool PointOctree::open(const std::string &_fname)
+{
+  close();
+  m_file.setFileName(QString::fromStdString(_fname));
+  if(!m_file.open(QIODevice::ReadOnly))
+  {
+    std::cerr<<"Unable to open "<<_fname<<'\n';
+    return false;
+  }
+  auto size=static_cast<uint64_t>(m_file.size());
+  m_map=size>=c_pageSize ? m_file.map(0,m_file.size()) : nullptr;
+  FileHeader header={};
+  if(m_map!=nullptr)
+  {
+    std::memcpy(&header,m_map,sizeof(FileHeader));
+  }
+  if(m_map==nullptr || std::memcmp(header.magic,c_fileMagic,sizeof(c_fileMagic))!=0 || header.version!=c_version)
+  {
+    std::cerr<<_fname<<" isn't an octree file\n";
+    close();
+    return false;
+  }
+  bool valid=header.numNodes!=0 && c_pageSize+uint64_t(header.numNodes)*sizeof(Node)<=size;
+  m_nodes=reinterpret_cast<const Node *>(m_map+c_pageSize);
+  for(uint32_t i=0; i<header.numNodes && valid; ++i)
+  {
+    const Node &n=m_nodes[i];
+    valid=n.count<=header.pointsPerNode && n.offset%c_pageSize==0 && n.offset+uint64_t(n.count)*3*sizeof(float)<=size;
+    for(auto c : n.children)
+    {
+      valid=valid && c<header.numNodes && (c==0 || c>i);
+    }
+  }
+  if(!valid)
+  {
+    std::cerr<<_fname<<" is truncated or corrupt\n";
+    close();
+    return false;
+  }
+  m_numNodes=header.numNodes;
+  m_pointsPerNode=header.pointsPerNode;
+  m_gridResolution=header.gridResolution;
+  m_totalPoints=header.totalPoints;
+#if defined(POINTOCTREE_MADVISE)
+  // nodes are read in whatever order the camera wants so the kernel shouldn't read ahead of each fault
+  madvise(const_cast<uchar *>(m_map),static_cast<size_t>(size),MADV_RANDOM);
+#endif
+  return true;
+}
+
+void PointOctree::close()
+{
+  if(m_map!=nullptr)
+  {
+    m_file.unmap(const_cast<uchar *>(m_map));
+    m_map=nullptr;
+  }
+  m_file.close();
+  m_nodes=nullptr;
+  m_numNodes=0;
+  m_pointsPerNode=0;
+  m_gridResolution=0;
+  m_totalPoints=0;
+}
+
+const float *PointOctree::points(size_t _index) const
+{
+  return reinterpret_cast<const float *>(m_map+m_nodes[_index].offset);
+}
+
+void PointOctree::prefetch(size_t _index) const
+{
+#if defined(POINTOCTREE_MADVISE)
+  const Node &n=m_nodes[_index];
+  madvise(const_cast<uchar *>(m_map)+n.offset,static_cast<size_t>(alignUp(uint64_t(n.count)*3*sizeof(float),c_pageSize)),MADV_WILLNEED);
+#else
+  (void)_index;
+#endif
+}
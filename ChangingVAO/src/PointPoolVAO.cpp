@@ -0,0 +1,90 @@
+#include "PointPoolVAO.h"
+#include <iostream>
+
+void PointPoolVAO::draw() const
+{
+  if(m_allocated == false)
+  {
+    std::cerr<<"Warning trying to draw an unallocated VOA\n";
+  }
+  if(m_bound == false)
+  {
+    std::cerr<<"Warning trying to draw an unbound VOA\n";
+  }
+  if(!m_firsts.empty())
+  {
+    glMultiDrawArrays(m_mode,m_firsts.data(),m_counts.data(),static_cast<GLsizei>(m_firsts.size()));
+  }
+}
+
+void PointPoolVAO::removeVAO()
+{
+  if(m_bound == true)
+  {
+    unbind();
+  }
+  if(m_allocated == true)
+  {
+    glDeleteBuffers(1,&m_buffer);
+  }
+  glDeleteVertexArrays(1,&m_id);
+  m_allocated=false;
+  m_slots=0;
+}
+
+void PointPoolVAO::setData(const VertexData &_data)
+{
+  if(m_bound == false)
+  {
+    std::cerr<<"trying to set VOA data when unbound\n";
+  }
+  if(m_allocated == false)
+  {
+    glGenBuffers(1,&m_buffer);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER,m_buffer);
+  glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(_data.m_size),&_data.m_data,_data.m_mode);
+  m_allocated=true;
+}
+
+void PointPoolVAO::allocate(size_t _slots, size_t _pointsPerSlot)
+{
+  if(m_bound == false)
+  {
+    std::cerr<<"trying to set VOA data when unbound\n";
+  }
+  if(m_allocated == false)
+  {
+    glGenBuffers(1,&m_buffer);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER,m_buffer);
+  glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(_slots*_pointsPerSlot*3*sizeof(float)),nullptr,GL_DYNAMIC_DRAW);
+  setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+  m_allocated=true;
+  m_slots=_slots;
+  m_pointsPerSlot=_pointsPerSlot;
+}
+
+void PointPoolVAO::upload(size_t _slot, const float *_points, size_t _count)
+{
+  glBindBuffer(GL_ARRAY_BUFFER,m_buffer);
+  glBufferSubData(GL_ARRAY_BUFFER,static_cast<GLintptr>(_slot*m_pointsPerSlot*3*sizeof(float)),
+                  static_cast<GLsizeiptr>(_count*3*sizeof(float)),_points);
+}
+
+void PointPoolVAO::clearDraws()
+{
+  m_firsts.clear();
+  m_counts.clear();
+}
+
+void PointPoolVAO::addDraw(size_t _slot, size_t _count)
+{
+  addRange(_slot*m_pointsPerSlot,_count);
+}
+
+void PointPoolVAO::addRange(size_t _first, size_t _count)
+{
+  m_firsts.push_back(static_cast<GLint>(_first));
+  m_counts.push_back(static_cast<GLsizei>(_count));
+}
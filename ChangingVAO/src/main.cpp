@@ -3,12 +3,63 @@ basic OpenGL demo modified from http://qt-project.org/doc/qt-5.0/qtgui/openglwin
 ****************************************************************************/
 #include <QtGui/QGuiApplication>
 #include <iostream>
+#include <string>
 #include "NGLScene.h"
 
 
 
 int main(int argc, char **argv)
 {
+  // --shm NAME draws frames from the FrameRing NAME (see ChangingVAOProducer) rather than random points
+  // --record FILE appends every frame drawn to FILE, --play FILE streams a recording back at --rate FPS (0 as fast as
+  // possible), --ply FILE draws a binary PLY point cloud, --octree FILE streams a cloud built by ChangingVAOOctreeBuilder
+  // through a --budget MB GPU pool refining nodes to --error pixels, --morton sorts generated points into Z order
+  // and --cull only draws the chunks of generated or PLY points inside the view
+  SceneOptions options;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--shm" && i + 1 < argc)
+    {
+      options.feed = argv[++i];
+    }
+    else if (arg == "--record" && i + 1 < argc)
+    {
+      options.record = argv[++i];
+    }
+    else if (arg == "--play" && i + 1 < argc)
+    {
+      options.play = argv[++i];
+    }
+    else if (arg == "--ply" && i + 1 < argc)
+    {
+      options.ply = argv[++i];
+    }
+    else if (arg == "--octree" && i + 1 < argc)
+    {
+      options.octree = argv[++i];
+    }
+    else if (arg == "--budget" && i + 1 < argc)
+    {
+      options.octreeBudgetMB = std::stoul(argv[++i]);
+    }
+    else if (arg == "--error" && i + 1 < argc)
+    {
+      options.octreeError = std::stof(argv[++i]);
+    }
+    else if (arg == "--morton")
+    {
+      options.morton = true;
+    }
+    else if (arg == "--cull")
+    {
+      options.cull = true;
+    }
+    else if (arg == "--rate" && i + 1 < argc)
+    {
+      options.playRate = std::stod(argv[++i]);
+    }
+  }
   QGuiApplication app(argc, argv);
   // create an OpenGL format specifier
   QSurfaceFormat format;
@@ -30,7 +81,7 @@ int main(int argc, char **argv)
   // now set the depth buffer to 24 bits
   format.setDepthBufferSize(24);
   // now we are going to create our scene window
-  NGLScene window;
+  NGLScene window(options);
   // and set the OpenGL format
   window.setFormat(format);
   // we can now query the version to see if it worked
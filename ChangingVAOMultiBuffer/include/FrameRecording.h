@@ -0,0 +1,99 @@
+#ifndef FRAMERECORDING_H_
+#define FRAMERECORDING_H_
+
+#include <QFile>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file FrameRecording.h
+/// @brief a chunked point cloud recording. After a one page file header each frame is a chunk starting on a page
+/// boundary, a 64 byte chunk header (sequence, time, point count and the offset of the next chunk) followed by the
+/// x,y,z floats. Chunks are only appended so a recording cut short by a crash is still readable up to the last whole
+/// frame.
+//----------------------------------------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class FrameRecorder
+/// @brief appends frames to a recording
+//----------------------------------------------------------------------------------------------------------------------
+class FrameRecorder
+{
+  public :
+    ~FrameRecorder();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start a new recording, replacing any file already there
+    /// @returns false if the file can't be written
+    //----------------------------------------------------------------------------------------------------------------------
+    bool open(const std::string &_fname);
+    void close();
+    bool isOpen() const {return m_file.isOpen();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief add a frame of _count x,y,z points
+    //----------------------------------------------------------------------------------------------------------------------
+    bool append(const float *_points, size_t _count);
+    uint64_t numFrames() const {return m_frames;}
+    uint64_t bytesWritten() const {return m_offset;}
+
+  private :
+    QFile m_file;
+    uint64_t m_frames=0;
+    uint64_t m_offset=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the time of the first frame, frame times are recorded relative to this
+    //----------------------------------------------------------------------------------------------------------------------
+    int64_t m_start=0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class FramePlayer
+/// @brief memory maps a recording and gives each frame as a pointer into the mapping so it can be passed to GL with
+/// no copy. prefetch() tells the kernel to start reading the frames that are coming up and drop the pages of ones
+/// already played so long recordings stream at disk speed with a bounded resident size.
+//----------------------------------------------------------------------------------------------------------------------
+class FramePlayer
+{
+  public :
+    struct Frame
+    {
+      uint64_t sequence;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief nanoseconds since the first recorded frame
+      //----------------------------------------------------------------------------------------------------------------------
+      uint64_t time;
+      uint32_t count;
+      const float *points;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief map a recording and index its frames
+    /// @returns false if it isn't a recording or has no frames
+    //----------------------------------------------------------------------------------------------------------------------
+    bool open(const std::string &_fname);
+    void close();
+    size_t numFrames() const {return m_chunks.size();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the largest point count of any frame, use this to size anything drawn alongside the points
+    //----------------------------------------------------------------------------------------------------------------------
+    uint32_t maxCount() const {return m_maxCount;}
+    Frame frame(size_t _index) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief advise the kernel that frames (_current,_current+_ahead] are needed soon and the one before _current
+    /// isn't, wrapping around at the end as playback loops
+    //----------------------------------------------------------------------------------------------------------------------
+    void prefetch(size_t _current, size_t _ahead);
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief tell the kernel about the pages of frame _index
+    //----------------------------------------------------------------------------------------------------------------------
+    void advise(size_t _index, bool _willNeed) const;
+    QFile m_file;
+    const uchar *m_map=nullptr;
+    uint64_t m_size=0;
+    std::vector<uint64_t> m_chunks;
+    uint32_t m_maxCount=0;
+};
+
+#endif
@@ -5,8 +5,13 @@
 #include <ngl/Vec3.h>
 #include <ngl/MultiBufferVAO.h>
 #include "WindowParams.h"
+#include "UniformHandle.h"
+#include "FrameRecording.h"
+#include "MortonSort.h"
+#include <QElapsedTimer>
 #include <QOpenGLWindow>
 #include <memory>
+#include <string>
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @file NGLScene.h
@@ -21,14 +26,29 @@
 /// put in this file
 //----------------------------------------------------------------------------------------------------------------------
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief whether the points are recorded or played back from a recording
+//----------------------------------------------------------------------------------------------------------------------
+struct SceneOptions
+{
+  // play this recording (see FrameRecording.h) instead of generating points
+  std::string play;
+  // playback frames per second, 0 plays as fast as the frames can be drawn
+  double playRate = 60.0;
+  // append every new frame to this recording
+  std::string record;
+  // sort the points and their colours into Morton order before upload
+  bool morton = false;
+};
+
 class NGLScene : public QOpenGLWindow
 {
   public:
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief ctor for our NGL drawing class
-    /// @param [in] parent the parent window to the class
+    /// @param [in] _options recording and playback options
     //----------------------------------------------------------------------------------------------------------------------
-    NGLScene();
+    explicit NGLScene(const SceneOptions &_options = {});
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief dtor must close down ngl and release OpenGL resources
     //----------------------------------------------------------------------------------------------------------------------
@@ -99,8 +119,39 @@ private:
     void timerEvent(QTimerEvent *_event) override;
     // Data to plot each frame
     std::vector <ngl::Vec3> m_data;
+    // the colour of each point, only uploaded again when a sort has reordered it
+    std::vector<ngl::Vec4> m_colours;
+    bool m_coloursChanged = false;
+    MortonSort m_sorter;
+    // the Morton sort cost in ms per million points averaged over the frames since the last report
+    double m_sortMs = 0.0;
+    size_t m_sortPoints = 0;
+    size_t m_sortFrames = 0;
+    double m_sortMsPerMillion = 0.0;
+    SceneOptions m_options;
+    size_t m_numPoints = 0;
+    FrameRecorder m_recorder;
+    // playback state, a frame is only stepped on once the last has been drawn so every frame is shown in order
+    FramePlayer m_player;
+    size_t m_playFrame = 0;
+    bool m_playPending = false;
+    double m_nextPlayTime = 0.0;
+    QElapsedTimer m_playTimer;
+    // sustained upload throughput for each pass through the recording
+    uint64_t m_playBytes = 0;
+    double m_playPassStart = 0.0;
+    double m_playFps = 0.0;
+    double m_playMBs = 0.0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief upload the current recorded frame straight from the mapped file
+    //----------------------------------------------------------------------------------------------------------------------
+    void uploadPlayFrame();
     
     std::unique_ptr<ngl::MultiBufferVAO> m_vao;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the MVP uniform of the shader, found once after linking
+    //----------------------------------------------------------------------------------------------------------------------
+    UniformHandle m_MVPUniform;
 
     // text render class
     std::unique_ptr <ngl::Text> m_text;
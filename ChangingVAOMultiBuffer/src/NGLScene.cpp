@@ -7,15 +7,28 @@
 #include <ngl/VAOPrimitives.h>
 #include <ngl/Random.h>
 #include <ngl/ShaderLib.h>
+#include <algorithm>
 #include <memory>
 #include <iostream>
 
 constexpr size_t c_dataSize = 123456;
 
-NGLScene::NGLScene()
+NGLScene::NGLScene(const SceneOptions &_options) : m_options(_options)
 {
   setTitle("Qt5 Simple NGL Demo");
-  m_data.resize(c_dataSize);
+  if (!m_options.play.empty() && !m_player.open(m_options.play))
+  {
+    std::cerr << "Unable to play " << m_options.play << " generating points instead\n";
+    m_options.play.clear();
+  }
+  if (m_options.play.empty())
+  {
+    m_data.resize(c_dataSize);
+  }
+  if (!m_options.record.empty() && !m_recorder.open(m_options.record))
+  {
+    std::cerr << "Unable to record to " << m_options.record << '\n';
+  }
 }
 
 NGLScene::~NGLScene()
@@ -58,9 +71,21 @@ void NGLScene::initializeGL()
   // now to load the shader and set the values
   // grab an instance of shader manager
   ngl::ShaderLib::loadShader(ColourShader, "shaders/ColourVertex.glsl", "shaders/ColourFragment.glsl");
+  // looked up once here so paintGL sets MVP without a name lookup
+  m_MVPUniform = UniformHandle(ngl::ShaderLib::getProgramID(ColourShader), "MVP");
 
   glViewport(0, 0, width(), height());
-  startTimer(250);
+  if (!m_options.play.empty())
+  {
+    // playback is paced in timerEvent so check often, the first frame is drawn straight away
+    m_playTimer.start();
+    m_playPending = true;
+    startTimer(1, Qt::PreciseTimer);
+  }
+  else
+  {
+    startTimer(250);
+  }
   glPointSize(10);
   m_text = std::make_unique<ngl::Text>("fonts/Arial.ttf", 18);
   m_text->setScreenSize(width(), height());
@@ -69,14 +94,14 @@ void NGLScene::initializeGL()
   m_vao->bind();
   // need to set initial data slot for Vertex this will be index 0
   m_vao->setData(ngl::MultiBufferVAO::VertexData(0, 0));
-  // next one for Colour
-  std::vector<ngl::Vec4> colours(c_dataSize);
-  for (auto &c : colours)
+  // next one for Colour, a recording may have more points than are generated
+  m_colours.resize(std::max<size_t>(c_dataSize, m_player.maxCount()));
+  for (auto &c : m_colours)
   {
     c = ngl::Random::getRandomColour4();
   }
   // need to set initial data slot for colour this will be index 1
-  m_vao->setData(ngl::MultiBufferVAO::VertexData(colours.size() * sizeof(ngl::Vec4), colours[0].m_r));
+  m_vao->setData(ngl::MultiBufferVAO::VertexData(m_colours.size() * sizeof(ngl::Vec4), m_colours[0].m_r));
   m_vao->setVertexAttributePointer(1, 4, GL_FLOAT, 0, 0);
 
   m_vao->unbind();
@@ -103,12 +128,27 @@ void NGLScene::paintGL()
   ngl::Mat4 MVP;
   MVP = m_project * m_view * m_mouseGlobalTX;
 
-  ngl::ShaderLib::setUniform("MVP", MVP);
+  m_MVPUniform.set(MVP);
   m_vao->bind();
-  m_vao->setData(0, ngl::MultiBufferVAO::VertexData(m_data.size() * sizeof(ngl::Vec3), m_data[0].m_x));
-  // We must do this each time as we change the data.
-  m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, 0, 0);
+  if (!m_options.play.empty())
+  {
+    uploadPlayFrame();
+  }
+  else
+  {
+    m_vao->setData(0, ngl::MultiBufferVAO::VertexData(m_data.size() * sizeof(ngl::Vec3), m_data[0].m_x));
+    // We must do this each time as we change the data.
+    m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, 0, 0);
+    m_numPoints = m_data.size();
+  }
 
+  if (m_coloursChanged)
+  {
+    // the sort moved each colour with its point
+    m_vao->setData(1, ngl::MultiBufferVAO::VertexData(m_colours.size() * sizeof(ngl::Vec4), m_colours[0].m_r));
+    m_vao->setVertexAttributePointer(1, 4, GL_FLOAT, 0, 0);
+    m_coloursChanged = false;
+  }
   // std::vector<ngl::Vec4> colours(c_dataSize);
   // for(auto & c : colours)
   // {
@@ -117,24 +157,96 @@ void NGLScene::paintGL()
   // // need to set initial data slot for colour this will be index 1
   // m_vao->setData(1,ngl::MultiBufferVAO::VertexData(colours.size()*sizeof(ngl::Vec4),colours[0].m_r));
   // m_vao->setVertexAttributePointer(1,4,GL_FLOAT,0,0);
-  m_vao->setNumIndices(m_data.size());
+  m_vao->setNumIndices(m_numPoints);
   m_vao->draw();
   m_vao->unbind();
 
   m_text->setColour(1.0f, 1.0f, 1.0f);
-  std::string text = fmt::format("Data Size {} ", m_data.size());
+  std::string text;
+  if (!m_options.play.empty())
+  {
+    text = fmt::format("Frame {}/{} Points {} {:.1f} fps {:.1f} MB/s", m_playFrame + 1, m_player.numFrames(), m_numPoints, m_playFps, m_playMBs);
+  }
+  else if (m_options.morton)
+  {
+    text = fmt::format("Data Size {} Morton {:.1f} ms/M points", m_numPoints, m_sortMsPerMillion);
+  }
+  else
+  {
+    text = fmt::format("Data Size {} ", m_numPoints);
+  }
   m_text->renderText(10, 700, text);
 }
 
+void NGLScene::uploadPlayFrame()
+{
+  if (!m_playPending)
+  {
+    return;
+  }
+  auto frame = m_player.frame(m_playFrame);
+  // the points are passed straight from the mapped file, the pages were prefetched while earlier frames played
+  m_vao->setData(0, ngl::MultiBufferVAO::VertexData(frame.count * 3 * sizeof(float), frame.points[0], GL_STREAM_DRAW));
+  m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, 0, 0);
+  m_numPoints = frame.count;
+  m_player.prefetch(m_playFrame, 8);
+  m_playBytes += frame.count * 3 * sizeof(float);
+  m_playPending = false;
+  if (m_playFrame + 1 == m_player.numFrames())
+  {
+    // report each full pass so the upload rate is measured over the whole recording
+    double now = m_playTimer.nsecsElapsed() * 1.0e-9;
+    double seconds = now - m_playPassStart;
+    m_playFps = m_player.numFrames() / seconds;
+    m_playMBs = m_playBytes / seconds / (1024.0 * 1024.0);
+    std::cout << "played " << m_player.numFrames() << " frames in " << seconds << " s, " << m_playFps << " fps, " << m_playMBs << " MB/s\n";
+    m_playPassStart = now;
+    m_playBytes = 0;
+  }
+}
+
 void NGLScene::timerEvent(QTimerEvent *_event)
 {
   NGL_UNUSED(_event);
+  if (!m_options.play.empty())
+  {
+    // step on once the last frame has been drawn and the next is due, if drawing is slower than the rate every
+    // frame is still shown just later
+    double now = m_playTimer.nsecsElapsed() * 1.0e-9;
+    if (!m_playPending && (m_options.playRate <= 0.0 || now >= m_nextPlayTime))
+    {
+      m_playFrame = (m_playFrame + 1) % m_player.numFrames();
+      m_nextPlayTime = std::max(m_nextPlayTime + (m_options.playRate > 0.0 ? 1.0 / m_options.playRate : 0.0), now - 1.0);
+      m_playPending = true;
+      update();
+    }
+    return;
+  }
   // clear out old data ready to add new
   // note reference as mutating vector
   for (auto &p : m_data)
   {
     p = ngl::Random::getRandomVec3() * 5;
   }
+  if (m_options.morton)
+  {
+    // positions and colours are reordered together so each point keeps its colour
+    m_sorter.sort(&m_data[0].m_x, m_data.size(), &m_colours[0].m_r, 4);
+    m_coloursChanged = true;
+    m_sortMs += m_sorter.timings().total();
+    m_sortPoints += m_data.size();
+    if (++m_sortFrames % 20 == 0)
+    {
+      m_sortMsPerMillion = m_sortMs / (m_sortPoints * 1.0e-6);
+      std::cout << "Morton sort " << m_sortMsPerMillion << " ms per million points\n";
+      m_sortMs = 0.0;
+      m_sortPoints = 0;
+    }
+  }
+  if (m_recorder.isOpen())
+  {
+    m_recorder.append(&m_data[0].m_x, m_data.size());
+  }
   update();
 }
 
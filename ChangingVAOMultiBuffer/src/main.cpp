@@ -3,12 +3,36 @@ basic OpenGL demo modified from http://qt-project.org/doc/qt-5.0/qtgui/openglwin
 ****************************************************************************/
 #include <QtGui/QGuiApplication>
 #include <iostream>
+#include <string>
 #include "NGLScene.h"
 
 
 
 int main(int argc, char **argv)
 {
+  // --record FILE appends every frame generated to FILE, --play FILE streams a recording back at --rate FPS (0 as fast
+  // as possible), --morton sorts the points and colours into Z order
+  SceneOptions options;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--record" && i + 1 < argc)
+    {
+      options.record = argv[++i];
+    }
+    else if (arg == "--play" && i + 1 < argc)
+    {
+      options.play = argv[++i];
+    }
+    else if (arg == "--morton")
+    {
+      options.morton = true;
+    }
+    else if (arg == "--rate" && i + 1 < argc)
+    {
+      options.playRate = std::stod(argv[++i]);
+    }
+  }
   QGuiApplication app(argc, argv);
   // create an OpenGL format specifier
   QSurfaceFormat format;
@@ -30,7 +54,7 @@ int main(int argc, char **argv)
   // now set the depth buffer to 24 bits
   format.setDepthBufferSize(24);
   // now we are going to create our scene window
-  NGLScene window;
+  NGLScene window(options);
   // and set the OpenGL format
   window.setFormat(format);
   // we can now query the version to see if it worked
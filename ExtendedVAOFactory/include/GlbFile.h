@@ -0,0 +1,137 @@
+#ifndef GLBFILE_H_
+#define GLBFILE_H_
+
+#include <ngl/AbstractVAO.h>
+#include <QFile>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class GlbFile
+/// @brief a binary glTF 2.0 (.glb) loader. The file is memory mapped, the JSON chunk is parsed for the buffer views,
+/// accessors and mesh primitives and the BIN chunk is used where it lies. An accessor GL can read as it is (no
+/// sparse substitution, component aligned, a stride that is a multiple of 4) has its whole buffer view passed
+/// straight from the mapping to a VAO buffer with the accessor's offset, stride, type and normalisation given to the
+/// attribute pointer, so interleaved or quantised data is uploaded without touching it. Anything else is converted
+/// to packed floats with SSE2 / NEON in parallel chunks, and byte indices are widened to GLushort as many drivers
+/// convert byte indices themselves on every draw.
+/// Only the mesh data is read, node transforms, materials, skins and morph targets are ignored and buffers other
+/// than the BIN chunk (external or data URIs) aren't supported.
+//----------------------------------------------------------------------------------------------------------------------
+class GlbFile
+{
+  public :
+    static constexpr size_t c_none=SIZE_MAX;
+    struct BufferView
+    {
+      size_t byteOffset=0;
+      size_t byteLength=0;
+      // 0 is tightly packed
+      size_t byteStride=0;
+    };
+    struct Accessor
+    {
+      size_t bufferView=c_none;
+      size_t byteOffset=0;
+      size_t count=0;
+      // the GL enum, glTF uses the same values
+      GLenum componentType=GL_FLOAT;
+      size_t components=1;
+      bool normalized=false;
+      // elements replaced by the sparse storage, the indices and values are in their own views
+      size_t sparseCount=0;
+      size_t sparseIndicesView=c_none;
+      size_t sparseIndicesOffset=0;
+      GLenum sparseIndexType=GL_UNSIGNED_INT;
+      size_t sparseValuesView=c_none;
+      size_t sparseValuesOffset=0;
+      // min and max are required for POSITION, only the first 3 components are kept
+      bool hasBounds=false;
+      float min[3]={0.0f,0.0f,0.0f};
+      float max[3]={0.0f,0.0f,0.0f};
+      size_t componentSize() const;
+      size_t elementSize() const {return componentSize()*components;}
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a draw call's worth of a mesh as accessor indices, c_none where the primitive doesn't have one
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Primitive
+    {
+      size_t position=c_none;
+      size_t normal=c_none;
+      size_t colour=c_none;
+      size_t indices=c_none;
+      GLenum mode=GL_TRIANGLES;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief what createVAO did, added to by each call
+    //----------------------------------------------------------------------------------------------------------------------
+    struct UploadStats
+    {
+      size_t inPlaceAccessors=0;
+      size_t convertedAccessors=0;
+      size_t inPlaceBytes=0;
+      size_t convertedBytes=0;
+    };
+
+    GlbFile()=default;
+    ~GlbFile();
+    GlbFile(const GlbFile &)=delete;
+    GlbFile &operator=(const GlbFile &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief map a file and read its JSON
+    /// @returns false if it isn't a glTF 2.0 binary whose views and accessors lie inside its BIN chunk, the reason is
+    /// printed
+    //----------------------------------------------------------------------------------------------------------------------
+    bool open(const std::string &_fname);
+    void close();
+    bool isOpen() const {return m_map!=nullptr;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief every primitive of every mesh, those without positions are left out
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<Primitive> &primitives() const {return m_primitives;}
+    const Accessor &accessor(size_t _index) const {return m_accessors[_index];}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if the accessor can be drawn from its buffer view as it is
+    //----------------------------------------------------------------------------------------------------------------------
+    bool inPlace(size_t _accessor) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the accessor as packed floats, normalised integers are scaled as glTF says and sparse elements
+    /// substituted
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<float> convert(size_t _accessor) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the box around every primitive's positions from the accessor min and max glTF requires
+    //----------------------------------------------------------------------------------------------------------------------
+    void bounds(float o_min[3], float o_max[3]) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create a VAO with positions as attribute 0 and colours (or normals if there are no colours) as
+    /// attribute 1, a MultiBufferIndexVAO for an indexed primitive and an ngl::MultiBufferVAO otherwise. The
+    /// multiBufferIndexVAO creator must be registered with the VAOFactory.
+    //----------------------------------------------------------------------------------------------------------------------
+    std::unique_ptr<ngl::AbstractVAO> createVAO(size_t _primitive, UploadStats &io_stats) const;
+
+  private :
+    bool parseJson(const char *_begin, const char *_end);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief check every view and accessor lies inside the BIN chunk so nothing later reads past the mapping
+    //----------------------------------------------------------------------------------------------------------------------
+    bool validate() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the address of byte _offset of a buffer view in the mapping
+    //----------------------------------------------------------------------------------------------------------------------
+    const uchar *viewData(size_t _view, size_t _offset) const {return m_bin+m_views[_view].byteOffset+_offset;}
+    size_t stride(const Accessor &_accessor) const;
+    QFile m_file;
+    const uchar *m_map=nullptr;
+    const uchar *m_bin=nullptr;
+    size_t m_binSize=0;
+    std::vector<BufferView> m_views;
+    std::vector<Accessor> m_accessors;
+    std::vector<Primitive> m_primitives;
+};
+
+#endif
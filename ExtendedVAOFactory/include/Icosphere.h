@@ -0,0 +1,45 @@
+#ifndef ICOSPHERE_H_
+#define ICOSPHERE_H_
+
+#include "MultiBufferIndexVAO.h"
+#include <ngl/Vec3.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class Icosphere
+/// @brief builds an icosphere by splitting each triangle of the base icosahedron into 4, N times. The shared edge
+/// midpoints are found with a lock free hash table so each level runs in parallel across the faces. The lowest face
+/// index using an edge owns its midpoint and the new vertices are numbered in face order, so the result is the same
+/// regardless of thread count and matches makeIcosphere<N>() in IcosphereTable.h. All storage is sized for the final
+/// level up front so there are no allocations per level.
+//----------------------------------------------------------------------------------------------------------------------
+class Icosphere
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief build the icosphere
+    /// @param _levels the number of subdivisions, 0 is the icosahedron
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit Icosphere(unsigned int _levels);
+    static size_t vertexCount(unsigned int _levels);
+    static size_t faceCount(unsigned int _levels);
+    const std::vector<ngl::Vec3> &positions() const {return m_positions;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the base colours, new vertices take the average of the edge they split
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<ngl::Vec3> &colours() const {return m_colours;}
+    const std::vector<GLuint> &indices() const {return m_indices;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create a MultiBufferIndexVAO with positions as attribute 0 and colours as attribute 1
+    //----------------------------------------------------------------------------------------------------------------------
+    std::unique_ptr<MultiBufferIndexVAO> createVAO() const;
+
+  private :
+    std::vector<ngl::Vec3> m_positions;
+    std::vector<ngl::Vec3> m_colours;
+    std::vector<GLuint> m_indices;
+};
+
+#endif
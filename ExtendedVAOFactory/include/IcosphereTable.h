@@ -0,0 +1,201 @@
+#ifndef ICOSPHERETABLE_H_
+#define ICOSPHERETABLE_H_
+
+#include "ConstexprMath.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file IcosphereTable.h
+/// @brief compile time icosphere tables. Level 0 is the icosahedron from
+/// http://rbwhitaker.wikidot.com/index-and-vertex-buffers which each level splits every triangle into 4
+/// pushing the new edge midpoints out onto the sphere. Use as
+/// static constexpr auto ico = makeIcosphere<0>();
+/// and the tables are in the read only data of the executable ready to be passed to setData.
+//----------------------------------------------------------------------------------------------------------------------
+namespace icosahedron
+{
+  constexpr float c_radius = 0.5f;
+  constexpr std::array<cmath::Float3, 12> c_verts = {{{-0.26286500f, 0.0000000f, 0.42532500f},
+                                                      {0.26286500f, 0.0000000f, 0.42532500f},
+                                                      {-0.26286500f, 0.0000000f, -0.42532500f},
+                                                      {0.26286500f, 0.0000000f, -0.42532500f},
+                                                      {0.0000000f, 0.42532500f, 0.26286500f},
+                                                      {0.0000000f, 0.42532500f, -0.26286500f},
+                                                      {0.0000000f, -0.42532500f, 0.26286500f},
+                                                      {0.0000000f, -0.42532500f, -0.26286500f},
+                                                      {0.42532500f, 0.26286500f, 0.0000000f},
+                                                      {-0.42532500f, 0.26286500f, 0.0000000f},
+                                                      {0.42532500f, -0.26286500f, 0.0000000f},
+                                                      {-0.42532500f, -0.26286500f, 0.0000000f}}};
+  constexpr std::array<cmath::Float3, 12> c_colours = {{{1.0f, 0.0f, 0.0f},
+                                                        {1.0f, 0.55f, 0.0f},
+                                                        {1.0f, 0.0f, 1.0f},
+                                                        {0.0f, 1.0f, 0.0f},
+                                                        {0.0f, 0.0f, 1.0f},
+                                                        {0.29f, 0.51f, 0.0f},
+                                                        {0.5f, 0.0f, 0.5f},
+                                                        {1.0f, 1.0f, 1.0f},
+                                                        {0.0f, 1.0f, 1.0f},
+                                                        {0.0f, 0.0f, 0.0f},
+                                                        {0.12f, 0.56f, 1.0f},
+                                                        {0.86f, 0.08f, 0.24f}}};
+  constexpr std::array<uint16_t, 60> c_indices = {{0, 6, 1, 0, 11, 6, 1, 4, 0, 1, 8, 4, 1, 10, 8, 2, 5, 3,
+                                                   2, 9, 5, 2, 11, 9, 3, 7, 2, 3, 10, 7, 4, 8, 5, 4, 9, 0,
+                                                   5, 8, 3, 5, 9, 4, 6, 10, 1, 6, 11, 7, 7, 10, 6, 7, 11, 2,
+                                                   8, 10, 3, 9, 11, 0}};
+} // end namespace icosahedron
+
+constexpr size_t icosphereVertexCount(size_t _subdiv)
+{
+  return 10 * (size_t(1) << (2 * _subdiv)) + 2;
+}
+
+constexpr size_t icosphereFaceCount(size_t _subdiv)
+{
+  return 20 * (size_t(1) << (2 * _subdiv));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief GLushort indices while they fit, GLuint after that
+//----------------------------------------------------------------------------------------------------------------------
+template <size_t Subdiv>
+using IcosphereIndex = std::conditional_t<icosphereVertexCount(Subdiv) <= 65536, uint16_t, uint32_t>;
+
+template <size_t Subdiv>
+struct IcosphereMesh
+{
+  std::array<cmath::Float3, icosphereVertexCount(Subdiv)> positions;
+  std::array<cmath::Float3, icosphereVertexCount(Subdiv)> normals;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the base colours, new vertices take the average of the edge they split
+  //----------------------------------------------------------------------------------------------------------------------
+  std::array<cmath::Float3, icosphereVertexCount(Subdiv)> colours;
+  std::array<IcosphereIndex<Subdiv>, icosphereFaceCount(Subdiv) * 3> indices;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief working state for makeIcosphere. Each vertex of an icosphere has at most 6 neighbours so the midpoint
+/// of edge a,b is found by searching the (at most 6) edges already stored against min(a,b), this keeps the compile
+/// time cost linear in the number of faces.
+//----------------------------------------------------------------------------------------------------------------------
+template <size_t NumVerts>
+struct IcosphereBuilder
+{
+  std::array<cmath::Float3, NumVerts> positions{};
+  std::array<cmath::Float3, NumVerts> colours{};
+  std::array<std::array<uint32_t, 6>, NumVerts> neighbours{};
+  std::array<std::array<uint32_t, 6>, NumVerts> midpoints{};
+  std::array<uint32_t, NumVerts> numEdges{};
+  uint32_t numVerts = 0;
+
+  constexpr uint32_t midpoint(uint32_t _a, uint32_t _b)
+  {
+    uint32_t low = _a < _b ? _a : _b;
+    uint32_t high = _a < _b ? _b : _a;
+    for (uint32_t i = 0; i < numEdges[low]; ++i)
+    {
+      if (neighbours[low][i] == high)
+      {
+        return midpoints[low][i];
+      }
+    }
+    const auto &pa = positions[_a];
+    const auto &pb = positions[_b];
+    double x = 0.5 * (static_cast<double>(pa.x) + pb.x);
+    double y = 0.5 * (static_cast<double>(pa.y) + pb.y);
+    double z = 0.5 * (static_cast<double>(pa.z) + pb.z);
+    double scale = icosahedron::c_radius / cmath::sqrt(x * x + y * y + z * z);
+    positions[numVerts] = {static_cast<float>(x * scale), static_cast<float>(y * scale), static_cast<float>(z * scale)};
+    const auto &ca = colours[_a];
+    const auto &cb = colours[_b];
+    colours[numVerts] = {0.5f * (ca.x + cb.x), 0.5f * (ca.y + cb.y), 0.5f * (ca.z + cb.z)};
+    neighbours[low][numEdges[low]] = high;
+    midpoints[low][numEdges[low]] = numVerts;
+    ++numEdges[low];
+    return numVerts++;
+  }
+};
+
+template <size_t Subdiv>
+constexpr IcosphereMesh<Subdiv> makeIcosphere()
+{
+  constexpr size_t numVerts = icosphereVertexCount(Subdiv);
+  constexpr size_t numIndices = icosphereFaceCount(Subdiv) * 3;
+  IcosphereBuilder<numVerts> builder;
+  for (size_t i = 0; i < 12; ++i)
+  {
+    builder.positions[i] = icosahedron::c_verts[i];
+    builder.colours[i] = icosahedron::c_colours[i];
+  }
+  builder.numVerts = 12;
+
+  std::array<uint32_t, numIndices> current{};
+  std::array<uint32_t, numIndices> next{};
+  for (size_t i = 0; i < icosahedron::c_indices.size(); ++i)
+  {
+    current[i] = icosahedron::c_indices[i];
+  }
+  size_t numFaces = 20;
+  for (size_t level = 0; level < Subdiv; ++level)
+  {
+    // edges are only shared within a level so start each one with an empty edge table
+    for (size_t v = 0; v < builder.numVerts; ++v)
+    {
+      builder.numEdges[v] = 0;
+    }
+    for (size_t f = 0; f < numFaces; ++f)
+    {
+      uint32_t a = current[f * 3];
+      uint32_t b = current[f * 3 + 1];
+      uint32_t c = current[f * 3 + 2];
+      uint32_t ab = builder.midpoint(a, b);
+      uint32_t bc = builder.midpoint(b, c);
+      uint32_t ca = builder.midpoint(c, a);
+      // the 4 children keep the winding of the parent
+      uint32_t children[12] = {a, ab, ca, ab, b, bc, ca, bc, c, ab, bc, ca};
+      for (size_t i = 0; i < 12; ++i)
+      {
+        next[f * 12 + i] = children[i];
+      }
+    }
+    numFaces *= 4;
+    for (size_t i = 0; i < numFaces * 3; ++i)
+    {
+      current[i] = next[i];
+    }
+  }
+
+  IcosphereMesh<Subdiv> mesh{};
+  for (size_t i = 0; i < numVerts; ++i)
+  {
+    const auto &p = builder.positions[i];
+    mesh.positions[i] = p;
+    mesh.normals[i] = {p.x / icosahedron::c_radius, p.y / icosahedron::c_radius, p.z / icosahedron::c_radius};
+    mesh.colours[i] = builder.colours[i];
+  }
+  for (size_t i = 0; i < numIndices; ++i)
+  {
+    mesh.indices[i] = static_cast<IcosphereIndex<Subdiv>>(current[i]);
+  }
+  return mesh;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief interleave two tables as a,b,a,b... for single buffer VAO's
+//----------------------------------------------------------------------------------------------------------------------
+template <size_t N>
+constexpr std::array<cmath::Float3, N * 2> interleave(const std::array<cmath::Float3, N> &_a, const std::array<cmath::Float3, N> &_b)
+{
+  std::array<cmath::Float3, N * 2> data{};
+  for (size_t i = 0; i < N; ++i)
+  {
+    data[i * 2] = _a[i];
+    data[i * 2 + 1] = _b[i];
+  }
+  return data;
+}
+
+#endif
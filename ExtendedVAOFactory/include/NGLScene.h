@@ -4,9 +4,12 @@
 #include <ngl/Mat4.h>
 #include <ngl/Vec3.h>
 #include "WindowParams.h"
+#include "UniformHandle.h"
 #include "MultiBufferIndexVAO.h"
 #include <QOpenGLWindow>
 #include <memory>
+#include <string>
+#include <vector>
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @file NGLScene.h
@@ -26,9 +29,10 @@ class NGLScene : public QOpenGLWindow
   public:
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief ctor for our NGL drawing class
-    /// @param [in] parent the parent window to the class
+    /// @param [in] _glbFile a binary glTF file drawn in place of the middle icosphere, the icosphere is drawn if this is
+    /// empty or can't be read
     //----------------------------------------------------------------------------------------------------------------------
-    NGLScene();
+    NGLScene(const std::string &_glbFile="");
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief dtor must close down ngl and release OpenGL resources
     //----------------------------------------------------------------------------------------------------------------------
@@ -69,6 +73,10 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     std::unique_ptr<MultiBufferIndexVAO> m_vao;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the MVP uniform of the shader, found once after linking
+    //----------------------------------------------------------------------------------------------------------------------
+    UniformHandle m_MVPUniform;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief Qt Event called when a key is pressed
     /// @param [in] _event the Qt event to query for size etc
     //----------------------------------------------------------------------------------------------------------------------
@@ -101,6 +109,26 @@ private:
     /// @brief build our VAO
     //----------------------------------------------------------------------------------------------------------------------
     void buildVAO();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief (re)build the middle icosphere at m_level
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildIcosphere();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the subdivided icosphere drawn in the middle, + and - change the level
+    //----------------------------------------------------------------------------------------------------------------------
+    std::unique_ptr<MultiBufferIndexVAO> m_icosphere;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief load m_glbFile into m_glb, a VAO per primitive
+    /// @returns false if it couldn't be read
+    //----------------------------------------------------------------------------------------------------------------------
+    bool buildGlb();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the glTF file, its primitives and the transform fitting them in a unit box
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string m_glbFile;
+    std::vector<std::unique_ptr<ngl::AbstractVAO>> m_glb;
+    ngl::Mat4 m_modelTX;
+    unsigned int m_level=3;
     int m_index=0;
     bool m_animate=true;
     void timerEvent(QTimerEvent *) override;
@@ -0,0 +1,1040 @@
+#include "GlbFile.h"
+#include "JobSystem.h"
+#include "MultiBufferIndexVAO.h"
+#include <ngl/VAOFactory.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#include <emmintrin.h>
+#define GLBFILE_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GLBFILE_NEON 1
+#endif
+
+namespace
+{
+  constexpr uint32_t c_magic=0x46546C67;
+  constexpr uint32_t c_jsonChunk=0x4E4F534A;
+  constexpr uint32_t c_binChunk=0x004E4942;
+  constexpr size_t c_headerSize=12;
+  constexpr size_t c_chunkHeaderSize=8;
+  // below this many elements in a chunk it isn't worth queuing a job
+  constexpr size_t c_minElementsPerChunk=16384;
+  // colour for a primitive with neither colours nor normals
+  constexpr float c_defaultColour=0.8f;
+
+  // glb is little endian as are the machines this runs on
+  uint32_t read32(const uchar *_p)
+  {
+    uint32_t value;
+    std::memcpy(&value,_p,sizeof(value));
+    return value;
+  }
+
+  bool fits(size_t _offset, size_t _size, size_t _limit)
+  {
+    return _offset<=_limit && _size<=_limit-_offset;
+  }
+
+  size_t componentSize(GLenum _type)
+  {
+    switch(_type)
+    {
+      case GL_BYTE : case GL_UNSIGNED_BYTE : return 1;
+      case GL_SHORT : case GL_UNSIGNED_SHORT : return 2;
+      case GL_UNSIGNED_INT : case GL_FLOAT : return 4;
+      default : return 0;
+    }
+  }
+
+  bool isIndexType(GLenum _type)
+  {
+    return _type==GL_UNSIGNED_BYTE || _type==GL_UNSIGNED_SHORT || _type==GL_UNSIGNED_INT;
+  }
+
+  uint32_t readIndex(const uchar *_p, GLenum _type)
+  {
+    switch(_type)
+    {
+      case GL_UNSIGNED_BYTE : return *_p;
+      case GL_UNSIGNED_SHORT : {uint16_t v; std::memcpy(&v,_p,sizeof(v)); return v;}
+      default : return read32(_p);
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief just enough JSON for the glTF header, objects keep their keys in order next to the values
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Json
+  {
+    enum class Type {Null,Bool,Number,String,Array,Object};
+    Type type=Type::Null;
+    bool boolean=false;
+    double number=0.0;
+    std::string string;
+    std::vector<Json> items;
+    std::vector<std::string> keys;
+    const Json *find(const char *_key) const
+    {
+      for(size_t i=0; i<keys.size(); ++i)
+      {
+        if(keys[i]==_key)
+        {
+          return &items[i];
+        }
+      }
+      return nullptr;
+    }
+    size_t size(const char *_key, size_t _default) const
+    {
+      const Json *value=find(_key);
+      return value!=nullptr && value->type==Type::Number && value->number>=0.0 && value->number<9.0e15 ?
+            static_cast<size_t>(value->number) : _default;
+    }
+    const Json *array(const char *_key) const
+    {
+      const Json *value=find(_key);
+      return value!=nullptr && value->type==Type::Array ? value : nullptr;
+    }
+  };
+
+  class JsonParser
+  {
+    public :
+      JsonParser(const char *_begin, const char *_end) : m_p(_begin), m_end(_end) {}
+      bool parse(Json &o_value)
+      {
+        if(!value(o_value,0))
+        {
+          return false;
+        }
+        // the chunk is padded to 4 bytes with spaces
+        skipSpace();
+        while(m_p<m_end && *m_p=='\0')
+        {
+          ++m_p;
+        }
+        return m_p==m_end;
+      }
+
+    private :
+      static constexpr int c_maxDepth=64;
+      void skipSpace()
+      {
+        while(m_p<m_end && (*m_p==' ' || *m_p=='\t' || *m_p=='\n' || *m_p=='\r'))
+        {
+          ++m_p;
+        }
+      }
+      bool literal(const char *_word)
+      {
+        size_t length=std::strlen(_word);
+        if(static_cast<size_t>(m_end-m_p)<length || std::strncmp(m_p,_word,length)!=0)
+        {
+          return false;
+        }
+        m_p+=length;
+        return true;
+      }
+      bool value(Json &o_value, int _depth)
+      {
+        skipSpace();
+        if(m_p==m_end || _depth>c_maxDepth)
+        {
+          return false;
+        }
+        switch(*m_p)
+        {
+          case '{' : return object(o_value,_depth);
+          case '[' : return array(o_value,_depth);
+          case '"' : o_value.type=Json::Type::String; return string(o_value.string);
+          case 't' : o_value.type=Json::Type::Bool; o_value.boolean=true; return literal("true");
+          case 'f' : o_value.type=Json::Type::Bool; return literal("false");
+          case 'n' : return literal("null");
+          default : o_value.type=Json::Type::Number; return number(o_value.number);
+        }
+      }
+      bool object(Json &o_value, int _depth)
+      {
+        o_value.type=Json::Type::Object;
+        ++m_p;
+        skipSpace();
+        if(m_p<m_end && *m_p=='}')
+        {
+          ++m_p;
+          return true;
+        }
+        while(true)
+        {
+          skipSpace();
+          o_value.keys.emplace_back();
+          o_value.items.emplace_back();
+          if(m_p==m_end || *m_p!='"' || !string(o_value.keys.back()))
+          {
+            return false;
+          }
+          skipSpace();
+          if(m_p==m_end || *m_p++!=':' || !value(o_value.items.back(),_depth+1))
+          {
+            return false;
+          }
+          skipSpace();
+          if(m_p==m_end)
+          {
+            return false;
+          }
+          char c=*m_p++;
+          if(c=='}')
+          {
+            return true;
+          }
+          if(c!=',')
+          {
+            return false;
+          }
+        }
+      }
+      bool array(Json &o_value, int _depth)
+      {
+        o_value.type=Json::Type::Array;
+        ++m_p;
+        skipSpace();
+        if(m_p<m_end && *m_p==']')
+        {
+          ++m_p;
+          return true;
+        }
+        while(true)
+        {
+          o_value.items.emplace_back();
+          if(!value(o_value.items.back(),_depth+1))
+          {
+            return false;
+          }
+          skipSpace();
+          if(m_p==m_end)
+          {
+            return false;
+          }
+          char c=*m_p++;
+          if(c==']')
+          {
+            return true;
+          }
+          if(c!=',')
+          {
+            return false;
+          }
+        }
+      }
+      bool hex4(uint32_t &o_code)
+      {
+        if(m_end-m_p<4)
+        {
+          return false;
+        }
+        o_code=0;
+        for(int i=0; i<4; ++i)
+        {
+          char c=*m_p++;
+          o_code<<=4;
+          if(c>='0' && c<='9') o_code|=static_cast<uint32_t>(c-'0');
+          else if(c>='a' && c<='f') o_code|=static_cast<uint32_t>(c-'a'+10);
+          else if(c>='A' && c<='F') o_code|=static_cast<uint32_t>(c-'A'+10);
+          else return false;
+        }
+        return true;
+      }
+      bool string(std::string &o_string)
+      {
+        ++m_p;
+        while(m_p<m_end)
+        {
+          char c=*m_p++;
+          if(c=='"')
+          {
+            return true;
+          }
+          if(c!='\\')
+          {
+            o_string+=c;
+            continue;
+          }
+          if(m_p==m_end)
+          {
+            return false;
+          }
+          switch(*m_p++)
+          {
+            case '"' : o_string+='"'; break;
+            case '\\' : o_string+='\\'; break;
+            case '/' : o_string+='/'; break;
+            case 'b' : o_string+='\b'; break;
+            case 'f' : o_string+='\f'; break;
+            case 'n' : o_string+='\n'; break;
+            case 'r' : o_string+='\r'; break;
+            case 't' : o_string+='\t'; break;
+            case 'u' :
+            {
+              uint32_t code;
+              if(!hex4(code))
+              {
+                return false;
+              }
+              // a high surrogate should be followed by the low one
+              uint32_t low;
+              if(code>=0xD800 && code<0xDC00 && m_end-m_p>=6 && m_p[0]=='\\' && m_p[1]=='u')
+              {
+                m_p+=2;
+                if(!hex4(low) || low<0xDC00 || low>=0xE000)
+                {
+                  return false;
+                }
+                code=0x10000+((code-0xD800)<<10)+(low-0xDC00);
+              }
+              // utf-8
+              if(code<0x80)
+              {
+                o_string+=static_cast<char>(code);
+              }
+              else if(code<0x800)
+              {
+                o_string+=static_cast<char>(0xC0 | (code>>6));
+                o_string+=static_cast<char>(0x80 | (code & 0x3F));
+              }
+              else if(code<0x10000)
+              {
+                o_string+=static_cast<char>(0xE0 | (code>>12));
+                o_string+=static_cast<char>(0x80 | ((code>>6) & 0x3F));
+                o_string+=static_cast<char>(0x80 | (code & 0x3F));
+              }
+              else
+              {
+                o_string+=static_cast<char>(0xF0 | (code>>18));
+                o_string+=static_cast<char>(0x80 | ((code>>12) & 0x3F));
+                o_string+=static_cast<char>(0x80 | ((code>>6) & 0x3F));
+                o_string+=static_cast<char>(0x80 | (code & 0x3F));
+              }
+              break;
+            }
+            default : return false;
+          }
+        }
+        return false;
+      }
+      bool number(double &o_number)
+      {
+        // the chunk isn't null terminated so copy the number out for strtod
+        char text[64];
+        size_t length=0;
+        while(m_p<m_end && length<sizeof(text)-1 && (std::strchr("0123456789+-.eE",*m_p)!=nullptr && *m_p!='\0'))
+        {
+          text[length++]=*m_p++;
+        }
+        text[length]='\0';
+        char *end;
+        o_number=std::strtod(text,&end);
+        return length>0 && end==text+length;
+      }
+      const char *m_p;
+      const char *m_end;
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert _count integers of type T to float, scaled and clamped for normalised signed types as glTF says
+  //----------------------------------------------------------------------------------------------------------------------
+  template<typename T>
+  void convertScalar(const uchar *_src, size_t _count, float _scale, bool _clamp, float *o_dst)
+  {
+    for(size_t i=0; i<_count; ++i)
+    {
+      T value;
+      std::memcpy(&value,_src+i*sizeof(T),sizeof(T));
+      float f=static_cast<float>(value)*_scale;
+      o_dst[i]=_clamp ? std::max(f,-1.0f) : f;
+    }
+  }
+
+#if defined(GLBFILE_SSE2)
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert 8 16 bit integers to float, sign or zero extending to 32 bits first
+  //----------------------------------------------------------------------------------------------------------------------
+  void storeWords(__m128i _words, bool _signed, __m128 _scale, bool _clamp, float *o_dst)
+  {
+    __m128i lo;
+    __m128i hi;
+    if(_signed)
+    {
+      lo=_mm_srai_epi32(_mm_unpacklo_epi16(_words,_words),16);
+      hi=_mm_srai_epi32(_mm_unpackhi_epi16(_words,_words),16);
+    }
+    else
+    {
+      lo=_mm_unpacklo_epi16(_words,_mm_setzero_si128());
+      hi=_mm_unpackhi_epi16(_words,_mm_setzero_si128());
+    }
+    __m128 f0=_mm_mul_ps(_mm_cvtepi32_ps(lo),_scale);
+    __m128 f1=_mm_mul_ps(_mm_cvtepi32_ps(hi),_scale);
+    if(_clamp)
+    {
+      f0=_mm_max_ps(f0,_mm_set1_ps(-1.0f));
+      f1=_mm_max_ps(f1,_mm_set1_ps(-1.0f));
+    }
+    _mm_storeu_ps(o_dst,f0);
+    _mm_storeu_ps(o_dst+4,f1);
+  }
+
+  // each returns how many it converted, the scalar code does the rest
+  size_t convertBytes(const uchar *_src, size_t _count, bool _signed, float _scale, bool _clamp, float *o_dst)
+  {
+    __m128 scale=_mm_set1_ps(_scale);
+    size_t i=0;
+    for(; i+16<=_count; i+=16)
+    {
+      __m128i bytes=_mm_loadu_si128(reinterpret_cast<const __m128i *>(_src+i));
+      if(_signed)
+      {
+        storeWords(_mm_srai_epi16(_mm_unpacklo_epi8(bytes,bytes),8),true,scale,_clamp,o_dst+i);
+        storeWords(_mm_srai_epi16(_mm_unpackhi_epi8(bytes,bytes),8),true,scale,_clamp,o_dst+i+8);
+      }
+      else
+      {
+        storeWords(_mm_unpacklo_epi8(bytes,_mm_setzero_si128()),false,scale,_clamp,o_dst+i);
+        storeWords(_mm_unpackhi_epi8(bytes,_mm_setzero_si128()),false,scale,_clamp,o_dst+i+8);
+      }
+    }
+    return i;
+  }
+
+  size_t convertShorts(const uchar *_src, size_t _count, bool _signed, float _scale, bool _clamp, float *o_dst)
+  {
+    __m128 scale=_mm_set1_ps(_scale);
+    size_t i=0;
+    for(; i+8<=_count; i+=8)
+    {
+      storeWords(_mm_loadu_si128(reinterpret_cast<const __m128i *>(_src+i*2)),_signed,scale,_clamp,o_dst+i);
+    }
+    return i;
+  }
+#elif defined(GLBFILE_NEON)
+  void storeWords(int16x8_t _words, float32x4_t _scale, bool _clamp, float *o_dst)
+  {
+    float32x4_t f0=vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(_words))),_scale);
+    float32x4_t f1=vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(_words))),_scale);
+    if(_clamp)
+    {
+      f0=vmaxq_f32(f0,vdupq_n_f32(-1.0f));
+      f1=vmaxq_f32(f1,vdupq_n_f32(-1.0f));
+    }
+    vst1q_f32(o_dst,f0);
+    vst1q_f32(o_dst+4,f1);
+  }
+
+  void storeWords(uint16x8_t _words, float32x4_t _scale, float *o_dst)
+  {
+    vst1q_f32(o_dst,vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(_words))),_scale));
+    vst1q_f32(o_dst+4,vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(_words))),_scale));
+  }
+
+  size_t convertBytes(const uchar *_src, size_t _count, bool _signed, float _scale, bool _clamp, float *o_dst)
+  {
+    float32x4_t scale=vdupq_n_f32(_scale);
+    size_t i=0;
+    for(; i+16<=_count; i+=16)
+    {
+      if(_signed)
+      {
+        int8x16_t bytes=vld1q_s8(reinterpret_cast<const int8_t *>(_src+i));
+        storeWords(vmovl_s8(vget_low_s8(bytes)),scale,_clamp,o_dst+i);
+        storeWords(vmovl_s8(vget_high_s8(bytes)),scale,_clamp,o_dst+i+8);
+      }
+      else
+      {
+        uint8x16_t bytes=vld1q_u8(_src+i);
+        storeWords(vmovl_u8(vget_low_u8(bytes)),scale,o_dst+i);
+        storeWords(vmovl_u8(vget_high_u8(bytes)),scale,o_dst+i+8);
+      }
+    }
+    return i;
+  }
+
+  size_t convertShorts(const uchar *_src, size_t _count, bool _signed, float _scale, bool _clamp, float *o_dst)
+  {
+    float32x4_t scale=vdupq_n_f32(_scale);
+    size_t i=0;
+    for(; i+8<=_count; i+=8)
+    {
+      if(_signed)
+      {
+        storeWords(vreinterpretq_s16_u8(vld1q_u8(_src+i*2)),scale,_clamp,o_dst+i);
+      }
+      else
+      {
+        storeWords(vreinterpretq_u16_u8(vld1q_u8(_src+i*2)),scale,o_dst+i);
+      }
+    }
+    return i;
+  }
+#else
+  size_t convertBytes(const uchar *, size_t, bool, float, bool, float *) {return 0;}
+  size_t convertShorts(const uchar *, size_t, bool, float, bool, float *) {return 0;}
+#endif
+
+  template<typename T>
+  float normalisedScale(bool _normalized)
+  {
+    return _normalized ? 1.0f/static_cast<float>(std::numeric_limits<T>::max()) : 1.0f;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert _count packed components to float
+  //----------------------------------------------------------------------------------------------------------------------
+  void convertPacked(const uchar *_src, size_t _count, GLenum _type, bool _normalized, float *o_dst)
+  {
+    size_t done=0;
+    switch(_type)
+    {
+      case GL_FLOAT :
+        std::memcpy(o_dst,_src,_count*sizeof(float));
+      break;
+      case GL_UNSIGNED_BYTE :
+      {
+        float scale=normalisedScale<uint8_t>(_normalized);
+        done=convertBytes(_src,_count,false,scale,false,o_dst);
+        convertScalar<uint8_t>(_src+done,_count-done,scale,false,o_dst+done);
+      }
+      break;
+      case GL_BYTE :
+      {
+        float scale=normalisedScale<int8_t>(_normalized);
+        done=convertBytes(_src,_count,true,scale,_normalized,o_dst);
+        convertScalar<int8_t>(_src+done,_count-done,scale,_normalized,o_dst+done);
+      }
+      break;
+      case GL_UNSIGNED_SHORT :
+      {
+        float scale=normalisedScale<uint16_t>(_normalized);
+        done=convertShorts(_src,_count,false,scale,false,o_dst);
+        convertScalar<uint16_t>(_src+done*2,_count-done,scale,false,o_dst+done);
+      }
+      break;
+      case GL_SHORT :
+      {
+        float scale=normalisedScale<int16_t>(_normalized);
+        done=convertShorts(_src,_count,true,scale,_normalized,o_dst);
+        convertScalar<int16_t>(_src+done*2,_count-done,scale,_normalized,o_dst+done);
+      }
+      break;
+      default :
+        convertScalar<uint32_t>(_src,_count,normalisedScale<uint32_t>(_normalized),false,o_dst);
+      break;
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief GLubyte indices to GLushort
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<GLushort> widenIndices(const uchar *_src, size_t _count)
+  {
+    std::vector<GLushort> indices(_count);
+    size_t i=0;
+#if defined(GLBFILE_SSE2)
+    for(; i+16<=_count; i+=16)
+    {
+      __m128i bytes=_mm_loadu_si128(reinterpret_cast<const __m128i *>(_src+i));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(&indices[i]),_mm_unpacklo_epi8(bytes,_mm_setzero_si128()));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(&indices[i+8]),_mm_unpackhi_epi8(bytes,_mm_setzero_si128()));
+    }
+#elif defined(GLBFILE_NEON)
+    for(; i+16<=_count; i+=16)
+    {
+      uint8x16_t bytes=vld1q_u8(_src+i);
+      vst1q_u16(&indices[i],vmovl_u8(vget_low_u8(bytes)));
+      vst1q_u16(&indices[i+8],vmovl_u8(vget_high_u8(bytes)));
+    }
+#endif
+    for(; i<_count; ++i)
+    {
+      indices[i]=_src[i];
+    }
+    return indices;
+  }
+}
+
+size_t GlbFile::Accessor::componentSize() const
+{
+  return ::componentSize(componentType);
+}
+
+GlbFile::~GlbFile()
+{
+  close();
+}
+
+void GlbFile::close()
+{
+  if(m_map!=nullptr)
+  {
+    m_file.unmap(const_cast<uchar *>(m_map));
+  }
+  m_file.close();
+  m_map=nullptr;
+  m_bin=nullptr;
+  m_binSize=0;
+  m_views.clear();
+  m_accessors.clear();
+  m_primitives.clear();
+}
+
+bool GlbFile::open(const std::string &_fname)
+{
+  close();
+  m_file.setFileName(QString::fromStdString(_fname));
+  if(!m_file.open(QIODevice::ReadOnly))
+  {
+    std::cerr<<"Unable to open "<<_fname<<'\n';
+    return false;
+  }
+  auto size=static_cast<size_t>(m_file.size());
+  m_map=size>=c_headerSize+c_chunkHeaderSize ? m_file.map(0,m_file.size()) : nullptr;
+  auto fail=[this,&_fname](const char *_why)
+  {
+    std::cerr<<"GlbFile "<<_why<<" in "<<_fname<<'\n';
+    close();
+    return false;
+  };
+  if(m_map==nullptr)
+  {
+    return fail("can't map the file or it is too short");
+  }
+  if(read32(m_map)!=c_magic || read32(m_map+4)!=2)
+  {
+    return fail("isn't glTF 2.0 binary");
+  }
+  size_t length=std::min<size_t>(read32(m_map+8),size);
+  size_t jsonSize=read32(m_map+c_headerSize);
+  if(read32(m_map+c_headerSize+4)!=c_jsonChunk || !fits(c_headerSize+c_chunkHeaderSize,jsonSize,length))
+  {
+    return fail("has no JSON chunk");
+  }
+  auto json=reinterpret_cast<const char *>(m_map+c_headerSize+c_chunkHeaderSize);
+  // the BIN chunk is optional and follows the JSON, anything after it is an extension
+  size_t bin=c_headerSize+c_chunkHeaderSize+jsonSize;
+  if(fits(bin,c_chunkHeaderSize,length) && read32(m_map+bin+4)==c_binChunk)
+  {
+    m_binSize=read32(m_map+bin);
+    if(!fits(bin+c_chunkHeaderSize,m_binSize,length))
+    {
+      return fail("has a truncated BIN chunk");
+    }
+    m_bin=m_map+bin+c_chunkHeaderSize;
+  }
+  if(!parseJson(json,json+jsonSize) || !validate())
+  {
+    std::cerr<<" in "<<_fname<<'\n';
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool GlbFile::parseJson(const char *_begin, const char *_end)
+{
+  Json root;
+  if(!JsonParser(_begin,_end).parse(root) || root.type!=Json::Type::Object)
+  {
+    std::cerr<<"GlbFile has malformed JSON";
+    return false;
+  }
+  if(const Json *buffers=root.array("buffers"))
+  {
+    // only the BIN chunk, buffer 0 without a uri
+    if(buffers->items.size()>1 || (!buffers->items.empty() && buffers->items[0].find("uri")!=nullptr))
+    {
+      std::cerr<<"GlbFile only supports the BIN chunk buffer";
+      return false;
+    }
+  }
+  if(const Json *views=root.array("bufferViews"))
+  {
+    for(const Json &v : views->items)
+    {
+      if(v.size("buffer",1)!=0)
+      {
+        std::cerr<<"GlbFile has a buffer view outside the BIN chunk";
+        return false;
+      }
+      m_views.push_back({v.size("byteOffset",0),v.size("byteLength",0),v.size("byteStride",0)});
+    }
+  }
+  if(const Json *accessors=root.array("accessors"))
+  {
+    for(const Json &a : accessors->items)
+    {
+      Accessor accessor;
+      accessor.bufferView=a.size("bufferView",c_none);
+      accessor.byteOffset=a.size("byteOffset",0);
+      accessor.count=a.size("count",0);
+      accessor.componentType=static_cast<GLenum>(a.size("componentType",0));
+      const Json *type=a.find("type");
+      const char *names[]={"SCALAR","VEC2","VEC3","VEC4","MAT2","MAT3","MAT4"};
+      const size_t components[]={1,2,3,4,4,9,16};
+      accessor.components=0;
+      for(size_t i=0; i<7 && type!=nullptr; ++i)
+      {
+        accessor.components= type->string==names[i] ? components[i] : accessor.components;
+      }
+      const Json *normalized=a.find("normalized");
+      accessor.normalized=normalized!=nullptr && normalized->boolean;
+      const Json *min=a.array("min");
+      const Json *max=a.array("max");
+      if(min!=nullptr && max!=nullptr && min->items.size()>=3 && max->items.size()>=3)
+      {
+        accessor.hasBounds=true;
+        for(size_t i=0; i<3; ++i)
+        {
+          accessor.min[i]=static_cast<float>(min->items[i].number);
+          accessor.max[i]=static_cast<float>(max->items[i].number);
+        }
+      }
+      if(const Json *sparse=a.find("sparse"))
+      {
+        const Json *indices=sparse->find("indices");
+        const Json *values=sparse->find("values");
+        if(indices==nullptr || values==nullptr)
+        {
+          std::cerr<<"GlbFile has a sparse accessor without indices or values";
+          return false;
+        }
+        accessor.sparseCount=sparse->size("count",0);
+        accessor.sparseIndicesView=indices->size("bufferView",c_none);
+        accessor.sparseIndicesOffset=indices->size("byteOffset",0);
+        accessor.sparseIndexType=static_cast<GLenum>(indices->size("componentType",0));
+        accessor.sparseValuesView=values->size("bufferView",c_none);
+        accessor.sparseValuesOffset=values->size("byteOffset",0);
+      }
+      m_accessors.push_back(accessor);
+    }
+  }
+  if(const Json *meshes=root.array("meshes"))
+  {
+    for(const Json &mesh : meshes->items)
+    {
+      const Json *primitives=mesh.array("primitives");
+      for(size_t i=0; primitives!=nullptr && i<primitives->items.size(); ++i)
+      {
+        const Json &p=primitives->items[i];
+        const Json *attributes=p.find("attributes");
+        if(attributes==nullptr || attributes->find("POSITION")==nullptr)
+        {
+          continue;
+        }
+        Primitive primitive;
+        primitive.position=attributes->size("POSITION",c_none);
+        primitive.normal=attributes->size("NORMAL",c_none);
+        primitive.colour=attributes->size("COLOR_0",c_none);
+        primitive.indices=p.size("indices",c_none);
+        primitive.mode=static_cast<GLenum>(p.size("mode",GL_TRIANGLES));
+        m_primitives.push_back(primitive);
+      }
+    }
+  }
+  return true;
+}
+
+bool GlbFile::validate() const
+{
+  for(const auto &view : m_views)
+  {
+    if(!fits(view.byteOffset,view.byteLength,m_binSize) || (view.byteStride!=0 && (view.byteStride<4 || view.byteStride>252)))
+    {
+      std::cerr<<"GlbFile has a buffer view outside the BIN chunk";
+      return false;
+    }
+  }
+  // the bytes count elements of _size, _stride apart, need from _offset in _view
+  auto inView=[this](size_t _view, size_t _offset, size_t _count, size_t _stride, size_t _size)
+  {
+    if(_view>=m_views.size())
+    {
+      return false;
+    }
+    size_t limit=m_views[_view].byteLength;
+    return _count==0 || (_count-1<=limit/std::max<size_t>(_stride,1) && fits(_offset,(_count-1)*_stride+_size,limit));
+  };
+  for(const auto &accessor : m_accessors)
+  {
+    if(accessor.componentSize()==0 || accessor.components==0 || accessor.count==0)
+    {
+      std::cerr<<"GlbFile has an empty accessor or one of unknown type";
+      return false;
+    }
+    if(accessor.bufferView!=c_none && !inView(accessor.bufferView,accessor.byteOffset,accessor.count,stride(accessor),accessor.elementSize()))
+    {
+      std::cerr<<"GlbFile has an accessor outside its buffer view";
+      return false;
+    }
+    if(accessor.sparseCount!=0 &&
+       (!isIndexType(accessor.sparseIndexType) ||
+        !inView(accessor.sparseIndicesView,accessor.sparseIndicesOffset,accessor.sparseCount,::componentSize(accessor.sparseIndexType),::componentSize(accessor.sparseIndexType)) ||
+        !inView(accessor.sparseValuesView,accessor.sparseValuesOffset,accessor.sparseCount,accessor.elementSize(),accessor.elementSize())))
+    {
+      std::cerr<<"GlbFile has a sparse accessor outside its buffer views";
+      return false;
+    }
+  }
+  auto isAccessor=[this](size_t _accessor, size_t _minComponents, size_t _maxComponents)
+  {
+    return _accessor==c_none ||
+           (_accessor<m_accessors.size() && m_accessors[_accessor].components>=_minComponents && m_accessors[_accessor].components<=_maxComponents);
+  };
+  for(const auto &primitive : m_primitives)
+  {
+    if(!isAccessor(primitive.position,3,3) || !isAccessor(primitive.normal,3,3) || !isAccessor(primitive.colour,3,4) ||
+       !isAccessor(primitive.indices,1,1) || primitive.mode>GL_TRIANGLE_FAN)
+    {
+      std::cerr<<"GlbFile has a primitive with a missing or mistyped accessor";
+      return false;
+    }
+    if(primitive.indices!=c_none)
+    {
+      const Accessor &indices=m_accessors[primitive.indices];
+      if(!isIndexType(indices.componentType) || (indices.bufferView!=c_none && m_views[indices.bufferView].byteStride!=0))
+      {
+        std::cerr<<"GlbFile has indices that aren't packed unsigned integers";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+size_t GlbFile::stride(const Accessor &_accessor) const
+{
+  size_t viewStride= _accessor.bufferView!=c_none ? m_views[_accessor.bufferView].byteStride : 0;
+  return viewStride!=0 ? viewStride : _accessor.elementSize();
+}
+
+bool GlbFile::inPlace(size_t _accessor) const
+{
+  const Accessor &accessor=m_accessors[_accessor];
+  size_t size=accessor.componentSize();
+  return accessor.sparseCount==0 && accessor.bufferView!=c_none && accessor.count!=0 &&
+         accessor.byteOffset%size==0 && m_views[accessor.bufferView].byteOffset%size==0 && stride(accessor)%4==0;
+}
+
+std::vector<float> GlbFile::convert(size_t _accessor) const
+{
+  const Accessor &accessor=m_accessors[_accessor];
+  // matrices of bytes or shorts have padded columns, nothing here converts one
+  std::vector<float> values(accessor.count*accessor.components,0.0f);
+  if(accessor.bufferView!=c_none && accessor.count!=0)
+  {
+    const uchar *src=viewData(accessor.bufferView,accessor.byteOffset);
+    size_t srcStride=stride(accessor);
+    size_t elementSize=accessor.elementSize();
+    auto &jobs=JobSystem::instance();
+    jobs.parallelFor(accessor.count,jobs.chunksFor(accessor.count,c_minElementsPerChunk),[&](size_t,size_t _begin,size_t _end)
+    {
+      float *dst=&values[_begin*accessor.components];
+      if(srcStride==elementSize)
+      {
+        convertPacked(src+_begin*elementSize,(_end-_begin)*accessor.components,accessor.componentType,accessor.normalized,dst);
+        return;
+      }
+      // interleaved, a few components at a time
+      for(size_t i=_begin; i<_end; ++i)
+      {
+        convertPacked(src+i*srcStride,accessor.components,accessor.componentType,accessor.normalized,dst);
+        dst+=accessor.components;
+      }
+    });
+  }
+  if(accessor.sparseCount!=0)
+  {
+    const uchar *indices=viewData(accessor.sparseIndicesView,accessor.sparseIndicesOffset);
+    const uchar *replacements=viewData(accessor.sparseValuesView,accessor.sparseValuesOffset);
+    size_t indexSize=::componentSize(accessor.sparseIndexType);
+    for(size_t i=0; i<accessor.sparseCount; ++i)
+    {
+      size_t element=readIndex(indices+i*indexSize,accessor.sparseIndexType);
+      if(element<accessor.count)
+      {
+        convertPacked(replacements+i*accessor.elementSize(),accessor.components,accessor.componentType,accessor.normalized,
+                      &values[element*accessor.components]);
+      }
+    }
+  }
+  return values;
+}
+
+void GlbFile::bounds(float o_min[3], float o_max[3]) const
+{
+  for(size_t i=0; i<3; ++i)
+  {
+    o_min[i]=std::numeric_limits<float>::max();
+    o_max[i]=-std::numeric_limits<float>::max();
+  }
+  for(const auto &primitive : m_primitives)
+  {
+    const Accessor &accessor=m_accessors[primitive.position];
+    if(accessor.hasBounds && accessor.sparseCount==0)
+    {
+      for(size_t i=0; i<3; ++i)
+      {
+        o_min[i]=std::min(o_min[i],accessor.min[i]);
+        o_max[i]=std::max(o_max[i],accessor.max[i]);
+      }
+      continue;
+    }
+    // the bounds are required but sparse data can move points outside them
+    auto positions=convert(primitive.position);
+    for(size_t p=0; p<positions.size(); p+=3)
+    {
+      for(size_t i=0; i<3; ++i)
+      {
+        o_min[i]=std::min(o_min[i],positions[p+i]);
+        o_max[i]=std::max(o_max[i],positions[p+i]);
+      }
+    }
+  }
+  if(o_min[0]>o_max[0])
+  {
+    std::fill(o_min,o_min+3,0.0f);
+    std::fill(o_max,o_max+3,0.0f);
+  }
+}
+
+std::unique_ptr<ngl::AbstractVAO> GlbFile::createVAO(size_t _primitive, UploadStats &io_stats) const
+{
+  const Primitive &primitive=m_primitives[_primitive];
+  std::unique_ptr<ngl::AbstractVAO> vao= primitive.indices!=c_none ?
+        ngl::VAOFactory::createVAO("multiBufferIndexVAO",primitive.mode) :
+        ngl::VAOFactory::createVAO(ngl::multiBufferVAO,primitive.mode);
+  vao->bind();
+  size_t attributes[2]={primitive.position,primitive.colour!=c_none ? primitive.colour : primitive.normal};
+
+  // the bytes of each view the in place attributes read, uploaded once even if the view is interleaved
+  struct Upload
+  {
+    size_t view;
+    size_t begin;
+    size_t end;
+    GLuint buffer;
+  };
+  std::vector<Upload> uploads;
+  for(size_t a : attributes)
+  {
+    if(a==c_none || !inPlace(a))
+    {
+      continue;
+    }
+    const Accessor &accessor=m_accessors[a];
+    // round down so the offsets within the upload stay aligned
+    size_t begin=accessor.byteOffset & ~size_t(3);
+    size_t end=accessor.byteOffset+(accessor.count-1)*stride(accessor)+accessor.elementSize();
+    auto upload=std::find_if(uploads.begin(),uploads.end(),[&accessor](const Upload &_u){return _u.view==accessor.bufferView;});
+    if(upload==uploads.end())
+    {
+      uploads.push_back({accessor.bufferView,begin,end,0});
+    }
+    else
+    {
+      upload->begin=std::min(upload->begin,begin);
+      upload->end=std::max(upload->end,end);
+    }
+  }
+  for(auto &upload : uploads)
+  {
+    vao->setData(ngl::AbstractVAO::VertexData(upload.end-upload.begin,*reinterpret_cast<const GLfloat *>(viewData(upload.view,upload.begin))));
+    // setData leaves its new buffer bound
+    GLint buffer=0;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING,&buffer);
+    upload.buffer=static_cast<GLuint>(buffer);
+    io_stats.inPlaceBytes+=upload.end-upload.begin;
+  }
+
+  for(GLuint id=0; id<2; ++id)
+  {
+    size_t a=attributes[id];
+    if(a==c_none)
+    {
+      // the constant is context state rather than part of the VAO
+      glDisableVertexAttribArray(id);
+      glVertexAttrib3f(id,c_defaultColour,c_defaultColour,c_defaultColour);
+      continue;
+    }
+    const Accessor &accessor=m_accessors[a];
+    if(inPlace(a))
+    {
+      auto upload=std::find_if(uploads.begin(),uploads.end(),[&accessor](const Upload &_u){return _u.view==accessor.bufferView;});
+      // GL reads the integer types and normalises them itself
+      glBindBuffer(GL_ARRAY_BUFFER,upload->buffer);
+      glVertexAttribPointer(id,static_cast<GLint>(accessor.components),accessor.componentType,accessor.normalized ? GL_TRUE : GL_FALSE,
+                            static_cast<GLsizei>(stride(accessor)),reinterpret_cast<const GLvoid *>(accessor.byteOffset-upload->begin));
+      glEnableVertexAttribArray(id);
+      ++io_stats.inPlaceAccessors;
+      continue;
+    }
+    auto values=convert(a);
+    vao->setData(ngl::AbstractVAO::VertexData(values.size()*sizeof(float),values[0]));
+    vao->setVertexAttributePointer(id,static_cast<GLint>(accessor.components),GL_FLOAT,0,0);
+    io_stats.convertedBytes+=values.size()*sizeof(float);
+    ++io_stats.convertedAccessors;
+  }
+
+  if(primitive.indices==c_none)
+  {
+    vao->setNumIndices(m_accessors[primitive.position].count);
+    vao->unbind();
+    return vao;
+  }
+  auto indexVAO=static_cast<MultiBufferIndexVAO *>(vao.get());
+  const Accessor &indices=m_accessors[primitive.indices];
+  auto count=static_cast<unsigned int>(indices.count);
+  // indices are always packed so only need to be aligned, the 4 byte stride rule is for attributes
+  bool packed=indices.sparseCount==0 && indices.bufferView!=c_none &&
+              (m_views[indices.bufferView].byteOffset+indices.byteOffset)%indices.componentSize()==0;
+  if(packed && indices.componentType!=GL_UNSIGNED_BYTE)
+  {
+    indexVAO->setIndices(count,viewData(indices.bufferView,indices.byteOffset),indices.componentType);
+    io_stats.inPlaceBytes+=indices.count*indices.componentSize();
+    ++io_stats.inPlaceAccessors;
+  }
+  else if(packed)
+  {
+    auto widened=widenIndices(viewData(indices.bufferView,indices.byteOffset),indices.count);
+    indexVAO->setIndices(count,widened.data(),GL_UNSIGNED_SHORT);
+    io_stats.convertedBytes+=widened.size()*sizeof(GLushort);
+    ++io_stats.convertedAccessors;
+  }
+  else
+  {
+    // sparse or without a view, rare enough for a plain loop
+    std::vector<GLuint> gathered(indices.count,0);
+    size_t size=indices.componentSize();
+    for(size_t i=0; i<indices.count && indices.bufferView!=c_none; ++i)
+    {
+      gathered[i]=readIndex(viewData(indices.bufferView,indices.byteOffset+i*size),indices.componentType);
+    }
+    size_t sparseSize=::componentSize(indices.sparseIndexType);
+    for(size_t i=0; i<indices.sparseCount; ++i)
+    {
+      size_t element=readIndex(viewData(indices.sparseIndicesView,indices.sparseIndicesOffset+i*sparseSize),indices.sparseIndexType);
+      if(element<indices.count)
+      {
+        gathered[element]=readIndex(viewData(indices.sparseValuesView,indices.sparseValuesOffset+i*size),indices.componentType);
+      }
+    }
+    indexVAO->setIndices(count,gathered.data(),GL_UNSIGNED_INT);
+    io_stats.convertedBytes+=gathered.size()*sizeof(GLuint);
+    ++io_stats.convertedAccessors;
+  }
+  vao->setNumIndices(indices.count);
+  vao->unbind();
+  return vao;
+}
@@ -0,0 +1,265 @@
+#include "Icosphere.h"
+#include "IcosphereTable.h"
+#include "JobSystem.h"
+#include <ngl/VAOFactory.h>
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+namespace
+{
+  constexpr uint64_t c_emptyKey=~uint64_t(0);
+  constexpr uint32_t c_noOwner=~uint32_t(0);
+  // below this many faces in a chunk it isn't worth queuing a job
+  constexpr size_t c_minFacesPerChunk=4096;
+
+  struct Range
+  {
+    size_t begin;
+    size_t end;
+  };
+
+  std::vector<Range> splitRange(size_t _count, size_t _minChunk)
+  {
+    size_t chunks=JobSystem::instance().chunksFor(_count,_minChunk);
+    std::vector<Range> ranges(chunks);
+    for(size_t i=0; i<chunks; ++i)
+    {
+      ranges[i]={_count*i/chunks,_count*(i+1)/chunks};
+    }
+    return ranges;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief run _func(chunk,range) for each range on the shared JobSystem
+  //----------------------------------------------------------------------------------------------------------------------
+  template<typename Func>
+  void parallelFor(const std::vector<Range> &_ranges, Func &&_func)
+  {
+    JobSystem::instance().parallelFor(_ranges.size(),_ranges.size(),[&_func,&_ranges](size_t _chunk,size_t,size_t)
+    {
+      _func(_chunk,_ranges[_chunk]);
+    });
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief open addressing table of edges keyed on the (sorted) vertex pair. Relaxed atomics are enough as each
+  /// pass over the faces is joined before the next reads the results.
+  //----------------------------------------------------------------------------------------------------------------------
+  class EdgeTable
+  {
+    public :
+      explicit EdgeTable(size_t _maxEdges) :
+        m_capacity(capacityFor(_maxEdges)),
+        m_keys(new std::atomic<uint64_t>[m_capacity]),
+        m_owners(new std::atomic<uint32_t>[m_capacity]),
+        m_vertex(new uint32_t[m_capacity])
+      {}
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief empty the part of the table needed for _numEdges, keeping the load factor at 50% or less
+      //----------------------------------------------------------------------------------------------------------------------
+      void reset(size_t _numEdges)
+      {
+        size_t size=capacityFor(_numEdges);
+        m_mask=size-1;
+        m_shift=64;
+        while(size>1)
+        {
+          size>>=1;
+          --m_shift;
+        }
+        parallelFor(splitRange(m_mask+1,c_minFacesPerChunk*4),[this](size_t,Range _r)
+        {
+          for(size_t i=_r.begin; i<_r.end; ++i)
+          {
+            m_keys[i].store(c_emptyKey,std::memory_order_relaxed);
+            m_owners[i].store(c_noOwner,std::memory_order_relaxed);
+          }
+        });
+      }
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief find or add the edge _a,_b used by _face
+      /// @returns the slot of the edge
+      //----------------------------------------------------------------------------------------------------------------------
+      uint32_t insert(uint32_t _a, uint32_t _b, uint32_t _face)
+      {
+        uint64_t key= _a<_b ? (uint64_t(_a)<<32) | _b : (uint64_t(_b)<<32) | _a;
+        uint64_t slot=(key*0x9e3779b97f4a7c15ULL)>>m_shift;
+        while(true)
+        {
+          uint64_t current=m_keys[slot].load(std::memory_order_relaxed);
+          if(current==c_emptyKey)
+          {
+            // on failure current is the key that won the slot which may still be ours
+            m_keys[slot].compare_exchange_strong(current,key,std::memory_order_relaxed);
+            if(current==c_emptyKey)
+            {
+              break;
+            }
+          }
+          if(current==key)
+          {
+            break;
+          }
+          slot=(slot+1) & m_mask;
+        }
+        // the lowest face index owns the edge so the numbering doesn't depend on thread timing
+        uint32_t owner=m_owners[slot].load(std::memory_order_relaxed);
+        while(_face<owner && !m_owners[slot].compare_exchange_weak(owner,_face,std::memory_order_relaxed))
+        {
+        }
+        return static_cast<uint32_t>(slot);
+      }
+      uint32_t owner(uint32_t _slot) const {return m_owners[_slot].load(std::memory_order_relaxed);}
+      uint32_t &vertex(uint32_t _slot) {return m_vertex[_slot];}
+
+    private :
+      static size_t capacityFor(size_t _numEdges)
+      {
+        size_t size=1;
+        while(size<_numEdges*2)
+        {
+          size<<=1;
+        }
+        return size;
+      }
+      size_t m_capacity;
+      std::unique_ptr<std::atomic<uint64_t>[]> m_keys;
+      std::unique_ptr<std::atomic<uint32_t>[]> m_owners;
+      std::unique_ptr<uint32_t[]> m_vertex;
+      uint64_t m_mask=0;
+      unsigned int m_shift=64;
+  };
+}
+
+size_t Icosphere::vertexCount(unsigned int _levels)
+{
+  return icosphereVertexCount(_levels);
+}
+
+size_t Icosphere::faceCount(unsigned int _levels)
+{
+  return icosphereFaceCount(_levels);
+}
+
+Icosphere::Icosphere(unsigned int _levels)
+{
+  m_positions.resize(vertexCount(_levels));
+  m_colours.resize(vertexCount(_levels));
+  m_indices.resize(faceCount(_levels)*3);
+  for(size_t i=0; i<icosahedron::c_verts.size(); ++i)
+  {
+    const auto &p=icosahedron::c_verts[i];
+    const auto &c=icosahedron::c_colours[i];
+    m_positions[i].set(p.x,p.y,p.z);
+    m_colours[i].set(c.x,c.y,c.z);
+  }
+  std::copy(icosahedron::c_indices.begin(),icosahedron::c_indices.end(),m_indices.begin());
+  if(_levels==0)
+  {
+    return;
+  }
+
+  // everything the levels need is allocated for the last one and reused
+  size_t lastFaces=faceCount(_levels-1);
+  std::vector<GLuint> next(m_indices.size());
+  std::vector<uint32_t> faceEdges(lastFaces*3);
+  EdgeTable edges(lastFaces*3/2);
+  size_t numFaces=icosahedron::c_indices.size()/3;
+  size_t numVerts=icosahedron::c_verts.size();
+
+  for(unsigned int level=0; level<_levels; ++level)
+  {
+    // a closed mesh has every edge shared by two faces
+    edges.reset(numFaces*3/2);
+    auto ranges=splitRange(numFaces,c_minFacesPerChunk);
+    const GLuint *faces=m_indices.data();
+
+    // find every edge and its owner
+    parallelFor(ranges,[&](size_t,Range _r)
+    {
+      for(size_t f=_r.begin; f<_r.end; ++f)
+      {
+        for(size_t e=0; e<3; ++e)
+        {
+          faceEdges[f*3+e]=edges.insert(faces[f*3+e],faces[f*3+(e+1)%3],static_cast<uint32_t>(f));
+        }
+      }
+    });
+
+    // count the owned edges in each chunk, the prefix sum gives each chunk its first new vertex
+    std::vector<size_t> firstVertex(ranges.size()+1,0);
+    parallelFor(ranges,[&](size_t _chunk,Range _r)
+    {
+      size_t owned=0;
+      for(size_t f=_r.begin; f<_r.end; ++f)
+      {
+        for(size_t e=0; e<3; ++e)
+        {
+          owned+= edges.owner(faceEdges[f*3+e])==f;
+        }
+      }
+      firstVertex[_chunk+1]=owned;
+    });
+    std::partial_sum(firstVertex.begin(),firstVertex.end(),firstVertex.begin());
+
+    // number the midpoints in face order and push them out onto the sphere
+    parallelFor(ranges,[&](size_t _chunk,Range _r)
+    {
+      auto v=static_cast<uint32_t>(numVerts+firstVertex[_chunk]);
+      for(size_t f=_r.begin; f<_r.end; ++f)
+      {
+        for(size_t e=0; e<3; ++e)
+        {
+          uint32_t slot=faceEdges[f*3+e];
+          if(edges.owner(slot) !=f)
+          {
+            continue;
+          }
+          GLuint a=faces[f*3+e];
+          GLuint b=faces[f*3+(e+1)%3];
+          ngl::Vec3 mid=m_positions[a]+m_positions[b];
+          m_positions[v]=mid*(icosahedron::c_radius/mid.length());
+          m_colours[v]=(m_colours[a]+m_colours[b])*0.5f;
+          edges.vertex(slot)=v++;
+        }
+      }
+    });
+
+    // split each face in 4 keeping the winding of the parent
+    parallelFor(ranges,[&](size_t,Range _r)
+    {
+      for(size_t f=_r.begin; f<_r.end; ++f)
+      {
+        GLuint a=faces[f*3];
+        GLuint b=faces[f*3+1];
+        GLuint c=faces[f*3+2];
+        GLuint ab=edges.vertex(faceEdges[f*3]);
+        GLuint bc=edges.vertex(faceEdges[f*3+1]);
+        GLuint ca=edges.vertex(faceEdges[f*3+2]);
+        GLuint *out=&next[f*12];
+        out[0]=a;  out[1]=ab;  out[2]=ca;
+        out[3]=ab; out[4]=b;   out[5]=bc;
+        out[6]=ca; out[7]=bc;  out[8]=c;
+        out[9]=ab; out[10]=bc; out[11]=ca;
+      }
+    });
+    m_indices.swap(next);
+    numVerts+=numFaces*3/2;
+    numFaces*=4;
+  }
+}
+
+std::unique_ptr<MultiBufferIndexVAO> Icosphere::createVAO() const
+{
+  auto vao=ngl::vaoFactoryCast<MultiBufferIndexVAO>(ngl::VAOFactory::createVAO("multiBufferIndexVAO",GL_TRIANGLES));
+  vao->bind();
+  vao->setData(MultiBufferIndexVAO::VertexData(m_positions.size()*sizeof(ngl::Vec3),m_positions[0].m_x));
+  vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+  vao->setData(MultiBufferIndexVAO::VertexData(m_colours.size()*sizeof(ngl::Vec3),m_colours[0].m_x));
+  vao->setVertexAttributePointer(1,3,GL_FLOAT,0,0);
+  vao->setIndices(static_cast<unsigned int>(m_indices.size()),m_indices.data(),GL_UNSIGNED_INT);
+  vao->setNumIndices(m_indices.size());
+  vao->unbind();
+  return vao;
+}
@@ -8,10 +8,15 @@
 #include <ngl/ShaderLib.h>
 #include <ngl/VAOFactory.h>
 #include "MultiBufferIndexVAO.h"
+#include "IcosphereTable.h"
+#include "Icosphere.h"
+#include "GlbFile.h"
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <iostream>
 
-NGLScene::NGLScene()
+NGLScene::NGLScene(const std::string &_glbFile) : m_glbFile(_glbFile)
 {
 
   setTitle("Qt5 SimpleInexVAO created from VAOFactory NGL Demo");
@@ -21,6 +26,11 @@ NGLScene::~NGLScene()
 {
   std::cout << "Shutting down NGL, removing VAO's and Shaders\n";
   m_vao->removeVAO();
+  m_icosphere->removeVAO();
+  for (auto &vao : m_glb)
+  {
+    vao->removeVAO();
+  }
 }
 
 void NGLScene::resizeGL(int _w, int _h)
@@ -77,52 +87,27 @@ void NGLScene::initializeGL()
   ngl::ShaderLib::linkProgramObject(shaderProgram);
   // and make it active ready to load values
   ngl::ShaderLib::use(shaderProgram);
+  // looked up once here so paintGL sets MVP without a name lookup
+  m_MVPUniform = UniformHandle(ngl::ShaderLib::getProgramID(shaderProgram), "MVP");
   // register our new Factory to draw the VAO
   ngl::VAOFactory::registerVAOCreator("multiBufferIndexVAO", MultiBufferIndexVAO::create);
   ngl::VAOFactory::listCreators();
 
   buildVAO();
+  buildIcosphere();
+  if (!m_glbFile.empty())
+  {
+    buildGlb();
+  }
   glViewport(0, 0, width(), height());
   startTimer(100);
 }
 
 void NGLScene::buildVAO()
 {
-  // data from here http://rbwhitaker.wikidot.com/index-and-vertex-buffers
-  std::array<ngl::Vec3, 12> verts =
-      {
-          {ngl::Vec3(-0.26286500f, 0.0000000f, 0.42532500f),
-           ngl::Vec3(0.26286500f, 0.0000000f, 0.42532500f),
-           ngl::Vec3(-0.26286500f, 0.0000000f, -0.42532500f),
-           ngl::Vec3(0.26286500f, 0.0000000f, -0.42532500f),
-           ngl::Vec3(0.0000000f, 0.42532500f, 0.26286500f),
-           ngl::Vec3(0.0000000f, 0.42532500f, -0.26286500f),
-           ngl::Vec3(0.0000000f, -0.42532500f, 0.26286500f),
-           ngl::Vec3(0.0000000f, -0.42532500f, -0.26286500f),
-           ngl::Vec3(0.42532500f, 0.26286500f, 0.0000000f),
-           ngl::Vec3(-0.42532500f, 0.26286500f, 0.0000000f),
-           ngl::Vec3(0.42532500f, -0.26286500f, 0.0000000f),
-           ngl::Vec3(-0.42532500f, -0.26286500f, 0.0000000f)}};
-  std::array<ngl::Vec3, 12> colours =
-      {
-          {ngl::Vec3(1.0f, 0.0f, 0.0f),
-           ngl::Vec3(1.0f, 0.55f, 0.0f),
-           ngl::Vec3(1.0f, 0.0f, 1.0f),
-           ngl::Vec3(0.0f, 1.0f, 0.0f),
-           ngl::Vec3(0.0f, 0.0f, 1.0f),
-           ngl::Vec3(0.29f, 0.51f, 0.0f),
-           ngl::Vec3(0.5f, 0.0f, 0.5f),
-           ngl::Vec3(1.0f, 1.0f, 1.0f),
-           ngl::Vec3(0.0f, 1.0f, 1.0f),
-           ngl::Vec3(0.0f, 0.0f, 0.0f),
-           ngl::Vec3(0.12f, 0.56f, 1.0f),
-           ngl::Vec3(0.86f, 0.08f, 0.24f)}};
-  std::array<GLshort, 60> indices =
-      {
-          {0, 6, 1, 0, 11, 6, 1, 4, 0, 1, 8, 4, 1, 10, 8, 2, 5, 3,
-           2, 9, 5, 2, 11, 9, 3, 7, 2, 3, 10, 7, 4, 8, 5, 4, 9, 0,
-           5, 8, 3, 5, 9, 4, 6, 10, 1, 6, 11, 7, 7, 10, 6, 7, 11, 2,
-           8, 10, 3, 9, 11, 0}};
+  // the icosahedron from http://rbwhitaker.wikidot.com/index-and-vertex-buffers is level 0 of the table,
+  // it is built by the compiler so there is no work to do here other than upload it.
+  static constexpr auto ico = makeIcosphere<0>();
 
   // create a vao as a series of GL_TRIANGLES
   // need to change this to be a MultiBufferIndexVAO and cast it from ngl::AbstractVAO see README.md for more details
@@ -131,21 +116,71 @@ void NGLScene::buildVAO()
 
   // in this case we are going to set our data as the vertices above
 
-  m_vao->setData(MultiBufferIndexVAO::VertexData(verts.size() * sizeof(ngl::Vec3), verts[0].m_x));
+  m_vao->setData(MultiBufferIndexVAO::VertexData(sizeof(ico.positions), ico.positions[0].x));
   m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, 0, 0);
-  m_vao->setData(MultiBufferIndexVAO::VertexData(colours.size() * sizeof(ngl::Vec3), colours[0].m_x));
+  m_vao->setData(MultiBufferIndexVAO::VertexData(sizeof(ico.colours), ico.colours[0].x));
 
   m_vao->setVertexAttributePointer(1, 3, GL_FLOAT, 0, 3);
   // as we are storing the abstract we need to get the concrete here to call setIndices, do a quick cast
-  m_vao->setIndices(sizeof(indices), &indices[0], GL_UNSIGNED_SHORT);
+  // setIndices wants the number of indices, it scales by the index type itself
+  m_vao->setIndices(static_cast<unsigned int>(ico.indices.size()), &ico.indices[0], GL_UNSIGNED_SHORT);
   // data is 24 bytes apart ( two Vec3's) first index
   // is 0 second is 3 floats into the data set (i.e. vec3 offset)
-  m_vao->setNumIndices(indices.size());
+  m_vao->setNumIndices(ico.indices.size());
 
   // now unbind
   m_vao->unbind();
 }
 
+void NGLScene::buildIcosphere()
+{
+  auto start = std::chrono::steady_clock::now();
+  Icosphere sphere(m_level);
+  auto end = std::chrono::steady_clock::now();
+  std::cout << "icosphere level " << m_level << " " << sphere.positions().size() << " verts "
+            << sphere.indices().size() / 3 << " faces built in "
+            << std::chrono::duration<double, std::milli>(end - start).count() << " ms\n";
+  if (m_icosphere)
+  {
+    m_icosphere->removeVAO();
+  }
+  m_icosphere = sphere.createVAO();
+}
+
+bool NGLScene::buildGlb()
+{
+  auto start = std::chrono::steady_clock::now();
+  GlbFile glb;
+  if (!glb.open(m_glbFile))
+  {
+    std::cerr << "Unable to load " << m_glbFile << " drawing the icosphere instead\n";
+    return false;
+  }
+  GlbFile::UploadStats stats;
+  for (size_t i = 0; i < glb.primitives().size(); ++i)
+  {
+    m_glb.push_back(glb.createVAO(i, stats));
+  }
+  auto end = std::chrono::steady_clock::now();
+  std::cout << "Loaded " << m_glbFile << " as " << m_glb.size() << " primitives in "
+            << std::chrono::duration<double, std::milli>(end - start).count() << " ms, "
+            << stats.inPlaceAccessors << " accessors (" << stats.inPlaceBytes << " bytes) uploaded in place and "
+            << stats.convertedAccessors << " (" << stats.convertedBytes << " bytes) converted\n";
+
+  // centre the mesh and scale its longest side to 1
+  float min[3];
+  float max[3];
+  glb.bounds(min, max);
+  float size = std::max({max[0] - min[0], max[1] - min[1], max[2] - min[2], 1.0e-6f});
+  m_modelTX = ngl::Mat4();
+  for (int a = 0; a < 3; ++a)
+  {
+    m_modelTX.m_m[a][a] = 1.0f / size;
+    m_modelTX.m_m[3][a] = -0.5f * (min[a] + max[a]) / size;
+  }
+  return !m_glb.empty();
+}
+
 void NGLScene::paintGL()
 {
   // clear the screen and depth buffer
@@ -169,22 +204,39 @@ void NGLScene::paintGL()
 
   t.setPosition(-1.2f, 0.0f, 0.0f);
   ngl::Mat4 MVP = m_project * m_view * t.getMatrix() * m_mouseGlobalTX;
-  ngl::ShaderLib::setUniform("MVP", MVP);
+  m_MVPUniform.set(MVP);
 
   m_vao->draw(0, m_index * 3);
 
   t.setPosition(0.0f, 0.0f, 0.0f);
 
   MVP = m_project * m_view * t.getMatrix() * m_mouseGlobalTX;
-  ngl::ShaderLib::setUniform("MVP", MVP);
+  m_MVPUniform.set(MVP);
 
   glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-  // draw right one
-  m_vao->draw();
+  // the middle one is the subdivided icosphere or the glTF primitives
+  m_vao->unbind();
+  if (m_glb.empty())
+  {
+    m_icosphere->bind();
+    m_icosphere->draw();
+    m_icosphere->unbind();
+  }
+  else
+  {
+    m_MVPUniform.set(MVP * m_modelTX);
+    for (auto &vao : m_glb)
+    {
+      vao->bind();
+      vao->draw();
+      vao->unbind();
+    }
+  }
+  m_vao->bind();
 
   t.setPosition(1.2f, 0.0f, 0.0f);
   MVP = m_project * m_view * t.getMatrix() * m_mouseGlobalTX;
-  ngl::ShaderLib::setUniform("MVP", MVP);
+  m_MVPUniform.set(MVP);
 
   m_vao->draw(m_index, 3);
   glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -323,6 +375,23 @@ void NGLScene::keyPressEvent(QKeyEvent *_event)
   case Qt::Key_Space:
     m_animate ^= true;
     break;
+  // change the subdivision level of the middle icosphere
+  case Qt::Key_Plus:
+    if (m_level < 9 && m_glb.empty())
+    {
+      ++m_level;
+      makeCurrent();
+      buildIcosphere();
+    }
+    break;
+  case Qt::Key_Minus:
+    if (m_level > 0 && m_glb.empty())
+    {
+      --m_level;
+      makeCurrent();
+      buildIcosphere();
+    }
+    break;
   default:
     break;
   }
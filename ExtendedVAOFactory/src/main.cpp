@@ -3,12 +3,23 @@ basic OpenGL demo modified from http://qt-project.org/doc/qt-5.0/qtgui/openglwin
 ****************************************************************************/
 #include <QtGui/QGuiApplication>
 #include <iostream>
+#include <string>
 #include "NGLScene.h"
 
 
 
 int main(int argc, char **argv)
 {
+  // --glb FILE draws a binary glTF mesh in place of the middle icosphere
+  std::string glbFile;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--glb" && i + 1 < argc)
+    {
+      glbFile = argv[++i];
+    }
+  }
   QGuiApplication app(argc, argv);
   // create an OpenGL format specifier
   QSurfaceFormat format;
@@ -30,7 +41,7 @@ int main(int argc, char **argv)
   // now set the depth buffer to 24 bits
   format.setDepthBufferSize(24);
   // now we are going to create our scene window
-  NGLScene window;
+  NGLScene window(glbFile);
   // and set the OpenGL format
   window.setFormat(format);
   // we can now query the version to see if it worked
@@ -0,0 +1,50 @@
+#ifndef LAYOUTADVISOR_H_
+#define LAYOUTADVISOR_H_
+
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the three ways the demos lay their vertex attributes out in buffers
+//----------------------------------------------------------------------------------------------------------------------
+enum class VertexLayout
+{
+  // one buffer, each vertex's attributes next to each other (SimpleIndexVAOFactory, VAOSphere's vertData)
+  Interleaved,
+  // one buffer, every vertex's first attribute then every vertex's second (BoidShaded's normals at 12*3)
+  Concatenated,
+  // a buffer per attribute (MultiBufferVAOFactory, ChangingVAOMultiBuffer)
+  MultiBuffer
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief how often an attribute's data is sent again after the first upload, attributes with the same frequency
+/// are taken to change in the same frames
+//----------------------------------------------------------------------------------------------------------------------
+enum class UpdateFrequency
+{
+  Static,
+  Occasional,
+  PerFrame
+};
+
+struct LayoutAdvice
+{
+  VertexLayout layout;
+  const char *reason;
+};
+
+const char *layoutName(VertexLayout _layout);
+const char *frequencyName(UpdateFrequency _frequency);
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief pick a layout from how often each attribute changes.
+/// Nothing changing, or everything changing together, is interleaved as it draws fastest and costs no more to send.
+/// Some attributes changing every frame while others don't go in their own buffers, so those buffers alone are
+/// orphaned and sent each frame. Only occasional changes to some attributes keep the one buffer, concatenated so
+/// each change is one contiguous range, as the rare wait for the GPU to finish with it costs less than the extra
+/// buffers on every draw. LayoutBenchmark measures all three for the same patterns to check this.
+/// This has no GL or NGL in it.
+//----------------------------------------------------------------------------------------------------------------------
+LayoutAdvice adviseLayout(const std::vector<UpdateFrequency> &_attributes);
+
+#endif
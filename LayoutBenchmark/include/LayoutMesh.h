@@ -0,0 +1,58 @@
+#ifndef LAYOUTMESH_H_
+#define LAYOUTMESH_H_
+
+#include <ngl/AbstractVAO.h>
+#include "LayoutAdvisor.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class LayoutMesh
+/// @brief triangles with any number of vec3 attributes (attribute i is location i) stored in one of the three
+/// VertexLayouts, so the same data can be uploaded, changed and drawn each way.
+/// Interleaved and Concatenated use an ngl::SimpleVAO and MultiBuffer an ngl::MultiBufferVAO. Each buffer's usage
+/// hint comes from the most frequently changed attribute in it.
+//----------------------------------------------------------------------------------------------------------------------
+class LayoutMesh
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief upload _numVertices vertices, _attributes holds each attribute's packed vec3s
+    /// @param _frequencies how often each attribute will change, for the usage hints
+    //----------------------------------------------------------------------------------------------------------------------
+    LayoutMesh(VertexLayout _layout, const std::vector<const float *> &_attributes,
+               const std::vector<UpdateFrequency> &_frequencies, size_t _numVertices);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief send new data for the attributes that aren't nullptr, the others keep what they have.
+    /// Interleaved has to send the whole buffer as GL can't write every nth float, Concatenated writes each changed
+    /// attribute's range of the one buffer (orphaning it first if all change) and MultiBuffer orphans each changed
+    /// attribute's buffer.
+    /// @returns the number of bytes sent
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t update(const std::vector<const float *> &_attributes);
+    void draw() const;
+    void remove();
+    VertexLayout layout() const {return m_layout;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the size of the vertex data on the GPU
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t bytes() const {return m_numAttributes*attributeBytes();}
+
+  private :
+    size_t attributeBytes() const {return m_numVertices*3*sizeof(float);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copy the attributes that aren't nullptr into their places in m_interleaved
+    //----------------------------------------------------------------------------------------------------------------------
+    void interleave(const std::vector<const float *> &_attributes);
+    VertexLayout m_layout;
+    size_t m_numAttributes;
+    size_t m_numVertices;
+    std::unique_ptr<ngl::AbstractVAO> m_vao;
+    // one per buffer
+    std::vector<GLenum> m_usage;
+    // the CPU copy the interleaved buffer is sent from, the unchanged attributes have to be sent with the rest
+    std::vector<float> m_interleaved;
+};
+
+#endif
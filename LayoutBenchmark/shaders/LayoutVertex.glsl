@@ -0,0 +1,15 @@
+#version 330 core
+// the positions are already in clip space so every frame costs the same whatever the layout
+layout (location=0)in vec3 inVert;
+layout (location=1)in vec3 inNormal;
+layout (location=2)in vec3 inColour;
+out vec3 vertColour;
+
+const vec3 lightDir=vec3(0.577350269,0.577350269,0.577350269);
+
+void main()
+{
+ gl_Position = vec4(inVert, 1.0);
+ // use every attribute so none are optimised away and all are fetched
+ vertColour=inColour*(0.5+0.5*abs(dot(normalize(inNormal),lightDir)));
+}
@@ -0,0 +1,48 @@
+#include "LayoutAdvisor.h"
+#include <algorithm>
+
+const char *layoutName(VertexLayout _layout)
+{
+  switch(_layout)
+  {
+    case VertexLayout::Interleaved : return "interleaved";
+    case VertexLayout::Concatenated : return "concatenated";
+    case VertexLayout::MultiBuffer : return "multi buffer";
+  }
+  return "unknown";
+}
+
+const char *frequencyName(UpdateFrequency _frequency)
+{
+  switch(_frequency)
+  {
+    case UpdateFrequency::Static : return "static";
+    case UpdateFrequency::Occasional : return "occasional";
+    case UpdateFrequency::PerFrame : return "per frame";
+  }
+  return "unknown";
+}
+
+LayoutAdvice adviseLayout(const std::vector<UpdateFrequency> &_attributes)
+{
+  auto count=[&](UpdateFrequency _frequency)
+  {
+    return static_cast<size_t>(std::count(_attributes.begin(),_attributes.end(),_frequency));
+  };
+  size_t perFrame=count(UpdateFrequency::PerFrame);
+  size_t occasional=count(UpdateFrequency::Occasional);
+  if(perFrame==0 && occasional==0)
+  {
+    return {VertexLayout::Interleaved,"nothing changes after the upload, so one fetch per vertex wins"};
+  }
+  if(perFrame==_attributes.size() || occasional==_attributes.size())
+  {
+    return {VertexLayout::Interleaved,"every attribute is sent whenever any is, so interleaving costs nothing extra"};
+  }
+  if(perFrame>0)
+  {
+    return {VertexLayout::MultiBuffer,"the per frame attributes are orphaned in their own buffers, the rest stay put"};
+  }
+  return {VertexLayout::Concatenated,"an occasional change is one range of one buffer, the rare stall costs less "
+                                     "than binding more buffers"};
+}
@@ -0,0 +1,353 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file LayoutBenchmark.cpp
+/// @brief times uploading, changing and drawing the same triangles with position, normal and colour attributes
+/// interleaved, concatenated in one buffer and in a buffer each, for several vertex counts and update patterns, and
+/// prints which was fastest next to what adviseLayout picks from the pattern alone. It needs no window, the frames
+/// go to an off screen framebuffer of an off screen surface's context.
+/// LayoutBenchmark [--counts 10000,100000,1000000] [--frames N] [--size S]
+/// Every layout draws the same data so the number of covered pixels is compared as a check, the exit status is non
+/// zero if they differ.
+//----------------------------------------------------------------------------------------------------------------------
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <ngl/NGLInit.h>
+#include <ngl/ShaderLib.h>
+#include "LayoutAdvisor.h"
+#include "LayoutMesh.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  constexpr auto LayoutShader="LayoutShader";
+  constexpr size_t c_numAttributes=3;
+  constexpr const char *c_attributeNames[c_numAttributes]={"position","normal","colour"};
+  // an occasional attribute is sent every this many frames
+  constexpr size_t c_occasionalFrames=16;
+  constexpr VertexLayout c_layouts[]={VertexLayout::Interleaved,VertexLayout::Concatenated,VertexLayout::MultiBuffer};
+
+  struct FrameStats
+  {
+    size_t frames=0;
+    double cpuMs=0.0;
+    double gpuMs=0.0;
+    size_t coverage=0;
+  };
+
+  struct Pattern
+  {
+    const char *name;
+    std::vector<UpdateFrequency> frequencies;
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief two versions of each attribute so every update sends something different to what was there
+  //----------------------------------------------------------------------------------------------------------------------
+  struct TestData
+  {
+    size_t numVertices=0;
+    std::vector<float> attributes[c_numAttributes][2];
+    const float *get(size_t _attribute, size_t _version) const {return attributes[_attribute][_version & 1].data();}
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief small triangles scattered over clip space, the second positions are the same triangles nudged along
+  //----------------------------------------------------------------------------------------------------------------------
+  TestData makeTriangles(size_t _count)
+  {
+    TestData data;
+    size_t triangles=std::max<size_t>(1,_count/3);
+    data.numVertices=triangles*3;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(-1.0f,1.0f);
+    std::uniform_real_distribution<float> bright(0.2f,1.0f);
+    float radius=std::clamp(4.0f/std::sqrt(static_cast<float>(triangles)),0.002f,0.1f);
+    for(auto &versions : data.attributes)
+    {
+      for(auto &v : versions)
+      {
+        v.resize(data.numVertices*3);
+      }
+    }
+    for(size_t t=0; t<triangles; ++t)
+    {
+      float centre[3]={unit(rng)*0.95f,unit(rng)*0.95f,unit(rng)*0.9f};
+      for(size_t corner=0; corner<3; ++corner)
+      {
+        size_t i=(t*3+corner)*3;
+        for(size_t c=0; c<3; ++c)
+        {
+          float offset= c<2 ? unit(rng)*radius : 0.0f;
+          data.attributes[0][0][i+c]=centre[c]+offset;
+          data.attributes[0][1][i+c]=centre[c]+offset+(c==0 ? radius*0.25f : 0.0f);
+        }
+        for(size_t version=0; version<2; ++version)
+        {
+          float *n=&data.attributes[1][version][i];
+          do
+          {
+            n[0]=unit(rng);
+            n[1]=unit(rng);
+            n[2]=unit(rng);
+          } while(n[0]*n[0]+n[1]*n[1]+n[2]*n[2]<0.01f);
+          float *colour=&data.attributes[2][version][i];
+          colour[0]=bright(rng);
+          colour[1]=bright(rng);
+          colour[2]=bright(rng);
+        }
+      }
+    }
+    return data;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the data each attribute gets on _frame, nullptr if it isn't sent that frame
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<const float *> frameData(const TestData &_data, const Pattern &_pattern, size_t _frame)
+  {
+    std::vector<const float *> attributes(c_numAttributes,nullptr);
+    for(size_t a=0; a<c_numAttributes; ++a)
+    {
+      switch(_pattern.frequencies[a])
+      {
+        case UpdateFrequency::Static : break;
+        case UpdateFrequency::Occasional :
+          if(_frame%c_occasionalFrames==0)
+          {
+            attributes[a]=_data.get(a,_frame/c_occasionalFrames);
+          }
+        break;
+        case UpdateFrequency::PerFrame : attributes[a]=_data.get(a,_frame); break;
+      }
+    }
+    return attributes;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a colour and depth framebuffer to draw into, the surface itself has no default framebuffer
+  //----------------------------------------------------------------------------------------------------------------------
+  class Target
+  {
+    public :
+      Target(GLsizei _size) : m_size(_size)
+      {
+        glGenFramebuffers(1,&m_fbo);
+        glGenRenderbuffers(2,m_renderbuffers);
+        glBindRenderbuffer(GL_RENDERBUFFER,m_renderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER,GL_RGBA8,_size,_size);
+        glBindRenderbuffer(GL_RENDERBUFFER,m_renderbuffers[1]);
+        glRenderbufferStorage(GL_RENDERBUFFER,GL_DEPTH_COMPONENT24,_size,_size);
+        glBindFramebuffer(GL_FRAMEBUFFER,m_fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER,GL_COLOR_ATTACHMENT0,GL_RENDERBUFFER,m_renderbuffers[0]);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER,GL_DEPTH_ATTACHMENT,GL_RENDERBUFFER,m_renderbuffers[1]);
+        glViewport(0,0,_size,_size);
+      }
+      ~Target()
+      {
+        glBindFramebuffer(GL_FRAMEBUFFER,0);
+        glDeleteRenderbuffers(2,m_renderbuffers);
+        glDeleteFramebuffers(1,&m_fbo);
+      }
+      bool complete() const {return glCheckFramebufferStatus(GL_FRAMEBUFFER)==GL_FRAMEBUFFER_COMPLETE;}
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the number of pixels not left at the clear colour (black)
+      //----------------------------------------------------------------------------------------------------------------------
+      size_t coverage() const
+      {
+        std::vector<GLubyte> pixels(static_cast<size_t>(m_size)*m_size*4);
+        glReadPixels(0,0,m_size,m_size,GL_RGBA,GL_UNSIGNED_BYTE,pixels.data());
+        size_t covered=0;
+        for(size_t i=0; i<pixels.size(); i+=4)
+        {
+          covered+=(pixels[i] | pixels[i+1] | pixels[i+2])!=0;
+        }
+        return covered;
+      }
+
+    private :
+      GLsizei m_size;
+      GLuint m_fbo=0;
+      GLuint m_renderbuffers[2]={0,0};
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief run _frames of _drawFrame after one warm up frame, each frame is finished before the next so the CPU
+  /// time includes waiting for the GPU
+  //----------------------------------------------------------------------------------------------------------------------
+  template<typename DrawFrame>
+  FrameStats timeFrames(const Target &_target, size_t _frames, DrawFrame &&_drawFrame)
+  {
+    using clock=std::chrono::steady_clock;
+    GLuint query;
+    glGenQueries(1,&query);
+    FrameStats stats;
+    stats.frames=_frames;
+    for(size_t frame=0; frame<=_frames; ++frame)
+    {
+      auto start=clock::now();
+      glBeginQuery(GL_TIME_ELAPSED,query);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      _drawFrame();
+      glEndQuery(GL_TIME_ELAPSED);
+      glFinish();
+      auto end=clock::now();
+      GLuint64 gpuNs=0;
+      glGetQueryObjectui64v(query,GL_QUERY_RESULT,&gpuNs);
+      if(frame>0)
+      {
+        stats.cpuMs+=std::chrono::duration<double,std::milli>(end-start).count();
+        stats.gpuMs+=static_cast<double>(gpuNs)*1.0e-6;
+      }
+    }
+    glDeleteQueries(1,&query);
+    stats.cpuMs/=static_cast<double>(_frames);
+    stats.gpuMs/=static_cast<double>(_frames);
+    stats.coverage=_target.coverage();
+    return stats;
+  }
+
+  std::string describe(const Pattern &_pattern)
+  {
+    std::string description;
+    for(size_t a=0; a<c_numAttributes; ++a)
+    {
+      description+=std::string(a==0 ? "" : ", ")+c_attributeNames[a]+" "+frequencyName(_pattern.frequencies[a]);
+    }
+    return description;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<size_t> counts={10000,100000,1000000};
+  size_t frames=100;
+  GLsizei size=512;
+  for(int i=1; i<argc; ++i)
+  {
+    std::string arg=argv[i];
+    if(arg=="--counts" && i+1<argc)
+    {
+      counts.clear();
+      std::stringstream list(argv[++i]);
+      std::string count;
+      while(std::getline(list,count,','))
+      {
+        counts.push_back(std::stoul(count));
+      }
+    }
+    else if(arg=="--frames" && i+1<argc)
+    {
+      frames=std::max<size_t>(1,std::stoul(argv[++i]));
+    }
+    else if(arg=="--size" && i+1<argc)
+    {
+      size=std::stoi(argv[++i]);
+    }
+  }
+  QGuiApplication app(argc,argv);
+  QSurfaceFormat format;
+  format.setMajorVersion(4);
+  format.setMinorVersion(1);
+  format.setProfile(QSurfaceFormat::CoreProfile);
+  format.setDepthBufferSize(24);
+  QOpenGLContext context;
+  context.setFormat(format);
+  if(!context.create())
+  {
+    std::cerr<<"couldn't create a GL context\n";
+    return EXIT_FAILURE;
+  }
+  QOffscreenSurface surface;
+  surface.setFormat(context.format());
+  surface.create();
+  if(!context.makeCurrent(&surface))
+  {
+    std::cerr<<"couldn't make the GL context current\n";
+    return EXIT_FAILURE;
+  }
+  ngl::NGLInit::initialize();
+  int status=EXIT_SUCCESS;
+  {
+    Target target(size);
+    if(!target.complete())
+    {
+      std::cerr<<"the off screen framebuffer isn't complete\n";
+      return EXIT_FAILURE;
+    }
+    glClearColor(0.0f,0.0f,0.0f,1.0f);
+    glEnable(GL_DEPTH_TEST);
+    ngl::ShaderLib::loadShader(LayoutShader,"shaders/LayoutVertex.glsl","shaders/LayoutFragment.glsl");
+    using S=UpdateFrequency;
+    const std::vector<Pattern> patterns=
+    {
+      {"static",{S::Static,S::Static,S::Static}},
+      {"moving",{S::PerFrame,S::Static,S::Static}},
+      {"deforming",{S::PerFrame,S::PerFrame,S::PerFrame}},
+      {"recoloured",{S::Static,S::Static,S::Occasional}},
+      {"moving and recoloured",{S::PerFrame,S::Static,S::Occasional}}
+    };
+
+    for(auto count : counts)
+    {
+      TestData data=makeTriangles(count);
+      std::vector<const float *> initial(c_numAttributes);
+      for(size_t a=0; a<c_numAttributes; ++a)
+      {
+        initial[a]=data.get(a,0);
+      }
+      for(const auto &pattern : patterns)
+      {
+        std::cout<<data.numVertices<<" vertices "<<pattern.name<<" ("<<describe(pattern)<<")\n";
+        std::vector<FrameStats> stats;
+        for(auto layout : c_layouts)
+        {
+          using clock=std::chrono::steady_clock;
+          auto start=clock::now();
+          LayoutMesh mesh(layout,initial,pattern.frequencies,data.numVertices);
+          glFinish();
+          double uploadMs=std::chrono::duration<double,std::milli>(clock::now()-start).count();
+
+          size_t frame=0;
+          size_t sent=0;
+          stats.push_back(timeFrames(target,frames,[&]()
+          {
+            sent+=mesh.update(frameData(data,pattern,++frame));
+            ngl::ShaderLib::use(LayoutShader);
+            mesh.draw();
+          }));
+          mesh.remove();
+          const FrameStats &s=stats.back();
+          std::cout<<"  "<<layoutName(layout)<<": upload "<<uploadMs<<" ms, "<<s.cpuMs<<" ms/frame ("<<s.gpuMs
+                   <<" ms GPU), "<<static_cast<double>(sent)/static_cast<double>(frame)/(1024.0*1024.0)
+                   <<" MB sent per frame\n";
+        }
+        size_t fastest=static_cast<size_t>(std::min_element(stats.begin(),stats.end(),[](const FrameStats &_a,const FrameStats &_b)
+        {
+          return _a.cpuMs<_b.cpuMs;
+        })-stats.begin());
+        LayoutAdvice advice=adviseLayout(pattern.frequencies);
+        std::cout<<"  fastest "<<layoutName(c_layouts[fastest])<<", advised "<<layoutName(advice.layout)
+                 <<" as "<<advice.reason<<"\n";
+        for(const auto &s : stats)
+        {
+          if(s.coverage!=stats[0].coverage)
+          {
+            std::cerr<<"  the layouts covered "<<stats[0].coverage<<" and "<<s.coverage<<" pixels, they should match\n";
+            status=EXIT_FAILURE;
+          }
+        }
+      }
+    }
+  }
+  context.doneCurrent();
+  return status;
+}
@@ -0,0 +1,148 @@
+#include "LayoutMesh.h"
+#include <ngl/MultiBufferVAO.h>
+#include <ngl/SimpleVAO.h>
+#include <ngl/VAOFactory.h>
+#include <algorithm>
+
+namespace
+{
+  GLenum usageFor(UpdateFrequency _frequency)
+  {
+    switch(_frequency)
+    {
+      case UpdateFrequency::Static : return GL_STATIC_DRAW;
+      case UpdateFrequency::Occasional : return GL_DYNAMIC_DRAW;
+      case UpdateFrequency::PerFrame : return GL_STREAM_DRAW;
+    }
+    return GL_STATIC_DRAW;
+  }
+} // end anon namespace
+
+LayoutMesh::LayoutMesh(VertexLayout _layout, const std::vector<const float *> &_attributes,
+                       const std::vector<UpdateFrequency> &_frequencies, size_t _numVertices) :
+  m_layout(_layout),m_numAttributes(_attributes.size()),m_numVertices(_numVertices)
+{
+  m_vao=ngl::VAOFactory::createVAO(_layout==VertexLayout::MultiBuffer ? ngl::multiBufferVAO : ngl::simpleVAO,GL_TRIANGLES);
+  m_vao->bind();
+  size_t floats=m_numVertices*3;
+  if(_layout==VertexLayout::MultiBuffer)
+  {
+    for(size_t a=0; a<m_numAttributes; ++a)
+    {
+      m_usage.push_back(usageFor(_frequencies[a]));
+      m_vao->setData(ngl::MultiBufferVAO::VertexData(attributeBytes(),*_attributes[a],m_usage[a]));
+      m_vao->setVertexAttributePointer(static_cast<GLuint>(a),3,GL_FLOAT,0,0);
+    }
+  }
+  else
+  {
+    m_usage.push_back(usageFor(*std::max_element(_frequencies.begin(),_frequencies.end())));
+    if(_layout==VertexLayout::Interleaved)
+    {
+      m_interleaved.resize(floats*m_numAttributes);
+      interleave(_attributes);
+      m_vao->setData(ngl::SimpleVAO::VertexData(bytes(),m_interleaved[0],m_usage[0]));
+    }
+    else
+    {
+      // one attribute after another as BoidShaded does, the copy is only needed as setData takes one pointer
+      std::vector<float> concatenated(floats*m_numAttributes);
+      for(size_t a=0; a<m_numAttributes; ++a)
+      {
+        std::copy(_attributes[a],_attributes[a]+floats,concatenated.begin()+a*floats);
+      }
+      m_vao->setData(ngl::SimpleVAO::VertexData(bytes(),concatenated[0],m_usage[0]));
+    }
+    for(size_t a=0; a<m_numAttributes; ++a)
+    {
+      bool interleaved=_layout==VertexLayout::Interleaved;
+      m_vao->setVertexAttributePointer(static_cast<GLuint>(a),3,GL_FLOAT,
+                                       interleaved ? static_cast<GLsizei>(m_numAttributes*3*sizeof(float)) : 0,
+                                       static_cast<unsigned int>(interleaved ? a*3 : a*floats));
+    }
+  }
+  m_vao->setNumIndices(m_numVertices);
+  m_vao->unbind();
+}
+
+void LayoutMesh::interleave(const std::vector<const float *> &_attributes)
+{
+  size_t stride=m_numAttributes*3;
+  for(size_t a=0; a<m_numAttributes; ++a)
+  {
+    const float *src=_attributes[a];
+    if(src==nullptr)
+    {
+      continue;
+    }
+    float *dst=m_interleaved.data()+a*3;
+    for(size_t v=0; v<m_numVertices; ++v)
+    {
+      std::copy(src+v*3,src+v*3+3,dst+v*stride);
+    }
+  }
+}
+
+size_t LayoutMesh::update(const std::vector<const float *> &_attributes)
+{
+  size_t changed=static_cast<size_t>(std::count_if(_attributes.begin(),_attributes.end(),[](const float *_a){return _a!=nullptr;}));
+  if(changed==0)
+  {
+    return 0;
+  }
+  size_t sent=0;
+  m_vao->bind();
+  switch(m_layout)
+  {
+    case VertexLayout::Interleaved :
+      interleave(_attributes);
+      glBindBuffer(GL_ARRAY_BUFFER,m_vao->getBufferID(0));
+      glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(bytes()),m_interleaved.data(),m_usage[0]);
+      sent=bytes();
+    break;
+    case VertexLayout::Concatenated :
+      glBindBuffer(GL_ARRAY_BUFFER,m_vao->getBufferID(0));
+      // with everything new the old storage can be dropped so the draw still reading it doesn't have to finish
+      if(changed==m_numAttributes)
+      {
+        glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(bytes()),nullptr,m_usage[0]);
+      }
+      for(size_t a=0; a<m_numAttributes; ++a)
+      {
+        if(_attributes[a]!=nullptr)
+        {
+          glBufferSubData(GL_ARRAY_BUFFER,static_cast<GLintptr>(a*attributeBytes()),
+                          static_cast<GLsizeiptr>(attributeBytes()),_attributes[a]);
+          sent+=attributeBytes();
+        }
+      }
+    break;
+    case VertexLayout::MultiBuffer :
+      // the same buffer is given new storage so the attribute pointer still refers to it
+      for(size_t a=0; a<m_numAttributes; ++a)
+      {
+        if(_attributes[a]!=nullptr)
+        {
+          static_cast<ngl::MultiBufferVAO *>(m_vao.get())->setData(a,ngl::MultiBufferVAO::VertexData(attributeBytes(),
+                                                                   *_attributes[a],m_usage[a]));
+          sent+=attributeBytes();
+        }
+      }
+    break;
+  }
+  glBindBuffer(GL_ARRAY_BUFFER,0);
+  m_vao->unbind();
+  return sent;
+}
+
+void LayoutMesh::draw() const
+{
+  m_vao->bind();
+  m_vao->draw();
+  m_vao->unbind();
+}
+
+void LayoutMesh::remove()
+{
+  m_vao->removeVAO();
+}
@@ -0,0 +1,183 @@
+#ifndef JOBSYSTEM_H_
+#define JOBSYSTEM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class JobSystem
+/// @brief a work stealing thread pool. Each worker has its own deque, it pushes and pops work at the back (so it
+/// works on what it just made while it is still in cache) and idle workers steal from the front of the others. The
+/// thread that waits on work also runs jobs rather than blocking so nested parallel loops can't deadlock and the
+/// calling thread counts as one of the threads. Use instance() so there is one pool sized to the machine for the
+/// whole program rather than each loop starting its own threads.
+//----------------------------------------------------------------------------------------------------------------------
+class JobSystem
+{
+  public :
+    struct Options
+    {
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the total number of threads including the caller, 0 uses std::thread::hardware_concurrency
+      //----------------------------------------------------------------------------------------------------------------------
+      size_t threads=0;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief pin each worker to its own core (Linux and Windows only), the calling thread is left alone
+      //----------------------------------------------------------------------------------------------------------------------
+      bool pinThreads=false;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief counts outstanding jobs, submit increments it and it is decremented as each job finishes
+    //----------------------------------------------------------------------------------------------------------------------
+    using Counter=std::atomic<size_t>;
+    JobSystem();
+    explicit JobSystem(const Options &_options);
+    ~JobSystem();
+    JobSystem(const JobSystem &)=delete;
+    JobSystem &operator=(const JobSystem &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the shared pool, created on first use
+    //----------------------------------------------------------------------------------------------------------------------
+    static JobSystem &instance();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the options used to create instance(), this must be called before the first call to instance()
+    /// @returns false if the pool already exists
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool setInstanceOptions(const Options &_options);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of threads that run jobs, the workers plus the thread waiting
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t numThreads() const {return m_queues.size();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief queue _job, io_counter is incremented now and decremented once the job has run
+    //----------------------------------------------------------------------------------------------------------------------
+    void submit(std::function<void()> _job, Counter &io_counter);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief run jobs until _counter reaches zero
+    //----------------------------------------------------------------------------------------------------------------------
+    void wait(const Counter &_counter);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief how many chunks to split _count items into, a few per thread so stealing can even out the load
+    /// unless there is too little work
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t chunksFor(size_t _count, size_t _minPerChunk) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief run _func(chunk,begin,end) over [0,_count) split into _chunks contiguous ranges and wait for them all.
+    /// The split only depends on _count and _chunks so per chunk results can be combined in a fixed order.
+    //----------------------------------------------------------------------------------------------------------------------
+    template<typename Func>
+    void parallelFor(size_t _count, size_t _chunks, Func &&_func);
+
+  private :
+    struct Job
+    {
+      std::function<void()> func;
+      Counter *counter;
+    };
+    struct Queue
+    {
+      std::mutex mutex;
+      std::deque<Job> jobs;
+    };
+    void workerLoop(size_t _index);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the queue used by the calling thread, workers have their own and any other thread shares queue 0
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t queueIndex() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief pop a job from queue _index or steal one from another, then run it
+    /// @returns false if there was no work anywhere
+    //----------------------------------------------------------------------------------------------------------------------
+    bool runOne(size_t _index);
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_workers;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief jobs in all the queues, idle workers sleep on m_wake while this is zero
+    //----------------------------------------------------------------------------------------------------------------------
+    std::atomic<size_t> m_queued={0};
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_stop={false};
+};
+
+template<typename Func>
+void JobSystem::parallelFor(size_t _count, size_t _chunks, Func &&_func)
+{
+  if(_chunks<=1 || m_queues.size()==1)
+  {
+    // no point paying for the queues
+    for(size_t c=0; c<_chunks; ++c)
+    {
+      _func(c,_count*c/_chunks,_count*(c+1)/_chunks);
+    }
+    return;
+  }
+  Counter counter={0};
+  // pushed in reverse so the owner pops them in order, thieves take the last chunks first
+  for(size_t c=_chunks-1; c>=1; --c)
+  {
+    submit([&_func,_count,_chunks,c](){_func(c,_count*c/_chunks,_count*(c+1)/_chunks);},counter);
+  }
+  _func(size_t(0),size_t(0),_count/_chunks);
+  wait(counter);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief JobSystem::instance().chunksFor(_count,_minPerChunk)
+//----------------------------------------------------------------------------------------------------------------------
+inline size_t parallelChunks(size_t _count, size_t _minPerChunk)
+{
+  return JobSystem::instance().chunksFor(_count,_minPerChunk);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief JobSystem::instance().parallelFor(_count,_chunks,_func)
+//----------------------------------------------------------------------------------------------------------------------
+template<typename Func>
+void parallelFor(size_t _count, size_t _chunks, Func &&_func)
+{
+  JobSystem::instance().parallelFor(_count,_chunks,std::forward<Func>(_func));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class TaskGraph
+/// @brief a set of tasks with dependencies run on a JobSystem, each task is started as soon as everything it
+/// depends on has finished. A graph can be run any number of times.
+//----------------------------------------------------------------------------------------------------------------------
+class TaskGraph
+{
+  public :
+    using Node=size_t;
+    Node add(std::function<void()> _task);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief _after won't start until _before has finished
+    //----------------------------------------------------------------------------------------------------------------------
+    void precede(Node _before, Node _after);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief run every task and wait for them all
+    /// @returns false (and runs nothing) if the dependencies have a cycle
+    //----------------------------------------------------------------------------------------------------------------------
+    bool run(JobSystem &_jobs=JobSystem::instance());
+    size_t size() const {return m_tasks.size();}
+
+  private :
+    struct Task
+    {
+      std::function<void()> func;
+      std::vector<Node> successors;
+      size_t numDependencies=0;
+      std::atomic<size_t> pending={0};
+    };
+    void start(JobSystem &_jobs, Node _node, JobSystem::Counter &io_counter);
+    bool hasCycle() const;
+    std::vector<std::unique_ptr<Task>> m_tasks;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef MESHNORMALS_H_
+#define MESHNORMALS_H_
+
+#include "VertexWeld.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class MeshNormals
+/// @brief normals for triangle meshes that don't come with them. Positions and normals are packed x,y,z floats and
+/// triangles are counter clockwise, every output buffer is allocated by the caller so the normals can be written
+/// straight into the array handed to the VAO. The work is split over the faces on the job system. Smooth normals are
+/// the sum of the unnormalised face normals around a vertex, so each face is weighted by its area, and each thread
+/// sums into its own buffer which are then added in a fixed order, so there are no atomics and the result is the same
+/// every time for a given number of threads. The buffers are kept between calls.
+/// This has no GL or NGL in it.
+//----------------------------------------------------------------------------------------------------------------------
+class MeshNormals
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the face normal for every vertex of unindexed triangles
+    /// @param o_normals _numVertices*3 floats
+    //----------------------------------------------------------------------------------------------------------------------
+    static void flat(const float *_positions, size_t _numVertices, float *o_normals);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the face normal for every corner of indexed triangles, for drawing them unindexed
+    /// @param o_normals _numIndices*3 floats
+    //----------------------------------------------------------------------------------------------------------------------
+    static void flat(const float *_positions, const uint32_t *_indices, size_t _numIndices, float *o_normals);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief area weighted vertex normals of indexed triangles, every index must be less than _numVertices and a
+    /// vertex no triangle uses gets a zero normal
+    /// @param o_normals _numVertices*3 floats
+    //----------------------------------------------------------------------------------------------------------------------
+    void smooth(const float *_positions, size_t _numVertices, const uint32_t *_indices, size_t _numIndices, float *o_normals);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief area weighted vertex normals of unindexed triangles, vertices at exactly the same position are treated
+    /// as one so they all get the same normal
+    /// @param o_normals _numVertices*3 floats
+    //----------------------------------------------------------------------------------------------------------------------
+    void smooth(const float *_positions, size_t _numVertices, float *o_normals);
+
+  private :
+    // a buffer of vertex normals for each thread after the first, which sums into the output
+    std::vector<float> m_sums;
+    // unindexed smoothing welds the positions and smooths those, these are kept between calls
+    VertexWeld m_weld;
+    std::vector<float> m_welded;
+};
+
+#endif
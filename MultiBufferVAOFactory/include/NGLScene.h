@@ -4,6 +4,9 @@
 #include <ngl/Mat4.h>
 #include <ngl/AbstractVAO.h>
 #include "WindowParams.h"
+#include "TransformCache.h"
+#include "UniformBuffer.h"
+#include "PhongBlocks.h"
 #include <QOpenGLWindow>
 #include <memory>
 
@@ -51,10 +54,9 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     WinParams m_win;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Our Camera
+    /// @brief Our Camera and the model transform, with the matrices made from them cached
     //----------------------------------------------------------------------------------------------------------------------
-    ngl::Mat4 m_view;
-    ngl::Mat4 m_project;
+    TransformCache m_transforms;
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief the model position for mouse movement
     //----------------------------------------------------------------------------------------------------------------------
@@ -68,6 +70,11 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     std::unique_ptr<ngl::AbstractVAO> m_vao;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the Phong light and material uniform blocks
+    //----------------------------------------------------------------------------------------------------------------------
+    std::unique_ptr<UniformBuffer> m_light;
+    std::unique_ptr<UniformBuffer> m_material;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief Qt Event called when a key is pressed
     /// @param [in] _event the Qt event to query for size etc
     //----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,42 @@
+#ifndef PHONGBLOCKS_H_
+#define PHONGBLOCKS_H_
+
+#include <ngl/Types.h>
+#include <cstddef>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file PhongBlocks.h
+/// @brief the std140 LightBlock and MaterialBlock of PhongVertex.glsl and PhongFragment.glsl. In std140 a vec4 is
+/// 16 bytes aligned to 16 and a struct is padded to a multiple of 16, so these are plain float arrays with the
+/// padding spelt out, the static_asserts check the offsets match the GLSL.
+//----------------------------------------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the binding points the blocks are attached to in every program
+//----------------------------------------------------------------------------------------------------------------------
+constexpr GLuint c_lightBinding=0;
+constexpr GLuint c_materialBinding=1;
+constexpr auto c_lightBlock="LightBlock";
+constexpr auto c_materialBlock="MaterialBlock";
+
+struct PhongLight
+{
+  float position[4];
+  float ambient[4];
+  float diffuse[4];
+  float specular[4];
+};
+
+struct PhongMaterial
+{
+  float ambient[4];
+  float diffuse[4];
+  float specular[4];
+  float shininess;
+  float pad[3];
+};
+
+static_assert(sizeof(PhongLight)==64 && offsetof(PhongLight,specular)==48, "PhongLight must match std140 Lights");
+static_assert(sizeof(PhongMaterial)==64 && offsetof(PhongMaterial,shininess)==48, "PhongMaterial must match std140 Materials");
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef TRANSFORMCACHE_H_
+#define TRANSFORMCACHE_H_
+
+#include <ngl/Mat3.h>
+#include <ngl/Mat4.h>
+#include "UniformHandle.h"
+#include <cstddef>
+#include <cstdint>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class TransformCache
+/// @brief the model, view and project matrices and the MV, MVP and normal matrices made from them. Each input has a
+/// version that only moves on when the matrix really changes, so it is fine to set them every frame. Each derived
+/// matrix remembers the versions it was made from and is only rebuilt (the normal matrix is an inversion) when one
+/// of them has moved on, and loadUniforms only sends the uniforms that have changed since it last sent them.
+//----------------------------------------------------------------------------------------------------------------------
+class TransformCache
+{
+  public :
+    void setModel(const ngl::Mat4 &_model) {set(m_model,_model);}
+    void setView(const ngl::Mat4 &_view) {set(m_view,_view);}
+    void setProject(const ngl::Mat4 &_project) {set(m_project,_project);}
+    const ngl::Mat4 &M() const {return m_model.matrix;}
+    const ngl::Mat4 &view() const {return m_view.matrix;}
+    const ngl::Mat4 &project() const {return m_project.matrix;}
+    const ngl::Mat4 &MV();
+    const ngl::Mat4 &MVP();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the inverse transpose of the top left of MV
+    //----------------------------------------------------------------------------------------------------------------------
+    const ngl::Mat3 &normalMatrix();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief look up the M, MV, MVP and normalMatrix uniforms of _program, call once after it is linked
+    //----------------------------------------------------------------------------------------------------------------------
+    void attach(GLuint _program);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the uniforms that have changed since the last load, the attached program must be in use.
+    /// This assumes nothing else sets them, call invalidateUniforms if something has.
+    /// @returns the number of uniforms sent
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t loadUniforms();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the next loadUniforms sends all of them
+    //----------------------------------------------------------------------------------------------------------------------
+    void invalidateUniforms();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief how many times the normal matrix has been inverted
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t inversions() const {return m_inversions;}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief versions come from one counter so a derived matrix is up to date if its version is the newest of its
+    /// inputs'
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Input
+    {
+      ngl::Mat4 matrix;
+      uint64_t version=0;
+    };
+    template<typename Matrix>
+    struct Derived
+    {
+      Matrix matrix;
+      uint64_t version=0;
+    };
+    void set(Input &io_input, const ngl::Mat4 &_matrix);
+    Input m_model;
+    Input m_view;
+    Input m_project;
+    uint64_t m_nextVersion=1;
+    // everything starts as the identity so the derived matrices match the inputs' version 0
+    Derived<ngl::Mat4> m_MV;
+    Derived<ngl::Mat4> m_MVP;
+    Derived<ngl::Mat3> m_normalMatrix;
+    size_t m_inversions=0;
+    // M MV MVP and normalMatrix and the version of each last sent
+    UniformHandle m_uniforms[4];
+    static constexpr uint64_t c_notLoaded=~uint64_t(0);
+    uint64_t m_loaded[4]={c_notLoaded,c_notLoaded,c_notLoaded,c_notLoaded};
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef VERTEXWELD_H_
+#define VERTEXWELD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class VertexWeld
+/// @brief turns a triangle soup (every corner its own vertex) into unique vertices and indices. Vertices are
+/// interleaved floats with the position first, two vertices are welded if every float is equal, or with an epsilon if
+/// their positions fall in the same epsilon sized grid cell and the other floats are equal. Cells are used so the
+/// result doesn't depend on the order, two positions closer than epsilon either side of a cell boundary stay apart.
+/// Each unique vertex keeps the values of its first use and vertices are numbered in first use order, so the result
+/// is the same whether it ran serially or in parallel.
+/// Small inputs, or any input on a single thread, go through a serial hash table. Large ones hash every vertex in parallel, sort the hashes in
+/// parallel runs merged pairwise then split the sorted array into chunks at hash boundaries, each chunk matching the
+/// vertices with equal hashes by comparing them, so nothing is shared between threads. The buffers are kept between
+/// calls. Indices are 32 bit so there can be at most 4G vertices.
+/// This has no GL or NGL in it.
+//----------------------------------------------------------------------------------------------------------------------
+class VertexWeld
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief weld _numVertices vertices of _floatsPerVertex floats, the first 3 being the position
+    /// @param _epsilon the size of the cells positions are snapped to for comparing, 0 welds equal positions only
+    //----------------------------------------------------------------------------------------------------------------------
+    void weld(const float *_vertices, size_t _numVertices, size_t _floatsPerVertex, float _epsilon=0.0f);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief at or above this many vertices the parallel sort is used, if there is more than one thread
+    //----------------------------------------------------------------------------------------------------------------------
+    void setParallelThreshold(size_t _vertices) {m_parallelThreshold=_vertices;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the unique vertices, laid out as the input
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<float> &vertices() const {return m_vertices;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the unique vertex each input vertex became, so the soup's triangles are the index triples
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<uint32_t> &indices() const {return m_indices;}
+    size_t numVertices() const {return m_floatsPerVertex==0 ? 0 : m_vertices.size()/m_floatsPerVertex;}
+
+  private :
+    struct SortedVertex
+    {
+      uint64_t hash;
+      uint32_t vertex;
+      bool operator<(const SortedVertex &_other) const
+      {
+        return hash!=_other.hash ? hash<_other.hash : vertex<_other.vertex;
+      }
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the value float _c of vertex _v is compared by, its bits or the index of its cell
+    //----------------------------------------------------------------------------------------------------------------------
+    uint64_t key(size_t _v, size_t _c) const;
+    uint64_t hash(size_t _v) const;
+    bool equal(size_t _a, size_t _b) const;
+    void weldSerial();
+    void weldParallel();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number the vertices that are their own first use and write the output, m_first must be set
+    //----------------------------------------------------------------------------------------------------------------------
+    void compact();
+    const float *m_input=nullptr;
+    size_t m_count=0;
+    size_t m_floatsPerVertex=0;
+    double m_inverseEpsilon=0.0;
+    size_t m_parallelThreshold=1<<16;
+    std::vector<float> m_vertices;
+    std::vector<uint32_t> m_indices;
+    // the first vertex each vertex is equal to, itself if it is the first
+    std::vector<uint32_t> m_first;
+    std::vector<uint32_t> m_table;
+    std::vector<SortedVertex> m_order;
+    std::vector<SortedVertex> m_merge;
+};
+
+#endif
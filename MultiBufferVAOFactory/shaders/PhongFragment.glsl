@@ -22,10 +22,17 @@ struct Lights
 	vec4 diffuse;
 	vec4 specular;
 };
-// @param material passed from our program
-uniform Materials material;
+// @param material passed from our program in a std140 uniform buffer (see PhongBlocks.h), as a block with no
+// instance name the members are used as before
+layout(std140) uniform MaterialBlock
+{
+	Materials material;
+};
 
-uniform Lights light;
+layout(std140) uniform LightBlock
+{
+	Lights light;
+};
 in vec3 lightDir;
 // out the blinn half vector
 in vec3 halfVector;
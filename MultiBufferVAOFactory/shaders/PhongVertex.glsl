@@ -28,10 +28,16 @@ struct Lights
 	vec4 diffuse;
 	vec4 specular;
 };
-// our material
-uniform Materials material;
+// our material, the blocks must match PhongFragment.glsl and PhongBlocks.h
+layout(std140) uniform MaterialBlock
+{
+	Materials material;
+};
 // array of lights
-uniform Lights light;
+layout(std140) uniform LightBlock
+{
+	Lights light;
+};
 // direction of the lights used for shading
 out vec3 lightDir;
 // out the blinn half vector
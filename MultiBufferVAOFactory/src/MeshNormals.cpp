@@ -0,0 +1,134 @@
+#include "MeshNormals.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  // a face is a few dozen flops so give each job plenty of them
+  constexpr size_t c_minFacesPerChunk=1<<14;
+  constexpr size_t c_minVerticesPerChunk=1<<15;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief (b-a)x(c-a), its length is twice the area of the triangle
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void faceNormal(const float *_a, const float *_b, const float *_c, float *o_n)
+  {
+    float u[3]={_b[0]-_a[0],_b[1]-_a[1],_b[2]-_a[2]};
+    float v[3]={_c[0]-_a[0],_c[1]-_a[1],_c[2]-_a[2]};
+    o_n[0]=u[1]*v[2]-u[2]*v[1];
+    o_n[1]=u[2]*v[0]-u[0]*v[2];
+    o_n[2]=u[0]*v[1]-u[1]*v[0];
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief normalise in place, a degenerate normal is left as it is
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void normalise(float *io_n)
+  {
+    float length=std::sqrt(io_n[0]*io_n[0]+io_n[1]*io_n[1]+io_n[2]*io_n[2]);
+    if(length>0.0f)
+    {
+      io_n[0]/=length;
+      io_n[1]/=length;
+      io_n[2]/=length;
+    }
+  }
+} // end anon namespace
+
+void MeshNormals::flat(const float *_positions, size_t _numVertices, float *o_normals)
+{
+  size_t faces=_numVertices/3;
+  parallelFor(faces,parallelChunks(faces,c_minFacesPerChunk),[=](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t f=_begin; f<_end; ++f)
+    {
+      const float *p=_positions+f*9;
+      float *n=o_normals+f*9;
+      faceNormal(p,p+3,p+6,n);
+      normalise(n);
+      std::copy(n,n+3,n+3);
+      std::copy(n,n+3,n+6);
+    }
+  });
+}
+
+void MeshNormals::flat(const float *_positions, const uint32_t *_indices, size_t _numIndices, float *o_normals)
+{
+  size_t faces=_numIndices/3;
+  parallelFor(faces,parallelChunks(faces,c_minFacesPerChunk),[=](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t f=_begin; f<_end; ++f)
+    {
+      const uint32_t *i=_indices+f*3;
+      float *n=o_normals+f*9;
+      faceNormal(_positions+size_t(i[0])*3,_positions+size_t(i[1])*3,_positions+size_t(i[2])*3,n);
+      normalise(n);
+      std::copy(n,n+3,n+3);
+      std::copy(n,n+3,n+6);
+    }
+  });
+}
+
+void MeshNormals::smooth(const float *_positions, size_t _numVertices, const uint32_t *_indices, size_t _numIndices, float *o_normals)
+{
+  size_t faces=_numIndices/3;
+  // one sum buffer per thread is all that is needed, more chunks would only cost memory
+  size_t chunks=std::max<size_t>(1,std::min(parallelChunks(faces,c_minFacesPerChunk),JobSystem::instance().numThreads()));
+  size_t floats=_numVertices*3;
+  m_sums.resize((chunks-1)*floats);
+
+  // each chunk clears its own buffer so the pages are first touched by the thread that sums into them
+  parallelFor(faces,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+  {
+    float *sums=_chunk==0 ? o_normals : &m_sums[(_chunk-1)*floats];
+    std::fill(sums,sums+floats,0.0f);
+    for(size_t f=_begin; f<_end; ++f)
+    {
+      const uint32_t *i=_indices+f*3;
+      float n[3];
+      faceNormal(_positions+size_t(i[0])*3,_positions+size_t(i[1])*3,_positions+size_t(i[2])*3,n);
+      for(size_t corner=0; corner<3; ++corner)
+      {
+        float *s=sums+size_t(i[corner])*3;
+        s[0]+=n[0];
+        s[1]+=n[1];
+        s[2]+=n[2];
+      }
+    }
+  });
+  // add the other threads' sums in chunk order so the result doesn't depend on which thread finished first
+  parallelFor(_numVertices,parallelChunks(_numVertices,c_minVerticesPerChunk),[&](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t c=1; c<chunks; ++c)
+    {
+      const float *sums=&m_sums[(c-1)*floats];
+      for(size_t i=_begin*3; i<_end*3; ++i)
+      {
+        o_normals[i]+=sums[i];
+      }
+    }
+    for(size_t v=_begin; v<_end; ++v)
+    {
+      normalise(o_normals+v*3);
+    }
+  });
+}
+
+void MeshNormals::smooth(const float *_positions, size_t _numVertices, float *o_normals)
+{
+  // vertices at exactly the same position become one, so the triangles can be smoothed as if they were indexed and
+  // each vertex takes the normal of the one it was welded into
+  m_weld.weld(_positions,_numVertices,3);
+  m_welded.resize(m_weld.vertices().size());
+  smooth(m_weld.vertices().data(),m_weld.numVertices(),m_weld.indices().data(),_numVertices,m_welded.data());
+  const uint32_t *welded=m_weld.indices().data();
+  parallelFor(_numVertices,parallelChunks(_numVertices,c_minVerticesPerChunk),[&](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t v=_begin; v<_end; ++v)
+    {
+      const float *n=&m_welded[size_t(welded[v])*3];
+      std::copy(n,n+3,o_normals+v*3);
+    }
+  });
+}
@@ -8,6 +8,7 @@
 #include <ngl/ShaderLib.h>
 #include <ngl/VAOFactory.h>
 #include <ngl/MultiBufferVAO.h>
+#include "MeshNormals.h"
 #include <iostream>
 
 NGLScene::NGLScene()
@@ -19,11 +20,13 @@ NGLScene::~NGLScene()
 {
   std::cout << "Shutting down NGL, removing VAO's and Shaders\n";
   m_vao->removeVAO();
+  m_light->remove();
+  m_material->remove();
 }
 
 void NGLScene::resizeGL(int _w, int _h)
 {
-  m_project = ngl::perspective(45.0f, static_cast<float>(_w) / _h, 0.05f, 350.0f);
+  m_transforms.setProject(ngl::perspective(45.0f, static_cast<float>(_w) / _h, 0.05f, 350.0f));
   m_win.width = static_cast<int>(_w * devicePixelRatio());
   m_win.height = static_cast<int>(_h * devicePixelRatio());
 }
@@ -47,10 +50,10 @@ void NGLScene::initializeGL()
   ngl::Vec3 to(0, 0, 0);
   ngl::Vec3 up(0, 1, 0);
 
-  m_view = ngl::lookAt(from, to, up);
+  m_transforms.setView(ngl::lookAt(from, to, up));
   // set the shape using FOV 45 Aspect Ratio based on Width and Height
   // The final two are near and far clipping planes of 0.5 and 10
-  m_project = ngl::perspective(45, 720.0f / 576.0f, 0.001f, 150);
+  m_transforms.setProject(ngl::perspective(45, 720.0f / 576.0f, 0.001f, 150));
 
   // we are creating a shader called Phong to save typos
   // in the code create some constexpr
@@ -76,16 +79,17 @@ void NGLScene::initializeGL()
   ngl::ShaderLib::linkProgramObject(shaderProgram);
   // and make it active ready to load values
   ngl::ShaderLib::use(shaderProgram);
-  ngl::Vec4 lightPos(-2.0f, 5.0f, 2.0f, 0.0f);
-  ngl::ShaderLib::setUniform("light.position", lightPos);
-  ngl::ShaderLib::setUniform("light.ambient", 0.0f, 0.0f, 0.0f, 1.0f);
-  ngl::ShaderLib::setUniform("light.diffuse", 1.0f, 1.0f, 1.0f, 1.0f);
-  ngl::ShaderLib::setUniform("light.specular", 0.8f, 0.8f, 0.8f, 1.0f);
+  // the light and material are std140 uniform blocks (see PhongBlocks.h) each filled with one call, any program
+  // attached to the same binding points shares them
+  GLuint program = ngl::ShaderLib::getProgramID(shaderProgram);
+  UniformBuffer::attach(program, c_lightBlock, c_lightBinding);
+  UniformBuffer::attach(program, c_materialBlock, c_materialBinding);
+  m_transforms.attach(program);
+  m_light = std::make_unique<UniformBuffer>(c_lightBinding, sizeof(PhongLight));
+  m_light->set(PhongLight{{-2.0f, 5.0f, 2.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, {0.8f, 0.8f, 0.8f, 1.0f}});
   // gold like phong material
-  ngl::ShaderLib::setUniform("material.ambient", 0.274725f, 0.1995f, 0.0745f, 0.0f);
-  ngl::ShaderLib::setUniform("material.diffuse", 0.75164f, 0.60648f, 0.22648f, 0.0f);
-  ngl::ShaderLib::setUniform("material.specular", 0.628281f, 0.555802f, 0.3666065f, 0.0f);
-  ngl::ShaderLib::setUniform("material.shininess", 51.2f);
+  m_material = std::make_unique<UniformBuffer>(c_materialBinding, sizeof(PhongMaterial));
+  m_material->set(PhongMaterial{{0.274725f, 0.1995f, 0.0745f, 0.0f}, {0.75164f, 0.60648f, 0.22648f, 0.0f}, {0.628281f, 0.555802f, 0.3666065f, 0.0f}, 51.2f, {}});
   ngl::ShaderLib::setUniform("viewerPos", from);
 
   buildVAO();
@@ -94,41 +98,26 @@ void NGLScene::initializeGL()
 
 void NGLScene::buildVAO()
 {
+  // counter clockwise triangles so MeshNormals gives the outward normals
   std::array<ngl::Vec3, 12> verts =
       {{ngl::Vec3(0, 1, 1),
         ngl::Vec3(0, 0, -1),
         ngl::Vec3(-0.5, 0, 1),
-        ngl::Vec3(0, 1, 1),
-        ngl::Vec3(0, 0, -1),
         ngl::Vec3(0.5, 0, 1),
+        ngl::Vec3(0, 0, -1),
         ngl::Vec3(0, 1, 1),
-        ngl::Vec3(0, 0, 1.5),
         ngl::Vec3(-0.5, 0, 1),
+        ngl::Vec3(0, 0, 1.5),
+        ngl::Vec3(0, 1, 1),
         ngl::Vec3(0, 1, 1),
         ngl::Vec3(0, 0, 1.5),
         ngl::Vec3(0.5, 0, 1)
 
       }};
 
-  std::vector<ngl::Vec3> normals;
-  ngl::Vec3 n = ngl::calcNormal(verts[2], verts[1], verts[0]);
-  normals.push_back(n);
-  normals.push_back(n);
-  normals.push_back(n);
-  n = ngl::calcNormal(verts[3], verts[4], verts[5]);
-  normals.push_back(n);
-  normals.push_back(n);
-  normals.push_back(n);
-
-  n = ngl::calcNormal(verts[6], verts[7], verts[8]);
-  normals.push_back(n);
-  normals.push_back(n);
-  normals.push_back(n);
-
-  n = ngl::calcNormal(verts[11], verts[10], verts[9]);
-  normals.push_back(n);
-  normals.push_back(n);
-  normals.push_back(n);
+  // written straight into a buffer of the right size rather than pushed back a vertex at a time
+  std::vector<ngl::Vec3> normals(verts.size());
+  MeshNormals::flat(&verts[0].m_x, verts.size(), &normals[0].m_x);
 
   std::cout << "sizeof(verts) " << sizeof(verts) << " sizeof(ngl::Vec3) " << sizeof(ngl::Vec3) << "\n";
   // create a vao as a series of GL_TRIANGLES
@@ -170,19 +159,9 @@ void NGLScene::paintGL()
 
   ngl::ShaderLib::use("Phong");
 
-  ngl::Mat4 MV;
-  ngl::Mat4 MVP;
-  ngl::Mat3 normalMatrix;
-  ngl::Mat4 M;
-  M = m_mouseGlobalTX;
-  MV = m_view * M;
-  MVP = m_project * MV;
-  normalMatrix = MV;
-  normalMatrix.inverse();
-  ngl::ShaderLib::setUniform("MV", MV);
-  ngl::ShaderLib::setUniform("MVP", MVP);
-  ngl::ShaderLib::setUniform("normalMatrix", normalMatrix);
-  ngl::ShaderLib::setUniform("M", M);
+  // MV, MVP and the normal matrix are only rebuilt and sent when the camera or the mouse transform has changed
+  m_transforms.setModel(m_mouseGlobalTX);
+  m_transforms.loadUniforms();
 
   m_vao->bind();
   m_vao->draw();
@@ -0,0 +1,88 @@
+#include "TransformCache.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+void TransformCache::set(Input &io_input, const ngl::Mat4 &_matrix)
+{
+  if(std::memcmp(io_input.matrix.m_openGL,_matrix.m_openGL,sizeof(_matrix.m_openGL))!=0)
+  {
+    io_input.matrix=_matrix;
+    io_input.version=m_nextVersion++;
+  }
+}
+
+const ngl::Mat4 &TransformCache::MV()
+{
+  uint64_t version=std::max(m_model.version,m_view.version);
+  if(m_MV.version!=version)
+  {
+    m_MV.matrix=m_view.matrix*m_model.matrix;
+    m_MV.version=version;
+  }
+  return m_MV.matrix;
+}
+
+const ngl::Mat4 &TransformCache::MVP()
+{
+  uint64_t version=std::max({m_model.version,m_view.version,m_project.version});
+  if(m_MVP.version!=version)
+  {
+    m_MVP.matrix=m_project.matrix*MV();
+    m_MVP.version=version;
+  }
+  return m_MVP.matrix;
+}
+
+const ngl::Mat3 &TransformCache::normalMatrix()
+{
+  uint64_t version=std::max(m_model.version,m_view.version);
+  if(m_normalMatrix.version!=version)
+  {
+    m_normalMatrix.matrix=MV();
+    m_normalMatrix.matrix.inverse().transpose();
+    m_normalMatrix.version=version;
+    ++m_inversions;
+  }
+  return m_normalMatrix.matrix;
+}
+
+void TransformCache::attach(GLuint _program)
+{
+  m_uniforms[0]=UniformHandle(_program,"M");
+  m_uniforms[1]=UniformHandle(_program,"MV");
+  m_uniforms[2]=UniformHandle(_program,"MVP");
+  m_uniforms[3]=UniformHandle(_program,"normalMatrix");
+  invalidateUniforms();
+}
+
+size_t TransformCache::loadUniforms()
+{
+  size_t sent=0;
+  auto load=[&](size_t _uniform, const auto &_matrix, uint64_t _version)
+  {
+    if(m_loaded[_uniform]!=_version)
+    {
+      m_uniforms[_uniform].set(_matrix);
+      m_loaded[_uniform]=_version;
+      ++sent;
+    }
+  };
+  // the getters bring each matrix up to date so their versions are read after
+  const ngl::Mat4 &MVP=this->MVP();
+  const ngl::Mat3 &normal=normalMatrix();
+  load(0,m_model.matrix,m_model.version);
+  load(1,m_MV.matrix,m_MV.version);
+  load(2,MVP,m_MVP.version);
+  load(3,normal,m_normalMatrix.version);
+  return sent;
+}
+
+void TransformCache::invalidateUniforms()
+{
+  std::fill(std::begin(m_loaded),std::end(m_loaded),c_notLoaded);
+  for(auto &uniform : m_uniforms)
+  {
+    uniform.invalidate();
+  }
+}
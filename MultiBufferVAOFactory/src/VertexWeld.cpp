@@ -0,0 +1,219 @@
+#include "VertexWeld.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+  // hashing or copying a vertex is cheap so give each job plenty of them
+  constexpr size_t c_minVerticesPerChunk=1<<15;
+  constexpr uint32_t c_empty=UINT32_MAX;
+  // keeps the cell index inside an int64_t
+  constexpr double c_maxCell=9.0e18;
+} // end anon namespace
+
+uint64_t VertexWeld::key(size_t _v, size_t _c) const
+{
+  float f=m_input[_v*m_floatsPerVertex+_c];
+  if(_c<3 && m_inverseEpsilon>0.0 && std::isfinite(f))
+  {
+    double cell=std::clamp(std::floor(static_cast<double>(f)*m_inverseEpsilon),-c_maxCell,c_maxCell);
+    return static_cast<uint64_t>(static_cast<int64_t>(cell));
+  }
+  // +0 and -0 are the same vertex
+  f= f==0.0f ? 0.0f : f;
+  uint32_t bits;
+  std::memcpy(&bits,&f,sizeof(bits));
+  return bits;
+}
+
+uint64_t VertexWeld::hash(size_t _v) const
+{
+  uint64_t h=0x9e3779b97f4a7c15ULL;
+  for(size_t c=0; c<m_floatsPerVertex; ++c)
+  {
+    h^=key(_v,c);
+    h*=0xff51afd7ed558ccdULL;
+    h^=h>>32;
+  }
+  h*=0xc4ceb9fe1a85ec53ULL;
+  return h^(h>>29);
+}
+
+bool VertexWeld::equal(size_t _a, size_t _b) const
+{
+  for(size_t c=0; c<m_floatsPerVertex; ++c)
+  {
+    if(key(_a,c)!=key(_b,c))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void VertexWeld::weld(const float *_vertices, size_t _numVertices, size_t _floatsPerVertex, float _epsilon)
+{
+  m_input=_vertices;
+  m_count=_numVertices;
+  m_floatsPerVertex=_floatsPerVertex;
+  m_inverseEpsilon=_epsilon>0.0f ? 1.0/static_cast<double>(_epsilon) : 0.0;
+  m_first.resize(_numVertices);
+  if(_numVertices==0)
+  {
+    m_vertices.clear();
+    m_indices.clear();
+    return;
+  }
+  // on one thread the hash table beats sorting at any size
+  if(_numVertices>=m_parallelThreshold && JobSystem::instance().numThreads()>1)
+  {
+    weldParallel();
+  }
+  else
+  {
+    weldSerial();
+  }
+  compact();
+  m_input=nullptr;
+}
+
+void VertexWeld::weldSerial()
+{
+  // open addressing at no more than 50% full, each slot holds the first vertex with that key
+  size_t capacity=16;
+  while(capacity<m_count*2)
+  {
+    capacity<<=1;
+  }
+  m_table.assign(capacity,c_empty);
+  size_t mask=capacity-1;
+  for(size_t v=0; v<m_count; ++v)
+  {
+    size_t slot=hash(v) & mask;
+    while(m_table[slot]!=c_empty && !equal(m_table[slot],v))
+    {
+      slot=(slot+1) & mask;
+    }
+    if(m_table[slot]==c_empty)
+    {
+      m_table[slot]=static_cast<uint32_t>(v);
+    }
+    m_first[v]=m_table[slot];
+  }
+}
+
+void VertexWeld::weldParallel()
+{
+  // sort by hash then vertex so equal vertices are next to each other with the first use first
+  m_order.resize(m_count);
+  m_merge.resize(m_count);
+  size_t chunks=parallelChunks(m_count,c_minVerticesPerChunk);
+  auto bound=[&](size_t _c){return m_count*std::min(_c,chunks)/chunks;};
+  parallelFor(m_count,chunks,[&](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t v=_begin; v<_end; ++v)
+    {
+      m_order[v]={hash(v),static_cast<uint32_t>(v)};
+    }
+    std::sort(m_order.begin()+_begin,m_order.begin()+_end);
+  });
+  for(size_t width=1; width<chunks; width*=2)
+  {
+    size_t pairs=(chunks+2*width-1)/(2*width);
+    parallelFor(pairs,pairs,[&](size_t _pair,size_t,size_t)
+    {
+      size_t first=bound(_pair*2*width);
+      size_t middle=bound(_pair*2*width+width);
+      size_t last=bound(_pair*2*width+2*width);
+      std::merge(m_order.begin()+first,m_order.begin()+middle,m_order.begin()+middle,m_order.begin()+last,
+                 m_merge.begin()+first);
+    });
+    m_order.swap(m_merge);
+  }
+
+  // move each chunk's start past any run of equal hashes so a run is only seen by one chunk
+  auto runStart=[this](size_t _i)
+  {
+    while(_i>0 && _i<m_count && m_order[_i].hash==m_order[_i-1].hash)
+    {
+      ++_i;
+    }
+    return _i;
+  };
+  parallelFor(m_count,chunks,[&](size_t,size_t _begin,size_t _end)
+  {
+    // almost every run is one vertex and its copies, different vertices only share a run if their hashes collide
+    std::vector<uint32_t> firsts;
+    size_t end=runStart(_end);
+    for(size_t i=runStart(_begin); i<end;)
+    {
+      size_t runEnd=i+1;
+      while(runEnd<m_count && m_order[runEnd].hash==m_order[i].hash)
+      {
+        ++runEnd;
+      }
+      firsts.clear();
+      for(; i<runEnd; ++i)
+      {
+        uint32_t v=m_order[i].vertex;
+        auto match=std::find_if(firsts.begin(),firsts.end(),[&](uint32_t _f){return equal(_f,v);});
+        if(match==firsts.end())
+        {
+          firsts.push_back(v);
+          m_first[v]=v;
+        }
+        else
+        {
+          m_first[v]=*match;
+        }
+      }
+    }
+  });
+}
+
+void VertexWeld::compact()
+{
+  // count the first uses in each chunk, the prefix sum numbers them in order
+  size_t chunks=parallelChunks(m_count,c_minVerticesPerChunk);
+  std::vector<size_t> firstIndex(chunks+1,0);
+  parallelFor(m_count,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+  {
+    size_t firsts=0;
+    for(size_t v=_begin; v<_end; ++v)
+    {
+      firsts+= m_first[v]==v;
+    }
+    firstIndex[_chunk+1]=firsts;
+  });
+  std::partial_sum(firstIndex.begin(),firstIndex.end(),firstIndex.begin());
+
+  m_vertices.resize(firstIndex.back()*m_floatsPerVertex);
+  m_indices.resize(m_count);
+  parallelFor(m_count,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+  {
+    auto next=static_cast<uint32_t>(firstIndex[_chunk]);
+    for(size_t v=_begin; v<_end; ++v)
+    {
+      if(m_first[v]==v)
+      {
+        const float *src=m_input+v*m_floatsPerVertex;
+        std::copy(src,src+m_floatsPerVertex,&m_vertices[next*m_floatsPerVertex]);
+        m_indices[v]=next++;
+      }
+    }
+  });
+  // a first use is never after its copies but may be in another chunk, so only look them up once all are numbered
+  parallelFor(m_count,chunks,[&](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t v=_begin; v<_end; ++v)
+    {
+      if(m_first[v]!=v)
+      {
+        m_indices[v]=m_indices[m_first[v]];
+      }
+    }
+  });
+}
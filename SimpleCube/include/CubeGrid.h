@@ -0,0 +1,32 @@
+#ifndef CUBEGRID_H_
+#define CUBEGRID_H_
+
+#include <ngl/Mat4.h>
+#include <ngl/Vec3.h>
+#include <cstddef>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class CubeGrid
+/// @brief the instance data for a block of cubes filling a box, row by row then layer by layer. Each cube gets a
+/// model matrix scaling the unit half size cube of makeCube() to fit its cell with a gap, and a colour from its
+/// place in the grid so neighbouring cubes can be told apart.
+//----------------------------------------------------------------------------------------------------------------------
+class CubeGrid
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief lay out _count cubes in the smallest grid that holds them
+    /// @param _extent the half size of the box the grid fills, centred on the origin
+    //----------------------------------------------------------------------------------------------------------------------
+    void build(size_t _count, float _extent);
+    size_t size() const {return m_transforms.size();}
+    const std::vector<ngl::Mat4> &transforms() const {return m_transforms;}
+    const std::vector<ngl::Vec3> &colours() const {return m_colours;}
+
+  private :
+    std::vector<ngl::Mat4> m_transforms;
+    std::vector<ngl::Vec3> m_colours;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef CUBETABLE_H_
+#define CUBETABLE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CubeTable.h
+/// @brief compile time cube table, 8 interleaved position / colour vertices and 36 GLubyte indices. Use as
+/// static constexpr auto cube = makeCube();
+/// and the table is in the read only data of the executable ready to be passed to setData.
+//----------------------------------------------------------------------------------------------------------------------
+struct CubeMesh
+{
+  std::array<float, 48> vertAndColour;
+  std::array<uint8_t, 36> indices;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief build the cube
+/// @param _halfSize the distance from the centre to each face
+//----------------------------------------------------------------------------------------------------------------------
+constexpr CubeMesh makeCube(float _halfSize = 1.0f)
+{
+  CubeMesh cube{
+      {{-1, 1, -1, 1, 0, 0,
+        1, 1, -1, 0, 1, 0,
+        1, 1, 1, 0, 0, 1,
+        -1, 1, 1, 1, 1, 1,
+        -1, -1, -1, 0, 0, 1,
+        1, -1, -1, 0, 1, 0,
+        1, -1, 1, 1, 0, 0,
+        -1, -1, 1, 1, 1, 1}},
+      {{0, 1, 5, 0, 4, 5, // back
+        3, 2, 6, 7, 6, 3, // front
+        0, 1, 2, 3, 2, 0, // top
+        4, 5, 6, 7, 6, 4, // bottom
+        0, 3, 4, 4, 7, 3,
+        1, 5, 2, 2, 6, 5}}};
+  // only scale the positions, the colours are the other half of each vertex
+  for (size_t v = 0; v < 8; ++v)
+  {
+    for (size_t i = 0; i < 3; ++i)
+    {
+      cube.vertAndColour[v * 6 + i] *= _halfSize;
+    }
+  }
+  return cube;
+}
+
+#endif
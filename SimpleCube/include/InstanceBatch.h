@@ -0,0 +1,69 @@
+#ifndef INSTANCEBATCH_H_
+#define INSTANCEBATCH_H_
+
+#include <ngl/AbstractVAO.h>
+#include <ngl/Mat4.h>
+#include <ngl/Vec3.h>
+#include <cstddef>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class InstanceBatch
+/// @brief draws many copies of an indexed mesh with one glDrawElementsInstanced. The mesh stays an ordinary
+/// SimpleIndexVAO (vertices at attribute 0 and 1), the batch adds two buffers to the same vertex array, a model
+/// matrix per instance at attributes 2 to 5 and a colour per instance at attribute 6, see ColourVertexInstanced.glsl.
+/// The two are separate so a static set of colours isn't sent again when only the transforms move.
+//----------------------------------------------------------------------------------------------------------------------
+class InstanceBatch
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief attach the instance buffers to _mesh, which must have its data and numIndices set
+    /// @param _mesh the mesh to copy, not owned and must outlive the batch
+    /// @param _indexType the index type given to the mesh's setData
+    //----------------------------------------------------------------------------------------------------------------------
+    InstanceBatch(ngl::AbstractVAO &_mesh, GLenum _indexType);
+    InstanceBatch(const InstanceBatch &)=delete;
+    InstanceBatch &operator=(const InstanceBatch &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief delete the instance buffers, the mesh is left alone. Like removeVAO this needs a current context
+    //----------------------------------------------------------------------------------------------------------------------
+    void remove();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief replace every transform with one upload, the old storage is orphaned so this doesn't wait for the GPU
+    /// to finish drawing with it
+    //----------------------------------------------------------------------------------------------------------------------
+    void setTransforms(const ngl::Mat4 *_transforms, size_t _count);
+    void setColours(const ngl::Vec3 *_colours, size_t _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief overwrite _count transforms from _first in place, they must already be inside the last set
+    //----------------------------------------------------------------------------------------------------------------------
+    void updateTransforms(const ngl::Mat4 *_transforms, size_t _first, size_t _count);
+    void updateColours(const ngl::Vec3 *_colours, size_t _first, size_t _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief map fresh storage for _count transforms to write straight into, saving the copy from a CPU array
+    /// @returns the pointer to write to, only valid until unmapTransforms
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Mat4 *mapTransforms(size_t _count);
+    void unmapTransforms();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bind the mesh and draw every instance that has both a transform and a colour, the program in use
+    /// must take the instance attributes
+    //----------------------------------------------------------------------------------------------------------------------
+    void draw();
+    size_t numInstances() const {return m_numTransforms<m_numColours ? m_numTransforms : m_numColours;}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief orphan _buffer and give it _size bytes of _data (which may be null)
+    //----------------------------------------------------------------------------------------------------------------------
+    static void upload(GLuint _buffer, size_t _size, const void *_data);
+    static void update(GLuint _buffer, size_t _offset, size_t _size, const void *_data);
+    ngl::AbstractVAO &m_mesh;
+    GLenum m_indexType;
+    GLuint m_transformBuffer=0;
+    GLuint m_colourBuffer=0;
+    size_t m_numTransforms=0;
+    size_t m_numColours=0;
+};
+
+#endif
@@ -4,8 +4,13 @@
 #include <ngl/Vec3.h>
 #include <ngl/AbstractVAO.h>
 #include "WindowParams.h"
+#include "UniformHandle.h"
+#include "InstanceBatch.h"
+#include "VoxelVolume.h"
 #include <QOpenGLWindow>
 #include <memory>
+#include <random>
+#include <vector>
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @file NGLScene.h
@@ -25,9 +30,10 @@ class NGLScene : public QOpenGLWindow
   public:
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief ctor for our NGL drawing class
-    /// @param [in] parent the parent window to the class
+    /// @param [in] _numCubes if not 0 draw a grid of this many cubes with one instanced draw rather than one cube
+    /// @param [in] _voxelChunks if not 0 draw a voxel terrain this many chunks across rather than one cube
     //----------------------------------------------------------------------------------------------------------------------
-    NGLScene();
+    NGLScene(size_t _numCubes=0, size_t _voxelChunks=0);
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief dtor must close down ngl and release OpenGL resources
     //----------------------------------------------------------------------------------------------------------------------
@@ -69,6 +75,23 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     std::unique_ptr<ngl::AbstractVAO> m_vao;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the MVP uniform of the shader, found once after linking
+    //----------------------------------------------------------------------------------------------------------------------
+    UniformHandle m_MVPUniform;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the grid of cubes sharing m_vao, only made when m_numCubes isn't 0
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_numCubes=0;
+    std::unique_ptr<InstanceBatch> m_batch;
+    UniformHandle m_instancedMVPUniform;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the voxel terrain and a VAO per chunk of it, only made when m_voxelChunks isn't 0
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_voxelChunks=0;
+    std::unique_ptr<VoxelVolume> m_voxels;
+    std::vector<std::unique_ptr<ngl::AbstractVAO>> m_chunkVAOs;
+    std::minstd_rand m_carveRandom;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief Qt Event called when a key is pressed
     /// @param [in] _event the Qt event to query for size etc
     //----------------------------------------------------------------------------------------------------------------------
@@ -101,6 +124,18 @@ private:
     /// @brief build our VAO
     //----------------------------------------------------------------------------------------------------------------------
     void buildVAO();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief fill the voxel volume with a terrain and mesh it
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildVoxels();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief re-mesh the chunks changed since the last call and replace their VAOs
+    //----------------------------------------------------------------------------------------------------------------------
+    void remeshVoxels();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief empty a ball of voxels somewhere on the terrain
+    //----------------------------------------------------------------------------------------------------------------------
+    void carveVoxels();
 
 
 };
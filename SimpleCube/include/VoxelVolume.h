@@ -0,0 +1,85 @@
+#ifndef VOXELVOLUME_H_
+#define VOXELVOLUME_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class VoxelVolume
+/// @brief a block of voxels stored and meshed in 32^3 chunks. A voxel is a byte, 0 is empty and anything else picks
+/// a colour from the palette. Each chunk's mesh only has the faces between a solid voxel and an empty one, and
+/// neighbouring faces of the same colour in the same plane are merged greedily into one quad, so a flat 32x32 patch
+/// is 2 triangles rather than 2048 for drawing a cube per voxel. The merged quads can meet with T junctions which
+/// may show the odd pixel crack, there is no ambient occlusion or lighting that would stop faces merging.
+/// The meshes are interleaved x,y,z,r,g,b vertices with GLuint indices, the layout of SimpleCube's cube, so each
+/// can be passed to ngl::SimpleIndexVAO::VertexData. set marks the chunk (and a neighbour if the voxel is on its
+/// edge) dirty and remesh rebuilds only the dirty chunks, each on its own job.
+/// This has no GL or NGL in it.
+//----------------------------------------------------------------------------------------------------------------------
+class VoxelVolume
+{
+  public :
+    static constexpr int c_chunkSize=32;
+    static constexpr size_t c_chunkVoxels=c_chunkSize*c_chunkSize*c_chunkSize;
+    static constexpr size_t c_floatsPerVertex=6;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mesh of one chunk in world space
+    //----------------------------------------------------------------------------------------------------------------------
+    struct ChunkMesh
+    {
+      std::vector<float> vertAndColour;
+      std::vector<uint32_t> indices;
+      // the visible voxel faces before merging, each merged quad covers one or more of them
+      size_t faces=0;
+      size_t quads() const {return indices.size()/6;}
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief an empty volume of _chunksX x _chunksY x _chunksZ chunks, every chunk starts dirty
+    //----------------------------------------------------------------------------------------------------------------------
+    VoxelVolume(size_t _chunksX, size_t _chunksY, size_t _chunksZ);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief where voxel 0,0,0's corner is and the size of a voxel, affects meshes built after this
+    //----------------------------------------------------------------------------------------------------------------------
+    void setPlacement(float _voxelSize, float _x, float _y, float _z);
+    void setColour(uint8_t _voxel, float _r, float _g, float _b);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the voxel at x,y,z, outside the volume is empty
+    //----------------------------------------------------------------------------------------------------------------------
+    uint8_t get(int _x, int _y, int _z) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief change a voxel and mark the chunks whose meshes it affects, outside the volume is ignored
+    //----------------------------------------------------------------------------------------------------------------------
+    void set(int _x, int _y, int _z, uint8_t _voxel);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief mesh every dirty chunk in parallel
+    /// @returns the number of chunks meshed, remeshed() lists them
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t remesh();
+    const std::vector<size_t> &remeshed() const {return m_remeshed;}
+    const ChunkMesh &mesh(size_t _chunk) const {return m_meshes[_chunk];}
+    size_t numChunks() const {return m_meshes.size();}
+    int sizeX() const {return static_cast<int>(m_chunks[0])*c_chunkSize;}
+    int sizeY() const {return static_cast<int>(m_chunks[1])*c_chunkSize;}
+    int sizeZ() const {return static_cast<int>(m_chunks[2])*c_chunkSize;}
+    size_t solidVoxels() const;
+
+  private :
+    size_t chunkIndex(size_t _x, size_t _y, size_t _z) const {return _x+m_chunks[0]*(_y+m_chunks[1]*_z);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief build the mesh of one chunk
+    /// @param io_padded scratch space for the chunk and a one voxel border of its neighbours
+    //----------------------------------------------------------------------------------------------------------------------
+    void meshChunk(size_t _chunk, ChunkMesh &o_mesh, std::vector<uint8_t> &io_padded) const;
+    size_t m_chunks[3];
+    // chunk after chunk, x fastest within each
+    std::vector<uint8_t> m_voxels;
+    std::vector<uint8_t> m_dirty;
+    std::vector<ChunkMesh> m_meshes;
+    std::vector<size_t> m_remeshed;
+    float m_palette[256][3];
+    float m_voxelSize=1.0f;
+    float m_origin[3]={0.0f,0.0f,0.0f};
+};
+
+#endif
@@ -0,0 +1,18 @@
+#version 330 core
+/// @brief Model View Projection Matrix shared by every instance
+uniform mat4 MVP;
+
+layout (location=0)in vec3 inVert;
+layout (location=1)in vec3 inColour;
+/// @brief per instance model matrix (locations 2 to 5) and tint, see InstanceBatch
+layout (location=2)in mat4 inTransform;
+layout (location=6)in vec3 inInstanceColour;
+out vec3 vertColour;
+
+void main()
+{
+
+ // calculate the vertex position
+ gl_Position = MVP*inTransform*vec4(inVert, 1.0);
+ vertColour=inColour*inInstanceColour;
+}
@@ -0,0 +1,263 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CubeBenchmark.cpp
+/// @brief times drawing a grid of cubes with InstanceBatch against one draw call (and MVP uniform) per cube. It
+/// needs no window, the frames go to an off screen framebuffer of an off screen surface's context.
+/// SimpleCubeBenchmark [--counts 1000,100000,1000000] [--frames N] [--size S]
+/// Both ways draw the same cubes so the number of covered pixels is compared as a check, the exit status is non
+/// zero if they differ.
+//----------------------------------------------------------------------------------------------------------------------
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <ngl/NGLInit.h>
+#include <ngl/ShaderLib.h>
+#include <ngl/SimpleIndexVAO.h>
+#include <ngl/Util.h>
+#include <ngl/VAOFactory.h>
+#include "CubeGrid.h"
+#include "CubeTable.h"
+#include "InstanceBatch.h"
+#include "UniformHandle.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  constexpr auto ColourShader="ColourShader";
+  constexpr auto InstancedColourShader="InstancedColourShader";
+  // the baseline runs fewer frames as the count grows so a million cubes doesn't take minutes
+  constexpr size_t c_baselineDrawBudget=2000000;
+  // the instanced MVP*model is done on the GPU and the baseline's on the CPU, so a few edge pixels may differ
+  constexpr double c_coverageTolerance=0.001;
+
+  struct FrameStats
+  {
+    size_t frames=0;
+    double cpuMs=0.0;
+    double gpuMs=0.0;
+    size_t coverage=0;
+  };
+
+  std::unique_ptr<ngl::AbstractVAO> makeCubeVAO()
+  {
+    static constexpr auto cube=makeCube();
+    auto vao=ngl::VAOFactory::createVAO(ngl::simpleIndexVAO,GL_TRIANGLES);
+    vao->bind();
+    vao->setData(ngl::SimpleIndexVAO::VertexData(sizeof(cube.vertAndColour),cube.vertAndColour[0],
+                 static_cast<unsigned int>(cube.indices.size()),&cube.indices[0],GL_UNSIGNED_BYTE,GL_STATIC_DRAW));
+    vao->setVertexAttributePointer(0,3,GL_FLOAT,sizeof(ngl::Vec3)*2,0);
+    vao->setVertexAttributePointer(1,3,GL_FLOAT,sizeof(ngl::Vec3)*2,3);
+    vao->setNumIndices(cube.indices.size());
+    vao->unbind();
+    return vao;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a colour and depth framebuffer to draw into, the surface itself has no default framebuffer
+  //----------------------------------------------------------------------------------------------------------------------
+  class Target
+  {
+    public :
+      Target(GLsizei _size) : m_size(_size)
+      {
+        glGenFramebuffers(1,&m_fbo);
+        glGenRenderbuffers(2,m_renderbuffers);
+        glBindRenderbuffer(GL_RENDERBUFFER,m_renderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER,GL_RGBA8,_size,_size);
+        glBindRenderbuffer(GL_RENDERBUFFER,m_renderbuffers[1]);
+        glRenderbufferStorage(GL_RENDERBUFFER,GL_DEPTH_COMPONENT24,_size,_size);
+        glBindFramebuffer(GL_FRAMEBUFFER,m_fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER,GL_COLOR_ATTACHMENT0,GL_RENDERBUFFER,m_renderbuffers[0]);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER,GL_DEPTH_ATTACHMENT,GL_RENDERBUFFER,m_renderbuffers[1]);
+        glViewport(0,0,_size,_size);
+      }
+      ~Target()
+      {
+        glBindFramebuffer(GL_FRAMEBUFFER,0);
+        glDeleteRenderbuffers(2,m_renderbuffers);
+        glDeleteFramebuffers(1,&m_fbo);
+      }
+      bool complete() const {return glCheckFramebufferStatus(GL_FRAMEBUFFER)==GL_FRAMEBUFFER_COMPLETE;}
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the number of pixels not left at the clear colour (black)
+      //----------------------------------------------------------------------------------------------------------------------
+      size_t coverage() const
+      {
+        std::vector<GLubyte> pixels(static_cast<size_t>(m_size)*m_size*4);
+        glReadPixels(0,0,m_size,m_size,GL_RGBA,GL_UNSIGNED_BYTE,pixels.data());
+        size_t covered=0;
+        for(size_t i=0; i<pixels.size(); i+=4)
+        {
+          covered+=(pixels[i] | pixels[i+1] | pixels[i+2])!=0;
+        }
+        return covered;
+      }
+
+    private :
+      GLsizei m_size;
+      GLuint m_fbo=0;
+      GLuint m_renderbuffers[2]={0,0};
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief run _frames of _drawFrame after one warm up frame, each frame is finished before the next so the CPU
+  /// time includes waiting for the GPU
+  //----------------------------------------------------------------------------------------------------------------------
+  template<typename DrawFrame>
+  FrameStats timeFrames(const Target &_target, size_t _frames, DrawFrame &&_drawFrame)
+  {
+    using clock=std::chrono::steady_clock;
+    GLuint query;
+    glGenQueries(1,&query);
+    FrameStats stats;
+    stats.frames=_frames;
+    for(size_t frame=0; frame<=_frames; ++frame)
+    {
+      auto start=clock::now();
+      glBeginQuery(GL_TIME_ELAPSED,query);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      _drawFrame();
+      glEndQuery(GL_TIME_ELAPSED);
+      glFinish();
+      auto end=clock::now();
+      GLuint64 gpuNs=0;
+      glGetQueryObjectui64v(query,GL_QUERY_RESULT,&gpuNs);
+      if(frame>0)
+      {
+        stats.cpuMs+=std::chrono::duration<double,std::milli>(end-start).count();
+        stats.gpuMs+=static_cast<double>(gpuNs)*1.0e-6;
+      }
+    }
+    glDeleteQueries(1,&query);
+    stats.cpuMs/=static_cast<double>(_frames);
+    stats.gpuMs/=static_cast<double>(_frames);
+    stats.coverage=_target.coverage();
+    return stats;
+  }
+
+  void report(const char *_method, size_t _count, size_t _drawCalls, const FrameStats &_stats)
+  {
+    std::cout<<_count<<" cubes "<<_method<<": "<<_stats.cpuMs<<" ms/frame ("<<_stats.gpuMs<<" ms GPU) over "
+             <<_stats.frames<<" frames, "<<_drawCalls<<" draw calls, "
+             <<static_cast<double>(_count)/(_stats.cpuMs*1.0e-3)<<" cubes/sec\n";
+  }
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<size_t> counts={1000,100000,1000000};
+  size_t frames=50;
+  GLsizei size=512;
+  for(int i=1; i<argc; ++i)
+  {
+    std::string arg=argv[i];
+    if(arg=="--counts" && i+1<argc)
+    {
+      counts.clear();
+      std::stringstream list(argv[++i]);
+      std::string count;
+      while(std::getline(list,count,','))
+      {
+        counts.push_back(std::stoul(count));
+      }
+    }
+    else if(arg=="--frames" && i+1<argc)
+    {
+      frames=std::max<size_t>(1,std::stoul(argv[++i]));
+    }
+    else if(arg=="--size" && i+1<argc)
+    {
+      size=std::stoi(argv[++i]);
+    }
+  }
+  QGuiApplication app(argc,argv);
+  QSurfaceFormat format;
+  format.setMajorVersion(4);
+  format.setMinorVersion(1);
+  format.setProfile(QSurfaceFormat::CoreProfile);
+  format.setDepthBufferSize(24);
+  QOpenGLContext context;
+  context.setFormat(format);
+  if(!context.create())
+  {
+    std::cerr<<"couldn't create a GL context\n";
+    return EXIT_FAILURE;
+  }
+  QOffscreenSurface surface;
+  surface.setFormat(context.format());
+  surface.create();
+  if(!context.makeCurrent(&surface))
+  {
+    std::cerr<<"couldn't make the GL context current\n";
+    return EXIT_FAILURE;
+  }
+  ngl::NGLInit::initialize();
+  int status=EXIT_SUCCESS;
+  {
+    Target target(size);
+    if(!target.complete())
+    {
+      std::cerr<<"the off screen framebuffer isn't complete\n";
+      return EXIT_FAILURE;
+    }
+    glClearColor(0.0f,0.0f,0.0f,1.0f);
+    glEnable(GL_DEPTH_TEST);
+    ngl::ShaderLib::loadShader(ColourShader,"shaders/ColourVertex.glsl","shaders/ColourFragment.glsl");
+    ngl::ShaderLib::loadShader(InstancedColourShader,"shaders/ColourVertexInstanced.glsl","shaders/ColourFragment.glsl");
+    UniformHandle MVPUniform(ngl::ShaderLib::getProgramID(ColourShader),"MVP");
+    UniformHandle instancedMVPUniform(ngl::ShaderLib::getProgramID(InstancedColourShader),"MVP");
+    ngl::Mat4 VP=ngl::perspective(45.0f,1.0f,0.05f,350.0f)*ngl::lookAt(ngl::Vec3(0.0f,1.0f,4.0f),ngl::Vec3(0.0f,0.0f,0.0f),
+                                                                         ngl::Vec3(0.0f,1.0f,0.0f));
+
+    auto vao=makeCubeVAO();
+    InstanceBatch batch(*vao,GL_UNSIGNED_BYTE);
+    CubeGrid grid;
+    for(auto count : counts)
+    {
+      grid.build(count,1.5f);
+      const auto &transforms=grid.transforms();
+      // the colours are static, every transform is sent again each frame as if the cubes had moved
+      batch.setColours(grid.colours().data(),count);
+      FrameStats instanced=timeFrames(target,frames,[&]()
+      {
+        batch.setTransforms(transforms.data(),count);
+        ngl::ShaderLib::use(InstancedColourShader);
+        instancedMVPUniform.set(VP);
+        batch.draw();
+      });
+      report("instanced",count,1,instanced);
+
+      size_t baselineFrames=std::clamp<size_t>(c_baselineDrawBudget/std::max<size_t>(count,1),1,frames);
+      FrameStats perCube=timeFrames(target,baselineFrames,[&]()
+      {
+        ngl::ShaderLib::use(ColourShader);
+        vao->bind();
+        for(const auto &tx : transforms)
+        {
+          MVPUniform.set(VP*tx);
+          vao->draw();
+        }
+        vao->unbind();
+      });
+      report("one draw per cube",count,count,perCube);
+      std::cout<<"  instanced is "<<perCube.cpuMs/instanced.cpuMs<<"x faster\n";
+      double difference=static_cast<double>(std::max(instanced.coverage,perCube.coverage)-std::min(instanced.coverage,perCube.coverage));
+      if(difference>c_coverageTolerance*static_cast<double>(size)*size)
+      {
+        std::cerr<<"  the two covered "<<instanced.coverage<<" and "<<perCube.coverage<<" pixels, they should match\n";
+        status=EXIT_FAILURE;
+      }
+    }
+    batch.remove();
+    vao->removeVAO();
+  }
+  context.doneCurrent();
+  return status;
+}
@@ -0,0 +1,35 @@
+#include "CubeGrid.h"
+#include <cmath>
+
+void CubeGrid::build(size_t _count, float _extent)
+{
+  size_t side=static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(_count))));
+  // cbrt may land just under a whole number
+  while(side*side*side<_count)
+  {
+    ++side;
+  }
+  float cell=2.0f*_extent/static_cast<float>(side>0 ? side : 1);
+  // makeCube's half size is 1 so this leaves a fifth of the cell between cubes
+  float scale=0.4f*cell;
+  float shade=1.0f/static_cast<float>(side>0 ? side : 1);
+  m_transforms.resize(_count);
+  m_colours.resize(_count);
+  for(size_t i=0; i<_count; ++i)
+  {
+    size_t x=i%side;
+    size_t y=(i/side)%side;
+    size_t z=i/(side*side);
+    ngl::Mat4 &tx=m_transforms[i];
+    tx=ngl::Mat4();
+    tx.m_m[0][0]=scale;
+    tx.m_m[1][1]=scale;
+    tx.m_m[2][2]=scale;
+    tx.m_m[3][0]=-_extent+(static_cast<float>(x)+0.5f)*cell;
+    tx.m_m[3][1]=-_extent+(static_cast<float>(y)+0.5f)*cell;
+    tx.m_m[3][2]=-_extent+(static_cast<float>(z)+0.5f)*cell;
+    // keep every channel above 0.3 so the cube's own colours still show
+    m_colours[i].set(0.3f+0.7f*static_cast<float>(x)*shade,0.3f+0.7f*static_cast<float>(y)*shade,
+                     0.3f+0.7f*static_cast<float>(z)*shade);
+  }
+}
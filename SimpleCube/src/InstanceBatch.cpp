@@ -0,0 +1,124 @@
+#include "InstanceBatch.h"
+#include <iostream>
+
+// the instance attributes are read straight out of the arrays passed in
+static_assert(sizeof(ngl::Mat4)==16*sizeof(float), "ngl::Mat4 must be 16 packed floats");
+static_assert(sizeof(ngl::Vec3)==3*sizeof(float), "ngl::Vec3 must be 3 packed floats");
+
+namespace
+{
+  // see ColourVertexInstanced.glsl, a mat4 attribute takes four locations one column each
+  constexpr GLuint c_transformAttrib=2;
+  constexpr GLuint c_colourAttrib=6;
+}
+
+InstanceBatch::InstanceBatch(ngl::AbstractVAO &_mesh, GLenum _indexType) : m_mesh(_mesh),m_indexType(_indexType)
+{
+  glGenBuffers(1,&m_transformBuffer);
+  glGenBuffers(1,&m_colourBuffer);
+  m_mesh.bind();
+  glBindBuffer(GL_ARRAY_BUFFER,m_transformBuffer);
+  for(GLuint column=0; column<4; ++column)
+  {
+    glEnableVertexAttribArray(c_transformAttrib+column);
+    glVertexAttribPointer(c_transformAttrib+column,4,GL_FLOAT,GL_FALSE,sizeof(ngl::Mat4),
+                          reinterpret_cast<const GLvoid *>(column*4*sizeof(float)));
+    glVertexAttribDivisor(c_transformAttrib+column,1);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER,m_colourBuffer);
+  glEnableVertexAttribArray(c_colourAttrib);
+  glVertexAttribPointer(c_colourAttrib,3,GL_FLOAT,GL_FALSE,sizeof(ngl::Vec3),nullptr);
+  glVertexAttribDivisor(c_colourAttrib,1);
+  m_mesh.unbind();
+  glBindBuffer(GL_ARRAY_BUFFER,0);
+}
+
+void InstanceBatch::remove()
+{
+  glDeleteBuffers(1,&m_transformBuffer);
+  glDeleteBuffers(1,&m_colourBuffer);
+  m_transformBuffer=0;
+  m_colourBuffer=0;
+  m_numTransforms=0;
+  m_numColours=0;
+}
+
+void InstanceBatch::upload(GLuint _buffer, size_t _size, const void *_data)
+{
+  glBindBuffer(GL_ARRAY_BUFFER,_buffer);
+  // a glBufferData of the whole buffer lets the driver hand out new storage rather than stall on the last draw
+  glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(_size),_data,GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER,0);
+}
+
+void InstanceBatch::update(GLuint _buffer, size_t _offset, size_t _size, const void *_data)
+{
+  glBindBuffer(GL_ARRAY_BUFFER,_buffer);
+  glBufferSubData(GL_ARRAY_BUFFER,static_cast<GLintptr>(_offset),static_cast<GLsizeiptr>(_size),_data);
+  glBindBuffer(GL_ARRAY_BUFFER,0);
+}
+
+void InstanceBatch::setTransforms(const ngl::Mat4 *_transforms, size_t _count)
+{
+  upload(m_transformBuffer,_count*sizeof(ngl::Mat4),_transforms);
+  m_numTransforms=_count;
+}
+
+void InstanceBatch::setColours(const ngl::Vec3 *_colours, size_t _count)
+{
+  upload(m_colourBuffer,_count*sizeof(ngl::Vec3),_colours);
+  m_numColours=_count;
+}
+
+void InstanceBatch::updateTransforms(const ngl::Mat4 *_transforms, size_t _first, size_t _count)
+{
+  if(_first+_count>m_numTransforms)
+  {
+    std::cerr<<"InstanceBatch transforms "<<_first<<" to "<<_first+_count<<" are past the "<<m_numTransforms<<" set\n";
+    return;
+  }
+  update(m_transformBuffer,_first*sizeof(ngl::Mat4),_count*sizeof(ngl::Mat4),_transforms);
+}
+
+void InstanceBatch::updateColours(const ngl::Vec3 *_colours, size_t _first, size_t _count)
+{
+  if(_first+_count>m_numColours)
+  {
+    std::cerr<<"InstanceBatch colours "<<_first<<" to "<<_first+_count<<" are past the "<<m_numColours<<" set\n";
+    return;
+  }
+  update(m_colourBuffer,_first*sizeof(ngl::Vec3),_count*sizeof(ngl::Vec3),_colours);
+}
+
+ngl::Mat4 *InstanceBatch::mapTransforms(size_t _count)
+{
+  size_t size=_count*sizeof(ngl::Mat4);
+  glBindBuffer(GL_ARRAY_BUFFER,m_transformBuffer);
+  if(_count!=m_numTransforms)
+  {
+    glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(size),nullptr,GL_DYNAMIC_DRAW);
+  }
+  m_numTransforms=_count;
+  return static_cast<ngl::Mat4 *>(glMapBufferRange(GL_ARRAY_BUFFER,0,static_cast<GLsizeiptr>(size),
+                                                   GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+}
+
+void InstanceBatch::unmapTransforms()
+{
+  glBindBuffer(GL_ARRAY_BUFFER,m_transformBuffer);
+  glUnmapBuffer(GL_ARRAY_BUFFER);
+  glBindBuffer(GL_ARRAY_BUFFER,0);
+}
+
+void InstanceBatch::draw()
+{
+  size_t count=numInstances();
+  if(count==0)
+  {
+    return;
+  }
+  m_mesh.bind();
+  glDrawElementsInstanced(m_mesh.getMode(),static_cast<GLsizei>(m_mesh.numIndices()),m_indexType,nullptr,
+                          static_cast<GLsizei>(count));
+  m_mesh.unbind();
+}
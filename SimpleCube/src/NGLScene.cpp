@@ -8,9 +8,13 @@
 #include <ngl/VAOFactory.h>
 #include <ngl/SimpleIndexVAO.h>
 #include <ngl/Transformation.h>
+#include "CubeTable.h"
+#include "CubeGrid.h"
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
-NGLScene::NGLScene()
+NGLScene::NGLScene(size_t _numCubes, size_t _voxelChunks) : m_numCubes(_numCubes), m_voxelChunks(_voxelChunks)
 {
   setTitle("Qt5 Simple NGL Demo");
 }
@@ -18,6 +22,17 @@ NGLScene::NGLScene()
 NGLScene::~NGLScene()
 {
   std::cout << "Shutting down NGL, removing VAO's and Shaders\n";
+  if (m_batch)
+  {
+    m_batch->remove();
+  }
+  for (auto &vao : m_chunkVAOs)
+  {
+    if (vao)
+    {
+      vao->removeVAO();
+    }
+  }
   m_vao->removeVAO();
 }
 
@@ -29,6 +44,7 @@ void NGLScene::resizeGL(int _w, int _h)
 }
 
 constexpr auto ColourShader = "ColourShader";
+constexpr auto InstancedColourShader = "InstancedColourShader";
 
 void NGLScene::initializeGL()
 {
@@ -70,8 +86,123 @@ void NGLScene::initializeGL()
   ngl::ShaderLib::attachShaderToProgram(ColourShader, ColourFragment);
 
   ngl::ShaderLib::linkProgramObject(ColourShader);
+  // looked up once here so paintGL sets MVP without a name lookup
+  m_MVPUniform = UniformHandle(ngl::ShaderLib::getProgramID(ColourShader), "MVP");
+  if (m_numCubes > 0)
+  {
+    // the same fragment shader with the model matrix and tint coming from each instance
+    ngl::ShaderLib::loadShader(InstancedColourShader, "shaders/ColourVertexInstanced.glsl", "shaders/ColourFragment.glsl");
+    m_instancedMVPUniform = UniformHandle(ngl::ShaderLib::getProgramID(InstancedColourShader), "MVP");
+  }
 
   buildVAO();
+  if (m_voxelChunks > 0)
+  {
+    buildVoxels();
+  }
+}
+
+void NGLScene::buildVoxels()
+{
+  // two chunks high, the whole volume is scaled to about 3 units across to fit the camera
+  m_voxels = std::make_unique<VoxelVolume>(m_voxelChunks, 2, m_voxelChunks);
+  int sizeX = m_voxels->sizeX();
+  int sizeY = m_voxels->sizeY();
+  int sizeZ = m_voxels->sizeZ();
+  float voxelSize = 3.0f / static_cast<float>(sizeX);
+  m_voxels->setPlacement(voxelSize, -0.5f * sizeX * voxelSize, -0.5f * sizeY * voxelSize, -0.5f * sizeZ * voxelSize);
+  enum : uint8_t { Stone = 1, Dirt, Grass, Snow };
+  m_voxels->setColour(Stone, 0.5f, 0.5f, 0.5f);
+  m_voxels->setColour(Dirt, 0.45f, 0.3f, 0.15f);
+  m_voxels->setColour(Grass, 0.2f, 0.6f, 0.2f);
+  m_voxels->setColour(Snow, 0.95f, 0.95f, 0.95f);
+  for (int z = 0; z < sizeZ; ++z)
+  {
+    for (int x = 0; x < sizeX; ++x)
+    {
+      float height = sizeY * (0.45f + 0.25f * std::sin(x * 0.05f) * std::cos(z * 0.04f) + 0.05f * std::sin((x + z) * 0.2f));
+      int top = static_cast<int>(height);
+      for (int y = 0; y < top; ++y)
+      {
+        uint8_t voxel = y < top - 4 ? Stone : y < top - 1 ? Dirt : Grass;
+        if (y == top - 1 && y > sizeY * 3 / 4)
+        {
+          voxel = Snow;
+        }
+        m_voxels->set(x, y, z, voxel);
+      }
+    }
+  }
+  m_chunkVAOs.resize(m_voxels->numChunks());
+  remeshVoxels();
+}
+
+void NGLScene::remeshVoxels()
+{
+  auto start = std::chrono::steady_clock::now();
+  size_t meshed = m_voxels->remesh();
+  auto end = std::chrono::steady_clock::now();
+  for (auto chunk : m_voxels->remeshed())
+  {
+    // a changed chunk gets a fresh VAO sized for its new mesh, an empty one gets none
+    if (m_chunkVAOs[chunk])
+    {
+      m_chunkVAOs[chunk]->removeVAO();
+      m_chunkVAOs[chunk].reset();
+    }
+    const auto &mesh = m_voxels->mesh(chunk);
+    if (mesh.indices.empty())
+    {
+      continue;
+    }
+    m_chunkVAOs[chunk] = ngl::VAOFactory::createVAO(ngl::simpleIndexVAO, GL_TRIANGLES);
+    m_chunkVAOs[chunk]->bind();
+    m_chunkVAOs[chunk]->setData(ngl::SimpleIndexVAO::VertexData(mesh.vertAndColour.size() * sizeof(float), mesh.vertAndColour[0], static_cast<unsigned int>(mesh.indices.size()), &mesh.indices[0], GL_UNSIGNED_INT, GL_STATIC_DRAW));
+    m_chunkVAOs[chunk]->setVertexAttributePointer(0, 3, GL_FLOAT, sizeof(ngl::Vec3) * 2, 0);
+    m_chunkVAOs[chunk]->setVertexAttributePointer(1, 3, GL_FLOAT, sizeof(ngl::Vec3) * 2, 3);
+    m_chunkVAOs[chunk]->setNumIndices(mesh.indices.size());
+    m_chunkVAOs[chunk]->unbind();
+  }
+  size_t faces = 0;
+  size_t quads = 0;
+  for (size_t i = 0; i < m_voxels->numChunks(); ++i)
+  {
+    faces += m_voxels->mesh(i).faces;
+    quads += m_voxels->mesh(i).quads();
+  }
+  std::cout << "meshed " << meshed << " of " << m_voxels->numChunks() << " chunks in "
+            << std::chrono::duration<double, std::milli>(end - start).count() << " ms, triangles for "
+            << m_voxels->solidVoxels() << " voxels: " << m_voxels->solidVoxels() * 12 << " as cubes, "
+            << faces * 2 << " visible faces, " << quads * 2 << " merged\n";
+}
+
+void NGLScene::carveVoxels()
+{
+  std::uniform_int_distribution<int> x(0, m_voxels->sizeX() - 1);
+  std::uniform_int_distribution<int> z(0, m_voxels->sizeZ() - 1);
+  int cx = x(m_carveRandom);
+  int cz = z(m_carveRandom);
+  // start from the surface so the hole can be seen
+  int cy = m_voxels->sizeY() - 1;
+  while (cy > 0 && m_voxels->get(cx, cy, cz) == 0)
+  {
+    --cy;
+  }
+  constexpr int radius = 8;
+  for (int dz = -radius; dz <= radius; ++dz)
+  {
+    for (int dy = -radius; dy <= radius; ++dy)
+    {
+      for (int dx = -radius; dx <= radius; ++dx)
+      {
+        if (dx * dx + dy * dy + dz * dz <= radius * radius)
+        {
+          m_voxels->set(cx + dx, cy + dy, cz + dz, 0);
+        }
+      }
+    }
+  }
+  remeshVoxels();
 }
 
 void NGLScene::buildVAO()
@@ -80,32 +211,27 @@ void NGLScene::buildVAO()
   m_vao = ngl::VAOFactory::createVAO(ngl::simpleIndexVAO, GL_TRIANGLES);
   m_vao->bind();
 
-  const static GLubyte indices[] = {
-      0, 1, 5, 0, 4, 5, // back
-      3, 2, 6, 7, 6, 3, // front
-      0, 1, 2, 3, 2, 0, // top
-      4, 5, 6, 7, 6, 4, // bottom
-      0, 3, 4, 4, 7, 3,
-      1, 5, 2, 2, 6, 5};
-
-  GLfloat vertcolour[] = {-1, 1, -1, 1, 0, 0,
-                          1, 1, -1, 0, 1, 0,
-                          1, 1, 1, 0, 0, 1,
-                          -1, 1, 1, 1, 1, 1,
-                          -1, -1, -1, 0, 0, 1,
-                          1, -1, -1, 0, 1, 0,
-                          1, -1, 1, 1, 0, 0,
-                          -1, -1, 1, 1, 1, 1};
+  // built by the compiler, see CubeTable.h
+  static constexpr auto cube = makeCube();
 
   // in this case we are going to set our data as the vertices above
 
-  m_vao->setData(ngl::SimpleIndexVAO::VertexData(48 * sizeof(GLfloat), vertcolour[0], sizeof(indices), &indices[0], GL_UNSIGNED_BYTE, GL_STATIC_DRAW));
+  m_vao->setData(ngl::SimpleIndexVAO::VertexData(sizeof(cube.vertAndColour), cube.vertAndColour[0], static_cast<unsigned int>(cube.indices.size()), &cube.indices[0], GL_UNSIGNED_BYTE, GL_STATIC_DRAW));
   // now we set the attribute pointer to be 0 (as this matches vertIn in our shader)
   m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, sizeof(ngl::Vec3) * 2, 0);
-  m_vao->setVertexAttributePointer(1, 3, GL_FLOAT, sizeof(ngl::Vec3) * 2, sizeof(ngl::Vec3));
-  m_vao->setNumIndices(sizeof(indices));
+  m_vao->setVertexAttributePointer(1, 3, GL_FLOAT, sizeof(ngl::Vec3) * 2, 3);
+  m_vao->setNumIndices(cube.indices.size());
   // now unbind
   m_vao->unbind();
+  if (m_numCubes > 0)
+  {
+    // the grid doesn't move so the instance data is sent once, the mouse transform is applied through MVP
+    CubeGrid grid;
+    grid.build(m_numCubes, 1.5f);
+    m_batch = std::make_unique<InstanceBatch>(*m_vao, GL_UNSIGNED_BYTE);
+    m_batch->setTransforms(grid.transforms().data(), grid.size());
+    m_batch->setColours(grid.colours().data(), grid.size());
+  }
 }
 
 void NGLScene::paintGL()
@@ -125,11 +251,32 @@ void NGLScene::paintGL()
   m_mouseGlobalTX.m_m[3][1] = m_modelPos.m_y;
   m_mouseGlobalTX.m_m[3][2] = m_modelPos.m_z;
 
-  ngl::ShaderLib::use(ColourShader);
-
   ngl::Mat4 MVP;
   MVP = m_project * m_view * m_mouseGlobalTX;
-  ngl::ShaderLib::setUniform("MVP", MVP);
+  if (m_voxels)
+  {
+    ngl::ShaderLib::use(ColourShader);
+    m_MVPUniform.set(MVP);
+    for (auto &vao : m_chunkVAOs)
+    {
+      if (vao)
+      {
+        vao->bind();
+        vao->draw();
+        vao->unbind();
+      }
+    }
+    return;
+  }
+  if (m_batch)
+  {
+    ngl::ShaderLib::use(InstancedColourShader);
+    m_instancedMVPUniform.set(MVP);
+    m_batch->draw();
+    return;
+  }
+  ngl::ShaderLib::use(ColourShader);
+  m_MVPUniform.set(MVP);
   m_vao->bind();
   m_vao->draw();
   m_vao->unbind();
@@ -255,6 +402,14 @@ void NGLScene::keyPressEvent(QKeyEvent *_event)
   case Qt::Key_N:
     showNormal();
     break;
+  // dig a hole in the voxel terrain, only the chunks it touches are meshed again
+  case Qt::Key_Space:
+    if (m_voxels)
+    {
+      makeCurrent();
+      carveVoxels();
+    }
+    break;
   default:
     break;
   }
@@ -0,0 +1,233 @@
+#include "VoxelVolume.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+  // the chunk with a one voxel border so faces on its edge can see the neighbouring chunk
+  constexpr int c_padded=VoxelVolume::c_chunkSize+2;
+
+  size_t paddedIndex(int _x, int _y, int _z)
+  {
+    return static_cast<size_t>((_x+1)+c_padded*((_y+1)+c_padded*(_z+1)));
+  }
+}
+
+VoxelVolume::VoxelVolume(size_t _chunksX, size_t _chunksY, size_t _chunksZ) :
+  m_chunks{_chunksX,_chunksY,_chunksZ}
+{
+  size_t count=_chunksX*_chunksY*_chunksZ;
+  m_voxels.assign(count*c_chunkVoxels,0);
+  m_dirty.assign(count,1);
+  m_meshes.resize(count);
+  for(size_t i=0; i<256; ++i)
+  {
+    m_palette[i][0]=m_palette[i][1]=m_palette[i][2]=1.0f;
+  }
+}
+
+void VoxelVolume::setPlacement(float _voxelSize, float _x, float _y, float _z)
+{
+  m_voxelSize=_voxelSize;
+  m_origin[0]=_x;
+  m_origin[1]=_y;
+  m_origin[2]=_z;
+}
+
+void VoxelVolume::setColour(uint8_t _voxel, float _r, float _g, float _b)
+{
+  m_palette[_voxel][0]=_r;
+  m_palette[_voxel][1]=_g;
+  m_palette[_voxel][2]=_b;
+}
+
+uint8_t VoxelVolume::get(int _x, int _y, int _z) const
+{
+  if(_x<0 || _y<0 || _z<0 || _x>=sizeX() || _y>=sizeY() || _z>=sizeZ())
+  {
+    return 0;
+  }
+  size_t chunk=chunkIndex(_x/c_chunkSize,_y/c_chunkSize,_z/c_chunkSize);
+  size_t local=(_x%c_chunkSize)+c_chunkSize*((_y%c_chunkSize)+c_chunkSize*(_z%c_chunkSize));
+  return m_voxels[chunk*c_chunkVoxels+local];
+}
+
+void VoxelVolume::set(int _x, int _y, int _z, uint8_t _voxel)
+{
+  if(_x<0 || _y<0 || _z<0 || _x>=sizeX() || _y>=sizeY() || _z>=sizeZ())
+  {
+    return;
+  }
+  size_t c[3]={static_cast<size_t>(_x/c_chunkSize),static_cast<size_t>(_y/c_chunkSize),static_cast<size_t>(_z/c_chunkSize)};
+  int l[3]={_x%c_chunkSize,_y%c_chunkSize,_z%c_chunkSize};
+  size_t chunk=chunkIndex(c[0],c[1],c[2]);
+  uint8_t &voxel=m_voxels[chunk*c_chunkVoxels+static_cast<size_t>(l[0]+c_chunkSize*(l[1]+c_chunkSize*l[2]))];
+  if(voxel==_voxel)
+  {
+    return;
+  }
+  voxel=_voxel;
+  m_dirty[chunk]=1;
+  // a voxel on the edge of its chunk also hides or shows a face of the neighbour
+  for(size_t axis=0; axis<3; ++axis)
+  {
+    size_t n[3]={c[0],c[1],c[2]};
+    if(l[axis]==0 && c[axis]>0)
+    {
+      --n[axis];
+      m_dirty[chunkIndex(n[0],n[1],n[2])]=1;
+    }
+    else if(l[axis]==c_chunkSize-1 && c[axis]+1<m_chunks[axis])
+    {
+      ++n[axis];
+      m_dirty[chunkIndex(n[0],n[1],n[2])]=1;
+    }
+  }
+}
+
+size_t VoxelVolume::solidVoxels() const
+{
+  return static_cast<size_t>(m_voxels.size()-static_cast<size_t>(std::count(m_voxels.begin(),m_voxels.end(),uint8_t(0))));
+}
+
+size_t VoxelVolume::remesh()
+{
+  m_remeshed.clear();
+  for(size_t i=0; i<m_dirty.size(); ++i)
+  {
+    if(m_dirty[i])
+    {
+      m_remeshed.push_back(i);
+      m_dirty[i]=0;
+    }
+  }
+  // a chunk is plenty of work for a job so one chunk per job, each job keeps its own scratch
+  parallelFor(m_remeshed.size(),parallelChunks(m_remeshed.size(),1),[this](size_t,size_t _begin,size_t _end)
+  {
+    std::vector<uint8_t> padded(static_cast<size_t>(c_padded*c_padded*c_padded));
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      meshChunk(m_remeshed[i],m_meshes[m_remeshed[i]],padded);
+    }
+  });
+  return m_remeshed.size();
+}
+
+void VoxelVolume::meshChunk(size_t _chunk, ChunkMesh &o_mesh, std::vector<uint8_t> &io_padded) const
+{
+  int base[3]={static_cast<int>(_chunk%m_chunks[0])*c_chunkSize,
+               static_cast<int>(_chunk/m_chunks[0]%m_chunks[1])*c_chunkSize,
+               static_cast<int>(_chunk/(m_chunks[0]*m_chunks[1]))*c_chunkSize};
+  const uint8_t *voxels=&m_voxels[_chunk*c_chunkVoxels];
+  // copy the chunk a row at a time and fetch the border through get
+  for(int z=-1; z<=c_chunkSize; ++z)
+  {
+    for(int y=-1; y<=c_chunkSize; ++y)
+    {
+      bool inside=z>=0 && z<c_chunkSize && y>=0 && y<c_chunkSize;
+      if(inside)
+      {
+        std::memcpy(&io_padded[paddedIndex(0,y,z)],&voxels[static_cast<size_t>(c_chunkSize*(y+c_chunkSize*z))],c_chunkSize);
+        io_padded[paddedIndex(-1,y,z)]=get(base[0]-1,base[1]+y,base[2]+z);
+        io_padded[paddedIndex(c_chunkSize,y,z)]=get(base[0]+c_chunkSize,base[1]+y,base[2]+z);
+      }
+      else
+      {
+        for(int x=-1; x<=c_chunkSize; ++x)
+        {
+          io_padded[paddedIndex(x,y,z)]=get(base[0]+x,base[1]+y,base[2]+z);
+        }
+      }
+    }
+  }
+
+  o_mesh.vertAndColour.clear();
+  o_mesh.indices.clear();
+  o_mesh.faces=0;
+  uint8_t mask[c_chunkSize*c_chunkSize];
+  for(int d=0; d<3; ++d)
+  {
+    // u x v is +d so u,v corners in order are anticlockwise seen from +d
+    int u=(d+1)%3;
+    int v=(d+2)%3;
+    for(int side=-1; side<=1; side+=2)
+    {
+      for(int slice=0; slice<c_chunkSize; ++slice)
+      {
+        // the colour of each face of this slice facing side, 0 where the neighbour hides it
+        int p[3];
+        p[d]=slice;
+        for(int j=0; j<c_chunkSize; ++j)
+        {
+          p[v]=j;
+          for(int i=0; i<c_chunkSize; ++i)
+          {
+            p[u]=i;
+            uint8_t voxel=io_padded[paddedIndex(p[0],p[1],p[2])];
+            int q[3]={p[0],p[1],p[2]};
+            q[d]+=side;
+            bool visible=voxel!=0 && io_padded[paddedIndex(q[0],q[1],q[2])]==0;
+            mask[i+c_chunkSize*j]=visible ? voxel : 0;
+            o_mesh.faces+=visible;
+          }
+        }
+        // grow each face along u while the colour matches then along v while whole rows match
+        for(int j=0; j<c_chunkSize; ++j)
+        {
+          for(int i=0; i<c_chunkSize;)
+          {
+            uint8_t colour=mask[i+c_chunkSize*j];
+            if(colour==0)
+            {
+              ++i;
+              continue;
+            }
+            int w=1;
+            while(i+w<c_chunkSize && mask[i+w+c_chunkSize*j]==colour)
+            {
+              ++w;
+            }
+            int h=1;
+            for(; j+h<c_chunkSize; ++h)
+            {
+              const uint8_t *row=&mask[i+c_chunkSize*(j+h)];
+              if(std::any_of(row,row+w,[colour](uint8_t _m){return _m!=colour;}))
+              {
+                break;
+              }
+            }
+            for(int y=0; y<h; ++y)
+            {
+              std::memset(&mask[i+c_chunkSize*(j+y)],0,static_cast<size_t>(w));
+            }
+
+            uint32_t first=static_cast<uint32_t>(o_mesh.vertAndColour.size()/c_floatsPerVertex);
+            int corners[4][2]={{i,j},{i+w,j},{i+w,j+h},{i,j+h}};
+            for(auto &corner : corners)
+            {
+              float c[3];
+              c[d]=static_cast<float>(base[d]+slice+(side>0 ? 1 : 0));
+              c[u]=static_cast<float>(base[u]+corner[0]);
+              c[v]=static_cast<float>(base[v]+corner[1]);
+              for(int a=0; a<3; ++a)
+              {
+                o_mesh.vertAndColour.push_back(m_origin[a]+c[a]*m_voxelSize);
+              }
+              o_mesh.vertAndColour.insert(o_mesh.vertAndColour.end(),m_palette[colour],m_palette[colour]+3);
+            }
+            if(side>0)
+            {
+              o_mesh.indices.insert(o_mesh.indices.end(),{first,first+1,first+2,first,first+2,first+3});
+            }
+            else
+            {
+              o_mesh.indices.insert(o_mesh.indices.end(),{first,first+2,first+1,first,first+3,first+2});
+            }
+            i+=w;
+          }
+        }
+      }
+    }
+  }
+}
@@ -4,12 +4,29 @@ basic OpenGL demo modified from http://qt-project.org/doc/qt-5.0/qtgui/openglwin
 
 #include <QtGui/QGuiApplication>
 #include <iostream>
+#include <string>
 #include "NGLScene.h"
 
 
 
 int main(int argc, char **argv)
 {
+  // --cubes N draws a grid of N cubes with one instanced draw call, see SimpleCubeBenchmark for the timings.
+  // --voxels N draws a voxel terrain N 32^3 chunks across, space digs holes in it
+  size_t numCubes = 0;
+  size_t voxelChunks = 0;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--cubes" && i + 1 < argc)
+    {
+      numCubes = std::stoul(argv[++i]);
+    }
+    else if (arg == "--voxels" && i + 1 < argc)
+    {
+      voxelChunks = std::stoul(argv[++i]);
+    }
+  }
   QGuiApplication app(argc, argv);
   // create an OpenGL format specifier
   QSurfaceFormat format;
@@ -31,7 +48,7 @@ int main(int argc, char **argv)
   // now set the depth buffer to 24 bits
   format.setDepthBufferSize(24);
   // now we are going to create our scene window
-  NGLScene window;
+  NGLScene window(numCubes, voxelChunks);
   // and set the OpenGL format
   window.setFormat(format);
   // we can now query the version to see if it worked
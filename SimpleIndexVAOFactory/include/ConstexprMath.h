@@ -0,0 +1,103 @@
+#ifndef CONSTEXPRMATH_H_
+#define CONSTEXPRMATH_H_
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ConstexprMath.h
+/// @brief the std maths functions aren't constexpr so these are used to build mesh tables at compile time.
+/// They work in double and are accurate to well below float precision which is all the tables need.
+//----------------------------------------------------------------------------------------------------------------------
+namespace cmath
+{
+  constexpr double c_pi = 3.14159265358979323846;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a simple x,y,z triple that can be built at compile time (ngl::Vec3 can't)
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Float3
+  {
+    float x;
+    float y;
+    float z;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief square root using Newton Raphson
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr double sqrt(double _x)
+  {
+    if (_x <= 0.0)
+    {
+      return 0.0;
+    }
+    // start above the root, Newton then decreases monotonically until it
+    // can't get any closer in double precision
+    double guess = _x < 1.0 ? 1.0 : _x;
+    while (true)
+    {
+      double next = 0.5 * (guess + _x / guess);
+      if (next >= guess)
+      {
+        return guess;
+      }
+      guess = next;
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Taylor series for sin and cos, only valid for |x| <= pi/4
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr double sinReduced(double _x)
+  {
+    double x2 = _x * _x;
+    return _x * (1.0 - x2 / 6.0 * (1.0 - x2 / 20.0 * (1.0 - x2 / 42.0 * (1.0 - x2 / 72.0 * (1.0 - x2 / 110.0 * (1.0 - x2 / 156.0))))));
+  }
+  constexpr double cosReduced(double _x)
+  {
+    double x2 = _x * _x;
+    return 1.0 - x2 / 2.0 * (1.0 - x2 / 12.0 * (1.0 - x2 / 30.0 * (1.0 - x2 / 56.0 * (1.0 - x2 / 90.0 * (1.0 - x2 / 132.0)))));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief sin and cos of any angle, reduced to a quadrant then evaluated with the series above
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr void sincos(double _angle, double &o_sin, double &o_cos)
+  {
+    double q = _angle / (c_pi * 0.5);
+    long long n = static_cast<long long>(q >= 0.0 ? q + 0.5 : q - 0.5);
+    double r = _angle - static_cast<double>(n) * (c_pi * 0.5);
+    double s = sinReduced(r);
+    double c = cosReduced(r);
+    // two's complement so this is also right for negative quadrants
+    switch (n & 3)
+    {
+    case 0:
+      o_sin = s;
+      o_cos = c;
+      break;
+    case 1:
+      o_sin = c;
+      o_cos = -s;
+      break;
+    case 2:
+      o_sin = -s;
+      o_cos = -c;
+      break;
+    default:
+      o_sin = -c;
+      o_cos = s;
+      break;
+    }
+  }
+  constexpr double sin(double _angle)
+  {
+    double s = 0.0;
+    double c = 0.0;
+    sincos(_angle, s, c);
+    return s;
+  }
+  constexpr double cos(double _angle)
+  {
+    double s = 0.0;
+    double c = 0.0;
+    sincos(_angle, s, c);
+    return c;
+  }
+} // end namespace cmath
+
+#endif
@@ -4,8 +4,10 @@
 #include <ngl/Mat4.h>
 #include <ngl/Vec3.h>
 #include "WindowParams.h"
+#include "UniformHandle.h"
 #include <QOpenGLWindow>
 #include <memory>
+#include <string>
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @file NGLScene.h
@@ -25,9 +27,9 @@ class NGLScene : public QOpenGLWindow
   public:
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief ctor for our NGL drawing class
-    /// @param [in] parent the parent window to the class
+    /// @param [in] _objFile an OBJ file to draw, the icosahedron is drawn if this is empty or can't be read
     //----------------------------------------------------------------------------------------------------------------------
-    NGLScene();
+    NGLScene(const std::string &_objFile="");
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief dtor must close down ngl and release OpenGL resources
     //----------------------------------------------------------------------------------------------------------------------
@@ -68,6 +70,15 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     std::unique_ptr<ngl::AbstractVAO> m_vao;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the MVP uniform of the shader, found once after linking
+    //----------------------------------------------------------------------------------------------------------------------
+    UniformHandle m_MVPUniform;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief an OBJ file to draw rather than the icosahedron and the transform fitting it in a unit box
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string m_objFile;
+    ngl::Mat4 m_modelTX;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief Qt Event called when a key is pressed
     /// @param [in] _event the Qt event to query for size etc
     //----------------------------------------------------------------------------------------------------------------------
@@ -100,6 +111,11 @@ private:
     /// @brief build our VAO
     //----------------------------------------------------------------------------------------------------------------------
     void buildVAO();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief load m_objFile into m_vao
+    /// @returns false if it couldn't be read
+    //----------------------------------------------------------------------------------------------------------------------
+    bool buildObjVAO();
 
 
 };
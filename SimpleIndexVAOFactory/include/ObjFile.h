@@ -0,0 +1,105 @@
+#ifndef OBJFILE_H_
+#define OBJFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class ObjFile
+/// @brief a Wavefront OBJ loader for very large meshes producing the interleaved vertices and indices an
+/// ngl::SimpleIndexVAO takes. The file is memory mapped and cut into chunks at line ends which are parsed on the job
+/// system, a first quick pass counts the v, vt and vn lines of each chunk so every chunk knows where its attributes
+/// go and can resolve negative (relative) indices itself. Numbers are read with a small parser rather than strtof.
+/// Polygons are split into triangle fans. Each face corner is a position / uv / normal tuple, equal tuples become one
+/// vertex through hash tables sharded by the tuple's hash so each shard is filled on its own job, vertices are
+/// numbered in the order they are first used so the result is the same as a serial load whatever the thread count.
+/// Only geometry is read, groups, materials, lines and points are skipped. Indices are 32 bit so a mesh is limited
+/// to 4G corners. This has no GL or NGL in it.
+//----------------------------------------------------------------------------------------------------------------------
+class ObjFile
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief milliseconds spent in each stage of the last load
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Timings
+    {
+      double parse=0.0;
+      double dedup=0.0;
+      double total() const {return parse+dedup;}
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief read a file, replacing anything loaded before
+    /// @returns false if it can't be read or has a malformed or out of range face, the reason is printed
+    //----------------------------------------------------------------------------------------------------------------------
+    bool load(const std::string &_fname);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief x,y,z then nx,ny,nz if the file has normals then u,v if it has uvs, a corner without one gets zeros
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<float> &vertices() const {return m_vertices;}
+    const std::vector<uint32_t> &indices() const {return m_indices;}
+    size_t floatsPerVertex() const {return 3+(m_hasNormals ? 3 : 0)+(m_hasUVs ? 2 : 0);}
+    size_t numVertices() const {return m_vertices.size()/floatsPerVertex();}
+    bool hasNormals() const {return m_hasNormals;}
+    bool hasUVs() const {return m_hasUVs;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief offsets in floats of the attributes in a vertex, for setVertexAttributePointer
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t normalOffset() const {return 3;}
+    size_t uvOffset() const {return m_hasNormals ? 6 : 3;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the bounding box of every v line, used or not
+    //----------------------------------------------------------------------------------------------------------------------
+    void bounds(float o_min[3], float o_max[3]) const;
+    const Timings &timings() const {return m_timings;}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a face corner as indices into the position, uv and normal arrays, c_none where one isn't given
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Corner
+    {
+      uint32_t v;
+      uint32_t t;
+      uint32_t n;
+      bool operator==(const Corner &_c) const {return v==_c.v && t==_c.t && n==_c.n;}
+    };
+    static constexpr uint32_t c_none=UINT32_MAX;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the lines of the mapping split into chunks with what each chunk adds
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Chunk
+    {
+      const char *begin;
+      const char *end;
+      // the number of each attribute before this chunk, then in it
+      size_t first[3]={0,0,0};
+      size_t count[3]={0,0,0};
+      std::vector<Corner> corners;
+      float min[3];
+      float max[3];
+      // the byte offset of the first bad line, or SIZE_MAX
+      size_t error=SIZE_MAX;
+    };
+    bool parse(const char *_begin, const char *_end);
+    void parseChunk(Chunk &io_chunk, const char *_file, size_t _totals[3]);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief give each distinct corner a vertex in first use order and write the vertices and indices
+    //----------------------------------------------------------------------------------------------------------------------
+    void dedup(const std::vector<Corner> &_corners);
+    // the attributes as read, only kept during a load
+    std::vector<float> m_positions;
+    std::vector<float> m_uvs;
+    std::vector<float> m_normals;
+    std::vector<float> m_vertices;
+    std::vector<uint32_t> m_indices;
+    float m_min[3]={0.0f,0.0f,0.0f};
+    float m_max[3]={0.0f,0.0f,0.0f};
+    bool m_hasNormals=false;
+    bool m_hasUVs=false;
+    Timings m_timings;
+};
+
+#endif
@@ -0,0 +1,266 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <iostream>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace
+{
+  JobSystem::Options g_instanceOptions;
+  std::atomic<bool> g_instanceCreated={false};
+  // set for the worker threads so they use their own queue
+  thread_local const JobSystem *t_system=nullptr;
+  thread_local size_t t_index=0;
+
+  void pinToCore(std::thread &_thread, size_t _core)
+  {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<int>(_core),&set);
+    if(pthread_setaffinity_np(_thread.native_handle(),sizeof(cpu_set_t),&set) !=0)
+    {
+      std::cerr<<"JobSystem unable to pin worker to core "<<_core<<'\n';
+    }
+#elif defined(_WIN32)
+    SetThreadAffinityMask(_thread.native_handle(),DWORD_PTR(1)<<(_core%(sizeof(DWORD_PTR)*8)));
+#else
+    // macOS only has affinity hints so the scheduler is left to it
+    (void)_thread;
+    (void)_core;
+#endif
+  }
+}
+
+JobSystem::JobSystem() : JobSystem(Options())
+{
+}
+
+JobSystem::JobSystem(const Options &_options)
+{
+  size_t threads=_options.threads !=0 ? _options.threads : std::max(1u,std::thread::hardware_concurrency());
+  size_t cores=std::max(1u,std::thread::hardware_concurrency());
+  for(size_t i=0; i<threads; ++i)
+  {
+    m_queues.push_back(std::make_unique<Queue>());
+  }
+  // queue 0 belongs to whoever calls in, the workers are 1..threads-1
+  for(size_t i=1; i<threads; ++i)
+  {
+    m_workers.emplace_back(&JobSystem::workerLoop,this,i);
+    if(_options.pinThreads)
+    {
+      pinToCore(m_workers.back(),i%cores);
+    }
+  }
+}
+
+JobSystem::~JobSystem()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_stop=true;
+  }
+  m_wake.notify_all();
+  for(auto &t : m_workers)
+  {
+    t.join();
+  }
+}
+
+JobSystem &JobSystem::instance()
+{
+  static JobSystem jobs((g_instanceCreated=true,g_instanceOptions));
+  return jobs;
+}
+
+bool JobSystem::setInstanceOptions(const Options &_options)
+{
+  if(g_instanceCreated)
+  {
+    return false;
+  }
+  g_instanceOptions=_options;
+  return true;
+}
+
+size_t JobSystem::chunksFor(size_t _count, size_t _minPerChunk) const
+{
+  constexpr size_t chunksPerThread=4;
+  return std::max<size_t>(1,std::min(numThreads()*chunksPerThread,_count/std::max<size_t>(1,_minPerChunk)));
+}
+
+size_t JobSystem::queueIndex() const
+{
+  return t_system==this ? t_index : 0;
+}
+
+void JobSystem::submit(std::function<void()> _job, Counter &io_counter)
+{
+  io_counter.fetch_add(1,std::memory_order_relaxed);
+  auto &queue=*m_queues[queueIndex()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back({std::move(_job),&io_counter});
+  }
+  m_queued.fetch_add(1);
+  {
+    // taking the lock means a worker can't miss this between checking m_queued and going to sleep
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+  }
+  m_wake.notify_one();
+}
+
+bool JobSystem::runOne(size_t _index)
+{
+  Job job;
+  bool found=false;
+  {
+    auto &own=*m_queues[_index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if(!own.jobs.empty())
+    {
+      job=std::move(own.jobs.back());
+      own.jobs.pop_back();
+      found=true;
+    }
+  }
+  for(size_t i=1; i<m_queues.size() && !found; ++i)
+  {
+    auto &victim=*m_queues[(_index+i)%m_queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if(!victim.jobs.empty())
+    {
+      job=std::move(victim.jobs.front());
+      victim.jobs.pop_front();
+      found=true;
+    }
+  }
+  if(!found)
+  {
+    return false;
+  }
+  m_queued.fetch_sub(1);
+  job.func();
+  job.counter->fetch_sub(1,std::memory_order_release);
+  return true;
+}
+
+void JobSystem::wait(const Counter &_counter)
+{
+  size_t index=queueIndex();
+  while(_counter.load(std::memory_order_acquire) !=0)
+  {
+    if(!runOne(index))
+    {
+      // the last jobs are running on other threads
+      std::this_thread::yield();
+    }
+  }
+}
+
+void JobSystem::workerLoop(size_t _index)
+{
+  t_system=this;
+  t_index=_index;
+  while(true)
+  {
+    if(runOne(_index))
+    {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_wake.wait(lock,[this](){return m_stop || m_queued.load()!=0;});
+    if(m_stop)
+    {
+      return;
+    }
+  }
+}
+
+TaskGraph::Node TaskGraph::add(std::function<void()> _task)
+{
+  m_tasks.push_back(std::make_unique<Task>());
+  m_tasks.back()->func=std::move(_task);
+  return m_tasks.size()-1;
+}
+
+void TaskGraph::precede(Node _before, Node _after)
+{
+  m_tasks[_before]->successors.push_back(_after);
+  ++m_tasks[_after]->numDependencies;
+}
+
+bool TaskGraph::hasCycle() const
+{
+  // Kahn's algorithm, anything left unvisited is on a cycle
+  std::vector<size_t> remaining(m_tasks.size());
+  std::vector<Node> ready;
+  for(Node n=0; n<m_tasks.size(); ++n)
+  {
+    remaining[n]=m_tasks[n]->numDependencies;
+    if(remaining[n]==0)
+    {
+      ready.push_back(n);
+    }
+  }
+  size_t visited=0;
+  while(!ready.empty())
+  {
+    Node n=ready.back();
+    ready.pop_back();
+    ++visited;
+    for(auto s : m_tasks[n]->successors)
+    {
+      if(--remaining[s]==0)
+      {
+        ready.push_back(s);
+      }
+    }
+  }
+  return visited !=m_tasks.size();
+}
+
+void TaskGraph::start(JobSystem &_jobs, Node _node, JobSystem::Counter &io_counter)
+{
+  _jobs.submit([this,&_jobs,_node,&io_counter]()
+  {
+    Task &task=*m_tasks[_node];
+    task.func();
+    for(auto s : task.successors)
+    {
+      // the last dependency to finish starts the task
+      if(m_tasks[s]->pending.fetch_sub(1,std::memory_order_acq_rel)==1)
+      {
+        start(_jobs,s,io_counter);
+      }
+    }
+  },io_counter);
+}
+
+bool TaskGraph::run(JobSystem &_jobs)
+{
+  if(hasCycle())
+  {
+    std::cerr<<"TaskGraph has a dependency cycle, not running it\n";
+    return false;
+  }
+  for(auto &t : m_tasks)
+  {
+    t->pending=t->numDependencies;
+  }
+  JobSystem::Counter counter={0};
+  for(Node n=0; n<m_tasks.size(); ++n)
+  {
+    if(m_tasks[n]->numDependencies==0)
+    {
+      start(_jobs,n,counter);
+    }
+  }
+  _jobs.wait(counter);
+  return true;
+}
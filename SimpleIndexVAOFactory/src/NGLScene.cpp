@@ -7,10 +7,13 @@
 #include <ngl/ShaderLib.h>
 #include <ngl/VAOFactory.h>
 #include <ngl/SimpleIndexVAO.h>
+#include "IcosphereTable.h"
+#include "ObjFile.h"
+#include <algorithm>
 #include <array>
 #include <iostream>
 
-NGLScene::NGLScene()
+NGLScene::NGLScene(const std::string &_objFile) : m_objFile(_objFile)
 {
   setTitle("Qt5 SimpleIndexVAO created from VAOFactory NGL Demo");
 }
@@ -69,6 +72,8 @@ void NGLScene::initializeGL()
 
   ngl::ShaderLib::linkProgramObject(ColourShader);
   ngl::ShaderLib::use(ColourShader);
+  // looked up once here so paintGL sets MVP without a name lookup
+  m_MVPUniform = UniformHandle(ngl::ShaderLib::getProgramID(ColourShader), "MVP");
 
   buildVAO();
   ngl::VAOFactory::listCreators();
@@ -76,28 +81,14 @@ void NGLScene::initializeGL()
 
 void NGLScene::buildVAO()
 {
-  // data from here http://rbwhitaker.wikidot.com/index-and-vertex-buffers
-  std::array<ngl::Vec3, 24> vertAndColour =
-      {
-          {ngl::Vec3(-0.26286500f, 0.0000000f, 0.42532500f), ngl::Vec3(1.0f, 0.0f, 0.0f),
-           ngl::Vec3(0.26286500f, 0.0000000f, 0.42532500f), ngl::Vec3(1.0f, 0.55f, 0.0f),
-           ngl::Vec3(-0.26286500f, 0.0000000f, -0.42532500f), ngl::Vec3(1.0f, 0.0f, 1.0f),
-           ngl::Vec3(0.26286500f, 0.0000000f, -0.42532500f), ngl::Vec3(0.0f, 1.0f, 0.0f),
-           ngl::Vec3(0.0000000f, 0.42532500f, 0.26286500f), ngl::Vec3(0.0f, 0.0f, 1.0f),
-           ngl::Vec3(0.0000000f, 0.42532500f, -0.26286500f), ngl::Vec3(0.29f, 0.51f, 0.0f),
-           ngl::Vec3(0.0000000f, -0.42532500f, 0.26286500f), ngl::Vec3(0.5f, 0.0f, 0.5f),
-           ngl::Vec3(0.0000000f, -0.42532500f, -0.26286500f), ngl::Vec3(1.0f, 1.0f, 1.0f),
-           ngl::Vec3(0.42532500f, 0.26286500f, 0.0000000f), ngl::Vec3(0.0f, 1.0f, 1.0f),
-           ngl::Vec3(-0.42532500f, 0.26286500f, 0.0000000f), ngl::Vec3(0.0f, 0.0f, 0.0f),
-           ngl::Vec3(0.42532500f, -0.26286500f, 0.0000000f), ngl::Vec3(0.12f, 0.56f, 1.0f),
-           ngl::Vec3(-0.42532500f, -0.26286500f, 0.0000000f), ngl::Vec3(0.86f, 0.08f, 0.24f)}};
-
-  std::array<GLshort, 60> indices =
-      {
-          {0, 6, 1, 0, 11, 6, 1, 4, 0, 1, 8, 4, 1, 10, 8, 2, 5, 3,
-           2, 9, 5, 2, 11, 9, 3, 7, 2, 3, 10, 7, 4, 8, 5, 4, 9, 0,
-           5, 8, 3, 5, 9, 4, 6, 10, 1, 6, 11, 7, 7, 10, 6, 7, 11, 2,
-           8, 10, 3, 9, 11, 0}};
+  if (!m_objFile.empty() && buildObjVAO())
+  {
+    return;
+  }
+  // the icosahedron from http://rbwhitaker.wikidot.com/index-and-vertex-buffers is level 0 of the table,
+  // both it and the interleaved vertex / colour data are built by the compiler.
+  static constexpr auto ico = makeIcosphere<0>();
+  static constexpr auto vertAndColour = interleave(ico.positions, ico.colours);
   // create a vao as a series of GL_TRIANGLES
   m_vao = ngl::VAOFactory::createVAO(ngl::simpleIndexVAO, GL_TRIANGLES);
   m_vao->bind();
@@ -106,19 +97,70 @@ void NGLScene::buildVAO()
 
   m_vao->setData(ngl::SimpleIndexVAO::VertexData(
       sizeof(vertAndColour),
-      vertAndColour[0].m_x,
-      sizeof(indices), &indices[0],
+      vertAndColour[0].x,
+      static_cast<unsigned int>(ico.indices.size()), &ico.indices[0],
       GL_UNSIGNED_SHORT));
   // data is 24 bytes apart ( two Vec3's) first index
   // is 0 second is 3 floats into the data set (i.e. vec3 offset)
   m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, 24, 0);
   m_vao->setVertexAttributePointer(1, 3, GL_FLOAT, 24, 3);
-  m_vao->setNumIndices(indices.size());
+  m_vao->setNumIndices(ico.indices.size());
 
   // now unbind
   m_vao->unbind();
 }
 
+bool NGLScene::buildObjVAO()
+{
+  ObjFile obj;
+  if (!obj.load(m_objFile))
+  {
+    std::cerr << "Unable to load " << m_objFile << " drawing the icosahedron instead\n";
+    return false;
+  }
+  std::cout << "Loaded " << m_objFile << " as " << obj.numVertices() << " vertices and " << obj.indices().size() / 3
+            << " triangles, parsed in " << obj.timings().parse << " ms and deduplicated in " << obj.timings().dedup << " ms\n";
+  if (obj.indices().empty())
+  {
+    std::cerr << m_objFile << " has no faces\n";
+    return false;
+  }
+  m_vao = ngl::VAOFactory::createVAO(ngl::simpleIndexVAO, GL_TRIANGLES);
+  m_vao->bind();
+  m_vao->setData(ngl::SimpleIndexVAO::VertexData(
+      obj.vertices().size() * sizeof(float),
+      obj.vertices()[0],
+      static_cast<unsigned int>(obj.indices().size()), &obj.indices()[0],
+      GL_UNSIGNED_INT));
+  auto stride = static_cast<GLsizei>(obj.floatsPerVertex() * sizeof(float));
+  m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, stride, 0);
+  if (obj.hasNormals())
+  {
+    // the colour shader has no lighting so show the normals as colours
+    m_vao->setVertexAttributePointer(1, 3, GL_FLOAT, stride, static_cast<unsigned int>(obj.normalOffset()));
+  }
+  else
+  {
+    // without an array the colour attribute is this constant
+    glVertexAttrib3f(1, 0.8f, 0.8f, 0.8f);
+  }
+  m_vao->setNumIndices(obj.indices().size());
+  m_vao->unbind();
+
+  // centre the mesh and scale its longest side to 1
+  float min[3];
+  float max[3];
+  obj.bounds(min, max);
+  float size = std::max({max[0] - min[0], max[1] - min[1], max[2] - min[2], 1.0e-6f});
+  m_modelTX = ngl::Mat4();
+  for (int a = 0; a < 3; ++a)
+  {
+    m_modelTX.m_m[a][a] = 1.0f / size;
+    m_modelTX.m_m[3][a] = -0.5f * (min[a] + max[a]) / size;
+  }
+  return true;
+}
+
 void NGLScene::paintGL()
 {
   // clear the screen and depth buffer
@@ -135,8 +177,8 @@ void NGLScene::paintGL()
   m_mouseGlobalTX.m_m[3][1] = m_modelPos.m_y;
   m_mouseGlobalTX.m_m[3][2] = m_modelPos.m_z;
 
-  ngl::Mat4 MVP = m_project * m_view * m_mouseGlobalTX;
-  ngl::ShaderLib::setUniform("MVP", MVP);
+  ngl::Mat4 MVP = m_project * m_view * m_mouseGlobalTX * m_modelTX;
+  m_MVPUniform.set(MVP);
 
   m_vao->bind();
   m_vao->draw();
@@ -0,0 +1,594 @@
+#include "ObjFile.h"
+#include "JobSystem.h"
+#include <QFile>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+  // big enough that a chunk is mostly parsing and not scheduling
+  constexpr size_t c_minBytesPerChunk=1<<20;
+  constexpr size_t c_minCornersPerChunk=1<<16;
+  // the attributes in the order of ObjFile::Chunk first and count
+  enum Attribute : size_t {Position=0,TexCoord=1,Normal=2,NumAttributes=3,Face=4,Other=5};
+  constexpr size_t c_attributeFloats[NumAttributes]={3,2,3};
+
+  bool isSpace(char _c)
+  {
+    return _c==' ' || _c=='\t';
+  }
+
+  bool isDigit(char _c)
+  {
+    return _c>='0' && _c<='9';
+  }
+
+  const char *skipSpace(const char *_p, const char *_end)
+  {
+    while(_p<_end && isSpace(*_p))
+    {
+      ++_p;
+    }
+    return _p;
+  }
+
+  const char *nextLine(const char *_p, const char *_end)
+  {
+    auto eol=static_cast<const char *>(std::memchr(_p,'\n',static_cast<size_t>(_end-_p)));
+    return eol==nullptr ? _end : eol+1;
+  }
+
+  // what a line holds from its first characters, sets io_p past the keyword
+  size_t lineType(const char *&io_p, const char *_end)
+  {
+    const char *p=skipSpace(io_p,_end);
+    size_t type=Other;
+    size_t length=0;
+    if(p<_end && *p=='v')
+    {
+      if(p+1<_end && isSpace(p[1]))
+      {
+        type=Position;
+        length=1;
+      }
+      else if(p+2<_end && p[1]=='t' && isSpace(p[2]))
+      {
+        type=TexCoord;
+        length=2;
+      }
+      else if(p+2<_end && p[1]=='n' && isSpace(p[2]))
+      {
+        type=Normal;
+        length=2;
+      }
+    }
+    else if(p+1<_end && *p=='f' && isSpace(p[1]))
+    {
+      type=Face;
+      length=1;
+    }
+    io_p=p+length;
+    return type;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief read a decimal number, up to 19 significant digits are gathered in an integer and scaled by an exact
+  /// power of ten in double so the float is correctly rounded in nearly all cases. Anything else (inf, nan, hex,
+  /// huge exponents) goes to strtof.
+  //----------------------------------------------------------------------------------------------------------------------
+  bool parseFloat(const char *&io_p, const char *_end, float &o_value)
+  {
+    static constexpr double powers[]={1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,1e16,
+                                      1e17,1e18,1e19,1e20,1e21,1e22};
+    const char *p=skipSpace(io_p,_end);
+    const char *start=p;
+    if(p==_end || *p=='\r' || *p=='\n')
+    {
+      return false;
+    }
+    bool negative=false;
+    if(p<_end && (*p=='-' || *p=='+'))
+    {
+      negative=*p=='-';
+      ++p;
+    }
+    uint64_t mantissa=0;
+    int digits=0;
+    int exponent=0;
+    bool any=false;
+    for(; p<_end && isDigit(*p); ++p)
+    {
+      any=true;
+      if(digits<19)
+      {
+        mantissa=mantissa*10+static_cast<uint64_t>(*p-'0');
+        digits+=mantissa!=0;
+      }
+      else
+      {
+        ++exponent;
+      }
+    }
+    if(p<_end && *p=='.')
+    {
+      for(++p; p<_end && isDigit(*p); ++p)
+      {
+        any=true;
+        if(digits<19)
+        {
+          mantissa=mantissa*10+static_cast<uint64_t>(*p-'0');
+          digits+=mantissa!=0;
+          --exponent;
+        }
+      }
+    }
+    if(any && p<_end && (*p=='e' || *p=='E'))
+    {
+      const char *e=p+1;
+      bool negativeExponent=false;
+      if(e<_end && (*e=='-' || *e=='+'))
+      {
+        negativeExponent=*e=='-';
+        ++e;
+      }
+      int value=0;
+      bool anyExponent=false;
+      for(; e<_end && isDigit(*e); ++e)
+      {
+        anyExponent=true;
+        value=std::min(value*10+(*e-'0'),100000);
+      }
+      if(anyExponent)
+      {
+        exponent+=negativeExponent ? -value : value;
+        p=e;
+      }
+    }
+    if(!any || (p<_end && !isSpace(*p) && *p!='\r' && *p!='\n' && *p!='/'))
+    {
+      // not a plain decimal, let the C library have a go at a copy that ends
+      char text[64];
+      size_t length=std::min<size_t>(sizeof(text)-1,static_cast<size_t>(_end-start));
+      std::memcpy(text,start,length);
+      text[length]='\0';
+      char *after=nullptr;
+      o_value=std::strtof(text,&after);
+      if(after==text)
+      {
+        return false;
+      }
+      io_p=start+(after-text);
+      return true;
+    }
+    double value=static_cast<double>(mantissa);
+    if(mantissa!=0)
+    {
+      if(exponent>=-22 && exponent<=22 && mantissa<(uint64_t(1)<<53))
+      {
+        value=exponent<0 ? value/powers[-exponent] : value*powers[exponent];
+      }
+      else
+      {
+        value*=std::pow(10.0,static_cast<double>(exponent));
+      }
+    }
+    o_value=static_cast<float>(negative ? -value : value);
+    io_p=p;
+    return true;
+  }
+
+  bool parseIndex(const char *&io_p, const char *_end, int64_t &o_index)
+  {
+    const char *p=io_p;
+    bool negative=false;
+    if(p<_end && (*p=='-' || *p=='+'))
+    {
+      negative=*p=='-';
+      ++p;
+    }
+    if(p==_end || !isDigit(*p))
+    {
+      return false;
+    }
+    int64_t value=0;
+    for(; p<_end && isDigit(*p); ++p)
+    {
+      value=std::min<int64_t>(value*10+(*p-'0'),int64_t(1)<<40);
+    }
+    o_index=negative ? -value : value;
+    io_p=p;
+    return true;
+  }
+
+  // OBJ indices count from 1, negative ones count back from the last of that attribute read so far
+  bool resolveIndex(int64_t _index, size_t _readSoFar, size_t _total, uint32_t &o_index)
+  {
+    int64_t index=_index>0 ? _index-1 : static_cast<int64_t>(_readSoFar)+_index;
+    if(_index==0 || index<0 || index>=static_cast<int64_t>(_total) || index>=int64_t(UINT32_MAX))
+    {
+      return false;
+    }
+    o_index=static_cast<uint32_t>(index);
+    return true;
+  }
+
+  uint64_t hashCorner(uint32_t _v, uint32_t _t, uint32_t _n)
+  {
+    uint64_t h=_v*0x9e3779b97f4a7c15ULL ^ _t*0xc2b2ae3d27d4eb4fULL ^ _n*0x165667b19e3779f9ULL;
+    h^=h>>29;
+    h*=0xbf58476d1ce4e5b9ULL;
+    return h^(h>>32);
+  }
+
+  double millisecondsSince(std::chrono::steady_clock::time_point _start)
+  {
+    return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-_start).count();
+  }
+}
+
+bool ObjFile::load(const std::string &_fname)
+{
+  m_vertices.clear();
+  m_indices.clear();
+  m_hasNormals=false;
+  m_hasUVs=false;
+  m_timings=Timings();
+  QFile file(QString::fromStdString(_fname));
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    std::cerr<<"Unable to open "<<_fname<<'\n';
+    return false;
+  }
+  const uchar *map=file.size()>0 ? file.map(0,file.size()) : nullptr;
+  if(map==nullptr)
+  {
+    std::cerr<<"Unable to map "<<_fname<<'\n';
+    return false;
+  }
+  auto text=reinterpret_cast<const char *>(map);
+  bool ok=parse(text,text+file.size());
+  file.unmap(const_cast<uchar *>(map));
+  if(!ok)
+  {
+    std::cerr<<" in "<<_fname<<'\n';
+  }
+  return ok;
+}
+
+bool ObjFile::parse(const char *_begin, const char *_end)
+{
+  auto start=std::chrono::steady_clock::now();
+  size_t size=static_cast<size_t>(_end-_begin);
+  size_t numChunks=parallelChunks(size,c_minBytesPerChunk);
+  std::vector<Chunk> chunks(numChunks);
+  // cut at the first line end after each even split so no line straddles two chunks
+  const char *p=_begin;
+  for(size_t c=0; c<numChunks; ++c)
+  {
+    chunks[c].begin=p;
+    p=c+1==numChunks ? _end : std::max(p,nextLine(_begin+size*(c+1)/numChunks,_end));
+    chunks[c].end=p;
+  }
+  // count each chunk's attributes so they can be parsed straight into place
+  parallelFor(numChunks,numChunks,[&](size_t,size_t _first,size_t _last)
+  {
+    for(size_t c=_first; c<_last; ++c)
+    {
+      for(const char *line=chunks[c].begin; line<chunks[c].end; line=nextLine(line,chunks[c].end))
+      {
+        const char *after=line;
+        size_t type=lineType(after,chunks[c].end);
+        if(type<NumAttributes)
+        {
+          ++chunks[c].count[type];
+        }
+      }
+    }
+  });
+  size_t totals[NumAttributes]={0,0,0};
+  for(auto &chunk : chunks)
+  {
+    for(size_t a=0; a<NumAttributes; ++a)
+    {
+      chunk.first[a]=totals[a];
+      totals[a]+=chunk.count[a];
+    }
+  }
+  m_positions.resize(totals[Position]*c_attributeFloats[Position]);
+  m_uvs.resize(totals[TexCoord]*c_attributeFloats[TexCoord]);
+  m_normals.resize(totals[Normal]*c_attributeFloats[Normal]);
+  parallelFor(numChunks,numChunks,[&](size_t,size_t _first,size_t _last)
+  {
+    for(size_t c=_first; c<_last; ++c)
+    {
+      parseChunk(chunks[c],_begin,totals);
+    }
+  });
+
+  std::vector<Corner> corners;
+  size_t numCorners=0;
+  std::vector<size_t> cornerOffsets(numChunks);
+  for(size_t a=0; a<3; ++a)
+  {
+    m_min[a]=std::numeric_limits<float>::max();
+    m_max[a]=std::numeric_limits<float>::lowest();
+  }
+  for(size_t c=0; c<numChunks; ++c)
+  {
+    if(chunks[c].error!=SIZE_MAX)
+    {
+      size_t line=1+static_cast<size_t>(std::count(_begin,_begin+chunks[c].error,'\n'));
+      std::cerr<<"ObjFile can't read line "<<line;
+      return false;
+    }
+    cornerOffsets[c]=numCorners;
+    numCorners+=chunks[c].corners.size();
+    for(size_t a=0; a<3; ++a)
+    {
+      m_min[a]=std::min(m_min[a],chunks[c].min[a]);
+      m_max[a]=std::max(m_max[a],chunks[c].max[a]);
+    }
+  }
+  if(numCorners>=UINT32_MAX)
+  {
+    std::cerr<<"ObjFile has "<<numCorners<<" corners, more than 32 bit indices can hold";
+    return false;
+  }
+  corners.resize(numCorners);
+  parallelFor(numChunks,numChunks,[&](size_t,size_t _first,size_t _last)
+  {
+    for(size_t c=_first; c<_last; ++c)
+    {
+      std::copy(chunks[c].corners.begin(),chunks[c].corners.end(),corners.begin()+static_cast<std::ptrdiff_t>(cornerOffsets[c]));
+      std::vector<Corner>().swap(chunks[c].corners);
+    }
+  });
+  m_hasUVs=totals[TexCoord]>0;
+  m_hasNormals=totals[Normal]>0;
+  m_timings.parse=millisecondsSince(start);
+
+  start=std::chrono::steady_clock::now();
+  dedup(corners);
+  std::vector<float>().swap(m_positions);
+  std::vector<float>().swap(m_uvs);
+  std::vector<float>().swap(m_normals);
+  m_timings.dedup=millisecondsSince(start);
+  return true;
+}
+
+void ObjFile::parseChunk(Chunk &io_chunk, const char *_file, size_t _totals[3])
+{
+  float *out[NumAttributes]={m_positions.data(),m_uvs.data(),m_normals.data()};
+  size_t read[NumAttributes]={io_chunk.first[0],io_chunk.first[1],io_chunk.first[2]};
+  for(size_t a=0; a<3; ++a)
+  {
+    io_chunk.min[a]=std::numeric_limits<float>::max();
+    io_chunk.max[a]=std::numeric_limits<float>::lowest();
+  }
+  // a polygon's corners before it is split into a fan
+  std::vector<Corner> polygon;
+  for(const char *line=io_chunk.begin; line<io_chunk.end; line=nextLine(line,io_chunk.end))
+  {
+    const char *p=line;
+    size_t type=lineType(p,io_chunk.end);
+    bool ok=true;
+    if(type<NumAttributes)
+    {
+      float *values=out[type]+read[type]*c_attributeFloats[type];
+      for(size_t i=0; i<c_attributeFloats[type] && ok; ++i)
+      {
+        ok=parseFloat(p,io_chunk.end,values[i]);
+        // vt u on its own is allowed, v is then 0
+        if(!ok && type==TexCoord && i==1)
+        {
+          values[i]=0.0f;
+          ok=true;
+        }
+      }
+      if(ok && type==Position)
+      {
+        for(size_t a=0; a<3; ++a)
+        {
+          io_chunk.min[a]=std::min(io_chunk.min[a],values[a]);
+          io_chunk.max[a]=std::max(io_chunk.max[a],values[a]);
+        }
+      }
+      ++read[type];
+    }
+    else if(type==Face)
+    {
+      polygon.clear();
+      for(;;)
+      {
+        p=skipSpace(p,io_chunk.end);
+        if(p==io_chunk.end || *p=='\r' || *p=='\n' || *p=='#')
+        {
+          break;
+        }
+        // v, v/t, v//n or v/t/n
+        Corner corner={c_none,c_none,c_none};
+        int64_t index;
+        ok=parseIndex(p,io_chunk.end,index) && resolveIndex(index,read[Position],_totals[Position],corner.v);
+        if(ok && p<io_chunk.end && *p=='/')
+        {
+          ++p;
+          if(p<io_chunk.end && *p!='/')
+          {
+            ok=parseIndex(p,io_chunk.end,index) && resolveIndex(index,read[TexCoord],_totals[TexCoord],corner.t);
+          }
+          if(ok && p<io_chunk.end && *p=='/')
+          {
+            ++p;
+            ok=parseIndex(p,io_chunk.end,index) && resolveIndex(index,read[Normal],_totals[Normal],corner.n);
+          }
+        }
+        if(!ok)
+        {
+          break;
+        }
+        polygon.push_back(corner);
+      }
+      ok=ok && polygon.size()>=3;
+      for(size_t i=2; ok && i<polygon.size(); ++i)
+      {
+        io_chunk.corners.push_back(polygon[0]);
+        io_chunk.corners.push_back(polygon[i-1]);
+        io_chunk.corners.push_back(polygon[i]);
+      }
+    }
+    if(!ok)
+    {
+      io_chunk.error=static_cast<size_t>(line-_file);
+      return;
+    }
+  }
+}
+
+void ObjFile::dedup(const std::vector<Corner> &_corners)
+{
+  size_t numCorners=_corners.size();
+  // a few shards per thread so the shards even out, a single thread has a single table
+  size_t threads=JobSystem::instance().numThreads();
+  size_t shardBits=0;
+  while(threads>1 && (size_t(1)<<shardBits)<threads*4)
+  {
+    ++shardBits;
+  }
+  size_t numShards=size_t(1)<<shardBits;
+  auto shardOf=[shardBits](uint64_t _hash){return shardBits==0 ? size_t(0) : static_cast<size_t>(_hash>>(64-shardBits));};
+
+  // bucket the corners by shard keeping them in order within each shard
+  size_t chunks=parallelChunks(numCorners,c_minCornersPerChunk);
+  std::vector<size_t> offsets(chunks*numShards,0);
+  parallelFor(numCorners,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+  {
+    size_t *count=&offsets[_chunk*numShards];
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      ++count[shardOf(hashCorner(_corners[i].v,_corners[i].t,_corners[i].n))];
+    }
+  });
+  std::vector<size_t> shardStart(numShards+1,0);
+  size_t running=0;
+  for(size_t s=0; s<numShards; ++s)
+  {
+    shardStart[s]=running;
+    for(size_t c=0; c<chunks; ++c)
+    {
+      size_t count=offsets[c*numShards+s];
+      offsets[c*numShards+s]=running;
+      running+=count;
+    }
+  }
+  shardStart[numShards]=running;
+  std::vector<uint32_t> byShard(numCorners);
+  parallelFor(numCorners,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+  {
+    size_t *next=&offsets[_chunk*numShards];
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      byShard[next[shardOf(hashCorner(_corners[i].v,_corners[i].t,_corners[i].n))]++]=static_cast<uint32_t>(i);
+    }
+  });
+
+  // each shard finds the first corner with each tuple, ids is 1 at those corners for now
+  std::vector<uint32_t> firstUse(numCorners);
+  std::vector<uint32_t> ids(numCorners,0);
+  parallelFor(numShards,numShards,[&](size_t,size_t _first,size_t _last)
+  {
+    std::vector<uint32_t> table;
+    for(size_t s=_first; s<_last; ++s)
+    {
+      size_t count=shardStart[s+1]-shardStart[s];
+      size_t capacity=16;
+      while(capacity<count*2)
+      {
+        capacity*=2;
+      }
+      // open addressing on the corner indices, each slot holds the first corner with its tuple
+      table.assign(capacity,c_none);
+      size_t mask=capacity-1;
+      for(size_t i=shardStart[s]; i<shardStart[s+1]; ++i)
+      {
+        uint32_t corner=byShard[i];
+        const Corner &c=_corners[corner];
+        size_t slot=static_cast<size_t>(hashCorner(c.v,c.t,c.n))&mask;
+        while(table[slot]!=c_none && !(_corners[table[slot]]==c))
+        {
+          slot=(slot+1)&mask;
+        }
+        if(table[slot]==c_none)
+        {
+          table[slot]=corner;
+          ids[corner]=1;
+        }
+        firstUse[corner]=table[slot];
+      }
+    }
+  });
+  std::vector<uint32_t>().swap(byShard);
+
+  // number the first uses in corner order, an exclusive scan of ids in two passes over the same chunks
+  std::vector<uint32_t> chunkFirst(chunks+1,0);
+  parallelFor(numCorners,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+  {
+    uint32_t count=0;
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      count+=ids[i];
+    }
+    chunkFirst[_chunk+1]=count;
+  });
+  for(size_t c=0; c<chunks; ++c)
+  {
+    chunkFirst[c+1]+=chunkFirst[c];
+  }
+  parallelFor(numCorners,chunks,[&](size_t _chunk,size_t _begin,size_t _end)
+  {
+    uint32_t next=chunkFirst[_chunk];
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      uint32_t isFirst=ids[i];
+      ids[i]=next;
+      next+=isFirst;
+    }
+  });
+
+  size_t stride=floatsPerVertex();
+  m_vertices.assign(static_cast<size_t>(chunkFirst[chunks])*stride,0.0f);
+  m_indices.resize(numCorners);
+  parallelFor(numCorners,chunks,[&](size_t,size_t _begin,size_t _end)
+  {
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      uint32_t first=firstUse[i];
+      m_indices[i]=ids[first];
+      if(first!=i)
+      {
+        continue;
+      }
+      const Corner &c=_corners[i];
+      float *vertex=&m_vertices[static_cast<size_t>(ids[i])*stride];
+      std::copy_n(&m_positions[static_cast<size_t>(c.v)*3],3,vertex);
+      if(m_hasNormals && c.n!=c_none)
+      {
+        std::copy_n(&m_normals[static_cast<size_t>(c.n)*3],3,vertex+normalOffset());
+      }
+      if(m_hasUVs && c.t!=c_none)
+      {
+        std::copy_n(&m_uvs[static_cast<size_t>(c.t)*2],2,vertex+uvOffset());
+      }
+    }
+  });
+}
+
+void ObjFile::bounds(float o_min[3], float o_max[3]) const
+{
+  std::copy_n(m_min,3,o_min);
+  std::copy_n(m_max,3,o_max);
+}
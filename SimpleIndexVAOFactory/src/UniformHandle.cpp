@@ -0,0 +1,74 @@
+#include "UniformHandle.h"
+#include <cstring>
+#include <iostream>
+
+UniformHandle::UniformHandle(GLuint _program, const char *_name) : m_location(glGetUniformLocation(_program,_name))
+{
+  if(m_location<0)
+  {
+    std::cerr<<"no active uniform "<<_name<<" in program "<<_program<<'\n';
+  }
+}
+
+bool UniformHandle::changed(const float *_value, size_t _size)
+{
+  if(m_location<0)
+  {
+    return false;
+  }
+  if(m_size==_size && std::memcmp(m_last,_value,_size*sizeof(float))==0)
+  {
+    ++m_skipped;
+    return false;
+  }
+  std::memcpy(m_last,_value,_size*sizeof(float));
+  m_size=_size;
+  return true;
+}
+
+void UniformHandle::set(const ngl::Mat4 &_value)
+{
+  if(changed(_value.m_openGL,16))
+  {
+    glUniformMatrix4fv(m_location,1,GL_FALSE,_value.m_openGL);
+  }
+}
+
+void UniformHandle::set(const ngl::Mat3 &_value)
+{
+  if(changed(_value.m_openGL,9))
+  {
+    glUniformMatrix3fv(m_location,1,GL_FALSE,_value.m_openGL);
+  }
+}
+
+void UniformHandle::set(const ngl::Vec3 &_value)
+{
+  float v[3]={_value.m_x,_value.m_y,_value.m_z};
+  if(changed(v,3))
+  {
+    glUniform3fv(m_location,1,v);
+  }
+}
+
+void UniformHandle::set(const ngl::Vec4 &_value)
+{
+  set(_value.m_x,_value.m_y,_value.m_z,_value.m_w);
+}
+
+void UniformHandle::set(float _r, float _g, float _b, float _a)
+{
+  float v[4]={_r,_g,_b,_a};
+  if(changed(v,4))
+  {
+    glUniform4fv(m_location,1,v);
+  }
+}
+
+void UniformHandle::set(float _value)
+{
+  if(changed(&_value,1))
+  {
+    glUniform1f(m_location,_value);
+  }
+}
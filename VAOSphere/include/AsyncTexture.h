@@ -0,0 +1,136 @@
+#ifndef ASYNCTEXTURE_H_
+#define ASYNCTEXTURE_H_
+
+#include <ngl/Types.h>
+#include "TextureCache.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class AsyncTexture
+/// @brief loads a texture without blocking the GL thread. The image is decoded and the mip chain generated on a
+/// worker thread which writes the texels straight into a mapped GL_PIXEL_UNPACK_BUFFER, until the upload is done
+/// a 1x1 placeholder texel is bound so the scene can still be drawn.
+/// If a cache directory is given the decoded chain is written to a TextureCache on the first load and later
+/// loads just map the cache file and copy it to the pixel buffer, with no decode at all.
+/// All methods apart from the worker itself must be called with the GL context current.
+//----------------------------------------------------------------------------------------------------------------------
+class AsyncTexture
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor creates the placeholder texture and pixel buffer then starts the decode thread
+    /// @param _fname the image file to load
+    /// @param _onReady called from the worker thread once the texels are ready to upload, use this to
+    /// schedule a repaint as the actual upload must happen on the GL thread in update()
+    /// @param _cacheDir where to keep the pre-built mip chains, empty to always decode
+    //----------------------------------------------------------------------------------------------------------------------
+    AsyncTexture(const std::string &_fname, std::function<void()> _onReady={}, const std::string &_cacheDir={});
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dtor waits for the worker and releases the GL objects, the context must be current
+    //----------------------------------------------------------------------------------------------------------------------
+    ~AsyncTexture();
+    AsyncTexture(const AsyncTexture &)=delete;
+    AsyncTexture &operator=(const AsyncTexture &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief call once per frame, if the worker has finished the texels are uploaded from the pixel buffer
+    /// @returns true once the real texture is resident
+    //----------------------------------------------------------------------------------------------------------------------
+    bool update();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bind the texture (or the placeholder) to the active texture unit
+    //----------------------------------------------------------------------------------------------------------------------
+    void bind() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the GL texture id, this doesn't change when the placeholder is replaced
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint getID() const {return m_id;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true once the decoded image has been uploaded
+    //----------------------------------------------------------------------------------------------------------------------
+    bool isLoaded() const {return m_loaded;}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief worker thread entry, loads from the cache or decodes the image and builds the mip chain
+    //----------------------------------------------------------------------------------------------------------------------
+    void decode();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief try and satisfy the load from the cache
+    /// @returns true if the texels have been handed over for upload
+    //----------------------------------------------------------------------------------------------------------------------
+    bool loadFromCache(uint64_t _hash);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief tell the GL thread the texels are ready (or that we failed)
+    //----------------------------------------------------------------------------------------------------------------------
+    void signalReady();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief 2x2 box filter an RGBA8 image, odd edges are clamped
+    //----------------------------------------------------------------------------------------------------------------------
+    static void downsample(const unsigned char *_src, int _srcWidth, int _srcHeight, unsigned char *_dst, int _dstWidth, int _dstHeight);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the file to load
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string m_fname;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief cache directory, empty for no caching
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string m_cacheDir;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief called by the worker when the decode has finished
+    //----------------------------------------------------------------------------------------------------------------------
+    std::function<void()> m_onReady;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief texture id, holds the placeholder until the upload is done
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_id=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the pixel unpack buffer used to stream the texels
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_pbo=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mapped pixel buffer the worker writes into, nullptr if the image size wasn't known up front
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned char *m_mapped=nullptr;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the layout of the mip chain
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<TextureCache::Level> m_levels;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief total size of the mip chain in bytes
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_size=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief used when the buffer couldn't be mapped before the decode, copied to the pbo in update()
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned char> m_staging;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the texels to copy to the pbo in update() if it wasn't mapped, points at m_staging or the cache
+    //----------------------------------------------------------------------------------------------------------------------
+    const unsigned char *m_upload=nullptr;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mapped cache file if we had a hit
+    //----------------------------------------------------------------------------------------------------------------------
+    TextureCache m_cache;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief decode thread
+    //----------------------------------------------------------------------------------------------------------------------
+    std::thread m_worker;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set by the worker when it has finished (successfully or not)
+    //----------------------------------------------------------------------------------------------------------------------
+    std::atomic<bool> m_decoded{false};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set by the worker if the image couldn't be loaded
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_failed=false;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true when the final texture has been uploaded
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_loaded=false;
+};
+
+#endif
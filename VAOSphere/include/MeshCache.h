@@ -0,0 +1,116 @@
+#ifndef MESHCACHE_H_
+#define MESHCACHE_H_
+
+#include <ngl/AbstractVAO.h>
+#include <QFile>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class MeshCache
+/// @brief a binary container for generated geometry. The file records everything needed to rebuild the VAO (draw
+/// mode, attribute pointers, index type and counts) followed by the page aligned vertex and index data. Loading
+/// memory maps the file and the mapped pages are passed straight to setData so there is no parse or copy on the CPU.
+/// Files are keyed by a hash of the generator name and its parameters.
+//----------------------------------------------------------------------------------------------------------------------
+class MeshCache
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief mirrors the parameters of AbstractVAO::setVertexAttributePointer, offset is in floats
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Attribute
+    {
+      uint32_t id;
+      int32_t size;
+      uint32_t type;
+      int32_t stride;
+      uint32_t offset;
+      uint32_t normalise;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief how to build the VAO from the data
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Layout
+    {
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the draw mode, e.g. GL_TRIANGLE_STRIP
+      //----------------------------------------------------------------------------------------------------------------------
+      GLenum mode=GL_TRIANGLES;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief GL_UNSIGNED_BYTE/SHORT/INT for indexed data or 0 for none, this selects simpleIndexVAO or simpleVAO
+      //----------------------------------------------------------------------------------------------------------------------
+      GLenum indexType=0;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the value passed to setNumIndices
+      //----------------------------------------------------------------------------------------------------------------------
+      uint64_t numIndices=0;
+      std::vector<Attribute> attributes;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief build the cache key from the generator and the parameters that affect its output
+    //----------------------------------------------------------------------------------------------------------------------
+    static uint64_t key(const std::string &_generator, std::initializer_list<float> _params);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the cache file name for a generator and key
+    //----------------------------------------------------------------------------------------------------------------------
+    static std::string cacheName(const std::string &_dir, const std::string &_generator, uint64_t _key);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create a VAO from a layout and data, used for both freshly generated and mapped meshes
+    /// @param _indices the index data, may be nullptr if _layout.indexType is 0
+    //----------------------------------------------------------------------------------------------------------------------
+    static std::unique_ptr<ngl::AbstractVAO> createVAO(const Layout &_layout, const void *_vertices, size_t _vertexSize,
+                                                       const void *_indices, size_t _indexSize);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write a mesh to disk, this goes via a temporary file so a partial file is never seen
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool write(const std::string &_fname, uint64_t _key, const Layout &_layout, const void *_vertices, size_t _vertexSize,
+                      const void *_indices, size_t _indexSize);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief memory map and validate a mesh file
+    /// @returns false if there is no valid mesh for _key
+    //----------------------------------------------------------------------------------------------------------------------
+    bool open(const std::string &_fname, uint64_t _key);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create the VAO straight from the mapped pages
+    //----------------------------------------------------------------------------------------------------------------------
+    std::unique_ptr<ngl::AbstractVAO> createVAO() const;
+    const Layout &layout() const {return m_layout;}
+    const void *vertices() const {return m_vertices;}
+    size_t vertexSize() const {return m_vertexSize;}
+    const void *indices() const {return m_indices;}
+    size_t indexSize() const {return m_indexSize;}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief on disk header
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Header
+    {
+      char magic[4];
+      uint32_t version;
+      uint64_t key;
+      uint32_t mode;
+      uint32_t indexType;
+      uint64_t numIndices;
+      uint32_t numAttributes;
+      uint32_t pad;
+      uint64_t vertexOffset;
+      uint64_t vertexSize;
+      uint64_t indexOffset;
+      uint64_t indexSize;
+    };
+    static constexpr uint32_t c_version=1;
+    static constexpr uint64_t c_alignment=4096;
+    QFile m_file;
+    Layout m_layout;
+    const void *m_vertices=nullptr;
+    size_t m_vertexSize=0;
+    const void *m_indices=nullptr;
+    size_t m_indexSize=0;
+};
+
+#endif
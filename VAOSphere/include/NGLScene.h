@@ -4,6 +4,8 @@
 #include <ngl/Mat4.h>
 #include <ngl/AbstractVAO.h>
 #include "WindowParams.h"
+#include "UniformHandle.h"
+#include "AsyncTexture.h"
 #include <QOpenGLWindow>
 #include <memory>
 
@@ -70,6 +72,14 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     std::unique_ptr<ngl::AbstractVAO> m_vao;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the MVP uniform of the shader, found once after linking
+    //----------------------------------------------------------------------------------------------------------------------
+    UniformHandle m_MVPUniform;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the earth texture, loaded in the background
+    //----------------------------------------------------------------------------------------------------------------------
+    std::unique_ptr<AsyncTexture> m_texture;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief Qt Event called when a key is pressed
     /// @param [in] _event the Qt event to query for size etc
     //----------------------------------------------------------------------------------------------------------------------
@@ -104,7 +114,22 @@ private:
     void buildVAO();
 
     void loadTexture();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief build the default sphere from the compile time table
+    //----------------------------------------------------------------------------------------------------------------------
     void buildVAOSphere();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief generate a sphere at run time, these are kept in the mesh cache
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildVAOSphere(float _radius, int _precision);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief precision of the compile time sphere
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr int c_defaultPrecision=100;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief current sphere precision, changed with + and -
+    //----------------------------------------------------------------------------------------------------------------------
+    int m_precision=c_defaultPrecision;
 
 
 
@@ -0,0 +1,79 @@
+#ifndef SPHERETABLE_H_
+#define SPHERETABLE_H_
+
+#include "ConstexprMath.h"
+#include <array>
+#include <cstddef>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a simple structure to hold our vertex data
+//----------------------------------------------------------------------------------------------------------------------
+struct vertData
+{
+  float x;  // 0
+  float y;  // 1
+  float z;  // 2
+  float nx; // 3
+  float ny; // 4
+  float nz; // 5
+  float u;  // 6
+  float v;  // 7
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief number of vertices in the triangle strip sphere for a given precision
+//----------------------------------------------------------------------------------------------------------------------
+constexpr size_t sphereVertexCount(size_t _precision)
+{
+  return (_precision / 2) * ((_precision + 1) * 2);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief build the same P,N,UV triangle strip sphere as NGLScene::buildVAOSphere but at compile time, use as
+/// static constexpr auto sphere = makeSphere<100>();
+/// and the table is in the read only data of the executable ready to be passed to setData.
+/// @param _radius the radius of the sphere
+//----------------------------------------------------------------------------------------------------------------------
+template <size_t Precision>
+constexpr std::array<vertData, sphereVertexCount(Precision)> makeSphere(float _radius = 1.0f)
+{
+  static_assert(Precision >= 4, "sphere precision must be at least 4");
+  // only Precision/2+1 latitudes and Precision+1 longitudes are used so do the trig once for each
+  std::array<double, Precision / 2 + 1> sinLat{};
+  std::array<double, Precision / 2 + 1> cosLat{};
+  std::array<double, Precision + 1> sinLon{};
+  std::array<double, Precision + 1> cosLon{};
+  for (size_t i = 0; i <= Precision / 2; ++i)
+  {
+    cmath::sincos(static_cast<double>(i) * 2.0 * cmath::c_pi / Precision - cmath::c_pi * 0.5, sinLat[i], cosLat[i]);
+  }
+  for (size_t j = 0; j <= Precision; ++j)
+  {
+    cmath::sincos(static_cast<double>(j) * 2.0 * cmath::c_pi / Precision, sinLon[j], cosLon[j]);
+  }
+
+  std::array<vertData, sphereVertexCount(Precision)> data{};
+  size_t index = 0;
+  for (size_t i = 0; i < Precision / 2; ++i)
+  {
+    for (size_t j = 0; j <= Precision; ++j)
+    {
+      // each step of the strip is a vertex on the next latitude then one on this
+      for (size_t lat : {i + 1, i})
+      {
+        vertData &d = data[index++];
+        d.nx = static_cast<float>(cosLat[lat] * cosLon[j]);
+        d.ny = static_cast<float>(sinLat[lat]);
+        d.nz = static_cast<float>(cosLat[lat] * sinLon[j]);
+        d.x = _radius * d.nx;
+        d.y = _radius * d.ny;
+        d.z = _radius * d.nz;
+        d.u = static_cast<float>(j) / Precision;
+        d.v = 2.0f * static_cast<float>(lat) / Precision;
+      }
+    }
+  }
+  return data;
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef TEXTURECACHE_H_
+#define TEXTURECACHE_H_
+
+#include <QFile>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class TextureCache
+/// @brief a disk cache of decoded RGBA8 textures with the full mip chain already built. The file is a small header,
+/// a table of levels then the texels starting on a page boundary, laid out exactly as they are uploaded so a cache
+/// hit is just a memory map of the file. Files are named after a hash of the source image so an edited source
+/// simply misses the cache.
+//----------------------------------------------------------------------------------------------------------------------
+class TextureCache
+{
+  public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief size and offset (from the start of the texel data) of a mip level
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Level
+    {
+      uint32_t width;
+      uint32_t height;
+      uint64_t offset;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief build the RGBA8 mip chain layout for an image, each level halves down to 1x1
+    /// @param [out] o_levels the levels
+    /// @returns the size in bytes of the whole chain
+    //----------------------------------------------------------------------------------------------------------------------
+    static size_t mipLayout(uint32_t _width, uint32_t _height, std::vector<Level> &o_levels);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief hash the contents of a file, this is the cache key
+    /// @param [out] o_hash the hash
+    /// @returns false if the file can't be read
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool hashFile(const std::string &_fname, uint64_t &o_hash);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the cache file name for a given source hash
+    //----------------------------------------------------------------------------------------------------------------------
+    static std::string cacheName(const std::string &_dir, uint64_t _hash);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write a cache file, this goes via a temporary file so a crash can't leave a partial cache behind
+    /// @param _data the texels for the whole chain as given by mipLayout
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool write(const std::string &_fname, uint64_t _hash, uint32_t _width, uint32_t _height, const unsigned char *_data, size_t _size);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief memory map a cache file and validate it
+    /// @param _hash the expected source hash
+    /// @returns true if the file exists and is a valid cache for _hash
+    //----------------------------------------------------------------------------------------------------------------------
+    bool open(const std::string &_fname, uint64_t _hash);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mapped texels, valid while this object is
+    //----------------------------------------------------------------------------------------------------------------------
+    const unsigned char *data() const {return m_data;}
+    size_t size() const {return m_size;}
+    const std::vector<Level> &levels() const {return m_levels;}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief on disk header
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Header
+    {
+      char magic[4];
+      uint32_t version;
+      uint64_t sourceHash;
+      uint32_t width;
+      uint32_t height;
+      uint32_t numLevels;
+      uint32_t dataOffset;
+      uint64_t dataSize;
+    };
+    static constexpr uint32_t c_version=1;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the texels start on a page boundary
+    //----------------------------------------------------------------------------------------------------------------------
+    static constexpr uint32_t c_alignment=4096;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mapped file, QFile unmaps when it's closed
+    //----------------------------------------------------------------------------------------------------------------------
+    QFile m_file;
+    const unsigned char *m_data=nullptr;
+    size_t m_size=0;
+    std::vector<Level> m_levels;
+};
+
+#endif
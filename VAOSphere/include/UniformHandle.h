@@ -0,0 +1,55 @@
+#ifndef UNIFORMHANDLE_H_
+#define UNIFORMHANDLE_H_
+
+#include <ngl/Mat3.h>
+#include <ngl/Mat4.h>
+#include <ngl/Vec3.h>
+#include <ngl/Vec4.h>
+#include <ngl/Types.h>
+#include <cstddef>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class UniformHandle
+/// @brief a uniform's location looked up once after the program is linked, so setting it each frame is a glUniform
+/// call with no name hashing or glGetUniformLocation. The handle keeps the last value it set and skips the call if
+/// the new one is the same, which relies on nothing else setting that uniform. The GL keeps uniforms per program so
+/// that holds across switching programs, but the handle's program must be the one in use when set is called.
+//----------------------------------------------------------------------------------------------------------------------
+class UniformHandle
+{
+  public :
+    UniformHandle()=default;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief look up _name in a linked program, if it isn't there (or was optimised away) set does nothing
+    //----------------------------------------------------------------------------------------------------------------------
+    UniformHandle(GLuint _program, const char *_name);
+    bool valid() const {return m_location>=0;}
+    GLint location() const {return m_location;}
+    void set(const ngl::Mat4 &_value);
+    void set(const ngl::Mat3 &_value);
+    void set(const ngl::Vec3 &_value);
+    void set(const ngl::Vec4 &_value);
+    void set(float _r, float _g, float _b, float _a);
+    void set(float _value);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the next set goes to the GL whatever its value, for when something else may have set the uniform
+    //----------------------------------------------------------------------------------------------------------------------
+    void invalidate() {m_size=0;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief how many sets were skipped as the value hadn't changed
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t skipped() const {return m_skipped;}
+
+  private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if _value differs from the last value, which it then replaces
+    //----------------------------------------------------------------------------------------------------------------------
+    bool changed(const float *_value, size_t _size);
+    GLint m_location=-1;
+    // a mat4 is the largest value, m_size is 0 until something is set
+    float m_last[16];
+    size_t m_size=0;
+    size_t m_skipped=0;
+};
+
+#endif
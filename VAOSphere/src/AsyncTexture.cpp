@@ -0,0 +1,229 @@
+#include "AsyncTexture.h"
+#include <QImage>
+#include <QImageReader>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+AsyncTexture::AsyncTexture(const std::string &_fname, std::function<void()> _onReady, const std::string &_cacheDir) :
+  m_fname(_fname), m_cacheDir(_cacheDir), m_onReady(std::move(_onReady))
+{
+  // the placeholder is a single texel so we have something to sample straight away
+  const GLubyte placeholder[4]={64,96,160,255};
+  glGenTextures(1,&m_id);
+  glBindTexture(GL_TEXTURE_2D,m_id);
+  glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8,1,1,0,GL_RGBA,GL_UNSIGNED_BYTE,placeholder);
+  glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAX_LEVEL,0);
+
+  // reading the header is cheap, if we know the size we can map the pixel buffer now and
+  // let the worker write straight into it.
+  QImageReader reader(QString::fromStdString(m_fname));
+  QSize size=reader.size();
+  glGenBuffers(1,&m_pbo);
+  if(size.isValid())
+  {
+    m_size=TextureCache::mipLayout(static_cast<uint32_t>(size.width()),static_cast<uint32_t>(size.height()),m_levels);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER,m_pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER,static_cast<GLsizeiptr>(m_size),nullptr,GL_STREAM_DRAW);
+    m_mapped=static_cast<unsigned char *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,0,static_cast<GLsizeiptr>(m_size),
+                                                           GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+    if(m_mapped==nullptr)
+    {
+      // nothing was mapped so there is nothing to unmap, the worker sees the failure and stops straight away
+      std::cerr<<"AsyncTexture unable to map the pixel buffer for "<<m_fname<<"\n";
+      m_failed=true;
+    }
+  }
+  m_worker=std::thread(&AsyncTexture::decode,this);
+}
+
+AsyncTexture::~AsyncTexture()
+{
+  if(m_worker.joinable())
+  {
+    m_worker.join();
+  }
+  if(m_mapped !=nullptr)
+  {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER,m_pbo);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+  }
+  glDeleteBuffers(1,&m_pbo);
+  glDeleteTextures(1,&m_id);
+}
+
+void AsyncTexture::signalReady()
+{
+  m_decoded.store(true,std::memory_order_release);
+  if(m_onReady)
+  {
+    m_onReady();
+  }
+}
+
+bool AsyncTexture::loadFromCache(uint64_t _hash)
+{
+  if(!m_cache.open(TextureCache::cacheName(m_cacheDir,_hash),_hash))
+  {
+    return false;
+  }
+  const auto &levels=m_cache.levels();
+  if(m_mapped !=nullptr && m_cache.size()==m_size && levels[0].width==m_levels[0].width && levels[0].height==m_levels[0].height)
+  {
+    // the layout is identical so this is one sequential copy from the page cache
+    std::memcpy(m_mapped,m_cache.data(),m_size);
+  }
+  else
+  {
+    m_levels=levels;
+    m_size=m_cache.size();
+    m_upload=m_cache.data();
+  }
+  signalReady();
+  return true;
+}
+
+void AsyncTexture::decode()
+{
+  if(m_failed)
+  {
+    signalReady();
+    return;
+  }
+  uint64_t hash=0;
+  bool cacheable=!m_cacheDir.empty() && TextureCache::hashFile(m_fname,hash);
+  if(cacheable && loadFromCache(hash))
+  {
+    return;
+  }
+
+  QImage image;
+  if(!image.load(QString::fromStdString(m_fname)))
+  {
+    m_failed=true;
+    signalReady();
+    return;
+  }
+  // GL expects the first row to be the bottom of the image
+  image=image.convertToFormat(QImage::Format_RGBA8888).mirrored();
+  auto width=static_cast<uint32_t>(image.width());
+  auto height=static_cast<uint32_t>(image.height());
+  // the header size can lie (or not be available) in which case the GL thread will
+  // copy the chain to the buffer.
+  bool direct=m_mapped !=nullptr && m_levels[0].width==width && m_levels[0].height==height;
+  if(!direct)
+  {
+    m_size=TextureCache::mipLayout(width,height,m_levels);
+  }
+
+  // the mapped buffer may be write combined so never read back from it, build the whole
+  // chain in normal memory and copy it over in one go.
+  std::vector<unsigned char> chain(m_size);
+  // RGBA8888 scanlines are always 4 byte aligned so there is no padding to skip
+  std::memcpy(chain.data(),image.constBits(),static_cast<size_t>(width)*height*4);
+  for(size_t i=1; i<m_levels.size(); ++i)
+  {
+    const auto &from=m_levels[i-1];
+    const auto &to=m_levels[i];
+    downsample(chain.data()+from.offset,static_cast<int>(from.width),static_cast<int>(from.height),
+               chain.data()+to.offset,static_cast<int>(to.width),static_cast<int>(to.height));
+  }
+
+  if(direct)
+  {
+    std::memcpy(m_mapped,chain.data(),m_size);
+    signalReady();
+    // the GL thread doesn't need anything else from us so the cache can be written after
+    if(cacheable)
+    {
+      TextureCache::write(TextureCache::cacheName(m_cacheDir,hash),hash,width,height,chain.data(),chain.size());
+    }
+  }
+  else
+  {
+    m_staging=std::move(chain);
+    m_upload=m_staging.data();
+    if(cacheable)
+    {
+      TextureCache::write(TextureCache::cacheName(m_cacheDir,hash),hash,width,height,m_staging.data(),m_staging.size());
+    }
+    signalReady();
+  }
+}
+
+void AsyncTexture::downsample(const unsigned char *_src, int _srcWidth, int _srcHeight, unsigned char *_dst, int _dstWidth, int _dstHeight)
+{
+  for(int y=0; y<_dstHeight; ++y)
+  {
+    int y0=std::min(y*2,_srcHeight-1);
+    int y1=std::min(y*2+1,_srcHeight-1);
+    const unsigned char *row0=_src+static_cast<size_t>(y0)*_srcWidth*4;
+    const unsigned char *row1=_src+static_cast<size_t>(y1)*_srcWidth*4;
+    unsigned char *out=_dst+static_cast<size_t>(y)*_dstWidth*4;
+    for(int x=0; x<_dstWidth; ++x)
+    {
+      int x0=std::min(x*2,_srcWidth-1)*4;
+      int x1=std::min(x*2+1,_srcWidth-1)*4;
+      for(int c=0; c<4; ++c)
+      {
+        out[x*4+c]=static_cast<unsigned char>((row0[x0+c]+row0[x1+c]+row1[x0+c]+row1[x1+c]+2)/4);
+      }
+    }
+  }
+}
+
+bool AsyncTexture::update()
+{
+  if(m_loaded || !m_decoded.load(std::memory_order_acquire))
+  {
+    return m_loaded;
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER,m_pbo);
+  if(m_mapped !=nullptr)
+  {
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    m_mapped=nullptr;
+  }
+  if(m_failed)
+  {
+    std::cerr<<"AsyncTexture unable to load "<<m_fname<<" keeping placeholder\n";
+  }
+  else
+  {
+    if(m_upload !=nullptr)
+    {
+      glBufferData(GL_PIXEL_UNPACK_BUFFER,static_cast<GLsizeiptr>(m_size),m_upload,GL_STREAM_DRAW);
+      m_upload=nullptr;
+      std::vector<unsigned char>().swap(m_staging);
+    }
+    glBindTexture(GL_TEXTURE_2D,m_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT,4);
+    // with a pixel unpack buffer bound the data pointer is an offset into the buffer
+    for(size_t i=0; i<m_levels.size(); ++i)
+    {
+      const auto &level=m_levels[i];
+      glTexImage2D(GL_TEXTURE_2D,static_cast<GLint>(i),GL_RGBA8,static_cast<GLsizei>(level.width),static_cast<GLsizei>(level.height),0,GL_RGBA,GL_UNSIGNED_BYTE,
+                   reinterpret_cast<const GLvoid *>(level.offset));
+    }
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_BASE_LEVEL,0);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAX_LEVEL,static_cast<GLint>(m_levels.size()-1));
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+  glDeleteBuffers(1,&m_pbo);
+  m_pbo=0;
+  m_loaded=!m_failed;
+  // either way there is nothing left to do
+  m_decoded.store(false,std::memory_order_relaxed);
+  return m_loaded;
+}
+
+void AsyncTexture::bind() const
+{
+  glBindTexture(GL_TEXTURE_2D,m_id);
+}
@@ -0,0 +1,175 @@
+#include "MeshCache.h"
+#include <ngl/VAOFactory.h>
+#include <ngl/SimpleVAO.h>
+#include <ngl/SimpleIndexVAO.h>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+  constexpr uint64_t c_fnvPrime=0x100000001b3ULL;
+
+  uint64_t hashBytes(uint64_t _hash, const void *_data, size_t _size)
+  {
+    auto bytes=static_cast<const unsigned char *>(_data);
+    for(size_t i=0; i<_size; ++i)
+    {
+      _hash=(_hash ^ bytes[i])*c_fnvPrime;
+    }
+    return _hash;
+  }
+
+  uint64_t alignUp(uint64_t _value, uint64_t _alignment)
+  {
+    return (_value+_alignment-1)/_alignment*_alignment;
+  }
+
+  size_t indexTypeSize(GLenum _type)
+  {
+    switch(_type)
+    {
+      case GL_UNSIGNED_INT   : return sizeof(GLuint);
+      case GL_UNSIGNED_SHORT : return sizeof(GLushort);
+      default : return sizeof(GLubyte);
+    }
+  }
+}
+
+uint64_t MeshCache::key(const std::string &_generator, std::initializer_list<float> _params)
+{
+  uint64_t hash=hashBytes(0xcbf29ce484222325ULL,_generator.data(),_generator.size());
+  for(auto p : _params)
+  {
+    hash=hashBytes(hash,&p,sizeof(float));
+  }
+  return hash;
+}
+
+std::string MeshCache::cacheName(const std::string &_dir, const std::string &_generator, uint64_t _key)
+{
+  std::ostringstream name;
+  name<<_dir<<'/'<<_generator<<'_'<<std::hex<<std::setw(16)<<std::setfill('0')<<_key<<".nmc";
+  return name.str();
+}
+
+std::unique_ptr<ngl::AbstractVAO> MeshCache::createVAO(const Layout &_layout, const void *_vertices, size_t _vertexSize,
+                                                       const void *_indices, size_t _indexSize)
+{
+  std::unique_ptr<ngl::AbstractVAO> vao;
+  auto data=static_cast<const GLfloat *>(_vertices);
+  if(_layout.indexType !=0)
+  {
+    vao=ngl::VAOFactory::createVAO(ngl::simpleIndexVAO,_layout.mode);
+    vao->bind();
+    // SimpleIndexVAO wants the number of indices not the size in bytes
+    auto count=static_cast<unsigned int>(_indexSize/indexTypeSize(_layout.indexType));
+    vao->setData(ngl::SimpleIndexVAO::VertexData(_vertexSize,*data,count,_indices,_layout.indexType));
+  }
+  else
+  {
+    vao=ngl::VAOFactory::createVAO(ngl::simpleVAO,_layout.mode);
+    vao->bind();
+    vao->setData(ngl::SimpleVAO::VertexData(_vertexSize,*data));
+  }
+  for(auto &a : _layout.attributes)
+  {
+    vao->setVertexAttributePointer(a.id,a.size,a.type,a.stride,a.offset,a.normalise!=0);
+  }
+  vao->setNumIndices(static_cast<size_t>(_layout.numIndices));
+  vao->unbind();
+  return vao;
+}
+
+bool MeshCache::write(const std::string &_fname, uint64_t _key, const Layout &_layout, const void *_vertices, size_t _vertexSize,
+                      const void *_indices, size_t _indexSize)
+{
+  QDir().mkpath(QFileInfo(QString::fromStdString(_fname)).absolutePath());
+  QSaveFile file(QString::fromStdString(_fname));
+  if(!file.open(QIODevice::WriteOnly))
+  {
+    return false;
+  }
+  Header header;
+  std::memset(&header,0,sizeof(Header));
+  std::memcpy(header.magic,"NMSH",4);
+  header.version=c_version;
+  header.key=_key;
+  header.mode=_layout.mode;
+  header.indexType=_layout.indexType;
+  header.numIndices=_layout.numIndices;
+  header.numAttributes=static_cast<uint32_t>(_layout.attributes.size());
+  header.vertexOffset=alignUp(sizeof(Header)+_layout.attributes.size()*sizeof(Attribute),c_alignment);
+  header.vertexSize=_vertexSize;
+  header.indexOffset=alignUp(header.vertexOffset+_vertexSize,c_alignment);
+  header.indexSize=_indexSize;
+
+  std::vector<char> prefix(header.vertexOffset,0);
+  std::memcpy(prefix.data(),&header,sizeof(Header));
+  std::memcpy(prefix.data()+sizeof(Header),_layout.attributes.data(),_layout.attributes.size()*sizeof(Attribute));
+  file.write(prefix.data(),static_cast<qint64>(prefix.size()));
+  file.write(static_cast<const char *>(_vertices),static_cast<qint64>(_vertexSize));
+  if(_indexSize !=0)
+  {
+    std::vector<char> pad(header.indexOffset-header.vertexOffset-_vertexSize,0);
+    file.write(pad.data(),static_cast<qint64>(pad.size()));
+    file.write(static_cast<const char *>(_indices),static_cast<qint64>(_indexSize));
+  }
+  return file.commit();
+}
+
+bool MeshCache::open(const std::string &_fname, uint64_t _key)
+{
+  m_file.close();
+  m_vertices=nullptr;
+  m_indices=nullptr;
+  m_file.setFileName(QString::fromStdString(_fname));
+  if(!m_file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+  auto fileSize=static_cast<uint64_t>(m_file.size());
+  const uchar *map=m_file.map(0,m_file.size());
+  if(map==nullptr || fileSize<sizeof(Header))
+  {
+    m_file.close();
+    return false;
+  }
+  Header header;
+  std::memcpy(&header,map,sizeof(Header));
+  // compare sizes against what is left of the file rather than summing
+  // offsets, so a corrupt header can't wrap the uint64 arithmetic
+  auto attributeSize=static_cast<uint64_t>(header.numAttributes)*sizeof(Attribute);
+  bool valid= std::memcmp(header.magic,"NMSH",4)==0 &&
+              header.version==c_version &&
+              header.key==_key &&
+              attributeSize<=fileSize-sizeof(Header) &&
+              header.vertexOffset>=sizeof(Header)+attributeSize &&
+              header.vertexOffset<=fileSize &&
+              header.vertexSize<=fileSize-header.vertexOffset &&
+              (header.indexSize==0 ||
+               (header.indexOffset<=fileSize && header.indexSize<=fileSize-header.indexOffset));
+  if(!valid)
+  {
+    m_file.close();
+    return false;
+  }
+  m_layout.mode=header.mode;
+  m_layout.indexType=header.indexType;
+  m_layout.numIndices=header.numIndices;
+  m_layout.attributes.resize(header.numAttributes);
+  std::memcpy(m_layout.attributes.data(),map+sizeof(Header),static_cast<size_t>(attributeSize));
+  m_vertices=map+header.vertexOffset;
+  m_vertexSize=static_cast<size_t>(header.vertexSize);
+  m_indices=header.indexSize !=0 ? map+header.indexOffset : nullptr;
+  m_indexSize=static_cast<size_t>(header.indexSize);
+  return true;
+}
+
+std::unique_ptr<ngl::AbstractVAO> MeshCache::createVAO() const
+{
+  return createVAO(m_layout,m_vertices,m_vertexSize,m_indices,m_indexSize);
+}
@@ -3,12 +3,14 @@
 
 #include "NGLScene.h"
 #include <ngl/Transformation.h>
-#include <ngl/Texture.h>
 #include <ngl/NGLInit.h>
 #include <ngl/ShaderLib.h>
 #include <ngl/VAOFactory.h>
 #include <ngl/SimpleVAO.h>
+#include "MeshCache.h"
+#include "SphereTable.h"
 //#include  <cstddef>
+#include <algorithm>
 #include <iostream>
 
 NGLScene::NGLScene()
@@ -19,42 +21,48 @@ NGLScene::NGLScene()
 NGLScene::~NGLScene()
 {
   std::cout << "Shutting down NGL, removing VAO's and Shaders\n";
+  // the texture owns GL objects so we need the context to release them
+  makeCurrent();
+  m_texture.reset();
 }
 
-// a simple structure to hold our vertex data
-struct vertData
+// the layout of the vertData in SphereTable.h, If you look at the shader we have the following attributes being used
+// attribute vec3 inVert; attribute 0
+// attribute vec3 inNormal; attribure 1
+// attribute vec2 inUV; attribute 2
+// so we need to set the vertexAttributePointer so the correct size and type as follows
+// vertex is attribute 0 with x,y,z(3) parts of type GL_FLOAT, our complete packed data is
+// sizeof(vertData) and the offset into the data structure for the first x component is 0 then
+// the normal is 3 floats in and the uv 6.
+static MeshCache::Layout sphereLayout(size_t _numVerts)
 {
-  GLfloat x;  // 0
-  GLfloat y;  // 1
-  GLfloat z;  // 2
-  GLfloat nx; // 3
-  GLfloat ny; // 4
-  GLfloat nz; // 5
-  GLfloat u;  // 6
-  GLfloat v;  // 7
-};
+  MeshCache::Layout layout;
+  layout.mode = GL_TRIANGLE_STRIP;
+  layout.numIndices = _numVerts;
+  layout.attributes = {{0, 3, GL_FLOAT, sizeof(vertData), 0, 0},
+                       {1, 3, GL_FLOAT, sizeof(vertData), 3, 0},
+                       {2, 2, GL_FLOAT, sizeof(vertData), 6, 0}};
+  return layout;
+}
 
 void NGLScene::buildVAOSphere()
+{
+  // the default sphere has a fixed precision so the whole table is built by the compiler
+  // and lives in the executable, all we need to do is upload it.
+  static constexpr auto sphere = makeSphere<c_defaultPrecision>(1.0f);
+  m_vao = MeshCache::createVAO(sphereLayout(sphere.size()), sphere.data(), sizeof(sphere), nullptr, 0);
+}
+
+void NGLScene::buildVAOSphere(float _radius, int _precision)
 {
   //  Sphere code based on a function Written by Paul Bourke.
   //  http://astronomy.swin.edu.au/~pbourke/opengl/sphere/
-  // first we grab an instance of our VOA class as a TRIANGLE_STRIP
-  m_vao = ngl::VAOFactory::createVAO(ngl::simpleVAO, GL_TRIANGLE_STRIP);
-  // next we bind it so it's active for setting data
-  m_vao->bind();
-  // the next part of the code calculates the P,N,UV of the sphere for tri_strips
-
   float theta1 = 0.0;
   float theta2 = 0.0;
   float theta3 = 0.0;
 
-  float radius = 1.0;
-  float precision = 100;
-  // a std::vector to store our verts, remember vector packs contiguously so we can use it
-  size_t buffSize = (static_cast<size_t>(precision) / 2) * ((static_cast<size_t>(precision) + 1) * 2);
-
-  std::vector<vertData> data(buffSize);
-  // calculate how big our buffer is
+  float radius = _radius;
+  float precision = static_cast<float>(_precision);
   // Disallow a negative number for radius.
   if (radius < 0)
   {
@@ -65,6 +73,23 @@ void NGLScene::buildVAOSphere()
   {
     precision = 4;
   }
+  auto layout = sphereLayout(0);
+  // if we have built this sphere before just map it from the cache, the key needs to
+  // change if the code below changes the output so bump this if you edit it.
+  constexpr float generatorVersion = 1.0f;
+  auto key = MeshCache::key("sphere", {generatorVersion, radius, precision});
+  auto cacheFile = MeshCache::cacheName("meshes/cache", "sphere", key);
+  MeshCache cache;
+  if (cache.open(cacheFile, key))
+  {
+    m_vao = cache.createVAO();
+    return;
+  }
+  // the next part of the code calculates the P,N,UV of the sphere for tri_strips
+  // calculate how big our buffer is
+  size_t buffSize = (static_cast<size_t>(precision) / 2) * ((static_cast<size_t>(precision) + 1) * 2);
+  // a std::vector to store our verts, remember vector packs contiguously so we can use it
+  std::vector<vertData> data(buffSize);
   // now fill in a vertData structure and add to the data list for our sphere
   vertData d;
   unsigned int index = 0;
@@ -102,28 +127,14 @@ void NGLScene::buildVAOSphere()
     } // end inner loop
   }   // end outer loop
 
-  // now we have our data add it to the VAO, we need to tell the VAO the following
+  // now we have our data create the VAO, we need to tell the VAO the following
   // how much (in bytes) data we are copying
   // a pointer to the first element of data (in this case the address of the first element of the
   // std::vector
-  m_vao->setData(ngl::AbstractVAO::VertexData(buffSize * sizeof(vertData), data[0].x));
-  // in this case we have packed our data in interleaved format as follows
-  // u,v,nx,ny,nz,x,y,z
-  // If you look at the shader we have the following attributes being used
-  // attribute vec3 inVert; attribute 0
-  // attribute vec3 inNormal; attribure 1
-  // attribute vec2 inUV; attribute 2
-  // so we need to set the vertexAttributePointer so the correct size and type as follows
-  // vertex is attribute 0 with x,y,z(3) parts of type GL_FLOAT, our complete packed data is
-  // sizeof(vertData) and the offset into the data structure for the first x component is 5 (u,v,nx,ny,nz)..x
-
-  m_vao->setVertexAttributePointer(0, 3, GL_FLOAT, sizeof(vertData), 0);
-  m_vao->setVertexAttributePointer(1, 3, GL_FLOAT, sizeof(vertData), 3);
-  m_vao->setVertexAttributePointer(2, 2, GL_FLOAT, sizeof(vertData), 6);
-  // set the size of the buffer / num verts to draw
-  m_vao->setNumIndices(buffSize);
-  // finally we have finished for now so time to unbind the VAO
-  m_vao->unbind();
+  layout.numIndices = buffSize;
+  m_vao = MeshCache::createVAO(layout, data.data(), buffSize * sizeof(vertData), nullptr, 0);
+  // and save it so next time we don't need to build it
+  MeshCache::write(cacheFile, key, layout, data.data(), buffSize * sizeof(vertData), nullptr, 0);
 }
 
 void NGLScene::resizeGL(int _w, int _h)
@@ -169,11 +180,20 @@ void NGLScene::initializeGL()
 
   ngl::ShaderLib::linkProgramObject("TextureShader");
   ngl::ShaderLib::use("TextureShader");
+  // looked up once here so paintGL sets MVP without a name lookup
+  m_MVPUniform = UniformHandle(ngl::ShaderLib::getProgramID("TextureShader"), "MVP");
   // build our VertexArrayObject
   buildVAOSphere();
-  // load and set a texture
-  ngl::Texture t("textures/earth.png");
-  t.setTextureGL();
+  // start loading the texture, the decode happens on another thread and until it's done
+  // we draw with a placeholder. When it's ready we need a repaint to do the upload, the
+  // callback comes from the worker so queue it onto the GUI thread. The decoded mip chain is
+  // cached in textures/cache so the next run doesn't need to decode the png at all.
+  m_texture = std::make_unique<AsyncTexture>(
+      "textures/earth.png", [this]()
+      { QMetaObject::invokeMethod(this, [this]()
+                                  { update(); },
+                                  Qt::QueuedConnection); },
+      "textures/cache");
 }
 
 void NGLScene::paintGL()
@@ -196,7 +216,10 @@ void NGLScene::paintGL()
   ngl::Mat4 MVP;
   MVP = m_project * m_view * m_mouseGlobalTX;
 
-  ngl::ShaderLib::setUniform("MVP", MVP);
+  m_MVPUniform.set(MVP);
+  // upload the texture if the loader has finished, else this is still the placeholder
+  m_texture->update();
+  m_texture->bind();
 
   // now we bind back our vertex array object and draw
   m_vao->bind();
@@ -325,6 +348,21 @@ void NGLScene::keyPressEvent(QKeyEvent *_event)
   case Qt::Key_N:
     showNormal();
     break;
+  // change the sphere precision, anything other than the default is generated at run time
+  case Qt::Key_Plus:
+  case Qt::Key_Minus:
+    m_precision = std::max(4, m_precision + (_event->key() == Qt::Key_Plus ? 10 : -10));
+    makeCurrent();
+    m_vao->removeVAO();
+    if (m_precision == c_defaultPrecision)
+    {
+      buildVAOSphere();
+    }
+    else
+    {
+      buildVAOSphere(1.0f, m_precision);
+    }
+    break;
   default:
     break;
   }
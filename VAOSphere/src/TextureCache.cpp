@@ -0,0 +1,135 @@
+#include "TextureCache.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+size_t TextureCache::mipLayout(uint32_t _width, uint32_t _height, std::vector<Level> &o_levels)
+{
+  o_levels.clear();
+  uint64_t offset=0;
+  uint32_t w=_width;
+  uint32_t h=_height;
+  while(true)
+  {
+    o_levels.push_back({w,h,offset});
+    offset+=static_cast<uint64_t>(w)*h*4;
+    if(w==1 && h==1)
+    {
+      break;
+    }
+    w=std::max(1u,w/2);
+    h=std::max(1u,h/2);
+  }
+  return static_cast<size_t>(offset);
+}
+
+bool TextureCache::hashFile(const std::string &_fname, uint64_t &o_hash)
+{
+  QFile file(QString::fromStdString(_fname));
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+  auto size=static_cast<size_t>(file.size());
+  const uchar *data=file.map(0,file.size());
+  if(data==nullptr)
+  {
+    return false;
+  }
+  // FNV-1a style but mixing a word at a time, we are hashing Gb's of textures so
+  // this needs to run at memory speed
+  constexpr uint64_t prime=0x100000001b3ULL;
+  uint64_t hash=0xcbf29ce484222325ULL ^ size;
+  size_t i=0;
+  for(; i+8<=size; i+=8)
+  {
+    uint64_t word;
+    std::memcpy(&word,data+i,sizeof(word));
+    hash=(hash ^ word)*prime;
+  }
+  for(; i<size; ++i)
+  {
+    hash=(hash ^ data[i])*prime;
+  }
+  o_hash=hash;
+  return true;
+}
+
+std::string TextureCache::cacheName(const std::string &_dir, uint64_t _hash)
+{
+  std::ostringstream name;
+  name<<_dir<<'/'<<std::hex<<std::setw(16)<<std::setfill('0')<<_hash<<".ntc";
+  return name.str();
+}
+
+bool TextureCache::write(const std::string &_fname, uint64_t _hash, uint32_t _width, uint32_t _height, const unsigned char *_data, size_t _size)
+{
+  std::vector<Level> levels;
+  if(mipLayout(_width,_height,levels) != _size)
+  {
+    return false;
+  }
+  QDir().mkpath(QFileInfo(QString::fromStdString(_fname)).absolutePath());
+  QSaveFile file(QString::fromStdString(_fname));
+  if(!file.open(QIODevice::WriteOnly))
+  {
+    return false;
+  }
+  Header header;
+  std::memcpy(header.magic,"NTXC",4);
+  header.version=c_version;
+  header.sourceHash=_hash;
+  header.width=_width;
+  header.height=_height;
+  header.numLevels=static_cast<uint32_t>(levels.size());
+  size_t tableEnd=sizeof(Header)+levels.size()*sizeof(Level);
+  header.dataOffset=static_cast<uint32_t>((tableEnd+c_alignment-1)/c_alignment*c_alignment);
+  header.dataSize=_size;
+
+  std::vector<char> prefix(header.dataOffset,0);
+  std::memcpy(prefix.data(),&header,sizeof(Header));
+  std::memcpy(prefix.data()+sizeof(Header),levels.data(),levels.size()*sizeof(Level));
+  file.write(prefix.data(),static_cast<qint64>(prefix.size()));
+  file.write(reinterpret_cast<const char *>(_data),static_cast<qint64>(_size));
+  return file.commit();
+}
+
+bool TextureCache::open(const std::string &_fname, uint64_t _hash)
+{
+  m_file.close();
+  m_data=nullptr;
+  m_file.setFileName(QString::fromStdString(_fname));
+  if(!m_file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+  auto fileSize=static_cast<uint64_t>(m_file.size());
+  const uchar *map=m_file.map(0,m_file.size());
+  if(map==nullptr || fileSize<sizeof(Header))
+  {
+    m_file.close();
+    return false;
+  }
+  Header header;
+  std::memcpy(&header,map,sizeof(Header));
+  bool valid= std::memcmp(header.magic,"NTXC",4)==0 &&
+              header.version==c_version &&
+              header.sourceHash==_hash &&
+              header.dataOffset>=sizeof(Header)+header.numLevels*sizeof(Level) &&
+              header.dataOffset+header.dataSize<=fileSize &&
+              mipLayout(header.width,header.height,m_levels)==header.dataSize &&
+              m_levels.size()==header.numLevels &&
+              std::memcmp(map+sizeof(Header),m_levels.data(),m_levels.size()*sizeof(Level))==0;
+  if(!valid)
+  {
+    m_file.close();
+    return false;
+  }
+  m_data=map+header.dataOffset;
+  m_size=static_cast<size_t>(header.dataSize);
+  return true;
+}